@@ -1,336 +1,2027 @@
-#pragma once
-
-#include <vector>
-#include <functional>
-#include <deque>
-#include <array>
-
-// 2-dimensional Tilemap structure (for 2-dimensional tilemaps in games and image processing) implementations and functions.
-
-// All 2-dimensional tilemap types here have a template tile type 'T' that can be default-constructed, has contiguous and direct memory access, with 1-dimensional data starting from the leftmost and first element of the top and first row, going from left to right.
-
-namespace tm2D
-{
-
-// Coordinates of a 2-dimensional tilemap.
-struct Point
-{
-	size_t x = 0;
-	size_t y = 0;
-
-	constexpr bool operator==(const Point&) const = default;
-};
-
-// An area of a 2-dimensional tilemap, starting from the top left.
-struct Rect
-{
-	size_t x = 0;
-	size_t y = 0;
-	size_t width = 0;
-	size_t height = 0;
-
-	constexpr bool operator==(const Rect& r) const = default;
-
-	// Check if 2 rectangles intersect. 
-	constexpr bool intersects(const Rect& r) const
-	{
-		return
-			(x + width > r.x) && (x < r.x + r.width) &&
-			(y + height > r.y) && (y < r.y + r.height);
-	}
-
-	// Get the intersection area of 2 rectangles.
-	// Returns:
-	// Empty rectangle (Rect()) if the 2 rectangles don't intersect.
-	Rect intersection(const Rect& r) const
-	{
-		Rect res;
-		if (intersects(r)) {
-			res.x = std::max<>(x, r.x);
-			res.y = std::max<>(y, r.y);
-			res.width = std::min<>(x + width, r.x + r.width) - res.x;
-			res.height = std::min<>(y + height, r.y + r.height) - res.y;
-		}
-		return res;
-	}
-};
-
-// Implementation class for TileMap2D types.
-template<typename T>
-struct TileMap2DImpl
-{
-	// Get width of tilemap.
-	virtual size_t width() const = 0;
-	// Get height of tilemap.
-	virtual size_t height() const = 0;
-
-	// Get tile directly (does not check for bounds).
-	virtual T& operator()(size_t x, size_t y) = 0;
-	// Get const reference to tile directly (does not check for bounds).
-	virtual const T& operator()(size_t x, size_t y) const = 0;
-
-	// Get tile, with bounds checking. If out of bounds, return default-constructed value.
-	virtual T get(size_t x, size_t y) const
-	{
-		return (x < width() && y < height()) ? operator()(x, y) : T{};
-	}
-	// Set tile, with bounds checking. If out of bounds, do nothing.
-	virtual void set(size_t x, size_t y, const T& t)
-	{
-		if (x < width() && y < height()) operator()(x, y) = t;
-	}
-
-	// Filp the tilemap.
-	// Note: calling this function with both parameters set to 'true' is equal to calling rot90() twice in the same direction.
-	void flip(bool horizontal, bool vertical)
-	{
-		if (horizontal) {
-			for (size_t x = 0; x < width() / 2; x++)
-				for (size_t y = 0; y < height(); y++)
-					std::swap(operator()(x, y), operator()(width() - 1 - x, y));
-		}
-		if (vertical) {
-			for (size_t y = 0; y < height() / 2; y++)
-				for (size_t x = 0; x < width(); x++)
-					std::swap(operator()(x, y), operator()(x, height() - 1 - y));
-		}
-	}
-
-	// Draw a line from [p1] to [p2] on a tilemap.
-	// Params:
-	//   [drawfunc] Draw function that takes a tilemap, x and y coordinates as parameters.
-	void drawLine(
-		const Point& p1,
-		const Point& p2,
-		const std::function<void(TileMap2DImpl*, size_t, size_t)>& drawfunc
-	) {
-		// Get the longer distance to use in the draw loop.
-		Point delta(
-			(p1.x < p2.x) ? (p2.x - p1.x) : (p1.x - p2.x),
-			(p1.y < p2.y) ? (p2.y - p1.y) : (p1.y - p2.y)
-		);
-
-		// Starting point.
-		double current_x = p1.x, current_y = p1.y;
-		double step_x, step_y;
-
-		if (delta.x > delta.y) {
-			step_x = (p2.x - p1.x) / (double)delta.x;
-			step_y = (p2.y - p1.y) / (double)delta.x;
-
-			for (size_t x = 0; x <= delta.x; x++) {
-				drawfunc(this, round(current_x), round(current_y));
-				current_x += step_x;
-				current_y += step_y;
-			}
-		}
-		else {
-			step_x = (p2.x - p1.x) / (double)delta.y;
-			step_y = (p2.y - p1.y) / (double)delta.y;
-
-			for (size_t y = 0; y <= delta.y; y++) {
-				drawfunc(this, round(current_x), round(current_y));
-				current_x += step_x;
-				current_y += step_y;
-			}
-		}
-	}
-
-	// Fill a polygonal area of elements sastifying [rule] with [elem].
-	void fillArea(
-		const Point& center,
-		const std::function<bool(const T&)>& rule,
-		const T& elem
-	) {
-		std::deque<Point> positions;
-
-		if (center.x < width() && center.y < height()) {
-			positions.push_back(center);
-		}
-		
-		while (!positions.empty()) {
-			// Get the current iteration's size to remove this iteration and get the next iteration in tandem.
-			size_t iteration_elem_size = positions.size();
-
-			for (size_t i = 0; i < iteration_elem_size; i++) {
-				Point current = *positions.begin();
-
-				operator()(current.x, current.y) = elem;
-
-				std::array<Point, 4> adjs({
-					{ current.x - 1, current.y },
-					{ current.x + 1, current.y },
-					{ current.x, current.y - 1 },
-					{ current.x, current.y + 1 }
-				});
-
-				for (const Point& adj : adjs) {
-					// Ignore out-of-bounds positions and elements that satisfy [rule].
-					if ((adj.x < width() && adj.y < height()) && rule(operator()(adj.x, adj.y))) {
-						positions.push_back(adj);
-
-						// Set the adjacent pixels also to avoid duplicates.
-						Point current_nextitr = *positions.rbegin();
-
-						operator()(current_nextitr.x, current_nextitr.y) = elem;
-					}
-				}
-
-				positions.pop_front();
-			}
-		}
-	}
-};
-
-// Implementation class for resizable TileMap2D types.
-template<typename T>
-struct ResizableTileMap2DImpl: public TileMap2DImpl<T>
-{
-	// Initialize the tilemap with a new buffer and fill the new space with [padding].
-	virtual void reset(size_t new_width, size_t new_height, const T& padding = {}) = 0;
-};
-
-// A 2-dimensional tilemap view of a contiguous memory buffer that can be used for providing 2-dimensional access to large 1-dimensional image data without having to copy it into a 2-dimensional container.
-template<typename T>
-struct TileMap2DView: public TileMap2DImpl<T>
-{
-	TileMap2DView() {}
-
-	TileMap2DView(void* data, size_t width, size_t height)
-		: _data((T*)data), _width(width), _height(height) {}
-
-	constexpr size_t width() const { return _width; }
-	constexpr size_t height() const { return _height; }
-
-	constexpr T& operator()(size_t x, size_t y) { return _data[x + _width * y]; }
-
-	constexpr const T& operator()(size_t x, size_t y) const { return _data[x + _width * y]; }
-
-	constexpr T* data() const { return _data; }
-
-private:
-	T* _data = NULL;
-	size_t _width = 0;
-	size_t _height = 0;
-};
-
-// A 2-dimensional tilemap with a contiguous 1-dimensional memory buffer.
-template<typename T>
-struct TileMap2D_1D: public ResizableTileMap2DImpl<T>
-{
-	TileMap2D_1D() {}
-
-	// Initialize by row-major initializer list as 2D array.
-	TileMap2D_1D(std::initializer_list<T> arr, size_t _width, size_t _height)
-		: _width(_width), _height(_height)
-	{
-		_data.resize(_width * _height);
-		for (size_t i = 0; i < std::min<>(arr.size(), _data.size()); i++)
-			_data[i] = *(arr.begin() + i);
-	}
-
-	// Copies the underlying content of a TileMap2DView.
-	TileMap2D_1D(const TileMap2DView<T>& view)
-		: _width(view.width()), _height(view.height())
-	{
-		_data.resize(_width * _height);
-		std::copy(view.data(), view.data() + _data.size(), _data.begin());
-	}
-
-	TileMap2D_1D(size_t _width, size_t _height, const T& elem = {})
-		: _width(_width), _height(_height)
-	{
-		_data.resize(_width * _height, elem);
-	}
-
-	constexpr size_t width() const { return _width; }
-	constexpr size_t height() const { return _height; }
-
-	constexpr T& operator()(size_t x, size_t y) { return _data[x + _width * y]; }
-
-	constexpr const T& operator()(size_t x, size_t y) const { return _data[x + _width * y]; }
-
-	void reset(size_t new_width, size_t new_height, const T& padding = {})
-	{
-		_width = new_width;
-		_height = new_height;
-		_data.clear();
-		_data.resize(new_width * new_height, padding);
-	}
-
-	// Get the pointer to the underlying data.
-	constexpr T* data() { return _data.data(); }
-
-private:
-	std::vector<T> _data = {};
-	size_t _width = 0;
-	size_t _height = 0;
-};
-
-// Get a chunk of a 2D tilemap with the size of [src_area] and return in [output_map].
-// This can also be used to 'resize' tilemap, by setting [src_area]'s position to (0; 0).
-template<typename T>
-void getChunk(
-	ResizableTileMap2DImpl<T>* output,
-	const TileMap2DImpl<T>* input,
-	const Rect& src_area
-) {
-	output->reset(src_area.width, src_area.height);
-	const Rect src_cliprect = src_area.intersection({ 0, 0, input->width(), input->height() });
-
-	for (size_t _x = 0; _x < src_cliprect.width; _x++)
-		for (size_t _y = 0; _y < src_cliprect.height; _y++)
-			(*output)(_x, _y) = (*input)(_x + src_cliprect.x, _y + src_cliprect.y);
-}
-
-// Set a chunk of a 2D tilemap.
-// Parameters:
-//   [src_area]: Source chunk area to get from. Default value is the whole [src_chunk] area.
-template<typename T>
-void setChunk(
-	TileMap2DImpl<T>* output,
-	const TileMap2DImpl<T>* input,
-	size_t x,
-	size_t y,
-	Rect src_area = {}
-) {
-	if (src_area == Rect(0, 0, 0, 0))
-		src_area = { 0, 0, input->width(), input->height() };
-
-	const Rect
-		src_cliprect = src_area.intersection({ 0, 0, input->width(), input->height() }),
-		dst_cliprect = Rect(x, y, src_cliprect.width, src_cliprect.height).intersection({ 0, 0, output->width(), output->height() });
-
-	for (size_t _x = 0; _x < dst_cliprect.width; _x++)
-		for (size_t _y = 0; _y < dst_cliprect.height; _y++)
-			(*output)(x + dst_cliprect.x, y + dst_cliprect.y) = (*input)(_x + src_cliprect.x, _y + src_cliprect.y);
-}
-
-// Rotate the tilemap 90 degrees in the top left corner.
-// Params:
-//   [rotate_left] If true, rotate to the left, otherwise rotate to the right.
-template<typename T>
-void rot90(
-	ResizableTileMap2DImpl<T>* output,
-	const TileMap2DImpl<T>* input,
-	bool rotate_left
-) {
-	output->reset(input->height(), input->width());
-
-	if (rotate_left) {
-		for (size_t x = 0; x < output->width(); x++) {
-			for (size_t y = 0; y < output->height(); y++) {
-				(*output)(x, y) = (*input)(output->height() - y - 1, x);
-			}
-		}
-	}
-	else {
-		for (size_t x = 0; x < output->width(); x++) {
-			for (size_t y = 0; y < output->height(); y++) {
-				(*output)(x, y) = (*input)(y, output->width() - x - 1);
-			}
-		}
-	}
-}
-
+#pragma once
+
+#include <vector>
+#include <functional>
+#include <concepts>
+#include <type_traits>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <utility>
+#include <span>
+#include <memory>
+#include <memory_resource>
+#include <cstdint>
+#include <bit>
+#if defined(_MSC_VER) && defined(_M_X64)
+	#include <intrin.h>
+#endif
+#ifdef TM2D_INSTRUMENT
+	#include <chrono>
+#endif
+
+// SIMD code paths are selected from the target's instruction sets. Define TM2D_NO_SIMD to use the scalar code paths only.
+#ifndef TM2D_NO_SIMD
+	#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#include <emmintrin.h>
+		#define TM2D_SSE2 1
+	#endif
+	#if defined(__AVX2__)
+		#include <immintrin.h>
+		#define TM2D_AVX2 1
+	#endif
+	#if defined(__ARM_NEON) || defined(_M_ARM64)
+		#include <arm_neon.h>
+		#define TM2D_NEON 1
+	#endif
+	// pdep/pext for the Z-order layout. They are microcoded and slow on AMD CPUs before Zen 3: define TM2D_NO_BMI2 for them.
+	#if (defined(__BMI2__) || (defined(_MSC_VER) && defined(__AVX2__))) && !defined(TM2D_NO_BMI2)
+		#include <immintrin.h>
+		#define TM2D_BMI2 1
+	#endif
+#endif
+
+// 2-dimensional Tilemap structure (for 2-dimensional tilemaps in games and image processing) implementations and functions.
+
+// All 2-dimensional tilemap types here have a template tile type 'T' that can be default-constructed, has contiguous and direct memory access, with 1-dimensional data starting from the leftmost and first element of the top and first row, going from left to right.
+
+namespace tm2D
+{
+
+// Coordinates of a 2-dimensional tilemap.
+struct Point
+{
+	size_t x = 0;
+	size_t y = 0;
+
+	constexpr bool operator==(const Point&) const = default;
+};
+
+// An area of a 2-dimensional tilemap, starting from the top left.
+struct Rect
+{
+	size_t x = 0;
+	size_t y = 0;
+	size_t width = 0;
+	size_t height = 0;
+
+	constexpr bool operator==(const Rect& r) const = default;
+
+	// Check if 2 rectangles intersect. 
+	constexpr bool intersects(const Rect& r) const
+	{
+		return
+			(x + width > r.x) && (x < r.x + r.width) &&
+			(y + height > r.y) && (y < r.y + r.height);
+	}
+
+	// Get the intersection area of 2 rectangles.
+	// Returns:
+	// Empty rectangle (Rect()) if the 2 rectangles don't intersect.
+	Rect intersection(const Rect& r) const
+	{
+		Rect res;
+		if (intersects(r)) {
+			res.x = std::max<>(x, r.x);
+			res.y = std::max<>(y, r.y);
+			res.width = std::min<>(x + width, r.x + r.width) - res.x;
+			res.height = std::min<>(y + height, r.y + r.height) - res.y;
+		}
+		return res;
+	}
+};
+
+// Tile type of a tilemap type [M].
+template<typename M>
+using tile_t = std::remove_cvref_t<decltype(std::declval<M&>()(size_t(0), size_t(0)))>;
+
+// Any type with 2-dimensional, unchecked tile access through 'operator()(x, y)' returning a reference, and 'width()' and 'height()'.
+// Algorithms taking a 'TileMapLike' are instantiated for the concrete tilemap type, so the tile access of types like TileMap2DView and TileMap2D_1D is inlined instead of going through TileMap2DImpl's virtual interface.
+template<typename M>
+concept TileMapLike = requires(M& m, const M& cm, size_t x, size_t y) {
+	{ cm.width() } -> std::convertible_to<size_t>;
+	{ cm.height() } -> std::convertible_to<size_t>;
+	{ m(x, y) } -> std::convertible_to<const tile_t<M>&>;
+	requires std::is_lvalue_reference_v<decltype(m(x, y))>;
+};
+
+// A 'TileMapLike' that can be reinitialized with a new size.
+template<typename M>
+concept ResizableTileMapLike = TileMapLike<M> && requires(M& m, size_t w, size_t h, const tile_t<M>& padding) {
+	m.reset(w, h, padding);
+};
+
+// A 'TileMapLike' whose rows are stored contiguously in a row-major buffer accessible through 'data()', with the starts of consecutive rows 'pitch()' tiles apart.
+template<typename M>
+concept ContiguousTileMap = TileMapLike<M> && requires(const M& cm) {
+	{ cm.data() } -> std::convertible_to<const tile_t<M>*>;
+	{ cm.pitch() } -> std::convertible_to<size_t>;
+};
+
+// Whether writes to the tiles of [M] may allocate its storage (e.g. the chunks of a TileMap2D_Chunked), which is not thread-safe. Set with a 'static constexpr bool allocates_on_write' member.
+template<typename M>
+inline constexpr bool allocates_on_write = requires { requires M::allocates_on_write; };
+
+// Define TM2D_INSTRUMENT to record the work of the algorithms below (tiles visited, bytes copied, peak fill queue size and wall time) in instrumentStats(), and to report their calls to a TraceCallback.
+// Without it, the instrumentation hooks are empty and cost nothing.
+#ifdef TM2D_INSTRUMENT
+
+// Algorithms recorded by the instrumentation.
+enum class Operation
+{
+	Flip,
+	Rot90,
+	Rot180,
+	GetChunk,
+	SetChunk,
+	FillArea,
+	DrawLine,
+	Stencil,
+	Resample,
+	Count
+};
+
+// Get the qualified name of the function of [op], e.g. to name a tracing zone.
+inline const char* operationName(Operation op)
+{
+	constexpr const char* names[] = { "tm2D::flip", "tm2D::rot90", "tm2D::rot180", "tm2D::getChunk", "tm2D::setChunk", "tm2D::fillArea", "tm2D::drawLine", "tm2D::applyStencil", "tm2D::resample" };
+	return op < Operation::Count ? names[size_t(op)] : "";
+}
+
+// Work done by calls of an operation. The work of the operations called by another one (e.g. flip() by rot90()) also counts for the calling one.
+struct OperationStats
+{
+	uint64_t calls = 0;
+	// Tiles read or written, including the tiles checked against the rule of fillArea().
+	uint64_t tiles_visited = 0;
+	// Bytes of tiles copied or moved.
+	uint64_t bytes_copied = 0;
+	// Largest number of spans pending in the queue of fillArea().
+	uint64_t peak_queue = 0;
+	uint64_t nanoseconds = 0;
+
+	void add(const OperationStats& stats)
+	{
+		calls += stats.calls;
+		tiles_visited += stats.tiles_visited;
+		bytes_copied += stats.bytes_copied;
+		peak_queue = std::max<>(peak_queue, stats.peak_queue);
+		nanoseconds += stats.nanoseconds;
+	}
+};
+
+// Accumulated work of each operation.
+struct InstrumentStats
+{
+	OperationStats operations[size_t(Operation::Count)];
+
+	OperationStats& operator[](Operation op) { return operations[size_t(op)]; }
+	const OperationStats& operator[](Operation op) const { return operations[size_t(op)]; }
+
+	void reset() { *this = {}; }
+};
+
+// Get the work recorded on the calling thread. Operations following a parallel execution policy are recorded on the thread calling them.
+inline InstrumentStats& instrumentStats()
+{
+	thread_local InstrumentStats stats;
+	return stats;
+}
+
+// Called on the calling thread when an operation begins, with a null [stats], and when it ends, with the work of that call. Calls of nested operations are nested in the same way, e.g. to begin and end Tracy or Perfetto zones named operationName([op]).
+using TraceCallback = void (*)(Operation op, const OperationStats* stats, void* user_data);
+
+namespace detail
+{
+
+struct TraceHook
+{
+	TraceCallback callback = nullptr;
+	void* user_data = nullptr;
+};
+
+inline TraceHook trace_hook;
+
+// Records the work of an operation for the lifetime of the object, as the innermost operation of the calling thread.
+struct InstrumentScope
+{
+	explicit InstrumentScope(Operation op)
+		: _op(op), _parent(current())
+	{
+		current() = this;
+		if (trace_hook.callback) trace_hook.callback(op, nullptr, trace_hook.user_data);
+		_start = std::chrono::steady_clock::now();
+	}
+
+	InstrumentScope(const InstrumentScope&) = delete;
+	InstrumentScope& operator=(const InstrumentScope&) = delete;
+
+	~InstrumentScope()
+	{
+		_stats.calls = 1;
+		_stats.nanoseconds = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _start).count();
+		current() = _parent;
+
+		if (_parent) {
+			_parent->_stats.tiles_visited += _stats.tiles_visited;
+			_parent->_stats.bytes_copied += _stats.bytes_copied;
+			_parent->_stats.peak_queue = std::max<>(_parent->_stats.peak_queue, _stats.peak_queue);
+		}
+		instrumentStats()[_op].add(_stats);
+		if (trace_hook.callback) trace_hook.callback(_op, &_stats, trace_hook.user_data);
+	}
+
+	// Add work to the innermost operation of the calling thread, if any.
+	static void count(uint64_t tiles, uint64_t bytes)
+	{
+		if (InstrumentScope* scope = current()) {
+			scope->_stats.tiles_visited += tiles;
+			scope->_stats.bytes_copied += bytes;
+		}
+	}
+
+	static void peakQueue(uint64_t size)
+	{
+		if (InstrumentScope* scope = current()) scope->_stats.peak_queue = std::max<>(scope->_stats.peak_queue, size);
+	}
+
+private:
+	static InstrumentScope*& current()
+	{
+		thread_local InstrumentScope* scope = nullptr;
+		return scope;
+	}
+
+	Operation _op;
+	InstrumentScope* _parent;
+	OperationStats _stats;
+	std::chrono::steady_clock::time_point _start;
+};
+
+}; // namespace detail
+
+// Set the function called when operations begin and end, or disable it with 'nullptr'. It must not be changed while operations are running.
+inline void setTraceCallback(TraceCallback callback, void* user_data = nullptr)
+{
+	detail::trace_hook = { callback, user_data };
+}
+
+// Record the enclosing function as the operation [OP] of 'tm2D::Operation'.
+#define TM2D_INSTRUMENT_SCOPE(OP) const ::tm2D::detail::InstrumentScope tm2d_instrument_scope(::tm2D::Operation::OP)
+// Record [TILES] tiles visited and [BYTES] bytes copied in the innermost operation.
+#define TM2D_INSTRUMENT_COUNT(TILES, BYTES) ::tm2D::detail::InstrumentScope::count((uint64_t)(TILES), (uint64_t)(BYTES))
+// Record a queue size of [SIZE] in the innermost operation.
+#define TM2D_INSTRUMENT_QUEUE(SIZE) ::tm2D::detail::InstrumentScope::peakQueue((uint64_t)(SIZE))
+#else
+#define TM2D_INSTRUMENT_SCOPE(OP)
+#define TM2D_INSTRUMENT_COUNT(TILES, BYTES) ((void)0)
+#define TM2D_INSTRUMENT_QUEUE(SIZE) ((void)0)
+#endif
+
+namespace detail
+{
+
+// Get the distance in tiles between the starts of 2 consecutive rows of a contiguous tilemap.
+template<ContiguousTileMap M>
+constexpr ptrdiff_t rowPitch(const M& map) { return (ptrdiff_t)map.pitch(); }
+
+// Get the pointer to the first tile of row [y] of a contiguous tilemap.
+template<ContiguousTileMap M>
+constexpr auto rowData(M& map, size_t y) { return map.data() + rowPitch(map) * (ptrdiff_t)y; }
+
+// Write [tile] to ([x]; [y]) of [map] within bounds, like set().
+// Tilemaps with a 'setUnchecked()' (e.g. allocating chunks on writes) can then skip the writes that don't change their storage.
+template<TileMapLike M>
+void setTile(M& map, size_t x, size_t y, const tile_t<M>& tile)
+{
+	if constexpr (requires { map.setUnchecked(x, y, tile); }) map.setUnchecked(x, y, tile);
+	else map(x, y) = tile;
+}
+
+// Swap the tiles ([x1]; [y1]) and ([x2]; [y2]) of [map] within bounds, through setTile() for tilemaps with a 'setUnchecked()'.
+template<TileMapLike M>
+void swapTiles(M& map, size_t x1, size_t y1, size_t x2, size_t y2)
+{
+	if constexpr (requires(const tile_t<M>& tile) { map.setUnchecked(x1, y1, tile); }) {
+		const tile_t<M> tile = std::as_const(map)(x1, y1);
+		setTile(map, x1, y1, std::as_const(map)(x2, y2));
+		setTile(map, x2, y2, tile);
+	}
+	else std::swap(map(x1, y1), map(x2, y2));
+}
+
+// Call [func(tiles, count)] for the row spans of [cliprect] (within [map]), as a single span when the rows are adjacent in memory.
+template<ContiguousTileMap M, typename F>
+void forEachSpan(M& map, const Rect& cliprect, F&& func)
+{
+	if (!cliprect.width || !cliprect.height) return;
+
+	if ((ptrdiff_t)cliprect.width == rowPitch(map)) {
+		func(rowData(map, cliprect.y) + cliprect.x, cliprect.width * cliprect.height);
+		return;
+	}
+	for (size_t y = cliprect.y; y < cliprect.y + cliprect.height; y++)
+		func(rowData(map, y) + cliprect.x, cliprect.width);
+}
+
+// Scanline flood fill from [center] over a [width] x [height] area.
+// [fillable(x, y)] tells whether a tile is to be filled, and [fill(begin, end, y)] fills the tiles [begin; end) of row [y], after which they must no longer be fillable.
+// The center tile is always filled. Only seed spans are kept pending (allocated from [scratch]), so the memory used is proportional to the area's boundary rather than to the area.
+template<typename Fillable, typename Fill>
+void scanlineFill(size_t width, size_t height, const Point& center, bool eight_connected, std::pmr::memory_resource* scratch, Fillable&& fillable, Fill&& fill)
+{
+	if (center.x >= width || center.y >= height) return;
+
+	// Tiles [begin; end) of row [y], whose adjacent rows are to be scanned for tiles to fill.
+	struct Span
+	{
+		size_t y, begin, end;
+	};
+	std::pmr::vector<Span> spans(scratch);
+	// Work recorded by the instrumentation, if enabled.
+	[[maybe_unused]] size_t visited = 1, peak_queue = 0;
+
+	const auto test = [&](size_t x, size_t y) {
+		visited++;
+		return fillable(x, y);
+	};
+	const auto pushAdjacent = [&](size_t y, size_t begin, size_t end) {
+		if (eight_connected) {
+			if (begin > 0) begin--;
+			if (end < width) end++;
+		}
+		if (y > 0) spans.push_back({ y - 1, begin, end });
+		if (y + 1 < height) spans.push_back({ y + 1, begin, end });
+		peak_queue = std::max<>(peak_queue, spans.size());
+	};
+
+	size_t begin = center.x, end = center.x + 1;
+	while (begin > 0 && test(begin - 1, center.y)) begin--;
+	while (end < width && test(end, center.y)) end++;
+	fill(begin, end, center.y);
+	pushAdjacent(center.y, begin, end);
+
+	while (!spans.empty()) {
+		const Span span = spans.back();
+		spans.pop_back();
+
+		for (size_t x = span.begin; x < span.end; x++) {
+			if (!test(x, span.y)) continue;
+
+			// Runs can only extend to the left of the span at its first tile, as any earlier tile was checked unfillable.
+			size_t run_begin = x, run_end = x + 1;
+			if (x == span.begin) while (run_begin > 0 && test(run_begin - 1, span.y)) run_begin--;
+			while (run_end < width && test(run_end, span.y)) run_end++;
+
+			fill(run_begin, run_end, span.y);
+			pushAdjacent(span.y, run_begin, run_end);
+			x = run_end;
+		}
+	}
+
+	TM2D_INSTRUMENT_COUNT(visited, 0);
+	TM2D_INSTRUMENT_QUEUE(peak_queue);
+}
+
+// Get floor(([a] * [b] + [c]) / [d]), with the remainder in [rem]. The quotient must fit in a 'size_t'.
+inline size_t mulAddDivMod(size_t a, size_t b, size_t c, size_t d, size_t& rem)
+{
+	if constexpr (sizeof(size_t) <= 4) {
+		const uint64_t v = (uint64_t)a * b + c;
+		rem = (size_t)(v % d);
+		return (size_t)(v / d);
+	}
+	else {
+#if defined(__SIZEOF_INT128__)
+		const unsigned __int128 v = (unsigned __int128)a * b + c;
+		rem = (size_t)(v % d);
+		return (size_t)(v / d);
+#elif defined(_MSC_VER) && defined(_M_X64)
+		unsigned __int64 high, low = _umul128(a, b, &high), r;
+		low += c;
+		high += (low < c);
+		const size_t q = _udiv128(high, low, d, &r);
+		rem = r;
+		return q;
+#else
+		// 128-bit product from 32-bit halves, then shift-subtract division.
+		const uint64_t
+			al = (uint32_t)a, ah = a >> 32, bl = (uint32_t)b, bh = b >> 32,
+			ll = al * bl, lh = al * bh, hl = ah * bl,
+			mid = (ll >> 32) + (uint32_t)lh + (uint32_t)hl;
+		uint64_t high = ah * bh + (lh >> 32) + (hl >> 32) + (mid >> 32), low = (mid << 32) | (uint32_t)ll;
+		low += c;
+		high += (low < c);
+
+		uint64_t q = 0, r = 0;
+		for (int i = 127; i >= 0; i--) {
+			const bool carry = r >> 63;
+			r = (r << 1) | (((i >= 64 ? high : low) >> (i & 63)) & 1);
+			q <<= 1;
+			if (carry || r >= d) {
+				r -= d;
+				q |= 1;
+			}
+		}
+		rem = (size_t)r;
+		return (size_t)q;
+#endif
+	}
+}
+
+// Rasterize the line from [p1] to [p2] with integer Bresenham stepping, calling [plot(x, y)] for the tiles within [clip] only.
+// The segment is clipped analytically before stepping, so the tiles plotted are the same as the unclipped line's within [clip].
+// Coordinates must be below 2^63.
+template<typename F>
+void rasterizeLine(const Point& p1, const Point& p2, const Rect& clip, F&& plot)
+{
+	if (!clip.width || !clip.height) return;
+
+	const size_t
+		dx = (p1.x < p2.x) ? (p2.x - p1.x) : (p1.x - p2.x),
+		dy = (p1.y < p2.y) ? (p2.y - p1.y) : (p1.y - p2.y);
+
+	// Step along the longer (major) axis, one tile per step.
+	const bool x_major = dx > dy;
+	const size_t
+		n = x_major ? dx : dy,
+		dm = x_major ? dy : dx,
+		major0 = x_major ? p1.x : p1.y,
+		minor0 = x_major ? p1.y : p1.x,
+		major_lo = x_major ? clip.x : clip.y,
+		major_hi = major_lo + (x_major ? clip.width : clip.height) - 1,
+		minor_lo = x_major ? clip.y : clip.x,
+		minor_hi = minor_lo + (x_major ? clip.height : clip.width) - 1;
+	const bool
+		major_neg = x_major ? (p2.x < p1.x) : (p2.y < p1.y),
+		minor_neg = x_major ? (p2.y < p1.y) : (p2.x < p1.x);
+
+	const auto emit = [&](size_t major, size_t minor) {
+		if (x_major) plot(major, minor);
+		else plot(minor, major);
+	};
+
+	if (n == 0) {
+		if (major0 >= major_lo && major0 <= major_hi && minor0 >= minor_lo && minor0 <= minor_hi) emit(major0, minor0);
+		return;
+	}
+
+	// Steps [t_begin; t_end] whose major coordinate is within the clip range.
+	size_t t_begin, t_end;
+	if (!major_neg) {
+		if (major0 > major_hi) return;
+		t_begin = (major0 < major_lo) ? major_lo - major0 : 0;
+		t_end = major_hi - major0;
+	}
+	else {
+		if (major0 < major_lo) return;
+		t_begin = (major0 > major_hi) ? major0 - major_hi : 0;
+		t_end = major0 - major_lo;
+	}
+	t_end = std::min<>(t_end, n);
+	if (t_begin > t_end) return;
+
+	// The minor offset at step t is floor((2 * t * dm + bias) / (2 * n)), which rounds the exact coordinate half up (in absolute coordinates, so both directions plot the same tiles).
+	const size_t bias = minor_neg ? n - 1 : n, n2 = 2 * n;
+
+	// Range [off_lo; off_hi] of minor offsets within the clip range.
+	size_t off_lo, off_hi;
+	if (!minor_neg) {
+		if (minor0 > minor_hi) return;
+		off_lo = (minor0 < minor_lo) ? minor_lo - minor0 : 0;
+		off_hi = minor_hi - minor0;
+	}
+	else {
+		if (minor0 < minor_lo) return;
+		off_lo = (minor0 > minor_hi) ? minor0 - minor_hi : 0;
+		off_hi = minor0 - minor_lo;
+	}
+	if (off_lo > dm) return;
+
+	if (dm > 0) {
+		size_t rem;
+		// First step with offset >= off_lo, and last step with offset <= off_hi.
+		if (off_lo > 0) t_begin = std::max<>(t_begin, mulAddDivMod(off_lo - 1, n2, n2 - bias - 1, 2 * dm, rem) + 1);
+		if (off_hi < dm) t_end = std::min<>(t_end, mulAddDivMod(off_hi, n2, n2 - bias - 1, 2 * dm, rem));
+		if (t_begin > t_end) return;
+	}
+
+	size_t acc;
+	const size_t off = mulAddDivMod(t_begin, 2 * dm, bias, n2, acc);
+	size_t
+		major = major_neg ? major0 - t_begin : major0 + t_begin,
+		minor = minor_neg ? minor0 - off : minor0 + off;
+
+	for (size_t t = t_begin;; t++) {
+		emit(major, minor);
+		if (t == t_end) break;
+
+		major = major_neg ? major - 1 : major + 1;
+		acc += 2 * dm;
+		if (acc >= n2) {
+			acc -= n2;
+			minor = minor_neg ? minor - 1 : minor + 1;
+		}
+	}
+}
+
+// In-register reversal of blocks of [lanes] tiles of [Size] bytes.
+// 'lanes' is 0 if there is no SIMD kernel for the tile size.
+template<size_t Size>
+struct SimdReverse
+{
+	static constexpr size_t lanes = 0;
+	static void swapReversed(void*, void*) {}
+};
+
+#if TM2D_AVX2
+// Specialization of SimdReverse for tiles of [SIZE] bytes with the register reversal function REVERSE. swapReversed() swaps the blocks at [p] and [q], reversing both.
+#define TM2D_SIMD_REVERSE(SIZE, REVERSE) \
+	template<> \
+	struct SimdReverse<SIZE> \
+	{ \
+		static constexpr size_t lanes = 32 / SIZE; \
+		static void swapReversed(void* p, void* q) \
+		{ \
+			const __m256i a = _mm256_loadu_si256((const __m256i*)p), b = _mm256_loadu_si256((const __m256i*)q); \
+			_mm256_storeu_si256((__m256i*)p, REVERSE(b)); \
+			_mm256_storeu_si256((__m256i*)q, REVERSE(a)); \
+		} \
+	};
+
+inline __m256i reverse8(__m256i v)
+{
+	const __m256i lanes = _mm256_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+	return _mm256_permute4x64_epi64(_mm256_shuffle_epi8(v, lanes), 0x4E);
+}
+inline __m256i reverse16(__m256i v)
+{
+	const __m256i lanes = _mm256_setr_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1, 14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1);
+	return _mm256_permute4x64_epi64(_mm256_shuffle_epi8(v, lanes), 0x4E);
+}
+inline __m256i reverse32(__m256i v) { return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0)); }
+inline __m256i reverse64(__m256i v) { return _mm256_permute4x64_epi64(v, 0x1B); }
+#elif TM2D_SSE2
+#define TM2D_SIMD_REVERSE(SIZE, REVERSE) \
+	template<> \
+	struct SimdReverse<SIZE> \
+	{ \
+		static constexpr size_t lanes = 16 / SIZE; \
+		static void swapReversed(void* p, void* q) \
+		{ \
+			const __m128i a = _mm_loadu_si128((const __m128i*)p), b = _mm_loadu_si128((const __m128i*)q); \
+			_mm_storeu_si128((__m128i*)p, REVERSE(b)); \
+			_mm_storeu_si128((__m128i*)q, REVERSE(a)); \
+		} \
+	};
+
+inline __m128i reverse16(__m128i v) { return _mm_shuffle_epi32(_mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0x1B), 0x1B), 0x4E); }
+// SSE2 has no byte shuffle, so the bytes of the reversed 16-bit words are swapped.
+inline __m128i reverse8(__m128i v)
+{
+	v = reverse16(v);
+	return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+}
+inline __m128i reverse32(__m128i v) { return _mm_shuffle_epi32(v, 0x1B); }
+inline __m128i reverse64(__m128i v) { return _mm_shuffle_epi32(v, 0x4E); }
+#elif TM2D_NEON
+#define TM2D_SIMD_REVERSE(SIZE, REVERSE) \
+	template<> \
+	struct SimdReverse<SIZE> \
+	{ \
+		static constexpr size_t lanes = 16 / SIZE; \
+		static void swapReversed(void* p, void* q) \
+		{ \
+			const uint8x16_t a = vld1q_u8((const uint8_t*)p), b = vld1q_u8((const uint8_t*)q); \
+			vst1q_u8((uint8_t*)p, REVERSE(b)); \
+			vst1q_u8((uint8_t*)q, REVERSE(a)); \
+		} \
+	};
+
+// Reverse the 64-bit halves, then the elements within them.
+inline uint8x16_t reverse8(uint8x16_t v) { v = vrev64q_u8(v); return vextq_u8(v, v, 8); }
+inline uint8x16_t reverse16(uint8x16_t v) { v = vreinterpretq_u8_u16(vrev64q_u16(vreinterpretq_u16_u8(v))); return vextq_u8(v, v, 8); }
+inline uint8x16_t reverse32(uint8x16_t v) { v = vreinterpretq_u8_u32(vrev64q_u32(vreinterpretq_u32_u8(v))); return vextq_u8(v, v, 8); }
+inline uint8x16_t reverse64(uint8x16_t v) { return vextq_u8(v, v, 8); }
+#endif
+
+#ifdef TM2D_SIMD_REVERSE
+TM2D_SIMD_REVERSE(1, reverse8)
+TM2D_SIMD_REVERSE(2, reverse16)
+TM2D_SIMD_REVERSE(4, reverse32)
+TM2D_SIMD_REVERSE(8, reverse64)
+#undef TM2D_SIMD_REVERSE
+#endif
+
+// Number of tiles of type [T] reversed at once by SIMD kernels, or 0 if there is none.
+template<typename T>
+constexpr size_t simd_reverse_lanes = std::is_trivially_copyable_v<T> ? SimdReverse<sizeof(T)>::lanes : 0;
+
+// Reverse the [count] tiles at [tiles], a SIMD block from each end at a time.
+template<typename T>
+void reverseSpan(T* tiles, size_t count)
+{
+	constexpr size_t V = simd_reverse_lanes<T>;
+	size_t i = 0, j = count;
+
+	if constexpr (V > 0) {
+		for (; j - i >= 2 * V; i += V, j -= V)
+			SimdReverse<sizeof(T)>::swapReversed(tiles + i, tiles + (j - V));
+	}
+	std::reverse(tiles + i, tiles + j);
+}
+
+// Replace the [count] tiles at [a] with the reversed tiles at [b] and the other way around. The spans must not overlap.
+template<typename T>
+void swapReversedSpans(T* a, T* b, size_t count)
+{
+	constexpr size_t V = simd_reverse_lanes<T>;
+	size_t i = 0, j = count;
+
+	if constexpr (V > 0) {
+		for (; j - i >= 2 * V; i += V, j -= V) {
+			SimdReverse<sizeof(T)>::swapReversed(a + i, b + (j - V));
+			SimdReverse<sizeof(T)>::swapReversed(a + (j - V), b + i);
+		}
+	}
+	std::swap_ranges(a + i, a + j, b + i);
+	std::reverse(a + i, a + j);
+	std::reverse(b + i, b + j);
+}
+
+// Reverse the tiles of rows [y_begin; y_end) (a horizontal flip of those rows).
+// Contiguous rows are reversed with SIMD shuffles for trivially copyable tiles of 1, 2, 4 or 8 bytes.
+template<TileMapLike M>
+void reverseRows(M& map, size_t y_begin, size_t y_end)
+{
+	const size_t width = map.width();
+
+	for (size_t y = y_begin; y < y_end; y++) {
+		if constexpr (ContiguousTileMap<M>) {
+			reverseSpan(rowData(map, y), width);
+		}
+		else {
+			for (size_t x = 0; x < width / 2; x++)
+				swapTiles(map, x, y, width - 1 - x, y);
+		}
+	}
+}
+
+// Swap rows [y_begin; y_end) with their mirrored rows (a vertical flip of those rows). [y_end] must not be greater than half the height.
+// Contiguous rows are swapped as whole spans.
+template<TileMapLike M>
+void swapMirroredRows(M& map, size_t y_begin, size_t y_end)
+{
+	const size_t width = map.width(), height = map.height();
+
+	for (size_t y = y_begin; y < y_end; y++) {
+		if constexpr (ContiguousTileMap<M>) {
+			const auto row = rowData(map, y);
+			std::swap_ranges(row, row + width, rowData(map, height - 1 - y));
+		}
+		else {
+			for (size_t x = 0; x < width; x++)
+				swapTiles(map, x, y, x, height - 1 - y);
+		}
+	}
+}
+
+// Swap rows [y_begin; y_end) with their reversed mirrored rows (a flip in both directions of those rows) in a single pass. [y_end] must not be greater than half the height.
+// The middle row of a tilemap of odd height is left to reverseRows().
+template<TileMapLike M>
+void swapReversedMirroredRows(M& map, size_t y_begin, size_t y_end)
+{
+	const size_t width = map.width(), height = map.height();
+
+	for (size_t y = y_begin; y < y_end; y++) {
+		if constexpr (ContiguousTileMap<M>) {
+			swapReversedSpans(rowData(map, y), rowData(map, height - 1 - y), width);
+		}
+		else {
+			for (size_t x = 0; x < width; x++)
+				swapTiles(map, x, y, width - 1 - x, height - 1 - y);
+		}
+	}
+}
+
+}; // namespace detail
+
+// Flip the tilemap.
+// Note: calling this function with both parameters set to 'true' is equal to calling rot90() twice in the same direction.
+// Rows are reversed and swapped as whole spans when the tilemap is contiguous, and flipping in both directions takes a single pass.
+template<TileMapLike M>
+void flip(M& map, bool horizontal, bool vertical)
+{
+	TM2D_INSTRUMENT_SCOPE(Flip);
+	const size_t height = map.height();
+	if (horizontal || vertical) TM2D_INSTRUMENT_COUNT(map.width() * height, map.width() * height * sizeof(tile_t<M>));
+
+	if (horizontal && vertical) {
+		detail::swapReversedMirroredRows(map, 0, height / 2);
+		if (height % 2) detail::reverseRows(map, height / 2, height / 2 + 1);
+	}
+	else if (horizontal) detail::reverseRows(map, 0, height);
+	else if (vertical) detail::swapMirroredRows(map, 0, height / 2);
+}
+
+// Draw a line from [p1] to [p2] on a tilemap, with integer Bresenham stepping.
+// The line is clipped to the tilemap, so [drawfunc] is only called for coordinates within bounds.
+// Params:
+//   [drawfunc] Draw function that takes a tilemap, x and y coordinates as parameters.
+template<TileMapLike M, std::invocable<M*, size_t, size_t> F>
+void drawLine(
+	M& map,
+	const Point& p1,
+	const Point& p2,
+	F&& drawfunc
+) {
+	TM2D_INSTRUMENT_SCOPE(DrawLine);
+	[[maybe_unused]] size_t plotted = 0;
+
+	detail::rasterizeLine(p1, p2, { 0, 0, map.width(), map.height() }, [&](size_t x, size_t y) {
+		plotted++;
+		drawfunc(&map, x, y);
+	});
+	TM2D_INSTRUMENT_COUNT(plotted, 0);
+}
+
+// Draw lines between each pair of points on a tilemap. See drawLine().
+template<TileMapLike M, std::invocable<M*, size_t, size_t> F>
+void drawLines(
+	M& map,
+	std::span<const std::pair<Point, Point>> lines,
+	F&& drawfunc
+) {
+	TM2D_INSTRUMENT_SCOPE(DrawLine);
+	const Rect clip = { 0, 0, map.width(), map.height() };
+	[[maybe_unused]] size_t plotted = 0;
+
+	for (const auto& [p1, p2] : lines) {
+		detail::rasterizeLine(p1, p2, clip, [&](size_t x, size_t y) {
+			plotted++;
+			drawfunc(&map, x, y);
+		});
+	}
+	TM2D_INSTRUMENT_COUNT(plotted, 0);
+}
+
+// Fill a polygonal area of elements sastifying [rule] with [elem], using a scanline flood fill.
+// The tile at [center] is always filled.
+// Returns the bounding rectangle of the filled tiles.
+// Params:
+//   [eight_connected] If true, diagonally adjacent tiles are also part of the area.
+//   [scratch] Memory resource for the temporary buffers, e.g. a 'std::pmr::monotonic_buffer_resource' reused across calls.
+template<TileMapLike M, std::predicate<const tile_t<M>&> Rule>
+Rect fillArea(
+	M& map,
+	const Point& center,
+	Rule&& rule,
+	const tile_t<M>& elem,
+	bool eight_connected = false,
+	std::pmr::memory_resource* scratch = std::pmr::get_default_resource()
+) {
+	TM2D_INSTRUMENT_SCOPE(FillArea);
+	const size_t width = map.width(), height = map.height();
+	size_t min_x = width, min_y = height, max_x = 0, max_y = 0;
+
+	const auto fill = [&](size_t begin, size_t end, size_t y) {
+		min_x = std::min<>(min_x, begin);
+		max_x = std::max<>(max_x, end);
+		min_y = std::min<>(min_y, y);
+		max_y = std::max<>(max_y, y + 1);
+
+		if constexpr (ContiguousTileMap<M>) {
+			const auto row = detail::rowData(map, y);
+			std::fill(row + begin, row + end, elem);
+		}
+		else {
+			for (size_t x = begin; x < end; x++) detail::setTile(map, x, y, elem);
+		}
+	};
+
+	if (!rule(elem)) {
+		detail::scanlineFill(width, height, center, eight_connected, scratch,
+			[&](size_t x, size_t y) { return (bool)rule(std::as_const(map)(x, y)); },
+			fill
+		);
+	}
+	else {
+		// Filled tiles still satisfy the rule, so they are told apart with a bitmap.
+		std::pmr::vector<bool> filled(width * height, false, scratch);
+
+		detail::scanlineFill(width, height, center, eight_connected, scratch,
+			[&](size_t x, size_t y) { return !filled[x + width * y] && rule(std::as_const(map)(x, y)); },
+			[&](size_t begin, size_t end, size_t y) {
+				fill(begin, end, y);
+				std::fill(filled.begin() + (begin + width * y), filled.begin() + (end + width * y), true);
+			}
+		);
+	}
+
+	if (min_x >= max_x) return {};
+	return { min_x, min_y, max_x - min_x, max_y - min_y };
+}
+
+// Fill [area] (clipped to the tilemap) with [elem].
+// Rows are filled as whole spans with 'std::fill' when the tilemap is contiguous.
+template<TileMapLike M>
+void fillRect(M& map, const Rect& area, const tile_t<M>& elem)
+{
+	// [elem] may be a tile of [map].
+	const tile_t<M> value = elem;
+	const Rect cliprect = area.intersection({ 0, 0, map.width(), map.height() });
+
+	if constexpr (ContiguousTileMap<M>) {
+		detail::forEachSpan(map, cliprect, [&](auto tiles, size_t count) { std::fill(tiles, tiles + count, value); });
+	}
+	else {
+		for (size_t y = cliprect.y; y < cliprect.y + cliprect.height; y++)
+			for (size_t x = cliprect.x; x < cliprect.x + cliprect.width; x++)
+				detail::setTile(map, x, y, value);
+	}
+}
+
+// Replace every tile of [area] (clipped to the tilemap) with [func(tile)], e.g. to remap palette IDs.
+// Rows are transformed as whole spans with 'std::transform' when the tilemap is contiguous.
+template<TileMapLike M, typename F>
+	requires std::invocable<F&, const tile_t<M>&> && std::assignable_from<tile_t<M>&, std::invoke_result_t<F&, const tile_t<M>&>>
+void transform(M& map, const Rect& area, F&& func)
+{
+	const Rect cliprect = area.intersection({ 0, 0, map.width(), map.height() });
+
+	if constexpr (ContiguousTileMap<M>) {
+		detail::forEachSpan(map, cliprect, [&](auto tiles, size_t count) { std::transform(tiles, tiles + count, tiles, func); });
+	}
+	else {
+		for (size_t y = cliprect.y; y < cliprect.y + cliprect.height; y++)
+			for (size_t x = cliprect.x; x < cliprect.x + cliprect.width; x++)
+				detail::setTile(map, x, y, func(std::as_const(map)(x, y)));
+	}
+}
+
+// Replace the tiles equal to [old_elem] with [new_elem].
+// Parameters:
+//   [area]: Area to replace in (clipped to the tilemap). Default value is the whole tilemap.
+template<TileMapLike M>
+	requires std::equality_comparable<tile_t<M>>
+void replace(M& map, const tile_t<M>& old_elem, const tile_t<M>& new_elem, Rect area = {})
+{
+	if (area == Rect(0, 0, 0, 0))
+		area = { 0, 0, map.width(), map.height() };
+
+	// The elements may be tiles of [map].
+	const tile_t<M> old_value = old_elem, new_value = new_elem;
+	const Rect cliprect = area.intersection({ 0, 0, map.width(), map.height() });
+
+	if constexpr (ContiguousTileMap<M>) {
+		detail::forEachSpan(map, cliprect, [&](auto tiles, size_t count) { std::replace(tiles, tiles + count, old_value, new_value); });
+	}
+	else {
+		// Only matching tiles are accessed for writing, so tilemaps allocating on writes only allocate where needed.
+		for (size_t y = cliprect.y; y < cliprect.y + cliprect.height; y++)
+			for (size_t x = cliprect.x; x < cliprect.x + cliprect.width; x++)
+				if (std::as_const(map)(x, y) == old_value) detail::setTile(map, x, y, new_value);
+	}
+}
+
+// Get the tiles at [points] into [tiles], like get() for each point: the tiles of the points out of bounds are default tiles.
+// Only the first 'min(points.size(), tiles.size())' points are read. Returns the number of them within bounds.
+// The buffer and the size of contiguous tilemaps are loaded once for the batch, and type-erased tilemaps make one virtual call for it (see TileMap2DImpl::gather()).
+template<TileMapLike M>
+size_t gather(const M& map, std::span<const Point> points, std::span<tile_t<M>> tiles)
+{
+	const size_t count = std::min<>(points.size(), tiles.size()), width = map.width(), height = map.height();
+	size_t within = 0;
+
+	if constexpr (ContiguousTileMap<M>) {
+		const auto data = map.data();
+		const size_t pitch = map.pitch();
+		for (size_t i = 0; i < count; i++) {
+			const Point p = points[i];
+			const bool inside = p.x < width && p.y < height;
+			tiles[i] = inside ? data[p.x + pitch * p.y] : tile_t<M>{};
+			within += inside;
+		}
+	}
+	else {
+		for (size_t i = 0; i < count; i++) {
+			const Point p = points[i];
+			const bool inside = p.x < width && p.y < height;
+			tiles[i] = inside ? map(p.x, p.y) : tile_t<M>{};
+			within += inside;
+		}
+	}
+	return within;
+}
+
+// Set the tiles at [points] to [tiles], like set() for each point in order: the points out of bounds are skipped.
+// Only the first 'min(points.size(), tiles.size())' points are written. Returns the number of them within bounds.
+// The buffer and the size of contiguous tilemaps are loaded once for the batch, and type-erased tilemaps make one virtual call for it (see TileMap2DImpl::scatter()).
+template<TileMapLike M>
+size_t scatter(M& map, std::span<const Point> points, std::span<const tile_t<M>> tiles)
+{
+	const size_t count = std::min<>(points.size(), tiles.size()), width = map.width(), height = map.height();
+	size_t within = 0;
+
+	if constexpr (ContiguousTileMap<M>) {
+		const auto data = map.data();
+		const size_t pitch = map.pitch();
+		for (size_t i = 0; i < count; i++) {
+			const Point p = points[i];
+			if (p.x < width && p.y < height) {
+				data[p.x + pitch * p.y] = tiles[i];
+				within++;
+			}
+		}
+	}
+	else {
+		for (size_t i = 0; i < count; i++) {
+			const Point p = points[i];
+			if (p.x < width && p.y < height) {
+				detail::setTile(map, p.x, p.y, tiles[i]);
+				within++;
+			}
+		}
+	}
+	return within;
+}
+
+// Copy the tiles of [input] satisfying [mask] to [output] at ([x]; [y]), e.g. to skip transparent tiles. The areas must not overlap.
+// For trivially copyable tiles in contiguous tilemaps, rows are blended with a branchless select, which compilers vectorize.
+// Returns the area of [output] covered by the copied area.
+// Parameters:
+//   [src_area]: Source chunk area to get from. Default value is the whole [input] area.
+template<TileMapLike Out, TileMapLike In, std::predicate<const tile_t<In>&> Mask>
+	requires std::same_as<tile_t<Out>, tile_t<In>>
+Rect blit(
+	Out* output,
+	const In* input,
+	size_t x,
+	size_t y,
+	Mask&& mask,
+	Rect src_area = {}
+) {
+	if (src_area == Rect(0, 0, 0, 0))
+		src_area = { 0, 0, input->width(), input->height() };
+
+	const Rect
+		src_cliprect = src_area.intersection({ 0, 0, input->width(), input->height() }),
+		dst_cliprect = Rect(x, y, src_cliprect.width, src_cliprect.height).intersection({ 0, 0, output->width(), output->height() });
+
+	for (size_t _y = 0; _y < dst_cliprect.height; _y++) {
+		if constexpr (ContiguousTileMap<Out> && ContiguousTileMap<In>) {
+			const auto dst = detail::rowData(*output, dst_cliprect.y + _y) + dst_cliprect.x;
+			const auto src = detail::rowData(*input, src_cliprect.y + _y) + src_cliprect.x;
+
+			if constexpr (std::is_trivially_copyable_v<tile_t<In>>) {
+				for (size_t _x = 0; _x < dst_cliprect.width; _x++) dst[_x] = mask(src[_x]) ? src[_x] : dst[_x];
+			}
+			else {
+				for (size_t _x = 0; _x < dst_cliprect.width; _x++) if (mask(src[_x])) dst[_x] = src[_x];
+			}
+		}
+		else {
+			for (size_t _x = 0; _x < dst_cliprect.width; _x++) {
+				const tile_t<In>& tile = (*input)(src_cliprect.x + _x, src_cliprect.y + _y);
+				if (mask(tile)) (*output)(dst_cliprect.x + _x, dst_cliprect.y + _y) = tile;
+			}
+		}
+	}
+	return dst_cliprect;
+}
+
+// Implementation class for TileMap2D types.
+// Its member algorithms go through the virtual interface, so it serves as the type-erased tilemap type. Use the free function algorithms or StaticTileMap2DImpl for statically dispatched access.
+template<typename T>
+struct TileMap2DImpl
+{
+	using tile_type = T;
+
+	// Get width of tilemap.
+	virtual size_t width() const = 0;
+	// Get height of tilemap.
+	virtual size_t height() const = 0;
+
+	// Get tile directly (does not check for bounds).
+	virtual T& operator()(size_t x, size_t y) = 0;
+	// Get const reference to tile directly (does not check for bounds).
+	virtual const T& operator()(size_t x, size_t y) const = 0;
+
+	// Get tile, with bounds checking. If out of bounds, return default-constructed value.
+	virtual T get(size_t x, size_t y) const
+	{
+		return (x < width() && y < height()) ? operator()(x, y) : T{};
+	}
+	// Set tile, with bounds checking. If out of bounds, do nothing.
+	virtual void set(size_t x, size_t y, const T& t)
+	{
+		if (x < width() && y < height()) operator()(x, y) = t;
+	}
+	// Get the tiles at [points] into [tiles], with bounds checking like get(). Returns the number of points within bounds.
+	// One virtual call reads the whole batch: the tilemaps based on StaticTileMap2DImpl read it with static dispatch.
+	virtual size_t gather(std::span<const Point> points, std::span<T> tiles) const
+	{
+		return tm2D::gather(*this, points, tiles);
+	}
+	// Set the tiles at [points] to [tiles] in order, with bounds checking like set(). Returns the number of points within bounds.
+	// One virtual call writes the whole batch: the tilemaps based on StaticTileMap2DImpl write it with static dispatch.
+	virtual size_t scatter(std::span<const Point> points, std::span<const T> tiles)
+	{
+		return tm2D::scatter(*this, points, tiles);
+	}
+
+	// Filp the tilemap.
+	// Note: calling this function with both parameters set to 'true' is equal to calling rot90() twice in the same direction.
+	void flip(bool horizontal, bool vertical)
+	{
+		tm2D::flip(*this, horizontal, vertical);
+	}
+
+	// Draw a line from [p1] to [p2] on a tilemap. Out-of-bounds parts of the line are not drawn.
+	// Params:
+	//   [drawfunc] Draw function that takes a tilemap, x and y coordinates as parameters.
+	void drawLine(
+		const Point& p1,
+		const Point& p2,
+		const std::function<void(TileMap2DImpl*, size_t, size_t)>& drawfunc
+	) {
+		tm2D::drawLine(*this, p1, p2, drawfunc);
+	}
+
+	// Draw lines between each pair of points on a tilemap. See drawLine().
+	void drawLines(
+		std::span<const std::pair<Point, Point>> lines,
+		const std::function<void(TileMap2DImpl*, size_t, size_t)>& drawfunc
+	) {
+		tm2D::drawLines(*this, lines, drawfunc);
+	}
+
+	// Fill a polygonal area of elements sastifying [rule] with [elem].
+	// Returns the bounding rectangle of the filled tiles.
+	// Params:
+	//   [eight_connected] If true, diagonally adjacent tiles are also part of the area.
+	//   [scratch] Memory resource for the temporary buffers.
+	Rect fillArea(
+		const Point& center,
+		const std::function<bool(const T&)>& rule,
+		const T& elem,
+		bool eight_connected = false,
+		std::pmr::memory_resource* scratch = std::pmr::get_default_resource()
+	) {
+		return tm2D::fillArea(*this, center, rule, elem, eight_connected, scratch);
+	}
+
+	// Fill [area] with [elem].
+	void fillRect(const Rect& area, const T& elem)
+	{
+		tm2D::fillRect(*this, area, elem);
+	}
+
+	// Replace every tile of [area] with [func(tile)].
+	void transform(const Rect& area, const std::function<T(const T&)>& func)
+	{
+		tm2D::transform(*this, area, func);
+	}
+
+	// Replace the tiles of [area] equal to [old_elem] with [new_elem]. Default value of [area] is the whole tilemap.
+	void replace(const T& old_elem, const T& new_elem, const Rect& area = {})
+		requires std::equality_comparable<T>
+	{
+		tm2D::replace(*this, old_elem, new_elem, area);
+	}
+};
+
+// Implementation class for resizable TileMap2D types.
+template<typename T>
+struct ResizableTileMap2DImpl: public TileMap2DImpl<T>
+{
+	// Initialize the tilemap with a new buffer and fill the new space with [padding].
+	virtual void reset(size_t new_width, size_t new_height, const T& padding = {}) = 0;
+
+	// Initialize the tilemap with a new size, for callers that overwrite every tile afterwards. The content of the tiles is unspecified.
+	// Implementations may skip filling the tiles and reuse the existing buffer. By default, this calls reset().
+	virtual void resetUninitialized(size_t new_width, size_t new_height)
+	{
+		reset(new_width, new_height);
+	}
+};
+
+// Implementation class for TileMap2D types with the concrete type [Derived], deriving from [Base] (TileMap2DImpl or ResizableTileMap2DImpl).
+// Hides TileMap2DImpl's member algorithms with statically dispatched ones, so they compile down to [Derived]'s inlined tile access. [Derived] should mark its 'width()', 'height()' and 'operator()' overrides 'final'.
+template<typename Derived, typename Base>
+struct StaticTileMap2DImpl: public Base
+{
+	using typename Base::tile_type;
+
+	tile_type get(size_t x, size_t y) const final
+	{
+		return (x < derived().width() && y < derived().height()) ? derived()(x, y) : tile_type{};
+	}
+	// Uses [Derived]'s 'setUnchecked(x, y, t)' if it has one, for tilemaps that can store tiles without going through 'operator()'.
+	void set(size_t x, size_t y, const tile_type& t) final
+	{
+		if (x < derived().width() && y < derived().height()) {
+			if constexpr (requires(Derived& d) { d.setUnchecked(x, y, t); }) derived().setUnchecked(x, y, t);
+			else derived()(x, y) = t;
+		}
+	}
+	size_t gather(std::span<const Point> points, std::span<tile_type> tiles) const final
+	{
+		return tm2D::gather(derived(), points, tiles);
+	}
+	size_t scatter(std::span<const Point> points, std::span<const tile_type> tiles) final
+	{
+		return tm2D::scatter(derived(), points, tiles);
+	}
+
+	void flip(bool horizontal, bool vertical)
+	{
+		tm2D::flip(derived(), horizontal, vertical);
+	}
+
+	template<std::invocable<Derived*, size_t, size_t> F>
+	void drawLine(
+		const Point& p1,
+		const Point& p2,
+		F&& drawfunc
+	) {
+		tm2D::drawLine(derived(), p1, p2, drawfunc);
+	}
+
+	template<std::invocable<Derived*, size_t, size_t> F>
+	void drawLines(
+		std::span<const std::pair<Point, Point>> lines,
+		F&& drawfunc
+	) {
+		tm2D::drawLines(derived(), lines, drawfunc);
+	}
+
+	template<std::predicate<const tile_type&> Rule>
+	Rect fillArea(
+		const Point& center,
+		Rule&& rule,
+		const tile_type& elem,
+		bool eight_connected = false,
+		std::pmr::memory_resource* scratch = std::pmr::get_default_resource()
+	) {
+		return tm2D::fillArea(derived(), center, rule, elem, eight_connected, scratch);
+	}
+
+	void fillRect(const Rect& area, const tile_type& elem)
+	{
+		tm2D::fillRect(derived(), area, elem);
+	}
+
+	template<typename F>
+		requires std::invocable<F&, const tile_type&>
+	void transform(const Rect& area, F&& func)
+	{
+		tm2D::transform(derived(), area, func);
+	}
+
+	void replace(const tile_type& old_elem, const tile_type& new_elem, const Rect& area = {})
+		requires std::equality_comparable<tile_type>
+	{
+		tm2D::replace(derived(), old_elem, new_elem, area);
+	}
+
+private:
+	constexpr Derived& derived() { return static_cast<Derived&>(*this); }
+	constexpr const Derived& derived() const { return static_cast<const Derived&>(*this); }
+};
+
+// A 2-dimensional tilemap view of a contiguous memory buffer that can be used for providing 2-dimensional access to large 1-dimensional image data without having to copy it into a 2-dimensional container.
+// Rows may be padded (e.g. for texture buffers or sub-rectangles of a larger buffer), with a row pitch larger than the width.
+template<typename T>
+struct TileMap2DView: public StaticTileMap2DImpl<TileMap2DView<T>, TileMap2DImpl<T>>
+{
+	TileMap2DView() {}
+
+	TileMap2DView(void* data, size_t width, size_t height)
+		: _data((T*)data), _width(width), _height(height), _pitch(width) {}
+
+	// Params:
+	//   [pitch] Distance in tiles between the starts of 2 consecutive rows.
+	TileMap2DView(void* data, size_t width, size_t height, size_t pitch)
+		: _data((T*)data), _width(width), _height(height), _pitch(pitch) {}
+
+	constexpr size_t width() const final { return _width; }
+	constexpr size_t height() const final { return _height; }
+
+	constexpr T& operator()(size_t x, size_t y) final { return _data[x + _pitch * y]; }
+
+	constexpr const T& operator()(size_t x, size_t y) const final { return _data[x + _pitch * y]; }
+
+	constexpr T* data() const { return _data; }
+
+	// Get the distance in tiles between the starts of 2 consecutive rows.
+	constexpr size_t pitch() const { return _pitch; }
+
+	// Get a view of [area] of this view (clipped to its bounds), sharing its buffer.
+	TileMap2DView subview(const Rect& area) const
+	{
+		const Rect cliprect = area.intersection({ 0, 0, _width, _height });
+		return TileMap2DView(_data + cliprect.x + _pitch * cliprect.y, cliprect.width, cliprect.height, _pitch);
+	}
+
+private:
+	T* _data = NULL;
+	size_t _width = 0;
+	size_t _height = 0;
+	size_t _pitch = 0;
+};
+
+namespace layout
+{
+
+// Memory layouts of TileMap2D_1D. A layout maps the tiles of a tilemap to indices in its buffer:
+// - 'size_t reset(size_t width, size_t height)' prepares the layout for a [width] x [height] tilemap and returns the number of tiles to allocate,
+// - 'size_t index(size_t x, size_t y) const' gets the index of the tile at ([x]; [y]), unless 'row_major' is true.
+
+// Rows one after another, the default. Only this layout exposes data(), pitch() and subview(), and gets the contiguous fast paths.
+struct RowMajor
+{
+	static constexpr bool row_major = true;
+
+	constexpr size_t reset(size_t width, size_t height) { return width * height; }
+};
+
+// Z-order (Morton) curve: the bits of x and y are interleaved, so that tiles close to each other in 2D are close in memory in both directions.
+// Suits random access around a point (e.g. a neighborhood query or a flood fill), not row scans. The sides are rounded up to powers of 2,
+// which wastes up to 3/4 of the buffer for sizes just above a power of 2: prefer Tiled for them.
+struct ZOrder
+{
+	static constexpr bool row_major = false;
+
+	size_t reset(size_t width, size_t height)
+	{
+		const unsigned x_bits = width > 1 ? (unsigned)std::bit_width(width - 1) : 0;
+		const unsigned y_bits = height > 1 ? (unsigned)std::bit_width(height - 1) : 0;
+		// The low bits common to both axes are interleaved (x in the even bits), and the high bits of the longer axis come after them.
+		_common_bits = std::min<>(x_bits, y_bits);
+		_low_mask = ((size_t)1 << _common_bits) - 1;
+		_x_longer = x_bits > y_bits;
+#if TM2D_BMI2
+		const uint64_t interleaved = spreadBits(_low_mask);
+		_x_mask = interleaved | ((((uint64_t)1 << x_bits) - 1) & ~(uint64_t)_low_mask) << _common_bits;
+		_y_mask = interleaved << 1 | ((((uint64_t)1 << y_bits) - 1) & ~(uint64_t)_low_mask) << _common_bits;
+#endif
+		return width && height ? (size_t)1 << (x_bits + y_bits) : 0;
+	}
+
+	size_t index(size_t x, size_t y) const
+	{
+#if TM2D_BMI2
+		if constexpr (sizeof(size_t) > 4) return (size_t)_pdep_u64(x, _x_mask) | (size_t)_pdep_u64(y, _y_mask);
+		else return (size_t)_pdep_u32((uint32_t)x, (uint32_t)_x_mask) | (size_t)_pdep_u32((uint32_t)y, (uint32_t)_y_mask);
+#else
+		// Only the longer axis has bits above the common ones.
+		return (size_t)(spreadBits(x & _low_mask) | spreadBits(y & _low_mask) << 1) | ((x | y) >> _common_bits) << (2 * _common_bits);
+#endif
+	}
+
+	// Get the tile coordinates at [index] in the buffer, the inverse of index().
+	Point position(size_t index) const
+	{
+#if TM2D_BMI2
+		if constexpr (sizeof(size_t) > 4) return { (size_t)_pext_u64(index, _x_mask), (size_t)_pext_u64(index, _y_mask) };
+		else return { (size_t)_pext_u32((uint32_t)index, (uint32_t)_x_mask), (size_t)_pext_u32((uint32_t)index, (uint32_t)_y_mask) };
+#else
+		const size_t low = index & (((size_t)1 << (2 * _common_bits)) - 1), high = index >> (2 * _common_bits) << _common_bits;
+		const size_t x = (size_t)compactBits(low), y = (size_t)compactBits(low >> 1);
+		// [high] belongs to the longer axis, which is x when the tilemap is wider than tall.
+		return _x_longer ? Point{ x | high, y } : Point{ x, y | high };
+#endif
+	}
+
+	// Spread the low 32 bits of [v] to the even bits of the result.
+	static constexpr uint64_t spreadBits(uint64_t v)
+	{
+		v &= 0xFFFFFFFF;
+		v = (v | v << 16) & 0x0000FFFF0000FFFF;
+		v = (v | v << 8) & 0x00FF00FF00FF00FF;
+		v = (v | v << 4) & 0x0F0F0F0F0F0F0F0F;
+		v = (v | v << 2) & 0x3333333333333333;
+		return (v | v << 1) & 0x5555555555555555;
+	}
+
+	// Gather the even bits of [v] to the low 32 bits of the result, the inverse of spreadBits().
+	static constexpr uint64_t compactBits(uint64_t v)
+	{
+		v &= 0x5555555555555555;
+		v = (v | v >> 1) & 0x3333333333333333;
+		v = (v | v >> 2) & 0x0F0F0F0F0F0F0F0F;
+		v = (v | v >> 4) & 0x00FF00FF00FF00FF;
+		v = (v | v >> 8) & 0x0000FFFF0000FFFF;
+		return (v | v >> 16) & 0xFFFFFFFF;
+	}
+
+private:
+	unsigned _common_bits = 0;
+	bool _x_longer = false;
+	size_t _low_mask = 0;
+#if TM2D_BMI2
+	uint64_t _x_mask = 0;
+	uint64_t _y_mask = 0;
+#endif
+};
+
+// Block-linear tiling: square blocks of (1 << [BlockShift])^2 tiles stored one after another in row-major order, each block row-major.
+// A block of 4-byte tiles with the default shift of 3 fills 4 cache lines, so 2D-local access touches few lines. The sides are rounded up to multiples of the block side.
+template<size_t BlockShift = 3>
+	requires (BlockShift > 0 && BlockShift < 16)
+struct Tiled
+{
+	static constexpr bool row_major = false;
+	static constexpr size_t block_size = (size_t)1 << BlockShift;
+
+	constexpr size_t reset(size_t width, size_t height)
+	{
+		_blocks_x = (width + block_size - 1) >> BlockShift;
+		return _blocks_x * ((height + block_size - 1) >> BlockShift) << (2 * BlockShift);
+	}
+
+	constexpr size_t index(size_t x, size_t y) const
+	{
+		constexpr size_t mask = block_size - 1;
+		return ((x >> BlockShift) + _blocks_x * (y >> BlockShift)) << (2 * BlockShift) | (y & mask) << BlockShift | (x & mask);
+	}
+
+	// Get the tile coordinates at [index] in the buffer, the inverse of index().
+	constexpr Point position(size_t index) const
+	{
+		constexpr size_t mask = block_size - 1;
+		const size_t block = index >> (2 * BlockShift);
+		return { (block % _blocks_x) << BlockShift | (index & mask), (block / _blocks_x) << BlockShift | ((index >> BlockShift) & mask) };
+	}
+
+private:
+	size_t _blocks_x = 0;
+};
+
+}; // namespace layout
+
+// Allocator adaptor of [A] that default-initializes elements constructed without arguments instead of value-initializing them.
+// With it, TileMap2D_1D::resetUninitialized() leaves new tiles of trivially default-constructible types uninitialized.
+template<typename T, typename A = std::allocator<T>>
+struct DefaultInitAllocator: public A
+{
+	template<typename U>
+	struct rebind
+	{
+		using other = DefaultInitAllocator<U, typename std::allocator_traits<A>::template rebind_alloc<U>>;
+	};
+
+	using A::A;
+
+	template<typename U>
+	void construct(U* ptr) noexcept(std::is_nothrow_default_constructible_v<U>)
+	{
+		::new((void*)ptr) U;
+	}
+	template<typename U, typename... Args>
+	void construct(U* ptr, Args&&... args)
+	{
+		std::allocator_traits<A>::construct(static_cast<A&>(*this), ptr, std::forward<Args>(args)...);
+	}
+};
+
+// A 2-dimensional tilemap with a contiguous 1-dimensional memory buffer.
+// The buffer is allocated with [Allocator], e.g. a 'std::pmr::polymorphic_allocator' (see tm2D::pmr::TileMap2D_1D) for arena or pool allocation.
+// The tiles are ordered in the buffer by [Layout] (see tm2D::layout): row-major by default, or e.g. in Z-order or in blocks for 2D-local access.
+// Maps of different layouts convert to each other with the converting constructor, getChunk() or setChunk().
+template<typename T, typename Allocator = std::allocator<T>, typename Layout = layout::RowMajor>
+struct TileMap2D_1D: public StaticTileMap2DImpl<TileMap2D_1D<T, Allocator, Layout>, ResizableTileMap2DImpl<T>>
+{
+	using allocator_type = Allocator;
+	using layout_type = Layout;
+
+	TileMap2D_1D() {}
+
+	explicit TileMap2D_1D(const Allocator& alloc)
+		: _data(alloc) {}
+
+	// Initialize by row-major initializer list as 2D array.
+	TileMap2D_1D(std::initializer_list<T> arr, size_t _width, size_t _height, const Allocator& alloc = {})
+		: _data(alloc), _width(_width), _height(_height)
+	{
+		_data.resize(_layout.reset(_width, _height));
+		for (size_t i = 0; i < std::min<>(arr.size(), _width * _height); i++)
+			(*this)(i % _width, i / _width) = *(arr.begin() + i);
+	}
+
+	// Copies the underlying content of a TileMap2DView.
+	TileMap2D_1D(const TileMap2DView<T>& view, const Allocator& alloc = {})
+		: _data(alloc), _width(view.width()), _height(view.height())
+	{
+		_data.resize(_layout.reset(_width, _height));
+		for (size_t y = 0; y < _height; y++) {
+			if constexpr (Layout::row_major)
+				std::copy(view.data() + view.pitch() * y, view.data() + view.pitch() * y + _width, _data.begin() + _width * y);
+			else {
+				for (size_t x = 0; x < _width; x++)
+					(*this)(x, y) = view(x, y);
+			}
+		}
+	}
+
+	// Copies [other] into this layout, e.g. 'TileMap2D_1D<T, std::allocator<T>, layout::ZOrder> zorder(row_major_map);'.
+	template<typename OtherLayout>
+		requires (!std::same_as<OtherLayout, Layout>)
+	explicit TileMap2D_1D(const TileMap2D_1D<T, Allocator, OtherLayout>& other)
+		: _data(other.get_allocator())
+	{
+		resetUninitialized(other.width(), other.height());
+		setChunk(this, &other, 0, 0);
+	}
+
+	TileMap2D_1D(size_t _width, size_t _height, const T& elem = {}, const Allocator& alloc = {})
+		: _data(alloc), _width(_width), _height(_height)
+	{
+		_data.resize(_layout.reset(_width, _height), elem);
+	}
+
+	// Take the ownership of the buffer [data] ordered by [Layout] without copying it. It is resized to the size of [_width] x [_height] tiles if needed.
+	TileMap2D_1D(std::vector<T, Allocator>&& data, size_t _width, size_t _height)
+		: _data(data.get_allocator())
+	{
+		adopt(std::move(data), _width, _height);
+	}
+
+	constexpr size_t width() const final { return _width; }
+	constexpr size_t height() const final { return _height; }
+
+	constexpr T& operator()(size_t x, size_t y) final { return _data[index(x, y)]; }
+
+	constexpr const T& operator()(size_t x, size_t y) const final { return _data[index(x, y)]; }
+
+	void reset(size_t new_width, size_t new_height, const T& padding = {}) final
+	{
+		_width = new_width;
+		_height = new_height;
+		_data.clear();
+		_data.resize(_layout.reset(new_width, new_height), padding);
+	}
+
+	// Resize the buffer without refilling the tiles it already holds, reusing its capacity. The content of the tiles is unspecified.
+	void resetUninitialized(size_t new_width, size_t new_height) final
+	{
+		_width = new_width;
+		_height = new_height;
+		_data.resize(_layout.reset(new_width, new_height));
+	}
+
+	// Take the ownership of the buffer [data] of [width] x [height] tiles ordered by [Layout], without copying it.
+	void adopt(std::vector<T, Allocator>&& data, size_t width, size_t height)
+	{
+		_data = std::move(data);
+		_data.resize(_layout.reset(width, height));
+		_width = width;
+		_height = height;
+	}
+
+	// Give up the ownership of the buffer, ordered by [Layout], leaving an empty tilemap.
+	std::vector<T, Allocator> release()
+	{
+		std::vector<T, Allocator> released(_data.get_allocator());
+		released.swap(_data);
+		_width = _height = 0;
+		_layout.reset(0, 0);
+		return released;
+	}
+
+	// Get the allocator of the buffer.
+	allocator_type get_allocator() const { return _data.get_allocator(); }
+
+	// Get the layout of the buffer, e.g. to walk it in memory order with 'layout().position(i)'.
+	const Layout& layout() const { return _layout; }
+
+	// Get the pointer to the underlying data.
+	constexpr T* data() requires Layout::row_major { return _data.data(); }
+	constexpr const T* data() const requires Layout::row_major { return _data.data(); }
+
+	// Get the distance in tiles between the starts of 2 consecutive rows, which is the width.
+	constexpr size_t pitch() const requires Layout::row_major { return _width; }
+
+	// Get a view of [area] of the tilemap (clipped to its bounds), sharing its buffer.
+	TileMap2DView<T> subview(const Rect& area) requires Layout::row_major
+	{
+		return TileMap2DView<T>(_data.data(), _width, _height).subview(area);
+	}
+
+private:
+	constexpr size_t index(size_t x, size_t y) const
+	{
+		if constexpr (Layout::row_major) return x + _width * y;
+		else return _layout.index(x, y);
+	}
+
+	std::vector<T, Allocator> _data = {};
+	size_t _width = 0;
+	size_t _height = 0;
+	[[no_unique_address]] Layout _layout = {};
+};
+
+namespace pmr
+{
+
+// TileMap2D_1D allocating from a 'std::pmr::memory_resource'.
+template<typename T, typename Layout = layout::RowMajor>
+using TileMap2D_1D = tm2D::TileMap2D_1D<T, std::pmr::polymorphic_allocator<T>, Layout>;
+
+}; // namespace pmr
+
+namespace detail
+{
+
+// Whether [M] is a TileMap2D_1D, with any allocator and layout.
+template<typename M>
+inline constexpr bool is_tilemap_1d = false;
+template<typename T, typename A, typename L>
+inline constexpr bool is_tilemap_1d<TileMap2D_1D<T, A, L>> = true;
+
+// Copy [count] tiles from [src] to [dst]. The ranges may overlap.
+template<typename T>
+void copyRow(T* dst, const T* src, size_t count)
+{
+	if constexpr (std::is_trivially_copyable_v<T>) {
+		if (count) std::memmove(dst, src, count * sizeof(T));
+	}
+	else if (std::less<>()(dst, src)) std::copy(src, src + count, dst);
+	else std::copy_backward(src, src + count, dst + count);
+}
+
+// Reinitialize [map] with a new size, for callers that overwrite every tile afterwards.
+template<ResizableTileMapLike M>
+void resetForOverwrite(M& map, size_t width, size_t height)
+{
+	if constexpr (requires { map.resetUninitialized(width, height); }) map.resetUninitialized(width, height);
+	else map.reset(width, height, {});
+}
+
+// Copy the area [src] of [input] to [output] at ([dst_x]; [dst_y]), row by row.
+// Both areas must be within bounds.
+template<TileMapLike Out, TileMapLike In>
+void copyArea(Out& output, const In& input, size_t dst_x, size_t dst_y, const Rect& src)
+{
+	if constexpr (ContiguousTileMap<Out> && ContiguousTileMap<In>) {
+		if (!src.width || !src.height) return;
+
+		// Copy bottom-up if the destination may overlap the source rows below it.
+		if (std::less<>()(rowData(input, src.y) + src.x, rowData(output, dst_y) + dst_x)) {
+			for (size_t _y = src.height; _y-- > 0;)
+				copyRow(rowData(output, dst_y + _y) + dst_x, rowData(input, src.y + _y) + src.x, src.width);
+		}
+		else {
+			for (size_t _y = 0; _y < src.height; _y++)
+				copyRow(rowData(output, dst_y + _y) + dst_x, rowData(input, src.y + _y) + src.x, src.width);
+		}
+	}
+	else {
+		// Tiles are written with setTile(), so that tilemaps allocating on writes skip the tiles they already hold.
+		// Copy backwards if the destination may overlap the source tiles after it.
+		if (static_cast<const void*>(&output) == static_cast<const void*>(&input) && (dst_y > src.y || (dst_y == src.y && dst_x > src.x))) {
+			for (size_t _y = src.height; _y-- > 0;)
+				for (size_t _x = src.width; _x-- > 0;)
+					setTile(output, dst_x + _x, dst_y + _y, input(src.x + _x, src.y + _y));
+			return;
+		}
+		for (size_t _y = 0; _y < src.height; _y++)
+			for (size_t _x = 0; _x < src.width; _x++)
+				setTile(output, dst_x + _x, dst_y + _y, input(src.x + _x, src.y + _y));
+	}
+}
+
+}; // namespace detail
+
+// Get a chunk of a 2D tilemap with the size of [src_area] and return in [output_map].
+// This can also be used to 'resize' tilemap, by setting [src_area]'s position to (0; 0).
+// Rows are copied as whole spans (with 'memmove' for trivially copyable tiles) when both tilemaps are contiguous.
+template<ResizableTileMapLike Out, TileMapLike In>
+	requires std::same_as<tile_t<Out>, tile_t<In>>
+void getChunk(
+	Out* output,
+	const In* input,
+	const Rect& src_area
+) {
+	TM2D_INSTRUMENT_SCOPE(GetChunk);
+	const Rect src_cliprect = src_area.intersection({ 0, 0, input->width(), input->height() });
+	// Only the tiles outside of [input] need padding.
+	if (src_cliprect == src_area) detail::resetForOverwrite(*output, src_area.width, src_area.height);
+	else output->reset(src_area.width, src_area.height, {});
+	TM2D_INSTRUMENT_COUNT(src_cliprect.width * src_cliprect.height, src_cliprect.width * src_cliprect.height * sizeof(tile_t<In>));
+
+	detail::copyArea(*output, *input, 0, 0, src_cliprect);
+}
+
+// Set a chunk of a 2D tilemap.
+// Rows are copied as whole spans (with 'memmove' for trivially copyable tiles) when both tilemaps are contiguous.
+// [input] may be [output] or a view of the same buffer, e.g. to scroll an area: overlapping areas are copied as if through a temporary.
+// Returns the area of [output] written to.
+// Parameters:
+//   [src_area]: Source chunk area to get from. Default value is the whole [src_chunk] area.
+template<TileMapLike Out, TileMapLike In>
+	requires std::same_as<tile_t<Out>, tile_t<In>>
+Rect setChunk(
+	Out* output,
+	const In* input,
+	size_t x,
+	size_t y,
+	Rect src_area = {}
+) {
+	TM2D_INSTRUMENT_SCOPE(SetChunk);
+	if (src_area == Rect(0, 0, 0, 0))
+		src_area = { 0, 0, input->width(), input->height() };
+
+	const Rect
+		src_cliprect = src_area.intersection({ 0, 0, input->width(), input->height() }),
+		dst_cliprect = Rect(x, y, src_cliprect.width, src_cliprect.height).intersection({ 0, 0, output->width(), output->height() });
+	TM2D_INSTRUMENT_COUNT(dst_cliprect.width * dst_cliprect.height, dst_cliprect.width * dst_cliprect.height * sizeof(tile_t<In>));
+
+	detail::copyArea(*output, *input, dst_cliprect.x, dst_cliprect.y, { src_cliprect.x, src_cliprect.y, dst_cliprect.width, dst_cliprect.height });
+	return dst_cliprect;
+}
+
+namespace detail
+{
+
+// In-register transpose of a square block of [block] x [block] tiles of [Size] bytes. Pitches are in bytes and may be negative.
+// 'block' is 0 if there is no SIMD kernel for the tile size.
+template<size_t Size>
+struct SimdTranspose
+{
+	static constexpr size_t block = 0;
+	static void run(void*, ptrdiff_t, const void*, ptrdiff_t) {}
+};
+
+#if TM2D_SSE2
+template<>
+struct SimdTranspose<1>
+{
+	static constexpr size_t block = 8;
+	static void run(void* dst, ptrdiff_t dst_pitch, const void* src, ptrdiff_t src_pitch)
+	{
+		const char* s = (const char*)src;
+		char* d = (char*)dst;
+		__m128i r[8];
+		for (int i = 0; i < 8; i++) r[i] = _mm_loadl_epi64((const __m128i*)(s + i * src_pitch));
+
+		const __m128i
+			a0 = _mm_unpacklo_epi8(r[0], r[1]), a1 = _mm_unpacklo_epi8(r[2], r[3]),
+			a2 = _mm_unpacklo_epi8(r[4], r[5]), a3 = _mm_unpacklo_epi8(r[6], r[7]),
+			b0 = _mm_unpacklo_epi16(a0, a1), b1 = _mm_unpackhi_epi16(a0, a1),
+			b2 = _mm_unpacklo_epi16(a2, a3), b3 = _mm_unpackhi_epi16(a2, a3),
+			c[4] = {
+				_mm_unpacklo_epi32(b0, b2), _mm_unpackhi_epi32(b0, b2),
+				_mm_unpacklo_epi32(b1, b3), _mm_unpackhi_epi32(b1, b3)
+			};
+
+		// Each register holds 2 output rows.
+		for (int i = 0; i < 4; i++) {
+			_mm_storel_epi64((__m128i*)(d + (2 * i) * dst_pitch), c[i]);
+			_mm_storel_epi64((__m128i*)(d + (2 * i + 1) * dst_pitch), _mm_unpackhi_epi64(c[i], c[i]));
+		}
+	}
+};
+
+template<>
+struct SimdTranspose<2>
+{
+	static constexpr size_t block = 8;
+	static void run(void* dst, ptrdiff_t dst_pitch, const void* src, ptrdiff_t src_pitch)
+	{
+		const char* s = (const char*)src;
+		char* d = (char*)dst;
+		__m128i r[8];
+		for (int i = 0; i < 8; i++) r[i] = _mm_loadu_si128((const __m128i*)(s + i * src_pitch));
+
+		const __m128i
+			a0 = _mm_unpacklo_epi16(r[0], r[1]), a1 = _mm_unpackhi_epi16(r[0], r[1]),
+			a2 = _mm_unpacklo_epi16(r[2], r[3]), a3 = _mm_unpackhi_epi16(r[2], r[3]),
+			a4 = _mm_unpacklo_epi16(r[4], r[5]), a5 = _mm_unpackhi_epi16(r[4], r[5]),
+			a6 = _mm_unpacklo_epi16(r[6], r[7]), a7 = _mm_unpackhi_epi16(r[6], r[7]),
+			b0 = _mm_unpacklo_epi32(a0, a2), b1 = _mm_unpackhi_epi32(a0, a2),
+			b2 = _mm_unpacklo_epi32(a1, a3), b3 = _mm_unpackhi_epi32(a1, a3),
+			b4 = _mm_unpacklo_epi32(a4, a6), b5 = _mm_unpackhi_epi32(a4, a6),
+			b6 = _mm_unpacklo_epi32(a5, a7), b7 = _mm_unpackhi_epi32(a5, a7),
+			c[8] = {
+				_mm_unpacklo_epi64(b0, b4), _mm_unpackhi_epi64(b0, b4),
+				_mm_unpacklo_epi64(b1, b5), _mm_unpackhi_epi64(b1, b5),
+				_mm_unpacklo_epi64(b2, b6), _mm_unpackhi_epi64(b2, b6),
+				_mm_unpacklo_epi64(b3, b7), _mm_unpackhi_epi64(b3, b7)
+			};
+
+		for (int i = 0; i < 8; i++) _mm_storeu_si128((__m128i*)(d + i * dst_pitch), c[i]);
+	}
+};
+#endif
+
+#if TM2D_AVX2
+template<>
+struct SimdTranspose<4>
+{
+	static constexpr size_t block = 8;
+	static void run(void* dst, ptrdiff_t dst_pitch, const void* src, ptrdiff_t src_pitch)
+	{
+		const char* s = (const char*)src;
+		char* d = (char*)dst;
+		__m256 r[8];
+		for (int i = 0; i < 8; i++) r[i] = _mm256_loadu_ps((const float*)(s + i * src_pitch));
+
+		const __m256
+			a0 = _mm256_unpacklo_ps(r[0], r[1]), a1 = _mm256_unpackhi_ps(r[0], r[1]),
+			a2 = _mm256_unpacklo_ps(r[2], r[3]), a3 = _mm256_unpackhi_ps(r[2], r[3]),
+			a4 = _mm256_unpacklo_ps(r[4], r[5]), a5 = _mm256_unpackhi_ps(r[4], r[5]),
+			a6 = _mm256_unpacklo_ps(r[6], r[7]), a7 = _mm256_unpackhi_ps(r[6], r[7]),
+			b0 = _mm256_shuffle_ps(a0, a2, _MM_SHUFFLE(1, 0, 1, 0)), b1 = _mm256_shuffle_ps(a0, a2, _MM_SHUFFLE(3, 2, 3, 2)),
+			b2 = _mm256_shuffle_ps(a1, a3, _MM_SHUFFLE(1, 0, 1, 0)), b3 = _mm256_shuffle_ps(a1, a3, _MM_SHUFFLE(3, 2, 3, 2)),
+			b4 = _mm256_shuffle_ps(a4, a6, _MM_SHUFFLE(1, 0, 1, 0)), b5 = _mm256_shuffle_ps(a4, a6, _MM_SHUFFLE(3, 2, 3, 2)),
+			b6 = _mm256_shuffle_ps(a5, a7, _MM_SHUFFLE(1, 0, 1, 0)), b7 = _mm256_shuffle_ps(a5, a7, _MM_SHUFFLE(3, 2, 3, 2)),
+			c[8] = {
+				_mm256_permute2f128_ps(b0, b4, 0x20), _mm256_permute2f128_ps(b1, b5, 0x20),
+				_mm256_permute2f128_ps(b2, b6, 0x20), _mm256_permute2f128_ps(b3, b7, 0x20),
+				_mm256_permute2f128_ps(b0, b4, 0x31), _mm256_permute2f128_ps(b1, b5, 0x31),
+				_mm256_permute2f128_ps(b2, b6, 0x31), _mm256_permute2f128_ps(b3, b7, 0x31)
+			};
+
+		for (int i = 0; i < 8; i++) _mm256_storeu_ps((float*)(d + i * dst_pitch), c[i]);
+	}
+};
+#elif TM2D_SSE2
+template<>
+struct SimdTranspose<4>
+{
+	static constexpr size_t block = 4;
+	static void run(void* dst, ptrdiff_t dst_pitch, const void* src, ptrdiff_t src_pitch)
+	{
+		const char* s = (const char*)src;
+		char* d = (char*)dst;
+		__m128i r[4];
+		for (int i = 0; i < 4; i++) r[i] = _mm_loadu_si128((const __m128i*)(s + i * src_pitch));
+
+		const __m128i
+			a0 = _mm_unpacklo_epi32(r[0], r[1]), a1 = _mm_unpacklo_epi32(r[2], r[3]),
+			a2 = _mm_unpackhi_epi32(r[0], r[1]), a3 = _mm_unpackhi_epi32(r[2], r[3]),
+			c[4] = {
+				_mm_unpacklo_epi64(a0, a1), _mm_unpackhi_epi64(a0, a1),
+				_mm_unpacklo_epi64(a2, a3), _mm_unpackhi_epi64(a2, a3)
+			};
+
+		for (int i = 0; i < 4; i++) _mm_storeu_si128((__m128i*)(d + i * dst_pitch), c[i]);
+	}
+};
+#elif TM2D_NEON
+template<>
+struct SimdTranspose<4>
+{
+	static constexpr size_t block = 4;
+	static void run(void* dst, ptrdiff_t dst_pitch, const void* src, ptrdiff_t src_pitch)
+	{
+		const char* s = (const char*)src;
+		char* d = (char*)dst;
+		const uint32x4x2_t
+			a0 = vtrnq_u32(vld1q_u32((const uint32_t*)s), vld1q_u32((const uint32_t*)(s + src_pitch))),
+			a1 = vtrnq_u32(vld1q_u32((const uint32_t*)(s + 2 * src_pitch)), vld1q_u32((const uint32_t*)(s + 3 * src_pitch)));
+
+		vst1q_u32((uint32_t*)d, vcombine_u32(vget_low_u32(a0.val[0]), vget_low_u32(a1.val[0])));
+		vst1q_u32((uint32_t*)(d + dst_pitch), vcombine_u32(vget_low_u32(a0.val[1]), vget_low_u32(a1.val[1])));
+		vst1q_u32((uint32_t*)(d + 2 * dst_pitch), vcombine_u32(vget_high_u32(a0.val[0]), vget_high_u32(a1.val[0])));
+		vst1q_u32((uint32_t*)(d + 3 * dst_pitch), vcombine_u32(vget_high_u32(a0.val[1]), vget_high_u32(a1.val[1])));
+	}
+};
+#endif
+
+// Size of the SIMD transpose block for tile type [T], or 0 if there is none.
+template<typename T>
+constexpr size_t simd_transpose_block = std::is_trivially_copyable_v<T> ? SimdTranspose<sizeof(T)>::block : 0;
+
+// Side of the square areas that transposes are blocked into, so that both the read and the written rows stay in cache.
+constexpr size_t transpose_tile = 32;
+
+// Transpose [width] x [height] source tiles: dst[x * dst_pitch + y] = src[y * src_pitch + x].
+template<typename T>
+void transposeScalar(T* dst, ptrdiff_t dst_pitch, const T* src, ptrdiff_t src_pitch, size_t width, size_t height)
+{
+	for (size_t y = 0; y < height; y++)
+		for (size_t x = 0; x < width; x++)
+			dst[(ptrdiff_t)x * dst_pitch + (ptrdiff_t)y] = src[(ptrdiff_t)y * src_pitch + (ptrdiff_t)x];
+}
+
+// Transpose [width] x [height] source tiles with cache blocking and SIMD kernels. Pitches are in tiles and may be negative. The areas must not overlap.
+template<typename T>
+void transposeTiles(T* dst, ptrdiff_t dst_pitch, const T* src, ptrdiff_t src_pitch, size_t width, size_t height)
+{
+	constexpr size_t K = simd_transpose_block<T>;
+
+	for (size_t by = 0; by < height; by += transpose_tile) {
+		for (size_t bx = 0; bx < width; bx += transpose_tile) {
+			const size_t
+				block_width = std::min<>(transpose_tile, width - bx),
+				block_height = std::min<>(transpose_tile, height - by);
+			const T* s = src + (ptrdiff_t)by * src_pitch + (ptrdiff_t)bx;
+			T* d = dst + (ptrdiff_t)bx * dst_pitch + (ptrdiff_t)by;
+
+			if constexpr (K > 0) {
+				const size_t
+					kernel_width = block_width - block_width % K,
+					kernel_height = block_height - block_height % K;
+
+				for (size_t y = 0; y < kernel_height; y += K)
+					for (size_t x = 0; x < kernel_width; x += K)
+						SimdTranspose<sizeof(T)>::run(
+							d + (ptrdiff_t)x * dst_pitch + (ptrdiff_t)y, dst_pitch * (ptrdiff_t)sizeof(T),
+							s + (ptrdiff_t)y * src_pitch + (ptrdiff_t)x, src_pitch * (ptrdiff_t)sizeof(T)
+						);
+
+				// Remaining right columns and bottom rows of the block.
+				transposeScalar(d + (ptrdiff_t)kernel_width * dst_pitch, dst_pitch, s + kernel_width, src_pitch, block_width - kernel_width, block_height);
+				transposeScalar(d + kernel_height, dst_pitch, s + (ptrdiff_t)kernel_height * src_pitch, src_pitch, kernel_width, block_height - kernel_height);
+			}
+			else transposeScalar(d, dst_pitch, s, src_pitch, block_width, block_height);
+		}
+	}
+}
+
+// Transpose a square area of [size] x [size] tiles in place.
+template<typename T>
+void transposeSquare(T* data, ptrdiff_t pitch, size_t size)
+{
+	constexpr size_t K = simd_transpose_block<T>;
+	size_t kernel_size = 0;
+
+	if constexpr (K > 0) {
+		constexpr ptrdiff_t tmp_pitch = K * sizeof(T);
+		const ptrdiff_t byte_pitch = pitch * (ptrdiff_t)sizeof(T);
+		T tmp[K * K];
+		kernel_size = size - size % K;
+
+		for (size_t by = 0; by < kernel_size; by += K) {
+			// Diagonal block.
+			T* diag = data + (ptrdiff_t)by * pitch + (ptrdiff_t)by;
+			SimdTranspose<sizeof(T)>::run(tmp, tmp_pitch, diag, byte_pitch);
+			for (size_t y = 0; y < K; y++) std::memcpy(diag + (ptrdiff_t)y * pitch, tmp + y * K, K * sizeof(T));
+
+			// Swap the transposed blocks on both sides of the diagonal.
+			for (size_t bx = by + K; bx < kernel_size; bx += K) {
+				T* upper = data + (ptrdiff_t)by * pitch + (ptrdiff_t)bx;
+				T* lower = data + (ptrdiff_t)bx * pitch + (ptrdiff_t)by;
+				SimdTranspose<sizeof(T)>::run(tmp, tmp_pitch, upper, byte_pitch);
+				SimdTranspose<sizeof(T)>::run(upper, byte_pitch, lower, byte_pitch);
+				for (size_t y = 0; y < K; y++) std::memcpy(lower + (ptrdiff_t)y * pitch, tmp + y * K, K * sizeof(T));
+			}
+		}
+	}
+	else {
+		kernel_size = size - size % transpose_tile;
+
+		for (size_t by = 0; by < kernel_size; by += transpose_tile)
+			for (size_t bx = by; bx < kernel_size; bx += transpose_tile)
+				for (size_t y = by; y < by + transpose_tile; y++)
+					for (size_t x = std::max<>(bx, y + 1); x < bx + transpose_tile; x++)
+						std::swap(data[(ptrdiff_t)y * pitch + (ptrdiff_t)x], data[(ptrdiff_t)x * pitch + (ptrdiff_t)y]);
+	}
+
+	// Tiles with a coordinate in the remaining right columns / bottom rows.
+	for (size_t y = 0; y < size; y++)
+		for (size_t x = std::max<>(kernel_size, y + 1); x < size; x++)
+			std::swap(data[(ptrdiff_t)y * pitch + (ptrdiff_t)x], data[(ptrdiff_t)x * pitch + (ptrdiff_t)y]);
+}
+
+// Rotate rows [y_begin; y_end) of [input] by 90 degrees into [output], which has the rotated size.
+template<TileMapLike Out, TileMapLike In>
+void rotateRows90(Out& output, const In& input, bool rotate_left, size_t y_begin, size_t y_end)
+{
+	const size_t in_width = input.width(), in_height = input.height();
+	if (!in_width || y_begin >= y_end) return;
+
+	if constexpr (ContiguousTileMap<Out> && ContiguousTileMap<In>) {
+		const ptrdiff_t dst_pitch = rowPitch(output), src_pitch = rowPitch(input);
+
+		// Left: input row y becomes output column y, read from the bottom output row up.
+		// Right: input row y becomes output column (in_height - 1 - y).
+		if (rotate_left)
+			transposeTiles(rowData(output, in_width - 1) + y_begin, -dst_pitch, rowData(input, y_begin), src_pitch, in_width, y_end - y_begin);
+		else
+			transposeTiles(rowData(output, 0) + (in_height - y_end), dst_pitch, rowData(input, y_end - 1), -src_pitch, in_width, y_end - y_begin);
+	}
+	else {
+		for (size_t by = y_begin; by < y_end; by += transpose_tile) {
+			for (size_t bx = 0; bx < in_width; bx += transpose_tile) {
+				const size_t block_y_end = std::min<>(by + transpose_tile, y_end), block_x_end = std::min<>(bx + transpose_tile, in_width);
+
+				for (size_t y = by; y < block_y_end; y++) {
+					for (size_t x = bx; x < block_x_end; x++) {
+						if (rotate_left) output(y, in_width - 1 - x) = input(x, y);
+						else output(in_height - 1 - y, x) = input(x, y);
+					}
+				}
+			}
+		}
+	}
+}
+
+// Rotate [input] by 180 degrees into rows [y_begin; y_end) of [output], which has the same size.
+template<TileMapLike Out, TileMapLike In>
+void rotateRows180(Out& output, const In& input, size_t y_begin, size_t y_end)
+{
+	const size_t width = input.width(), height = input.height();
+
+	if constexpr (ContiguousTileMap<Out> && ContiguousTileMap<In>) {
+		for (size_t y = y_begin; y < y_end; y++) {
+			const auto src = rowData(input, height - 1 - y);
+			std::reverse_copy(src, src + width, rowData(output, y));
+		}
+	}
+	else {
+		for (size_t y = y_begin; y < y_end; y++)
+			for (size_t x = 0; x < width; x++)
+				output(x, y) = input(width - 1 - x, height - 1 - y);
+	}
+}
+
+}; // namespace detail
+
+// Rotate the tilemap 90 degrees in the top left corner.
+// Contiguous tilemaps are rotated with a cache-blocked transpose, using SIMD kernels for 1, 2 and 4-byte trivially copyable tiles. [output] must not share its buffer with [input].
+// Params:
+//   [rotate_left] If true, rotate to the left, otherwise rotate to the right.
+template<ResizableTileMapLike Out, TileMapLike In>
+	requires std::same_as<tile_t<Out>, tile_t<In>>
+void rot90(
+	Out* output,
+	const In* input,
+	bool rotate_left
+) {
+	TM2D_INSTRUMENT_SCOPE(Rot90);
+	TM2D_INSTRUMENT_COUNT(input->width() * input->height(), input->width() * input->height() * sizeof(tile_t<In>));
+	detail::resetForOverwrite(*output, input->height(), input->width());
+	detail::rotateRows90(*output, *input, rotate_left, 0, input->height());
+}
+
+// Rotate the tilemap 90 degrees in place.
+// Square tilemaps are rotated without a second buffer. Other tilemaps are rotated through a temporary TileMap2D_1D if they are resizable.
+// Returns:
+//   'false' if the tilemap is not square and can't be resized, in which case it is left unchanged.
+template<TileMapLike M>
+bool rot90(M* map, bool rotate_left)
+{
+	TM2D_INSTRUMENT_SCOPE(Rot90);
+	const size_t width = map->width(), height = map->height();
+
+	if (width == height) {
+		TM2D_INSTRUMENT_COUNT(width * height, width * height * sizeof(tile_t<M>));
+		if constexpr (ContiguousTileMap<M>) {
+			detail::transposeSquare(detail::rowData(*map, 0), detail::rowPitch(*map), width);
+		}
+		else {
+			for (size_t y = 0; y < height; y++)
+				for (size_t x = y + 1; x < width; x++)
+					detail::swapTiles(*map, x, y, y, x);
+		}
+
+		// Transposing then flipping the rows (left) or the columns (right) completes the rotation.
+		flip(*map, !rotate_left, rotate_left);
+		return true;
+	}
+
+	if constexpr (detail::is_tilemap_1d<M>) {
+		// Rotate into a buffer from the same allocator, then take it over.
+		M rotated(map->get_allocator());
+		rot90(&rotated, map, rotate_left);
+		*map = std::move(rotated);
+		return true;
+	}
+	else if constexpr (ResizableTileMapLike<M>) {
+		TileMap2D_1D<tile_t<M>> rotated;
+		rot90(&rotated, map, rotate_left);
+
+		detail::resetForOverwrite(*map, height, width);
+		setChunk(map, &rotated, 0, 0);
+		return true;
+	}
+	else return false;
+}
+
+// Rotate the tilemap 180 degrees.
+// [output] must not share its buffer with [input].
+template<ResizableTileMapLike Out, TileMapLike In>
+	requires std::same_as<tile_t<Out>, tile_t<In>>
+void rot180(
+	Out* output,
+	const In* input
+) {
+	TM2D_INSTRUMENT_SCOPE(Rot180);
+	TM2D_INSTRUMENT_COUNT(input->width() * input->height(), input->width() * input->height() * sizeof(tile_t<In>));
+	detail::resetForOverwrite(*output, input->width(), input->height());
+	detail::rotateRows180(*output, *input, 0, input->height());
+}
+
+// Rotate the tilemap 180 degrees in place.
+template<TileMapLike M>
+void rot180(M* map)
+{
+	TM2D_INSTRUMENT_SCOPE(Rot180);
+	flip(*map, true, true);
+}
+
 }; // |===|   END namespace tm2D   |===|
\ No newline at end of file
@@ -0,0 +1,558 @@
+#pragma once
+
+#include "TileMap2D.h"
+
+#include <memory>
+#include <cstdint>
+
+// Chunked, sparse and copy-on-write 2-dimensional tilemap storage, for huge and streaming worlds and cheap snapshots.
+
+namespace tm2D
+{
+
+// A 2-dimensional tilemap stored as square chunks of (1 << [ChunkShift]) x (1 << [ChunkShift]) tiles, each a contiguous row-major buffer, indexed by a chunk directory.
+// Chunks are allocated when first written to through the non-const 'operator()'. Chunks that are not allocated read as the padding tile.
+// Local operations touch only a few chunks, and the tilemap can be resized without copying its tiles.
+// Note: allocating chunks is not thread-safe. To write to different chunks from multiple threads, allocate them beforehand with allocateArea(). The parallel algorithms write it sequentially instead.
+template<typename T, size_t ChunkShift = 6>
+struct TileMap2D_Chunked: public StaticTileMap2DImpl<TileMap2D_Chunked<T, ChunkShift>, ResizableTileMap2DImpl<T>>
+{
+	// Width and height of a chunk in tiles.
+	static constexpr size_t chunk_size = size_t(1) << ChunkShift;
+	static constexpr size_t chunk_mask = chunk_size - 1;
+	// Writes allocate chunks, so the parallel algorithms write this tilemap sequentially. See allocates_on_write.
+	static constexpr bool allocates_on_write = true;
+
+	TileMap2D_Chunked() {}
+
+	TileMap2D_Chunked(size_t width, size_t height, const T& padding = {})
+	{
+		reset(width, height, padding);
+	}
+
+	TileMap2D_Chunked(const TileMap2D_Chunked& other) { *this = other; }
+	TileMap2D_Chunked(TileMap2D_Chunked&&) = default;
+
+	TileMap2D_Chunked& operator=(const TileMap2D_Chunked& other)
+	{
+		if (this == &other) return *this;
+
+		_width = other._width;
+		_height = other._height;
+		_chunks_x = other._chunks_x;
+		_chunks_y = other._chunks_y;
+		_padding = other._padding;
+		_chunks.clear();
+		_chunks.resize(other._chunks.size());
+
+		for (size_t i = 0; i < _chunks.size(); i++) {
+			if (other._chunks[i]) {
+				_chunks[i] = std::make_unique<T[]>(chunk_size * chunk_size);
+				std::copy(other._chunks[i].get(), other._chunks[i].get() + chunk_size * chunk_size, _chunks[i].get());
+			}
+		}
+		return *this;
+	}
+	TileMap2D_Chunked& operator=(TileMap2D_Chunked&&) = default;
+
+	constexpr size_t width() const final { return _width; }
+	constexpr size_t height() const final { return _height; }
+
+	// Get tile directly (does not check for bounds). Allocates the tile's chunk if needed.
+	T& operator()(size_t x, size_t y) final
+	{
+		std::unique_ptr<T[]>& chunk = _chunks[(x >> ChunkShift) + _chunks_x * (y >> ChunkShift)];
+		if (!chunk) chunk = newChunk();
+		return chunk[(x & chunk_mask) | ((y & chunk_mask) << ChunkShift)];
+	}
+
+	// Get const reference to tile directly (does not check for bounds). Tiles of unallocated chunks are the padding tile.
+	const T& operator()(size_t x, size_t y) const final
+	{
+		const T* chunk = _chunks[(x >> ChunkShift) + _chunks_x * (y >> ChunkShift)].get();
+		return chunk ? chunk[(x & chunk_mask) | ((y & chunk_mask) << ChunkShift)] : _padding;
+	}
+
+	// Set tile directly (does not check for bounds). Unallocated chunks are left unallocated if [t] is the padding tile.
+	void setUnchecked(size_t x, size_t y, const T& t)
+	{
+		std::unique_ptr<T[]>& chunk = _chunks[(x >> ChunkShift) + _chunks_x * (y >> ChunkShift)];
+		if (!chunk) {
+			if constexpr (std::equality_comparable<T>) {
+				if (t == _padding) return;
+			}
+			chunk = newChunk();
+		}
+		chunk[(x & chunk_mask) | ((y & chunk_mask) << ChunkShift)] = t;
+	}
+
+	// Clear the tilemap to [padding] with a new size. Only the chunk directory is reallocated.
+	void reset(size_t new_width, size_t new_height, const T& padding = {}) final
+	{
+		_padding = padding;
+		_chunks.clear();
+		setSize(new_width, new_height);
+		_chunks.resize(_chunks_x * _chunks_y);
+	}
+
+	// Clear the tilemap with a new size, keeping the padding tile. No chunk is allocated.
+	void resetUninitialized(size_t new_width, size_t new_height) final
+	{
+		reset(new_width, new_height, _padding);
+	}
+
+	// Resize the tilemap, keeping the tiles within both the old and the new size. New space is filled with the padding tile.
+	// Chunks are moved to their new directory position without copying their tiles.
+	void resize(size_t new_width, size_t new_height)
+	{
+		const size_t old_chunks_x = _chunks_x, old_chunks_y = _chunks_y;
+		std::vector<std::unique_ptr<T[]>> old_chunks = std::move(_chunks);
+
+		setSize(new_width, new_height);
+		_chunks.clear();
+		_chunks.resize(_chunks_x * _chunks_y);
+
+		for (size_t cy = 0; cy < std::min<>(old_chunks_y, _chunks_y); cy++)
+			for (size_t cx = 0; cx < std::min<>(old_chunks_x, _chunks_x); cx++)
+				_chunks[cx + _chunks_x * cy] = std::move(old_chunks[cx + old_chunks_x * cy]);
+
+		// Tiles of edge chunks past the new size are reset, so that growing the tilemap later reveals padding.
+		const size_t edge_width = _width & chunk_mask, edge_height = _height & chunk_mask;
+		for (size_t cy = 0; cy < _chunks_y; cy++) {
+			for (size_t cx = 0; cx < _chunks_x; cx++) {
+				T* chunk = _chunks[cx + _chunks_x * cy].get();
+				if (!chunk) continue;
+
+				const size_t used_width = (edge_width && cx == _chunks_x - 1) ? edge_width : chunk_size;
+				const size_t used_height = (edge_height && cy == _chunks_y - 1) ? edge_height : chunk_size;
+				for (size_t y = 0; y < chunk_size; y++) {
+					if (y < used_height) std::fill(chunk + (y << ChunkShift) + used_width, chunk + ((y + 1) << ChunkShift), _padding);
+					else std::fill(chunk + (y << ChunkShift), chunk + ((y + 1) << ChunkShift), _padding);
+				}
+			}
+		}
+	}
+
+	// Get the tile of unallocated chunks.
+	constexpr const T& padding() const { return _padding; }
+
+	// Number of chunks in a row of the chunk directory.
+	constexpr size_t chunksX() const { return _chunks_x; }
+	// Number of chunks in a column of the chunk directory.
+	constexpr size_t chunksY() const { return _chunks_y; }
+
+	// Get the area of the tilemap covered by chunk ([cx]; [cy]).
+	Rect chunkRect(size_t cx, size_t cy) const
+	{
+		return Rect(cx << ChunkShift, cy << ChunkShift, chunk_size, chunk_size).intersection({ 0, 0, _width, _height });
+	}
+
+	// Get the row-major tiles of chunk ([cx]; [cy]), or NULL if it is not allocated.
+	T* chunk(size_t cx, size_t cy) { return _chunks[cx + _chunks_x * cy].get(); }
+	const T* chunk(size_t cx, size_t cy) const { return _chunks[cx + _chunks_x * cy].get(); }
+
+	// Get a view of all the chunk_size x chunk_size tiles of chunk ([cx]; [cy]), allocating it if needed.
+	// Tiles outside of chunkRect() must be kept as the padding tile.
+	TileMap2DView<T> chunkView(size_t cx, size_t cy)
+	{
+		return TileMap2DView<T>(allocateChunk(cx, cy), chunk_size, chunk_size);
+	}
+
+	// Allocate chunk ([cx]; [cy]) if it is not allocated, and return its tiles.
+	T* allocateChunk(size_t cx, size_t cy)
+	{
+		std::unique_ptr<T[]>& chunk = _chunks[cx + _chunks_x * cy];
+		if (!chunk) chunk = newChunk();
+		return chunk.get();
+	}
+
+	// Allocate all chunks intersecting [area].
+	void allocateArea(const Rect& area)
+	{
+		const Rect cliprect = area.intersection({ 0, 0, _width, _height });
+		if (!cliprect.width || !cliprect.height) return;
+
+		for (size_t cy = cliprect.y >> ChunkShift; cy <= (cliprect.y + cliprect.height - 1) >> ChunkShift; cy++)
+			for (size_t cx = cliprect.x >> ChunkShift; cx <= (cliprect.x + cliprect.width - 1) >> ChunkShift; cx++)
+				allocateChunk(cx, cy);
+	}
+
+	// Free chunk ([cx]; [cy]), so that its tiles read as the padding tile.
+	void releaseChunk(size_t cx, size_t cy) { _chunks[cx + _chunks_x * cy].reset(); }
+
+	// Replace chunk ([cx]; [cy]) with the chunk_size x chunk_size row-major [tiles], e.g. loaded on another thread. Tiles outside of chunkRect() must be the padding tile.
+	void adoptChunk(size_t cx, size_t cy, std::unique_ptr<T[]> tiles) { _chunks[cx + _chunks_x * cy] = std::move(tiles); }
+
+	// Get the number of allocated chunks.
+	size_t allocatedChunks() const
+	{
+		return std::count_if(_chunks.begin(), _chunks.end(), [](const std::unique_ptr<T[]>& chunk) { return (bool)chunk; });
+	}
+
+	// Call [func(cx, cy, area, tiles)] for every allocated chunk, with the chunk's area in the tilemap and its row-major tiles (with a row pitch of chunk_size).
+	// Chunks are independent buffers, so their tiles may be processed in parallel or streamed individually.
+	template<typename F>
+	void forEachChunk(F&& func)
+	{
+		for (size_t cy = 0; cy < _chunks_y; cy++)
+			for (size_t cx = 0; cx < _chunks_x; cx++)
+				if (T* chunk = _chunks[cx + _chunks_x * cy].get()) func(cx, cy, chunkRect(cx, cy), chunk);
+	}
+
+	template<typename F>
+	void forEachChunk(F&& func) const
+	{
+		for (size_t cy = 0; cy < _chunks_y; cy++)
+			for (size_t cx = 0; cx < _chunks_x; cx++)
+				if (const T* chunk = _chunks[cx + _chunks_x * cy].get()) func(cx, cy, chunkRect(cx, cy), chunk);
+	}
+
+private:
+	std::unique_ptr<T[]> newChunk() const
+	{
+		std::unique_ptr<T[]> chunk = std::make_unique<T[]>(chunk_size * chunk_size);
+		std::fill(chunk.get(), chunk.get() + chunk_size * chunk_size, _padding);
+		return chunk;
+	}
+
+	void setSize(size_t new_width, size_t new_height)
+	{
+		_width = new_width;
+		_height = new_height;
+		_chunks_x = (new_width + chunk_mask) >> ChunkShift;
+		_chunks_y = (new_height + chunk_mask) >> ChunkShift;
+	}
+
+	std::vector<std::unique_ptr<T[]>> _chunks = {};
+	size_t _width = 0;
+	size_t _height = 0;
+	size_t _chunks_x = 0;
+	size_t _chunks_y = 0;
+	T _padding = {};
+};
+
+// A sparse 2-dimensional tilemap of (1 << [ChunkShift]) x (1 << [ChunkShift]) tile chunks, where a chunk holding a single value is stored as that value only.
+// Chunks start uniform with the default tile. 'set()' keeps a chunk uniform when writing its value, and the non-const 'operator()' makes the chunk dense. Call compact() to turn dense chunks holding a single value back into uniform chunks.
+// The algorithms write tilemaps that are not contiguous like set(), so fillRect(), setChunk(), flip(), rot90() and the others only make dense the chunks whose tiles they change.
+// Resetting to the same size is O(1): chunks from before a reset are invalidated, and their buffers are recycled when they are made dense again.
+template<typename T, size_t ChunkShift = 6>
+	requires std::equality_comparable<T>
+struct TileMap2D_Sparse: public StaticTileMap2DImpl<TileMap2D_Sparse<T, ChunkShift>, ResizableTileMap2DImpl<T>>
+{
+	// Width and height of a chunk in tiles.
+	static constexpr size_t chunk_size = size_t(1) << ChunkShift;
+	static constexpr size_t chunk_mask = chunk_size - 1;
+	// Writes allocate chunks, so the parallel algorithms write this tilemap sequentially. See allocates_on_write.
+	static constexpr bool allocates_on_write = true;
+
+	TileMap2D_Sparse() {}
+
+	TileMap2D_Sparse(size_t width, size_t height, const T& default_tile = {})
+	{
+		reset(width, height, default_tile);
+	}
+
+	constexpr size_t width() const final { return _width; }
+	constexpr size_t height() const final { return _height; }
+
+	// Get tile directly (does not check for bounds). Makes the tile's chunk dense if needed.
+	T& operator()(size_t x, size_t y) final
+	{
+		Chunk& chunk = _chunks[(x >> ChunkShift) + _chunks_x * (y >> ChunkShift)];
+		if (chunk.generation != _generation || !chunk.dense) makeDense(chunk);
+		return chunk.tiles[(x & chunk_mask) | ((y & chunk_mask) << ChunkShift)];
+	}
+
+	// Get const reference to tile directly (does not check for bounds).
+	const T& operator()(size_t x, size_t y) const final
+	{
+		const Chunk& chunk = _chunks[(x >> ChunkShift) + _chunks_x * (y >> ChunkShift)];
+		if (chunk.generation != _generation) return _default;
+		return chunk.dense ? chunk.tiles[(x & chunk_mask) | ((y & chunk_mask) << ChunkShift)] : chunk.value;
+	}
+
+	// Set tile directly (does not check for bounds). Uniform chunks are only made dense when [t] differs from their value.
+	void setUnchecked(size_t x, size_t y, const T& t)
+	{
+		Chunk& chunk = _chunks[(x >> ChunkShift) + _chunks_x * (y >> ChunkShift)];
+		if (chunk.generation != _generation) {
+			if (t == _default) return;
+			chunk.generation = _generation;
+			chunk.dense = false;
+			chunk.value = _default;
+		}
+		if (!chunk.dense) {
+			if (t == chunk.value) return;
+			makeDense(chunk);
+		}
+		chunk.tiles[(x & chunk_mask) | ((y & chunk_mask) << ChunkShift)] = t;
+	}
+
+	// Clear the tilemap to [default_tile] with a new size. This is O(1) if the number of chunks doesn't change.
+	void reset(size_t new_width, size_t new_height, const T& default_tile = {}) final
+	{
+		const size_t chunks_x = (new_width + chunk_mask) >> ChunkShift, chunks_y = (new_height + chunk_mask) >> ChunkShift;
+
+		_width = new_width;
+		_height = new_height;
+		_default = default_tile;
+
+		if (chunks_x * chunks_y == _chunks.size() && _generation != UINT32_MAX) {
+			_generation++;
+		}
+		else {
+			_chunks.clear();
+			_chunks.resize(chunks_x * chunks_y);
+			_generation = 1;
+		}
+		_chunks_x = chunks_x;
+		_chunks_y = chunks_y;
+	}
+
+	// Clear the tilemap with a new size, keeping the default tile. Every chunk is left uniform.
+	void resetUninitialized(size_t new_width, size_t new_height) final
+	{
+		reset(new_width, new_height, _default);
+	}
+
+	// Make all chunks intersecting [area] dense, so that their tiles can be written to from multiple threads.
+	void allocateArea(const Rect& area)
+	{
+		const Rect cliprect = area.intersection({ 0, 0, _width, _height });
+		if (!cliprect.width || !cliprect.height) return;
+
+		for (size_t cy = cliprect.y >> ChunkShift; cy <= (cliprect.y + cliprect.height - 1) >> ChunkShift; cy++) {
+			for (size_t cx = cliprect.x >> ChunkShift; cx <= (cliprect.x + cliprect.width - 1) >> ChunkShift; cx++) {
+				Chunk& chunk = _chunks[cx + _chunks_x * cy];
+				if (chunk.generation != _generation || !chunk.dense) makeDense(chunk);
+			}
+		}
+	}
+
+	// Turn dense chunks holding a single value into uniform chunks, and free the buffers of uniform and invalidated chunks.
+	void compact()
+	{
+		for (Chunk& chunk : _chunks) {
+			if (chunk.generation == _generation && chunk.dense) {
+				const T* tiles = chunk.tiles.get();
+				if (std::all_of(tiles + 1, tiles + chunk_size * chunk_size, [&](const T& t) { return t == tiles[0]; })) {
+					chunk.value = tiles[0];
+					chunk.dense = false;
+				}
+			}
+			if (chunk.generation != _generation || !chunk.dense) chunk.tiles.reset();
+		}
+	}
+
+	// Get the default tile, which chunks are filled with after a reset.
+	constexpr const T& defaultTile() const { return _default; }
+
+	// Number of chunks in a row of the chunk directory.
+	constexpr size_t chunksX() const { return _chunks_x; }
+	// Number of chunks in a column of the chunk directory.
+	constexpr size_t chunksY() const { return _chunks_y; }
+
+	// Check if chunk ([cx]; [cy]) is stored as a single value.
+	bool isUniform(size_t cx, size_t cy) const
+	{
+		const Chunk& chunk = _chunks[cx + _chunks_x * cy];
+		return chunk.generation != _generation || !chunk.dense;
+	}
+
+	// Get the number of dense chunks.
+	size_t denseChunks() const
+	{
+		return std::count_if(_chunks.begin(), _chunks.end(), [&](const Chunk& chunk) { return chunk.generation == _generation && chunk.dense; });
+	}
+
+	// Get the number of bytes used by the chunk directory and the allocated chunk buffers.
+	size_t memoryUsage() const
+	{
+		size_t bytes = _chunks.capacity() * sizeof(Chunk);
+		for (const Chunk& chunk : _chunks)
+			if (chunk.tiles) bytes += chunk_size * chunk_size * sizeof(T);
+		return bytes;
+	}
+
+private:
+	struct Chunk
+	{
+		// Buffer of a dense chunk. Uniform and invalidated chunks may keep it for reuse.
+		std::unique_ptr<T[]> tiles = {};
+		// Value of a uniform chunk.
+		T value = {};
+		// Generation of the tilemap the chunk is valid for. Chunks from older generations read as the default tile.
+		uint32_t generation = 0;
+		bool dense = false;
+	};
+
+	void makeDense(Chunk& chunk)
+	{
+		const T& value = (chunk.generation == _generation) ? chunk.value : _default;
+		if (!chunk.tiles) chunk.tiles = std::make_unique<T[]>(chunk_size * chunk_size);
+		std::fill(chunk.tiles.get(), chunk.tiles.get() + chunk_size * chunk_size, value);
+		chunk.generation = _generation;
+		chunk.dense = true;
+	}
+
+	std::vector<Chunk> _chunks = {};
+	size_t _width = 0;
+	size_t _height = 0;
+	size_t _chunks_x = 0;
+	size_t _chunks_y = 0;
+	uint32_t _generation = 1;
+	T _default = {};
+};
+
+// A 2-dimensional tilemap of (1 << [ChunkShift]) x (1 << [ChunkShift]) tile chunks shared copy-on-write between its copies, for cheap snapshots (e.g. undo history or per-tick states).
+// Copying the tilemap (or calling snapshot()) shares all its chunks, in O(number of chunks). Writes through the non-const 'operator()' clone the written chunk if it is shared, so set(), setChunk(), fillArea() and the other algorithms only clone the chunks they modify.
+// Chunks that are not allocated read as the padding tile, like in TileMap2D_Chunked.
+// Note: references returned by the non-const 'operator()' point into chunks that may be shared by later snapshots, so they must not be written to after a copy is made.
+template<typename T, size_t ChunkShift = 6>
+struct TileMap2D_CoW: public StaticTileMap2DImpl<TileMap2D_CoW<T, ChunkShift>, ResizableTileMap2DImpl<T>>
+{
+	// Width and height of a chunk in tiles.
+	static constexpr size_t chunk_size = size_t(1) << ChunkShift;
+	static constexpr size_t chunk_mask = chunk_size - 1;
+	// Writes allocate chunks, so the parallel algorithms write this tilemap sequentially. See allocates_on_write.
+	static constexpr bool allocates_on_write = true;
+
+	TileMap2D_CoW() {}
+
+	TileMap2D_CoW(size_t width, size_t height, const T& padding = {})
+	{
+		reset(width, height, padding);
+	}
+
+	constexpr size_t width() const final { return _width; }
+	constexpr size_t height() const final { return _height; }
+
+	// Get tile directly (does not check for bounds). Allocates the tile's chunk, or clones it if it is shared with another copy.
+	T& operator()(size_t x, size_t y) final
+	{
+		return ownChunk(x >> ChunkShift, y >> ChunkShift)[(x & chunk_mask) | ((y & chunk_mask) << ChunkShift)];
+	}
+
+	// Get const reference to tile directly (does not check for bounds). Tiles of unallocated chunks are the padding tile.
+	const T& operator()(size_t x, size_t y) const final
+	{
+		const T* chunk = _chunks[(x >> ChunkShift) + _chunks_x * (y >> ChunkShift)].get();
+		return chunk ? chunk[(x & chunk_mask) | ((y & chunk_mask) << ChunkShift)] : _padding;
+	}
+
+	// Set tile directly (does not check for bounds). Shared and unallocated chunks are left as they are if the tile already has the value [t].
+	void setUnchecked(size_t x, size_t y, const T& t)
+	{
+		if constexpr (std::equality_comparable<T>) {
+			if (std::as_const(*this)(x, y) == t) return;
+		}
+		(*this)(x, y) = t;
+	}
+
+	// Clear the tilemap to [padding] with a new size. Only the chunk directory is reallocated.
+	void reset(size_t new_width, size_t new_height, const T& padding = {}) final
+	{
+		_width = new_width;
+		_height = new_height;
+		_chunks_x = (new_width + chunk_mask) >> ChunkShift;
+		_chunks_y = (new_height + chunk_mask) >> ChunkShift;
+		_padding = padding;
+		_chunks.clear();
+		_chunks.resize(_chunks_x * _chunks_y);
+	}
+
+	// Clear the tilemap with a new size, keeping the padding tile. No chunk is allocated.
+	void resetUninitialized(size_t new_width, size_t new_height) final
+	{
+		reset(new_width, new_height, _padding);
+	}
+
+	// Get a copy of the tilemap sharing all its chunks. Restoring it is an assignment, which is as cheap.
+	TileMap2D_CoW snapshot() const { return *this; }
+
+	// Get the tile of unallocated chunks.
+	constexpr const T& padding() const { return _padding; }
+
+	// Number of chunks in a row of the chunk directory.
+	constexpr size_t chunksX() const { return _chunks_x; }
+	// Number of chunks in a column of the chunk directory.
+	constexpr size_t chunksY() const { return _chunks_y; }
+
+	// Get the area of the tilemap covered by chunk ([cx]; [cy]).
+	Rect chunkRect(size_t cx, size_t cy) const
+	{
+		return Rect(cx << ChunkShift, cy << ChunkShift, chunk_size, chunk_size).intersection({ 0, 0, _width, _height });
+	}
+
+	// Get the row-major tiles of chunk ([cx]; [cy]), or NULL if it is not allocated.
+	const T* chunk(size_t cx, size_t cy) const { return _chunks[cx + _chunks_x * cy].get(); }
+
+	// Check if chunk ([cx]; [cy]) is shared with another copy of the tilemap.
+	bool isShared(size_t cx, size_t cy) const { return _chunks[cx + _chunks_x * cy].use_count() > 1; }
+
+	// Get a view of all the chunk_size x chunk_size tiles of chunk ([cx]; [cy]), allocating or cloning it if needed.
+	// Tiles outside of chunkRect() must be kept as the padding tile.
+	TileMap2DView<T> chunkView(size_t cx, size_t cy)
+	{
+		return TileMap2DView<T>(ownChunk(cx, cy), chunk_size, chunk_size);
+	}
+
+	// Allocate or clone all chunks intersecting [area], so that its tiles can be written to from multiple threads.
+	void allocateArea(const Rect& area)
+	{
+		const Rect cliprect = area.intersection({ 0, 0, _width, _height });
+		if (!cliprect.width || !cliprect.height) return;
+
+		for (size_t cy = cliprect.y >> ChunkShift; cy <= (cliprect.y + cliprect.height - 1) >> ChunkShift; cy++)
+			for (size_t cx = cliprect.x >> ChunkShift; cx <= (cliprect.x + cliprect.width - 1) >> ChunkShift; cx++)
+				ownChunk(cx, cy);
+	}
+
+	// Get the number of allocated chunks.
+	size_t allocatedChunks() const
+	{
+		return std::count_if(_chunks.begin(), _chunks.end(), [](const std::shared_ptr<T[]>& chunk) { return (bool)chunk; });
+	}
+
+	// Get the number of allocated chunks shared with other copies of the tilemap.
+	size_t sharedChunks() const
+	{
+		return std::count_if(_chunks.begin(), _chunks.end(), [](const std::shared_ptr<T[]>& chunk) { return chunk.use_count() > 1; });
+	}
+
+	// Get the areas of the chunks that differ from [other], a copy of the tilemap of the same size, e.g. to send the changes since a snapshot.
+	// Chunks are compared by buffer, so a cloned chunk counts as changed even if its tiles were written with the same values.
+	std::vector<Rect> changedAreas(const TileMap2D_CoW& other) const
+	{
+		std::vector<Rect> areas;
+		for (size_t cy = 0; cy < _chunks_y; cy++)
+			for (size_t cx = 0; cx < _chunks_x; cx++)
+				if (_chunks[cx + _chunks_x * cy] != other._chunks[cx + _chunks_x * cy]) areas.push_back(chunkRect(cx, cy));
+		return areas;
+	}
+
+private:
+	// Get the tiles of chunk ([cx]; [cy]), allocating it, or cloning it if it is shared.
+	T* ownChunk(size_t cx, size_t cy)
+	{
+		std::shared_ptr<T[]>& chunk = _chunks[cx + _chunks_x * cy];
+		if (!chunk) {
+			chunk = std::make_shared<T[]>(chunk_size * chunk_size, _padding);
+		}
+		else if (chunk.use_count() > 1) {
+			std::shared_ptr<T[]> copy = std::make_shared_for_overwrite<T[]>(chunk_size * chunk_size);
+			std::copy(chunk.get(), chunk.get() + chunk_size * chunk_size, copy.get());
+			chunk = std::move(copy);
+		}
+		return chunk.get();
+	}
+
+	std::vector<std::shared_ptr<T[]>> _chunks = {};
+	size_t _width = 0;
+	size_t _height = 0;
+	size_t _chunks_x = 0;
+	size_t _chunks_y = 0;
+	T _padding = {};
+};
+
+}; // |===|   END namespace tm2D   |===|
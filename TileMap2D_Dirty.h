@@ -0,0 +1,269 @@
+#pragma once
+
+#include "TileMap2D.h"
+
+#include <cstdint>
+
+// Dirty area tracking for 2-dimensional tilemaps, so that renderers and network synchronization only process the modified areas.
+
+namespace tm2D
+{
+
+// Bitmap of the modified cells of (1 << [CellShift]) x (1 << [CellShift]) tiles of a tilemap.
+template<size_t CellShift = 5>
+struct DirtyTracker
+{
+	// Width and height of a cell in tiles.
+	static constexpr size_t cell_size = size_t(1) << CellShift;
+
+	DirtyTracker() {}
+
+	DirtyTracker(size_t width, size_t height)
+	{
+		reset(width, height);
+	}
+
+	// Cover a [width] x [height] tilemap, with no dirty cell.
+	void reset(size_t width, size_t height)
+	{
+		_width = width;
+		_height = height;
+		_cells_x = (width + cell_size - 1) >> CellShift;
+		_cells_y = (height + cell_size - 1) >> CellShift;
+		_cells.assign(_cells_x * _cells_y, 0);
+		_dirty = false;
+	}
+
+	// Mark the tile ([x]; [y]) as modified. It must be within the tilemap.
+	// Only reads the tracker if the cell is already marked, so tiles of an area marked beforehand can be marked from multiple threads.
+	void mark(size_t x, size_t y)
+	{
+		uint8_t& cell = _cells[(x >> CellShift) + _cells_x * (y >> CellShift)];
+		if (cell) return;
+		cell = 1;
+		_dirty = true;
+	}
+
+	// Mark [area] (clipped to the tilemap) as modified.
+	void mark(const Rect& area)
+	{
+		const Rect cliprect = area.intersection({ 0, 0, _width, _height });
+		if (!cliprect.width || !cliprect.height) return;
+
+		const size_t
+			cx_begin = cliprect.x >> CellShift, cx_end = ((cliprect.x + cliprect.width - 1) >> CellShift) + 1,
+			cy_begin = cliprect.y >> CellShift, cy_end = ((cliprect.y + cliprect.height - 1) >> CellShift) + 1;
+		for (size_t cy = cy_begin; cy < cy_end; cy++)
+			std::fill(_cells.begin() + (cx_begin + _cells_x * cy), _cells.begin() + (cx_end + _cells_x * cy), uint8_t(1));
+		_dirty = true;
+	}
+
+	// Mark the whole tilemap as modified.
+	void markAll()
+	{
+		std::fill(_cells.begin(), _cells.end(), uint8_t(1));
+		_dirty = !_cells.empty();
+	}
+
+	// Unmark every cell.
+	void clear()
+	{
+		if (_dirty) std::fill(_cells.begin(), _cells.end(), uint8_t(0));
+		_dirty = false;
+	}
+
+	// Check if any tile was marked since the last clear.
+	bool hasDirty() const { return _dirty; }
+
+	// Get the number of cells on each axis.
+	size_t cellsX() const { return _cells_x; }
+	size_t cellsY() const { return _cells_y; }
+
+	// Check if the cell ([cx]; [cy]) holds a modified tile.
+	bool isDirty(size_t cx, size_t cy) const { return _cells[cx + _cells_x * cy] != 0; }
+
+	// Get the tile area of the cell ([cx]; [cy]), clipped to the tilemap.
+	Rect cellRect(size_t cx, size_t cy) const
+	{
+		return Rect(cx << CellShift, cy << CellShift, cell_size, cell_size).intersection({ 0, 0, _width, _height });
+	}
+
+	// Get the dirty cells as non-overlapping rectangles of tiles (clipped to the tilemap), and unmark them.
+	// Horizontal runs of dirty cells are merged with identical runs in the rows below them.
+	std::vector<Rect> consumeDirty()
+	{
+		std::vector<Rect> rects;
+		if (!_dirty) return rects;
+
+		// Rectangles in cells, and the ones ending on the previous row of cells, ordered by x.
+		std::vector<size_t> open, next_open;
+		for (size_t cy = 0; cy < _cells_y; cy++) {
+			const uint8_t* const row = _cells.data() + _cells_x * cy;
+			size_t o = 0;
+			next_open.clear();
+
+			for (size_t cx = 0; cx < _cells_x;) {
+				if (!row[cx]) { cx++; continue; }
+
+				size_t end = cx + 1;
+				while (end < _cells_x && row[end]) end++;
+
+				while (o < open.size() && rects[open[o]].x < cx) o++;
+				if (o < open.size() && rects[open[o]].x == cx && rects[open[o]].width == end - cx) {
+					rects[open[o]].height++;
+					next_open.push_back(open[o]);
+				}
+				else {
+					next_open.push_back(rects.size());
+					rects.push_back({ cx, cy, end - cx, 1 });
+				}
+				cx = end;
+			}
+			std::swap(open, next_open);
+		}
+
+		for (Rect& rect : rects) {
+			rect = Rect(rect.x << CellShift, rect.y << CellShift, rect.width << CellShift, rect.height << CellShift)
+				.intersection({ 0, 0, _width, _height });
+		}
+		clear();
+		return rects;
+	}
+
+private:
+	size_t _width = 0;
+	size_t _height = 0;
+	size_t _cells_x = 0;
+	size_t _cells_y = 0;
+	std::vector<uint8_t> _cells;
+	bool _dirty = false;
+};
+
+// A tilemap [M] (e.g. a TileMap2D_1D or a TileMap2DView) recording its modified areas in a DirtyTracker.
+// Writes through 'operator()' and set() mark their tile, so every algorithm taking a 'TileMapLike' is tracked. flip(), fillArea(), fillRect(), transform(), replace() and setChunk() members run on [M] directly and mark their whole area at once, keeping the fast paths of contiguous tilemaps.
+// Parallel algorithms call allocateArea() before writing from multiple threads, which marks their area up front so that the concurrent writes only read the tracker. Like [M], it is written sequentially if [M] allocates on write.
+// Note: writes through map() are not tracked, so this does not expose 'data()'. Mark them with markDirty().
+template<TileMapLike M, size_t CellShift = 5>
+struct TileMap2D_Tracked: public StaticTileMap2DImpl<TileMap2D_Tracked<M, CellShift>, TileMap2DImpl<tile_t<M>>>
+{
+	using typename TileMap2DImpl<tile_t<M>>::tile_type;
+
+	static constexpr bool allocates_on_write = tm2D::allocates_on_write<M>;
+
+	TileMap2D_Tracked() {}
+
+	explicit TileMap2D_Tracked(M map)
+		: _map(std::move(map)), _dirty(_map.width(), _map.height()) {}
+
+	constexpr size_t width() const final { return _map.width(); }
+	constexpr size_t height() const final { return _map.height(); }
+
+	tile_type& operator()(size_t x, size_t y) final
+	{
+		_dirty.mark(x, y);
+		return _map(x, y);
+	}
+
+	constexpr const tile_type& operator()(size_t x, size_t y) const final { return std::as_const(_map)(x, y); }
+
+	// Reinitialize the tilemap, marking all of it as modified.
+	void reset(size_t new_width, size_t new_height, const tile_type& padding = {})
+		requires ResizableTileMapLike<M>
+	{
+		_map.reset(new_width, new_height, padding);
+		_dirty.reset(new_width, new_height);
+		_dirty.markAll();
+	}
+
+	// Reinitialize the tilemap for callers that overwrite every tile afterwards, marking all of it as modified.
+	void resetUninitialized(size_t new_width, size_t new_height)
+		requires ResizableTileMapLike<M>
+	{
+		detail::resetForOverwrite(_map, new_width, new_height);
+		_dirty.reset(new_width, new_height);
+		_dirty.markAll();
+	}
+
+	// Mark [area] as modified, and allocate its storage in [M] if it allocates on write. Called by parallel algorithms before writing to [area] concurrently.
+	void allocateArea(const Rect& area)
+	{
+		if constexpr (requires { _map.allocateArea(area); }) _map.allocateArea(area);
+		_dirty.mark(area);
+	}
+
+	void flip(bool horizontal, bool vertical)
+	{
+		tm2D::flip(_map, horizontal, vertical);
+		if (horizontal || vertical) _dirty.markAll();
+	}
+
+	// Fill a polygonal area of elements sastifying [rule] with [elem]. See tm2D::fillArea().
+	template<std::predicate<const tile_type&> Rule>
+	Rect fillArea(
+		const Point& center,
+		Rule&& rule,
+		const tile_type& elem,
+		bool eight_connected = false,
+		std::pmr::memory_resource* scratch = std::pmr::get_default_resource()
+	) {
+		const Rect area = tm2D::fillArea(_map, center, rule, elem, eight_connected, scratch);
+		_dirty.mark(area);
+		return area;
+	}
+
+	void fillRect(const Rect& area, const tile_type& elem)
+	{
+		tm2D::fillRect(_map, area, elem);
+		_dirty.mark(area);
+	}
+
+	template<typename F>
+		requires std::invocable<F&, const tile_type&>
+	void transform(const Rect& area, F&& func)
+	{
+		tm2D::transform(_map, area, func);
+		_dirty.mark(area);
+	}
+
+	// Replace the tiles of [area] equal to [old_elem] with [new_elem], marking the whole area as modified. See tm2D::replace().
+	void replace(const tile_type& old_elem, const tile_type& new_elem, Rect area = {})
+		requires std::equality_comparable<tile_type>
+	{
+		if (area == Rect(0, 0, 0, 0))
+			area = { 0, 0, width(), height() };
+		tm2D::replace(_map, old_elem, new_elem, area);
+		_dirty.mark(area);
+	}
+
+	// Set a chunk of the tilemap from [input]. See tm2D::setChunk().
+	template<TileMapLike In>
+		requires std::same_as<tile_t<In>, tile_type>
+	Rect setChunk(const In* input, size_t x, size_t y, const Rect& src_area = {})
+	{
+		const Rect area = tm2D::setChunk(&_map, input, x, y, src_area);
+		_dirty.mark(area);
+		return area;
+	}
+
+	// Get the underlying tilemap. Writes through it are not tracked.
+	M& map() { return _map; }
+	const M& map() const { return _map; }
+
+	const DirtyTracker<CellShift>& tracker() const { return _dirty; }
+
+	// Mark [area] as modified, e.g. after writing to it through map().
+	void markDirty(const Rect& area) { _dirty.mark(area); }
+
+	bool hasDirty() const { return _dirty.hasDirty(); }
+
+	// Get the areas modified since the last call, as non-overlapping rectangles. See DirtyTracker::consumeDirty().
+	std::vector<Rect> consumeDirty() { return _dirty.consumeDirty(); }
+
+	void clearDirty() { _dirty.clear(); }
+
+private:
+	M _map;
+	DirtyTracker<CellShift> _dirty;
+};
+
+}; // |===|   END namespace tm2D   |===|
@@ -0,0 +1,1288 @@
+#pragma once
+
+#include "TileMap2D.h"
+#include "TileMap2D_MMap.h"
+#include "TileMap2D_Serialize.h"
+
+#include <istream>
+#include <ostream>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+// Image files of 2-dimensional tilemaps, decoded directly into the rows of the output tilemaps, and only up to the rows of the requested areas.
+//
+// Formats:
+//   Raw: a tilemap file of TileMap2D_MMap (a MMapHeader, then the row-major tiles at its 'data_offset'), which can also be mapped instead of read.
+//   QOI: the lossless "Quite OK Image" format (https://qoiformat.org), much faster to encode and decode than PNG. Its pixels are 4-byte tiles holding
+//        R, G, B and A bytes in this order in memory.
+//   PNG: non-interlaced PNG images of any color type and bit depth, decoded to the same RGBA tiles as QOI, and decompressed row by row instead of
+//        all at once. They are written as 8-bit RGBA, compressed for speed rather than size with fixed Huffman codes.
+
+namespace tm2D
+{
+
+enum class ImageFormat
+{
+	Raw,
+	QOI,
+	PNG,
+};
+
+namespace detail
+{
+
+inline constexpr unsigned char
+	qoi_op_index = 0x00,
+	qoi_op_diff = 0x40,
+	qoi_op_luma = 0x80,
+	qoi_op_run = 0xC0,
+	qoi_op_rgb = 0xFE,
+	qoi_op_rgba = 0xFF;
+inline constexpr size_t qoi_header_size = 14;
+inline constexpr unsigned char qoi_end_marker[8] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+
+// Size in bytes of the buffers of encoded data, and of the strips of rows read for tilemaps that are not contiguous.
+inline constexpr size_t image_buffer_size = 64 * 1024;
+
+inline size_t qoiHash(const unsigned char* px) { return (px[0] * 3 + px[1] * 5 + px[2] * 7 + px[3] * 11) % 64; }
+
+inline void storeBigEndian32(unsigned char* out, uint32_t value)
+{
+	for (size_t i = 0; i < 4; i++) out[i] = (unsigned char)(value >> (24 - 8 * i));
+}
+
+inline uint32_t loadBigEndian32(const unsigned char* in)
+{
+	return uint32_t(in[0]) << 24 | uint32_t(in[1]) << 16 | uint32_t(in[2]) << 8 | uint32_t(in[3]);
+}
+
+// Write the tiles of [map] as a raw tilemap file. See ImageFormat::Raw.
+template<TileMapLike M>
+bool writeRawImage(std::ostream& out, const M& map)
+{
+	using T = tile_t<M>;
+
+	MMapHeader header;
+	header.tile_size = sizeof(T);
+	header.width = map.width();
+	header.height = map.height();
+	header.pitch = map.width();
+	header.data_offset = mmap_data_offset;
+	constexpr unsigned char padding[mmap_data_offset - sizeof(MMapHeader)] = {};
+	if (!writeBytes(out, &header) || !writeBytes(out, padding, sizeof(padding))) return false;
+
+	std::vector<T> row;
+	for (size_t y = 0; y < map.height(); y++) {
+		if constexpr (ContiguousTileMap<M>) {
+			if (!writeBytes(out, rowData(map, y), map.width())) return false;
+		}
+		else {
+			row.resize(map.width());
+			for (size_t x = 0; x < row.size(); x++) row[x] = map(x, y);
+			if (!writeBytes(out, row.data(), row.size())) return false;
+		}
+	}
+	return true;
+}
+
+// Encode the tiles of [map] as a QOI image with 4 channels. See ImageFormat::QOI.
+template<TileMapLike M>
+bool writeQOI(std::ostream& out, const M& map)
+{
+	using T = tile_t<M>;
+	const size_t width = map.width(), height = map.height();
+	if (width > UINT32_MAX || height > UINT32_MAX) return false;
+
+	unsigned char header[qoi_header_size] = { 'q', 'o', 'i', 'f' };
+	storeBigEndian32(header + 4, uint32_t(width));
+	storeBigEndian32(header + 8, uint32_t(height));
+	header[12] = 4;
+	// sRGB with linear alpha.
+	header[13] = 0;
+	if (!writeBytes(out, header, sizeof(header))) return false;
+
+	std::vector<unsigned char> encoded;
+	encoded.reserve(image_buffer_size + 8);
+	std::vector<T> row;
+	unsigned char index[64][4] = {};
+	unsigned char previous[4] = { 0, 0, 0, 255 };
+	size_t run = 0;
+
+	for (size_t y = 0; y < height; y++) {
+		const T* tiles;
+		if constexpr (ContiguousTileMap<M>) tiles = rowData(map, y);
+		else {
+			row.resize(width);
+			for (size_t x = 0; x < width; x++) row[x] = map(x, y);
+			tiles = row.data();
+		}
+
+		for (size_t x = 0; x < width; x++) {
+			unsigned char px[4];
+			std::memcpy(px, tiles + x, 4);
+			if (std::memcmp(px, previous, 4) == 0) {
+				if (++run == 62) {
+					encoded.push_back(qoi_op_run | 61);
+					run = 0;
+				}
+				continue;
+			}
+			if (run) {
+				encoded.push_back(qoi_op_run | (unsigned char)(run - 1));
+				run = 0;
+			}
+
+			const size_t hash = qoiHash(px);
+			if (std::memcmp(index[hash], px, 4) == 0) encoded.push_back(qoi_op_index | (unsigned char)hash);
+			else {
+				std::memcpy(index[hash], px, 4);
+				if (px[3] == previous[3]) {
+					// Differences wrapping around, as the decoder adds them.
+					const int
+						dr = (signed char)(px[0] - previous[0]),
+						dg = (signed char)(px[1] - previous[1]),
+						db = (signed char)(px[2] - previous[2]),
+						dr_dg = dr - dg,
+						db_dg = db - dg;
+					if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1)
+						encoded.push_back((unsigned char)(qoi_op_diff | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2)));
+					else if (dg >= -32 && dg <= 31 && dr_dg >= -8 && dr_dg <= 7 && db_dg >= -8 && db_dg <= 7) {
+						encoded.push_back((unsigned char)(qoi_op_luma | (dg + 32)));
+						encoded.push_back((unsigned char)((dr_dg + 8) << 4 | (db_dg + 8)));
+					}
+					else encoded.insert(encoded.end(), { qoi_op_rgb, px[0], px[1], px[2] });
+				}
+				else encoded.insert(encoded.end(), { qoi_op_rgba, px[0], px[1], px[2], px[3] });
+			}
+			std::memcpy(previous, px, 4);
+
+			if (encoded.size() >= image_buffer_size) {
+				if (!writeBytes(out, encoded.data(), encoded.size())) return false;
+				encoded.clear();
+			}
+		}
+	}
+	if (run) encoded.push_back(qoi_op_run | (unsigned char)(run - 1));
+	encoded.insert(encoded.end(), std::begin(qoi_end_marker), std::end(qoi_end_marker));
+	return writeBytes(out, encoded.data(), encoded.size());
+}
+
+inline constexpr unsigned char png_signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+// Update the CRC-32 [crc] of PNG chunks with [size] bytes at [data]. Starts from 0.
+inline uint32_t crc32(uint32_t crc, const unsigned char* data, size_t size)
+{
+	static constexpr auto table = [] {
+		std::array<uint32_t, 256> table = {};
+		for (uint32_t i = 0; i < 256; i++) {
+			uint32_t c = i;
+			for (int k = 0; k < 8; k++) c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+			table[i] = c;
+		}
+		return table;
+	}();
+
+	crc = ~crc;
+	for (size_t i = 0; i < size; i++) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+	return ~crc;
+}
+
+// Update the Adler-32 [adler] of zlib streams with [size] bytes at [data]. Starts from 1.
+inline uint32_t adler32(uint32_t adler, const unsigned char* data, size_t size)
+{
+	uint32_t a = adler & 0xFFFF, b = adler >> 16;
+	while (size) {
+		// The largest number of bytes before 'b' may overflow.
+		const size_t n = std::min<size_t>(size, 5552);
+		for (size_t i = 0; i < n; i++) {
+			a += data[i];
+			b += a;
+		}
+		a %= 65521;
+		b %= 65521;
+		data += n;
+		size -= n;
+	}
+	return b << 16 | a;
+}
+
+// Base lengths and distances of the length and distance codes of Deflate, and their numbers of extra bits.
+inline constexpr uint16_t deflate_length_base[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+inline constexpr uint8_t deflate_length_extra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+inline constexpr uint16_t deflate_distance_base[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+inline constexpr uint8_t deflate_distance_extra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+inline constexpr size_t deflate_window_size = 32768;
+inline constexpr size_t deflate_max_match = 258;
+
+// Compressor of zlib streams, as a single Deflate block of fixed Huffman codes with greedy LZ77 matches searched in hash chains.
+// This is much faster than the best levels of zlib, at the cost of larger files. The compressed bytes are appended to 'out', and may be taken from it at any time.
+struct DeflateEncoder
+{
+	std::vector<unsigned char> out;
+
+	DeflateEncoder()
+		: _head(hash_size, 0), _prev(deflate_window_size, 0)
+	{
+		// A 32K window and the fastest level, then the header of the final block.
+		out = { 0x78, 0x01 };
+		putBits(1 | 1 << 1, 3);
+	}
+
+	// Compress [size] bytes at [data]. The last bytes are kept until more arrive, to find the matches starting in them.
+	void write(const unsigned char* data, size_t size)
+	{
+		_adler = adler32(_adler, data, size);
+		_data.insert(_data.end(), data, data + size);
+		if (_data.size() - _pos > deflate_max_match) compress(_data.size() - deflate_max_match);
+	}
+
+	// Compress the bytes left, and end the stream.
+	void finish()
+	{
+		compress(_data.size());
+		putSymbol(256);
+		if (_bit_count) putBits(0, 8 - _bit_count);
+		for (int i = 0; i < 4; i++) out.push_back((unsigned char)(_adler >> (24 - 8 * i)));
+	}
+
+private:
+	static constexpr size_t hash_bits = 15, hash_size = size_t(1) << hash_bits, max_chain = 16;
+
+	void putBits(uint32_t value, unsigned count)
+	{
+		_bits |= uint64_t(value) << _bit_count;
+		_bit_count += count;
+		for (; _bit_count >= 8; _bit_count -= 8) {
+			out.push_back((unsigned char)_bits);
+			_bits >>= 8;
+		}
+	}
+
+	// Huffman codes are packed from their most significant bit.
+	void putCode(uint32_t code, unsigned length)
+	{
+		uint32_t reversed = 0;
+		for (unsigned i = 0; i < length; i++) reversed |= ((code >> i) & 1) << (length - 1 - i);
+		putBits(reversed, length);
+	}
+
+	// Write the literal or length symbol [symbol] with its fixed Huffman code.
+	void putSymbol(unsigned symbol)
+	{
+		if (symbol < 144) putCode(0x30 + symbol, 8);
+		else if (symbol < 256) putCode(0x190 + symbol - 144, 9);
+		else if (symbol < 280) putCode(symbol - 256, 7);
+		else putCode(0xC0 + symbol - 280, 8);
+	}
+
+	void putMatch(size_t length, size_t distance)
+	{
+		unsigned l = 28;
+		while (deflate_length_base[l] > length) l--;
+		putSymbol(257 + l);
+		putBits(uint32_t(length - deflate_length_base[l]), deflate_length_extra[l]);
+
+		unsigned d = 29;
+		while (deflate_distance_base[d] > distance) d--;
+		putCode(d, 5);
+		putBits(uint32_t(distance - deflate_distance_base[d]), deflate_distance_extra[d]);
+	}
+
+	size_t hash(size_t i) const
+	{
+		const uint32_t v = uint32_t(_data[i]) | uint32_t(_data[i + 1]) << 8 | uint32_t(_data[i + 2]) << 16;
+		return (v * 2654435761u) >> (32 - hash_bits);
+	}
+
+	// Insert the position [i] of '_data' in the hash chains. Positions are stored plus one, so that 0 means none.
+	void insert(size_t i)
+	{
+		if (i + 2 >= _data.size()) return;
+		const size_t h = hash(i);
+		const uint64_t position = _base + i;
+		_prev[position % deflate_window_size] = _head[h];
+		_head[h] = position + 1;
+	}
+
+	// Encode the bytes of '_data' from '_pos' to [end], with matches possibly extending past it.
+	void compress(size_t end)
+	{
+		while (_pos < end) {
+			size_t best_length = 0, best_distance = 0;
+			if (_pos + 2 < _data.size()) {
+				const size_t max_length = std::min<>(deflate_max_match, _data.size() - _pos);
+				const uint64_t position = _base + _pos;
+				uint64_t candidate = _head[hash(_pos)];
+				for (size_t chain = 0; candidate && chain < max_chain; chain++) {
+					const uint64_t match = candidate - 1;
+					if (match >= position || position - match > deflate_window_size) break;
+					const unsigned char* a = _data.data() + (match - _base), * b = _data.data() + _pos;
+					size_t length = 0;
+					while (length < max_length && a[length] == b[length]) length++;
+					if (length > best_length) {
+						best_length = length;
+						best_distance = size_t(position - match);
+						if (length == max_length) break;
+					}
+					const uint64_t previous = _prev[match % deflate_window_size];
+					if (previous >= candidate) break;
+					candidate = previous;
+				}
+			}
+
+			if (best_length >= 3) {
+				putMatch(best_length, best_distance);
+				for (size_t i = 0; i < best_length; i++) insert(_pos + i);
+				_pos += best_length;
+			}
+			else {
+				putSymbol(_data[_pos]);
+				insert(_pos);
+				_pos++;
+			}
+		}
+
+		// Keep the window before the next bytes.
+		if (_pos > 2 * deflate_window_size) {
+			const size_t dropped = _pos - deflate_window_size;
+			_data.erase(_data.begin(), _data.begin() + dropped);
+			_base += dropped;
+			_pos -= dropped;
+		}
+	}
+
+	std::vector<unsigned char> _data;
+	// Position in the stream of '_data[0]', and of the next byte to encode in '_data'.
+	uint64_t _base = 0;
+	size_t _pos = 0;
+	std::vector<uint64_t> _head, _prev;
+	uint64_t _bits = 0;
+	unsigned _bit_count = 0;
+	uint32_t _adler = 1;
+};
+
+inline unsigned char paeth(unsigned char a, unsigned char b, unsigned char c)
+{
+	const int p = a + b - c, pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+	return pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+}
+
+// Write a PNG chunk of [type] holding [size] bytes at [data].
+inline bool writePNGChunk(std::ostream& out, const char* type, const unsigned char* data, size_t size)
+{
+	if (size > 0x7FFFFFFF) return false;
+	unsigned char header[8];
+	storeBigEndian32(header, uint32_t(size));
+	std::memcpy(header + 4, type, 4);
+	unsigned char crc[4];
+	storeBigEndian32(crc, crc32(crc32(0, header + 4, 4), data, size));
+	return writeBytes(out, header, 8) && writeBytes(out, data, size) && writeBytes(out, crc, 4);
+}
+
+// Encode the tiles of [map] as an 8-bit RGBA PNG image. See ImageFormat::PNG.
+// Each row is filtered with the filter giving the smallest sum of absolute differences, and compressed by a DeflateEncoder.
+template<TileMapLike M>
+bool writePNG(std::ostream& out, const M& map)
+{
+	using T = tile_t<M>;
+	const size_t width = map.width(), height = map.height();
+	if (width == 0 || height == 0 || width > 0x7FFFFFFF || height > 0x7FFFFFFF || width > (SIZE_MAX - 1) / 4) return false;
+
+	unsigned char header[13];
+	storeBigEndian32(header, uint32_t(width));
+	storeBigEndian32(header + 4, uint32_t(height));
+	// 8 bits per channel, RGBA, no interlacing.
+	header[8] = 8;
+	header[9] = 6;
+	header[10] = header[11] = header[12] = 0;
+	if (!writeBytes(out, png_signature, sizeof(png_signature)) || !writePNGChunk(out, "IHDR", header, sizeof(header))) return false;
+
+	const size_t row_size = 4 * width;
+	std::vector<unsigned char> previous(row_size, 0), current(row_size), filtered[5];
+	for (std::vector<unsigned char>& row : filtered) row.resize(1 + row_size);
+	std::vector<T> row;
+	DeflateEncoder encoder;
+
+	for (size_t y = 0; y < height; y++) {
+		if constexpr (ContiguousTileMap<M>) std::memcpy(current.data(), rowData(map, y), row_size);
+		else {
+			row.resize(width);
+			for (size_t x = 0; x < width; x++) row[x] = map(x, y);
+			std::memcpy(current.data(), row.data(), row_size);
+		}
+
+		size_t best = 0;
+		uint64_t best_cost = UINT64_MAX;
+		for (size_t f = 0; f < 5; f++) {
+			unsigned char* const dst = filtered[f].data();
+			dst[0] = (unsigned char)f;
+			uint64_t cost = 0;
+			for (size_t i = 0; i < row_size; i++) {
+				const unsigned char a = i >= 4 ? current[i - 4] : 0, b = previous[i], c = i >= 4 ? previous[i - 4] : 0;
+				const unsigned char predicted = f == 0 ? 0 : f == 1 ? a : f == 2 ? b : f == 3 ? (unsigned char)((a + b) / 2) : paeth(a, b, c);
+				dst[1 + i] = (unsigned char)(current[i] - predicted);
+				cost += (uint64_t)std::abs((signed char)dst[1 + i]);
+			}
+			if (cost < best_cost) {
+				best = f;
+				best_cost = cost;
+			}
+		}
+		encoder.write(filtered[best].data(), filtered[best].size());
+		std::swap(previous, current);
+
+		if (encoder.out.size() >= image_buffer_size) {
+			if (!writePNGChunk(out, "IDAT", encoder.out.data(), encoder.out.size())) return false;
+			encoder.out.clear();
+		}
+	}
+	encoder.finish();
+	return writePNGChunk(out, "IDAT", encoder.out.data(), encoder.out.size()) && writePNGChunk(out, "IEND", NULL, 0);
+}
+
+// Reader of the bytes of the consecutive IDAT chunks of a PNG image, starting at the header of the first one, checking the CRC of each chunk.
+struct PNGDataStream
+{
+	// Start reading the chunks at the current position of [in].
+	void open(std::istream& in)
+	{
+		_in = &in;
+		_buffer.resize(image_buffer_size);
+		_begin = _end = 0;
+		_chunk_left = 0;
+		_in_chunk = false;
+	}
+
+	// Get the next byte of the data. Fails at the end of the IDAT chunks, or if they are corrupted.
+	bool next(unsigned char* byte)
+	{
+		if (_begin == _end && !fill()) return false;
+		*byte = _buffer[_begin++];
+		return true;
+	}
+
+private:
+	bool fill()
+	{
+		while (_chunk_left == 0) {
+			unsigned char bytes[8];
+			if (_in_chunk) {
+				if (!readBytes(*_in, bytes, 4) || loadBigEndian32(bytes) != _crc) return false;
+				_in_chunk = false;
+			}
+			if (!readBytes(*_in, bytes, 8) || std::memcmp(bytes + 4, "IDAT", 4) != 0) return false;
+			_chunk_left = loadBigEndian32(bytes);
+			if (_chunk_left > 0x7FFFFFFF) return false;
+			_crc = crc32(0, bytes + 4, 4);
+			_in_chunk = true;
+		}
+
+		const size_t size = std::min<size_t>(_chunk_left, _buffer.size());
+		if (!readBytes(*_in, _buffer.data(), size)) return false;
+		_crc = crc32(_crc, _buffer.data(), size);
+		_chunk_left -= uint32_t(size);
+		_begin = 0;
+		_end = size;
+		return true;
+	}
+
+	std::istream* _in = NULL;
+	std::vector<unsigned char> _buffer;
+	size_t _begin = 0;
+	size_t _end = 0;
+	uint32_t _chunk_left = 0;
+	uint32_t _crc = 0;
+	bool _in_chunk = false;
+};
+
+// Decompressor of zlib streams read from a PNGDataStream, producing the requested numbers of bytes one call after the other.
+// The Adler-32 checksum at the end is not checked, as the data of PNG images is already checked by the CRCs of their chunks.
+struct Inflater
+{
+	void open(PNGDataStream& in)
+	{
+		_in = &in;
+		_bits = 0;
+		_bit_count = 0;
+		_state = State::ZlibHeader;
+		_final = false;
+		_total = 0;
+		_copy_length = _copy_distance = 0;
+		_window.resize(deflate_window_size);
+	}
+
+	// Decompress the next [count] bytes of the stream into [out], or skip them if [out] is NULL.
+	// Fails if the stream is corrupted or ends before them.
+	bool inflate(unsigned char* out, size_t count)
+	{
+		for (size_t i = 0; i < count;) {
+			if (_copy_length) {
+				const size_t n = std::min<>(_copy_length, count - i);
+				for (size_t k = 0; k < n; k++) put(out, i++, _window[(_total - _copy_distance) % deflate_window_size]);
+				_copy_length -= n;
+				continue;
+			}
+
+			switch (_state) {
+			case State::ZlibHeader: {
+				uint32_t cmf, flg;
+				if (!getBits(8, &cmf) || !getBits(8, &flg)) return false;
+				// Deflate with a window of at most 32K, and no preset dictionary.
+				if ((cmf & 0x0F) != 8 || (cmf >> 4) > 7 || (cmf << 8 | flg) % 31 != 0 || (flg & 0x20)) return false;
+				_state = State::BlockHeader;
+				break;
+			}
+			case State::BlockHeader:
+				if (_final || !readBlockHeader()) return false;
+				break;
+			case State::Stored: {
+				if (_stored_left == 0) {
+					_state = State::BlockHeader;
+					break;
+				}
+				uint32_t byte;
+				if (!getBits(8, &byte)) return false;
+				put(out, i++, (unsigned char)byte);
+				_stored_left--;
+				break;
+			}
+			case State::Huffman: {
+				unsigned symbol;
+				if (!decode(_lengths_code, &symbol)) return false;
+				if (symbol < 256) put(out, i++, (unsigned char)symbol);
+				else if (symbol == 256) _state = State::BlockHeader;
+				else {
+					uint32_t extra;
+					if (symbol > 285 || !getBits(deflate_length_extra[symbol - 257], &extra)) return false;
+					_copy_length = deflate_length_base[symbol - 257] + extra;
+					if (!decode(_distances_code, &symbol) || symbol > 29 || !getBits(deflate_distance_extra[symbol], &extra)) return false;
+					_copy_distance = deflate_distance_base[symbol] + extra;
+					if (_copy_distance > _total) return false;
+				}
+				break;
+			}
+			}
+		}
+		return true;
+	}
+
+private:
+	enum class State { ZlibHeader, BlockHeader, Stored, Huffman };
+
+	static constexpr unsigned fast_bits = 10;
+
+	// Canonical Huffman code, decoded from a table for the codes of up to 'fast_bits' bits, and bit by bit for the longer ones.
+	struct Code
+	{
+		uint16_t count[16];
+		uint16_t symbol[288];
+		// Symbol shifted by 4 bits and length of the code starting with each combination of 'fast_bits' bits, or 0.
+		uint16_t fast[1 << fast_bits];
+
+		// Build the code of [count] symbols with the code lengths [lengths]. Fails if it is over-subscribed.
+		bool build(const uint8_t* lengths, size_t count)
+		{
+			std::memset(this->count, 0, sizeof(this->count));
+			for (size_t s = 0; s < count; s++) this->count[lengths[s]]++;
+			this->count[0] = 0;
+
+			int left = 1;
+			uint16_t offsets[16] = {}, next_code[16] = {};
+			for (size_t length = 1; length < 16; length++) {
+				left = 2 * left - this->count[length];
+				if (left < 0) return false;
+				offsets[length] = offsets[length - 1] + (length > 1 ? this->count[length - 1] : 0);
+				next_code[length] = length > 1 ? uint16_t((next_code[length - 1] + this->count[length - 1]) << 1) : 0;
+			}
+
+			std::memset(fast, 0, sizeof(fast));
+			for (size_t s = 0; s < count; s++) {
+				const unsigned length = lengths[s];
+				if (!length) continue;
+				symbol[offsets[length]++] = uint16_t(s);
+				const unsigned code = next_code[length]++;
+				if (length > fast_bits) continue;
+				unsigned reversed = 0;
+				for (unsigned i = 0; i < length; i++) reversed |= ((code >> i) & 1) << (length - 1 - i);
+				for (unsigned k = reversed; k < (1u << fast_bits); k += 1u << length) fast[k] = uint16_t(s << 4 | length);
+			}
+			return true;
+		}
+	};
+
+	void put(unsigned char* out, size_t i, unsigned char byte)
+	{
+		if (out) out[i] = byte;
+		_window[_total++ % deflate_window_size] = byte;
+	}
+
+	// Read more bytes of the stream into the bit buffer, as long as it has room and the stream has bytes.
+	void refill()
+	{
+		unsigned char byte;
+		while (_bit_count <= 56 && _in->next(&byte)) {
+			_bits |= uint64_t(byte) << _bit_count;
+			_bit_count += 8;
+		}
+	}
+
+	bool getBits(unsigned count, uint32_t* value)
+	{
+		if (_bit_count < count) {
+			refill();
+			if (_bit_count < count) return false;
+		}
+		*value = uint32_t(_bits & ((uint64_t(1) << count) - 1));
+		_bits >>= count;
+		_bit_count -= count;
+		return true;
+	}
+
+	bool decode(const Code& code, unsigned* symbol)
+	{
+		if (_bit_count < 15) refill();
+		const uint16_t entry = code.fast[_bits & ((1u << fast_bits) - 1)];
+		if (entry) {
+			const unsigned length = entry & 0x0F;
+			if (length > _bit_count) return false;
+			*symbol = entry >> 4;
+			_bits >>= length;
+			_bit_count -= length;
+			return true;
+		}
+
+		int value = 0, first = 0, index = 0;
+		for (unsigned length = 1; length < 16 && length <= _bit_count; length++) {
+			value |= int((_bits >> (length - 1)) & 1);
+			const int count = code.count[length];
+			if (value - count < first) {
+				*symbol = code.symbol[index + (value - first)];
+				_bits >>= length;
+				_bit_count -= length;
+				return true;
+			}
+			index += count;
+			first = (first + count) << 1;
+			value <<= 1;
+		}
+		return false;
+	}
+
+	bool readBlockHeader()
+	{
+		uint32_t final, type;
+		if (!getBits(1, &final) || !getBits(2, &type)) return false;
+		_final = final;
+
+		if (type == 0) {
+			// The length and its complement start at the next byte.
+			uint32_t length, complement;
+			_bits >>= _bit_count % 8;
+			_bit_count -= _bit_count % 8;
+			if (!getBits(16, &length) || !getBits(16, &complement) || (length ^ complement) != 0xFFFF) return false;
+			_stored_left = length;
+			_state = State::Stored;
+			return true;
+		}
+
+		uint8_t lengths[288 + 32];
+		if (type == 1) {
+			std::memset(lengths, 8, 144);
+			std::memset(lengths + 144, 9, 112);
+			std::memset(lengths + 256, 7, 24);
+			std::memset(lengths + 280, 8, 8);
+			std::memset(lengths + 288, 5, 32);
+			_lengths_code.build(lengths, 288);
+			_distances_code.build(lengths + 288, 32);
+		}
+		else if (type == 2) {
+			static constexpr uint8_t order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+			uint32_t literal_count, distance_count, length_count;
+			if (!getBits(5, &literal_count) || !getBits(5, &distance_count) || !getBits(4, &length_count)) return false;
+			literal_count += 257;
+			distance_count += 1;
+			length_count += 4;
+			if (literal_count > 286 || distance_count > 30) return false;
+
+			uint8_t length_lengths[19] = {};
+			for (size_t i = 0; i < length_count; i++) {
+				uint32_t length;
+				if (!getBits(3, &length)) return false;
+				length_lengths[order[i]] = uint8_t(length);
+			}
+			if (!_lengths_code.build(length_lengths, 19)) return false;
+
+			// The code lengths of both codes form one sequence, in which repeats may cross from one to the other.
+			for (size_t i = 0; i < literal_count + distance_count;) {
+				unsigned symbol;
+				if (!decode(_lengths_code, &symbol)) return false;
+				if (symbol < 16) {
+					lengths[i++] = uint8_t(symbol);
+					continue;
+				}
+				uint32_t repeat;
+				uint8_t length = 0;
+				if (symbol == 16) {
+					if (i == 0 || !getBits(2, &repeat)) return false;
+					length = lengths[i - 1];
+					repeat += 3;
+				}
+				else if (symbol == 17) {
+					if (!getBits(3, &repeat)) return false;
+					repeat += 3;
+				}
+				else {
+					if (!getBits(7, &repeat)) return false;
+					repeat += 11;
+				}
+				if (i + repeat > literal_count + distance_count) return false;
+				std::memset(lengths + i, length, repeat);
+				i += repeat;
+			}
+			// A block needs its end code.
+			if (lengths[256] == 0) return false;
+			if (!_lengths_code.build(lengths, literal_count) || !_distances_code.build(lengths + literal_count, distance_count)) return false;
+		}
+		else return false;
+
+		_state = State::Huffman;
+		return true;
+	}
+
+	PNGDataStream* _in = NULL;
+	uint64_t _bits = 0;
+	unsigned _bit_count = 0;
+	State _state = State::ZlibHeader;
+	bool _final = false;
+	size_t _stored_left = 0;
+	// Number of bytes decompressed, the last of which are kept in '_window' for the matches.
+	uint64_t _total = 0;
+	size_t _copy_length = 0;
+	size_t _copy_distance = 0;
+	std::vector<unsigned char> _window;
+	Code _lengths_code;
+	Code _distances_code;
+};
+
+}; // namespace detail
+
+// Write [map] to [out] as an image of [format]. Only writes sequentially, so [out] does not need to be seekable.
+// Returns false if writing fails, or if the tiles can't be stored in [format]:
+// QOI needs 4-byte tiles and sides of at most 2^32 - 1 tiles, and PNG 4-byte tiles and sides of 1 to 2^31 - 1 tiles.
+template<TileMapLike M>
+	requires std::is_trivially_copyable_v<tile_t<M>>
+bool writeImage(std::ostream& out, const M& map, ImageFormat format)
+{
+	if (format == ImageFormat::Raw) return detail::writeRawImage(out, map);
+	if constexpr (sizeof(tile_t<M>) == 4) return format == ImageFormat::QOI ? detail::writeQOI(out, map) : detail::writePNG(out, map);
+	else return false;
+}
+
+// Reader of images, decoding the requested areas straight into the rows of the output tilemaps, e.g. a TileMap2DView of a strided buffer of the caller.
+// Raw images are read row by row at their offsets, so only the rows of the area are read, and QOI and PNG images are decoded sequentially up to the last row of the area.
+// Tilemaps that are not contiguous are written from strips of rows, so that memory use is bounded by a few buffers of 'detail::image_buffer_size' bytes.
+// The input stream must be seekable, and is read from as long as the reader is used.
+template<typename T>
+	requires std::is_trivially_copyable_v<T>
+struct ImageReader
+{
+	ImageReader() {}
+
+	// Read the header of the image starting at the current position of [in].
+	// Fails if it is neither a raw image of tiles of the size of [T] in the native byte order, nor a QOI or non-interlaced PNG image with 4-byte [T].
+	bool open(std::istream& in)
+	{
+		close();
+
+		// The dimensions are checked against the rest of the stream, so that a corrupted header can't make getChunk() allocate more than the image holds.
+		const std::streamoff base = in.tellg();
+		uint64_t available;
+		if (base < 0 || !detail::remainingBytes(in, &available)) return false;
+
+		char magic[4];
+		if (!detail::readBytes(in, magic, 4) || !in.seekg(base)) return false;
+
+		if (std::memcmp(magic, MMapHeader().magic, sizeof(magic)) == 0) {
+			MMapHeader header;
+			if (!detail::readBytes(in, &header)) return false;
+			if (
+				header.version != MMapHeader::current_version ||
+				header.byte_order != MMapHeader::native_byte_order ||
+				header.tile_size != sizeof(T) ||
+				header.pitch < header.width ||
+				header.data_offset < sizeof(MMapHeader) ||
+				header.pitch > SIZE_MAX || header.height > SIZE_MAX ||
+				(header.height != 0 && header.pitch > (uint64_t(PTRDIFF_MAX) - header.data_offset) / sizeof(T) / header.height) ||
+				header.data_offset > available ||
+				(header.height != 0 && ((header.height - 1) * header.pitch + header.width) * sizeof(T) > available - header.data_offset)
+			) return false;
+
+			_format = ImageFormat::Raw;
+			_width = (size_t)header.width;
+			_height = (size_t)header.height;
+			_pitch = (size_t)header.pitch;
+			_data_offset = (std::streamoff)header.data_offset;
+			_channels = 0;
+		}
+		else if (std::memcmp(magic, "qoif", 4) == 0) {
+			unsigned char header[detail::qoi_header_size];
+			if (sizeof(T) != 4 || !detail::readBytes(in, header, sizeof(header))) return false;
+			const unsigned char channels = header[12], colorspace = header[13];
+			if ((channels != 3 && channels != 4) || colorspace > 1) return false;
+
+			_format = ImageFormat::QOI;
+			_width = detail::loadBigEndian32(header + 4);
+			_height = detail::loadBigEndian32(header + 8);
+			if (_height != 0 && _width > SIZE_MAX / sizeof(T) / _height) return false;
+
+			// Each encoded chunk takes at least a byte and covers at most a run of 62 pixels, and the end marker follows them.
+			const uint64_t pixels = uint64_t(_width) * _height;
+			if ((pixels + 61) / 62 + sizeof(detail::qoi_end_marker) > available - sizeof(header)) return false;
+			_pitch = _width;
+			_data_offset = detail::qoi_header_size;
+			_channels = channels;
+		}
+		else if (std::memcmp(magic, detail::png_signature, 4) == 0) {
+			if (sizeof(T) != 4 || !openPNG(in, available)) return false;
+		}
+		else return false;
+
+		_in = &in;
+		_base = base;
+		return true;
+	}
+
+	// Stop using the input stream.
+	void close()
+	{
+		_in = NULL;
+		_width = _height = _pitch = 0;
+		_channels = 0;
+	}
+
+	bool isOpen() const { return _in != NULL; }
+
+	ImageFormat format() const { return _format; }
+
+	size_t width() const { return _width; }
+	size_t height() const { return _height; }
+
+	// Get the number of channels of a QOI image: 3 (RGB, whose tiles are decoded with an alpha of 255) or 4 (RGBA). 0 for raw images.
+	// PNG images have 1 (gray), 2 (gray and alpha), 3 (RGB or palette) or 4 (RGBA) channels, all decoded as RGBA, with the transparency of their tRNS chunk.
+	size_t channels() const { return _channels; }
+
+	// Decode the chunk of the image with the size of [src_area] into [output], like tm2D::getChunk().
+	// Returns false if the stream can't be read or is corrupted.
+	template<ResizableTileMapLike Out>
+		requires std::same_as<tile_t<Out>, T>
+	bool getChunk(Out* output, const Rect& src_area)
+	{
+		const Rect src_cliprect = src_area.intersection({ 0, 0, width(), height() });
+		if (src_cliprect == src_area) detail::resetForOverwrite(*output, src_area.width, src_area.height);
+		else output->reset(src_area.width, src_area.height, {});
+
+		return decodeArea(*output, 0, 0, src_cliprect);
+	}
+
+	// Decode [src_area] of the image into [output] at ([x]; [y]), like tm2D::setChunk().
+	// Returns false if the stream can't be read or is corrupted.
+	// Parameters:
+	//   [src_area]: Source area to decode. Default value is the whole image.
+	template<TileMapLike Out>
+		requires std::same_as<tile_t<Out>, T>
+	bool setChunk(Out* output, size_t x, size_t y, Rect src_area = {})
+	{
+		if (src_area == Rect(0, 0, 0, 0))
+			src_area = { 0, 0, width(), height() };
+
+		// Clip to the image, then to the part landing in [output].
+		Rect src_cliprect = src_area.intersection({ 0, 0, width(), height() });
+		const Rect dst_cliprect = Rect(x, y, src_cliprect.width, src_cliprect.height).intersection({ 0, 0, output->width(), output->height() });
+		src_cliprect.width = dst_cliprect.width;
+		src_cliprect.height = dst_cliprect.height;
+
+		return decodeArea(*output, dst_cliprect.x, dst_cliprect.y, src_cliprect);
+	}
+
+private:
+	// Decode [src_cliprect], which is within the image, into [output] at ([dst_x]; [dst_y]).
+	template<TileMapLike Out>
+	bool decodeArea(Out& output, size_t dst_x, size_t dst_y, const Rect& src_cliprect)
+	{
+		if (!_in) return false;
+		if (!src_cliprect.width || !src_cliprect.height) return true;
+		if (_format == ImageFormat::PNG) return decodePNG(output, dst_x, dst_y, src_cliprect);
+		return _format == ImageFormat::Raw ? decodeRaw(output, dst_x, dst_y, src_cliprect) : decodeQOI(output, dst_x, dst_y, src_cliprect);
+	}
+
+	// Read the chunks of a PNG image before its first IDAT chunk, with [available] bytes from its start.
+	bool openPNG(std::istream& in, uint64_t available)
+	{
+		unsigned char signature[8];
+		if (!detail::readBytes(in, signature, 8) || std::memcmp(signature, detail::png_signature, 8) != 0) return false;
+
+		bool has_header = false;
+		std::vector<unsigned char> data;
+		std::memset(_palette, 0, sizeof(_palette));
+		for (size_t i = 0; i < 256; i++) _palette[i][3] = 255;
+		_has_palette = false;
+		_has_key = false;
+
+		for (;;) {
+			const std::streamoff offset = in.tellg();
+			unsigned char header[8];
+			if (offset < 0 || !detail::readBytes(in, header, 8)) return false;
+			const uint32_t length = detail::loadBigEndian32(header);
+			const char* const type = (const char*)header + 4;
+			if (length > 0x7FFFFFFF || uint64_t(offset - _base) + 12 + length > available) return false;
+
+			if (std::memcmp(type, "IDAT", 4) == 0) {
+				if (!has_header || (_png_color_type == 3 && !_has_palette)) return false;
+				_data_offset = offset - _base;
+				break;
+			}
+
+			// Ancillary chunks other than tRNS are skipped without being read. Unknown critical chunks can't be.
+			const bool known = std::memcmp(type, "IHDR", 4) == 0 || std::memcmp(type, "PLTE", 4) == 0 || std::memcmp(type, "tRNS", 4) == 0;
+			if (!known) {
+				if (!(type[0] & 0x20) || !in.seekg(std::streamoff(length) + 4, std::ios::cur)) return false;
+				continue;
+			}
+			data.resize(length);
+			unsigned char crc[4];
+			if (!detail::readBytes(in, data.data(), length) || !detail::readBytes(in, crc, 4)) return false;
+			if (detail::crc32(detail::crc32(0, header + 4, 4), data.data(), length) != detail::loadBigEndian32(crc)) return false;
+
+			if (std::memcmp(type, "IHDR", 4) == 0) {
+				if (has_header || length != 13) return false;
+				has_header = true;
+				_width = detail::loadBigEndian32(data.data());
+				_height = detail::loadBigEndian32(data.data() + 4);
+				_png_depth = data[8];
+				_png_color_type = data[9];
+				// Deflate, adaptive filtering, no interlacing.
+				if (data[10] != 0 || data[11] != 0 || data[12] != 0) return false;
+
+				const unsigned char depth = _png_depth;
+				switch (_png_color_type) {
+				case 0: _channels = 1; if (depth != 1 && depth != 2 && depth != 4 && depth != 8 && depth != 16) return false; break;
+				case 3: _channels = 3; if (depth != 1 && depth != 2 && depth != 4 && depth != 8) return false; break;
+				case 2: _channels = 3; if (depth != 8 && depth != 16) return false; break;
+				case 4: _channels = 2; if (depth != 8 && depth != 16) return false; break;
+				case 6: _channels = 4; if (depth != 8 && depth != 16) return false; break;
+				default: return false;
+				}
+				if (_width == 0 || _height == 0 || _width > 0x7FFFFFFF || _height > 0x7FFFFFFF || _width > SIZE_MAX / sizeof(T) / _height) return false;
+
+				// Deflate can't compress more than 1032 times, so the image can't hold more rows than the rest of the stream gives.
+				const size_t samples = _png_color_type == 3 ? 1 : _channels;
+				_row_size = size_t((uint64_t(_width) * samples * depth + 7) / 8);
+				_pixel_size = std::max<size_t>(samples * depth / 8, 1);
+				if (_height > std::min<uint64_t>(available, UINT64_MAX / 1032) * 1032 / (_row_size + 1)) return false;
+				_pitch = _width;
+			}
+			else if (!has_header) return false;
+			else if (std::memcmp(type, "PLTE", 4) == 0) {
+				if (length % 3 != 0 || length > 3 * 256 || _png_color_type == 0 || _png_color_type == 4) return false;
+				for (size_t i = 0; i < length / 3; i++) std::memcpy(_palette[i], data.data() + 3 * i, 3);
+				_has_palette = true;
+			}
+			else if (_png_color_type == 3) {
+				if (length > 256) return false;
+				for (size_t i = 0; i < length; i++) _palette[i][3] = data[i];
+			}
+			else if (_png_color_type == 0 || _png_color_type == 2) {
+				// The samples of the only color that is fully transparent.
+				if (length != (_png_color_type == 0 ? 2u : 6u)) return false;
+				for (size_t i = 0; i < length / 2; i++) _key[i] = uint16_t(data[2 * i] << 8 | data[2 * i + 1]);
+				_has_key = true;
+			}
+			else return false;
+		}
+
+		_format = ImageFormat::PNG;
+		return true;
+	}
+
+	template<TileMapLike Out>
+	bool decodeRaw(Out& output, size_t dst_x, size_t dst_y, const Rect& src_cliprect)
+	{
+		const auto seekRow = [&](size_t y) {
+			return (bool)_in->seekg(_base + _data_offset + std::streamoff((_pitch * y + src_cliprect.x) * sizeof(T)));
+		};
+		// Rows spanning the whole pitch follow each other in the stream.
+		const bool adjacent = src_cliprect.width == _pitch;
+
+		if constexpr (ContiguousTileMap<Out>) {
+			for (size_t i = 0; i < src_cliprect.height; i++) {
+				if ((i == 0 || !adjacent) && !seekRow(src_cliprect.y + i)) return false;
+				if (!detail::readBytes(*_in, detail::rowData(output, dst_y + i) + dst_x, src_cliprect.width)) return false;
+			}
+		}
+		else {
+			const size_t strip_rows = std::max<size_t>(detail::image_buffer_size / (src_cliprect.width * sizeof(T)), 1);
+			_tiles.resize(std::min<>(strip_rows, src_cliprect.height) * src_cliprect.width);
+			for (size_t i = 0; i < src_cliprect.height; i += strip_rows) {
+				const size_t rows = std::min<>(strip_rows, src_cliprect.height - i);
+				for (size_t row = 0; row < rows; row++) {
+					if ((i + row == 0 || !adjacent) && !seekRow(src_cliprect.y + i + row)) return false;
+					if (!detail::readBytes(*_in, _tiles.data() + src_cliprect.width * row, src_cliprect.width)) return false;
+				}
+				detail::copyArea(output, TileMap2DView<T>(_tiles.data(), src_cliprect.width, rows), dst_x, dst_y + i, { 0, 0, src_cliprect.width, rows });
+			}
+		}
+		return true;
+	}
+
+	template<TileMapLike Out>
+	bool decodeQOI(Out& output, size_t dst_x, size_t dst_y, const Rect& src_cliprect)
+	{
+		// The state of the decoder only depends on the previous pixels, so every area is decoded from the first one.
+		if (!_in->seekg(_base + _data_offset)) return false;
+		_encoded.resize(detail::image_buffer_size);
+		_encoded_begin = _encoded_end = 0;
+		std::memset(_index, 0, sizeof(_index));
+		const unsigned char first[4] = { 0, 0, 0, 255 };
+		std::memcpy(_px, first, 4);
+		_run = 0;
+
+		if (!decodePixels(NULL, _width * src_cliprect.y)) return false;
+		for (size_t i = 0; i < src_cliprect.height; i++) {
+			T* tiles;
+			if constexpr (ContiguousTileMap<Out>) tiles = detail::rowData(output, dst_y + i) + dst_x;
+			else {
+				_tiles.resize(src_cliprect.width);
+				tiles = _tiles.data();
+			}
+
+			if (!decodePixels(NULL, src_cliprect.x) || !decodePixels(tiles, src_cliprect.width)) return false;
+			if constexpr (!ContiguousTileMap<Out>)
+				for (size_t x = 0; x < src_cliprect.width; x++) output(dst_x + x, dst_y + i) = _tiles[x];
+			// The end of the last row of the area is not needed.
+			if (i + 1 < src_cliprect.height && !decodePixels(NULL, _width - src_cliprect.x - src_cliprect.width)) return false;
+		}
+		return true;
+	}
+
+	template<TileMapLike Out>
+	bool decodePNG(Out& output, size_t dst_x, size_t dst_y, const Rect& src_cliprect)
+	{
+		// The rows are filtered against the previous ones, so every area is decompressed from the first row.
+		if (!_in->seekg(_base + _data_offset)) return false;
+		_png_data.open(*_in);
+		_inflater.open(_png_data);
+		_previous_row.assign(_row_size + 1, 0);
+		_current_row.resize(_row_size + 1);
+
+		for (size_t y = 0; y < src_cliprect.y + src_cliprect.height; y++) {
+			if (!_inflater.inflate(_current_row.data(), _current_row.size()) || !unfilterRow()) return false;
+			std::swap(_previous_row, _current_row);
+			if (y < src_cliprect.y) continue;
+
+			const size_t i = y - src_cliprect.y;
+			T* tiles;
+			if constexpr (ContiguousTileMap<Out>) tiles = detail::rowData(output, dst_y + i) + dst_x;
+			else {
+				_tiles.resize(src_cliprect.width);
+				tiles = _tiles.data();
+			}
+			convertPNGRow(_previous_row.data() + 1, src_cliprect.x, src_cliprect.width, tiles);
+			if constexpr (!ContiguousTileMap<Out>)
+				for (size_t x = 0; x < src_cliprect.width; x++) output(dst_x + x, dst_y + i) = _tiles[x];
+		}
+		return true;
+	}
+
+	// Undo the filter of the row in '_current_row', whose first byte is its type, against '_previous_row'.
+	bool unfilterRow()
+	{
+		unsigned char* const row = _current_row.data() + 1;
+		const unsigned char* const previous = _previous_row.data() + 1;
+		const size_t size = _row_size, bpp = _pixel_size;
+		switch (_current_row[0]) {
+		case 0:
+			break;
+		case 1:
+			for (size_t i = bpp; i < size; i++) row[i] += row[i - bpp];
+			break;
+		case 2:
+			for (size_t i = 0; i < size; i++) row[i] += previous[i];
+			break;
+		case 3:
+			for (size_t i = 0; i < size; i++) row[i] += (unsigned char)(((i >= bpp ? row[i - bpp] : 0) + previous[i]) / 2);
+			break;
+		case 4:
+			for (size_t i = 0; i < size; i++)
+				row[i] += i >= bpp ? detail::paeth(row[i - bpp], previous[i], previous[i - bpp]) : previous[i];
+			break;
+		default:
+			return false;
+		}
+		return true;
+	}
+
+	// Convert [count] pixels of the unfiltered PNG row [row] from [x] to RGBA tiles in [tiles].
+	// 16-bit samples keep their most significant byte, and gray samples of less than 8 bits are scaled to 8 bits.
+	void convertPNGRow(const unsigned char* row, size_t x, size_t count, T* tiles) const
+	{
+		const unsigned depth = _png_depth;
+		const unsigned max = (1u << (depth < 8 ? depth : 8)) - 1;
+		const auto sample = [&](size_t i) -> unsigned {
+			if (depth == 8) return row[i];
+			if (depth == 16) return unsigned(row[2 * i]) << 8 | row[2 * i + 1];
+			const size_t bit = i * depth;
+			return (row[bit / 8] >> (8 - depth - bit % 8)) & max;
+		};
+		const auto high = [&](unsigned value) {
+			return (unsigned char)(depth == 16 ? value >> 8 : depth < 8 ? value * 255 / max : value);
+		};
+
+		for (size_t i = 0; i < count; i++) {
+			const size_t p = x + i;
+			unsigned char px[4];
+			switch (_png_color_type) {
+			case 0: {
+				const unsigned gray = sample(p);
+				px[0] = px[1] = px[2] = high(gray);
+				px[3] = _has_key && gray == _key[0] ? 0 : 255;
+				break;
+			}
+			case 2: {
+				const unsigned r = sample(3 * p), g = sample(3 * p + 1), b = sample(3 * p + 2);
+				px[0] = high(r);
+				px[1] = high(g);
+				px[2] = high(b);
+				px[3] = _has_key && r == _key[0] && g == _key[1] && b == _key[2] ? 0 : 255;
+				break;
+			}
+			case 3:
+				// Indices past the palette are decoded as opaque black.
+				std::memcpy(px, _palette[sample(p)], 4);
+				break;
+			case 4:
+				px[0] = px[1] = px[2] = high(sample(2 * p));
+				px[3] = high(sample(2 * p + 1));
+				break;
+			default:
+				for (size_t c = 0; c < 4; c++) px[c] = high(sample(4 * p + c));
+				break;
+			}
+			std::memcpy(tiles + i, px, 4);
+		}
+	}
+
+	// Make at least [count] bytes of the QOI data available from '_encoded_begin', reading more of the stream. Fails past its end.
+	bool fill(size_t count)
+	{
+		if (_encoded_end - _encoded_begin >= count) return true;
+		std::memmove(_encoded.data(), _encoded.data() + _encoded_begin, _encoded_end - _encoded_begin);
+		_encoded_end -= _encoded_begin;
+		_encoded_begin = 0;
+		_in->read((char*)_encoded.data() + _encoded_end, std::streamsize(_encoded.size() - _encoded_end));
+		_encoded_end += (size_t)_in->gcount();
+		_in->clear();
+		return _encoded_end >= count;
+	}
+
+	// Decode the next [count] pixels of the QOI data into [tiles], or skip them if [tiles] is NULL.
+	bool decodePixels(T* tiles, size_t count)
+	{
+		unsigned char* const px = _px;
+		for (size_t i = 0; i < count; i++) {
+			if (_run) _run--;
+			else {
+				// The longest operation has 5 bytes, and the end marker follows the last one.
+				if (!fill(5)) return false;
+				const unsigned char* in = _encoded.data() + _encoded_begin;
+				const unsigned char op = *in++;
+
+				if (op == detail::qoi_op_rgb) {
+					std::memcpy(px, in, 3);
+					in += 3;
+				}
+				else if (op == detail::qoi_op_rgba) {
+					std::memcpy(px, in, 4);
+					in += 4;
+				}
+				else {
+					switch (op & 0xC0) {
+					case detail::qoi_op_index:
+						std::memcpy(px, _index[op], 4);
+						break;
+					case detail::qoi_op_diff:
+						px[0] += (unsigned char)(((op >> 4) & 3) - 2);
+						px[1] += (unsigned char)(((op >> 2) & 3) - 2);
+						px[2] += (unsigned char)((op & 3) - 2);
+						break;
+					case detail::qoi_op_luma: {
+						const int dg = (op & 0x3F) - 32, next = *in++;
+						px[0] += (unsigned char)(dg - 8 + (next >> 4));
+						px[1] += (unsigned char)dg;
+						px[2] += (unsigned char)(dg - 8 + (next & 0x0F));
+						break;
+					}
+					default:
+						_run = op & 0x3F;
+						break;
+					}
+				}
+				std::memcpy(_index[detail::qoiHash(px)], px, 4);
+				_encoded_begin = size_t(in - _encoded.data());
+			}
+			if (tiles) std::memcpy(tiles + i, px, 4);
+		}
+		return true;
+	}
+
+	std::istream* _in = NULL;
+	std::streamoff _base = 0;
+	ImageFormat _format = ImageFormat::Raw;
+	size_t _width = 0;
+	size_t _height = 0;
+	size_t _pitch = 0;
+	std::streamoff _data_offset = 0;
+	size_t _channels = 0;
+	// Strip of rows read for tilemaps that are not contiguous.
+	std::vector<T> _tiles;
+
+	// State of the QOI decoder.
+	std::vector<unsigned char> _encoded;
+	size_t _encoded_begin = 0;
+	size_t _encoded_end = 0;
+	unsigned char _index[64][4] = {};
+	unsigned char _px[4] = {};
+	size_t _run = 0;
+
+	// Header of the PNG image, and state of its decoder.
+	unsigned char _png_color_type = 0;
+	unsigned char _png_depth = 0;
+	size_t _row_size = 0;
+	size_t _pixel_size = 0;
+	unsigned char _palette[256][4] = {};
+	bool _has_palette = false;
+	uint16_t _key[3] = {};
+	bool _has_key = false;
+	detail::PNGDataStream _png_data;
+	detail::Inflater _inflater;
+	std::vector<unsigned char> _previous_row;
+	std::vector<unsigned char> _current_row;
+};
+
+// Decode the image at the current position of [in] into [output]. The stream must be seekable.
+// Returns false if the stream can't be read, is corrupted, or holds tiles of another size. See ImageReader.
+// Parameters:
+//   [src_area]: Area of the image to decode. Default value is the whole image.
+template<ResizableTileMapLike Out>
+	requires std::is_trivially_copyable_v<tile_t<Out>>
+bool readImage(std::istream& in, Out* output, Rect src_area = {})
+{
+	ImageReader<tile_t<Out>> reader;
+	if (!reader.open(in)) return false;
+	if (src_area == Rect(0, 0, 0, 0))
+		src_area = { 0, 0, reader.width(), reader.height() };
+	return reader.getChunk(output, src_area);
+}
+
+}; // |===|   END namespace tm2D   |===|
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "TileMap2D.h"
+#include "TileMap2D_Parallel.h"
+
+// Summed-area tables (integral images) of 2-dimensional tilemaps, for constant time sums over rectangles.
+
+namespace tm2D
+{
+
+// Summed-area table of the values of the tiles of a tilemap, as [S], answering sums over any Rect in constant time.
+// Counts are sums of a 'bool' value, e.g. 'SummedAreaTable<uint32_t>(map, [](const Tile& t) { return t.blocked; })', and averages are sums divided by the area.
+// Note: [S] must be wide enough for the sum of the whole tilemap.
+template<typename S>
+	requires std::is_arithmetic_v<S>
+struct SummedAreaTable
+{
+	SummedAreaTable() {}
+
+	// Build the table of [value(tile)] over [map].
+	template<TileMapLike M, typename F>
+		requires std::invocable<F&, const tile_t<M>&>
+	SummedAreaTable(const M& map, F&& value)
+	{
+		build(map, value);
+	}
+
+	// Build the table of [value(tile)] over [map], replacing the current one.
+	template<TileMapLike M, typename F>
+		requires std::invocable<F&, const tile_t<M>&>
+	void build(const M& map, F&& value)
+	{
+		build(execution::seq, map, value);
+	}
+
+	// Build the table of [value(tile)] over [map], following [policy].
+	// Rows are prefix-summed in parallel bands, then accumulated down in parallel column bands. [value] is called concurrently with the parallel policy.
+	template<ExecutionPolicy P, TileMapLike M, typename F>
+		requires std::invocable<F&, const tile_t<M>&>
+	void build(const P& policy, const M& map, F&& value)
+	{
+		_width = map.width();
+		_height = map.height();
+		_pitch = _width + 1;
+		_table.assign(_pitch * (_height + 1), S(0));
+
+		detail::forRowBands(policy, _width * _height, _height, [&](size_t y_begin, size_t y_end) {
+			for (size_t y = y_begin; y < y_end; y++) {
+				S* const row = entry(0, y + 1);
+				S sum = 0;
+				for (size_t x = 0; x < _width; x++) {
+					sum += S(value(map(x, y)));
+					row[x + 1] = sum;
+				}
+			}
+		});
+
+		detail::forRowBands(policy, _width * _height, _pitch, [&](size_t x_begin, size_t x_end) {
+			for (size_t y = 1; y < _height; y++) {
+				const S* const above = entry(0, y);
+				S* const row = entry(0, y + 1);
+				for (size_t x = x_begin; x < x_end; x++) row[x] += above[x];
+			}
+		});
+	}
+
+	// Update the table after the tiles of [area] of [map] (e.g. the area returned by setChunk()) changed.
+	// The rows of [area] are summed again from [map], and the rows below it are shifted by the change of the last one, which costs one addition per entry below and to the right of [area].
+	// [map] must have the size of the table.
+	template<TileMapLike M, typename F>
+		requires std::invocable<F&, const tile_t<M>&>
+	void update(const M& map, const Rect& area, F&& value)
+	{
+		const Rect cliprect = area.intersection({ 0, 0, _width, _height });
+		if (!cliprect.width || !cliprect.height) return;
+
+		const size_t y_end = cliprect.y + cliprect.height;
+		// Change of the last row of [area], carried to every row below it.
+		std::vector<S> delta(entry(cliprect.x + 1, y_end), entry(0, y_end) + _pitch);
+
+		for (size_t y = cliprect.y; y < y_end; y++) {
+			const S* const above = entry(0, y);
+			S* const row = entry(0, y + 1);
+			// Row prefix sums up to [area] are unchanged, i.e. 'row[x] - above[x]' for 'x <= cliprect.x'.
+			S sum = row[cliprect.x] - above[cliprect.x];
+			for (size_t x = cliprect.x; x < _width; x++) {
+				sum += S(value(map(x, y)));
+				row[x + 1] = above[x + 1] + sum;
+			}
+		}
+
+		const S* const last = entry(cliprect.x + 1, y_end);
+		for (size_t i = 0; i < delta.size(); i++) delta[i] = last[i] - delta[i];
+
+		for (size_t y = y_end; y < _height; y++) {
+			S* const row = entry(cliprect.x + 1, y + 1);
+			for (size_t i = 0; i < delta.size(); i++) row[i] += delta[i];
+		}
+	}
+
+	size_t width() const { return _width; }
+	size_t height() const { return _height; }
+
+	// Get the sum of the values of the tiles in [area] (clipped to the tilemap).
+	S sum(const Rect& area) const
+	{
+		const Rect cliprect = area.intersection({ 0, 0, _width, _height });
+		if (!cliprect.width || !cliprect.height) return S(0);
+
+		const size_t x_end = cliprect.x + cliprect.width, y_end = cliprect.y + cliprect.height;
+		return *entry(x_end, y_end) - *entry(cliprect.x, y_end) - *entry(x_end, cliprect.y) + *entry(cliprect.x, cliprect.y);
+	}
+
+	// Get the average of the values of the tiles in [area] (clipped to the tilemap), or 0 if it is empty.
+	double average(const Rect& area) const
+	{
+		const Rect cliprect = area.intersection({ 0, 0, _width, _height });
+		if (!cliprect.width || !cliprect.height) return 0.0;
+		return double(sum(cliprect)) / double(cliprect.width * cliprect.height);
+	}
+
+private:
+	// Get the sum of the tiles in [(0; 0); ([x]; [y])).
+	S* entry(size_t x, size_t y) { return _table.data() + x + _pitch * y; }
+	const S* entry(size_t x, size_t y) const { return _table.data() + x + _pitch * y; }
+
+	std::vector<S> _table;
+	size_t _width = 0;
+	size_t _height = 0;
+	size_t _pitch = 0;
+};
+
+}; // |===|   END namespace tm2D   |===|
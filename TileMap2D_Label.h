@@ -0,0 +1,205 @@
+#pragma once
+
+#include "TileMap2D.h"
+#include "TileMap2D_Parallel.h"
+
+#include <limits>
+#include <memory>
+
+// Connected-component labeling of 2-dimensional tilemaps.
+
+namespace tm2D
+{
+
+// A connected area of tiles, as found by labelComponents().
+struct Component
+{
+	// Number of tiles.
+	size_t area = 0;
+	// Bounding rectangle of the tiles.
+	Rect bounds;
+};
+
+namespace detail
+{
+
+// Label the components of [map] in [labels] (of the size of [map]), which must be able to hold 'height * ((width + 1) / 2)' provisional labels.
+// Row bands are labeled independently with disjoint ranges of provisional labels, joined with a union-find whose roots are the smallest labels, then merged across band boundaries and relabeled.
+template<ExecutionPolicy P, TileMapLike LabelMap, TileMapLike M, typename Rule>
+std::vector<Component> labelComponents(const P& policy, LabelMap& labels, const M& map, Rule& rule, bool eight_connected)
+{
+	using L = tile_t<LabelMap>;
+	const size_t width = map.width(), height = map.height();
+
+	// A row holds at most that many components that don't touch the tile to their left.
+	const size_t row_labels = (width + 1) / 2;
+	// Parent of each provisional label. Only the labels in use are initialized.
+	const std::unique_ptr<L[]> parent(new L[height * row_labels + 1]);
+
+	const auto find = [&](L l) {
+		while (parent[l] != l) l = parent[l] = parent[parent[l]];
+		return l;
+	};
+	const auto unite = [&](L a, L b) {
+		a = find(a);
+		b = find(b);
+		if (a < b) std::swap(a, b);
+		parent[a] = b;
+		return b;
+	};
+
+	struct Stats
+	{
+		size_t area, min_x, min_y, max_x, max_y;
+	};
+	// Row band starting at each row, with the stats of its provisional labels in order.
+	struct Band
+	{
+		size_t end = 0;
+		std::vector<Stats> stats;
+	};
+	std::vector<Band> bands(height);
+
+	detail::forRowBands(policy, width * height, height, [&](size_t y_begin, size_t y_end) {
+		Band& band = bands[y_begin];
+		band.end = y_end;
+		const L first = L(y_begin * row_labels + 1);
+
+		for (size_t y = y_begin; y < y_end; y++) {
+			for (size_t x = 0; x < width; x++) {
+				if (!rule(map(x, y))) {
+					labels(x, y) = 0;
+					continue;
+				}
+
+				L l = 0;
+				const auto join = [&](L neighbor) {
+					if (neighbor) l = l ? unite(l, neighbor) : find(neighbor);
+				};
+				if (x > 0) join(std::as_const(labels)(x - 1, y));
+				if (y > y_begin) {
+					if (eight_connected && x > 0) join(std::as_const(labels)(x - 1, y - 1));
+					join(std::as_const(labels)(x, y - 1));
+					if (eight_connected && x + 1 < width) join(std::as_const(labels)(x + 1, y - 1));
+				}
+
+				if (!l) {
+					l = L(first + band.stats.size());
+					parent[l] = l;
+					band.stats.push_back({ 0, x, y, x, y });
+				}
+				labels(x, y) = l;
+
+				Stats& stats = band.stats[l - first];
+				stats.area++;
+				stats.min_x = std::min<>(stats.min_x, x);
+				stats.max_x = std::max<>(stats.max_x, x);
+				stats.max_y = y;
+			}
+		}
+	});
+
+	// Join the components across the first row of each band and the last row of the band above.
+	for (size_t y = bands.empty() ? 0 : bands[0].end; y < height; y = bands[y].end) {
+		for (size_t x = 0; x < width; x++) {
+			const L l = std::as_const(labels)(x, y);
+			if (!l) continue;
+
+			if (eight_connected && x > 0 && std::as_const(labels)(x - 1, y - 1)) unite(l, std::as_const(labels)(x - 1, y - 1));
+			if (std::as_const(labels)(x, y - 1)) unite(l, std::as_const(labels)(x, y - 1));
+			if (eight_connected && x + 1 < width && std::as_const(labels)(x + 1, y - 1)) unite(l, std::as_const(labels)(x + 1, y - 1));
+		}
+	}
+
+	// Number the components in the order of their first tile, which is the order of their smallest provisional label.
+	// Every label's parent is smaller than it, so it is already replaced by its final label when the label is reached.
+	std::vector<Component> components;
+	for (size_t y = 0; y < height; y = bands[y].end) {
+		const L first = L(y * row_labels + 1);
+		for (size_t i = 0; i < bands[y].stats.size(); i++) {
+			const L l = L(first + i);
+			if (parent[l] == l) {
+				components.emplace_back();
+				parent[l] = L(components.size());
+			}
+			else parent[l] = parent[parent[l]];
+
+			const Stats& stats = bands[y].stats[i];
+			Component& component = components[parent[l] - 1];
+			if (component.area == 0) {
+				component.bounds = { stats.min_x, stats.min_y, stats.max_x + 1 - stats.min_x, stats.max_y + 1 - stats.min_y };
+			}
+			else {
+				const size_t
+					min_x = std::min<>(component.bounds.x, stats.min_x),
+					min_y = std::min<>(component.bounds.y, stats.min_y),
+					max_x = std::max<>(component.bounds.x + component.bounds.width, stats.max_x + 1),
+					max_y = std::max<>(component.bounds.y + component.bounds.height, stats.max_y + 1);
+				component.bounds = { min_x, min_y, max_x - min_x, max_y - min_y };
+			}
+			component.area += stats.area;
+		}
+	}
+
+	detail::forRowBands(policy, width * height, height, [&](size_t y_begin, size_t y_end) {
+		for (size_t y = y_begin; y < y_end; y++) {
+			for (size_t x = 0; x < width; x++) {
+				L& l = labels(x, y);
+				if (l) l = parent[l];
+			}
+		}
+	});
+
+	return components;
+}
+
+}; // namespace detail
+
+// Label the connected areas of tiles satisfying [rule] of [map], like the areas filled by fillArea(), following [policy].
+// [labels] is reset to the size of [map], with 0 for the tiles not satisfying [rule] and the components numbered from 1 in the order of their first tile in row-major order.
+// Returns the components, the component labeled 'n' being at index 'n - 1'. [rule] is called concurrently for different rows with the parallel policy.
+// Note: the tile type of [labels] must be able to hold the number of components. If it can't hold 'height * ((width + 1) / 2)', a temporary label buffer is used.
+// Params:
+//   [eight_connected] If true, diagonally adjacent tiles are also part of the same component.
+template<ExecutionPolicy P, ResizableTileMapLike LabelMap, TileMapLike M, std::predicate<const tile_t<M>&> Rule>
+	requires std::unsigned_integral<tile_t<LabelMap>>
+std::vector<Component> labelComponents(
+	const P& policy,
+	LabelMap* labels,
+	const M& map,
+	Rule&& rule,
+	bool eight_connected = false
+) {
+	using L = tile_t<LabelMap>;
+	const size_t width = map.width(), height = map.height();
+	detail::resetForOverwrite(*labels, width, height);
+	const auto write_policy = detail::prepareConcurrentWrite(policy, *labels, { 0, 0, width, height });
+
+	if (height * ((width + 1) / 2) <= std::numeric_limits<L>::max())
+		return detail::labelComponents(write_policy, *labels, map, rule, eight_connected);
+
+	TileMap2D_1D<size_t> provisional;
+	detail::resetForOverwrite(provisional, width, height);
+	std::vector<Component> components = detail::labelComponents(policy, provisional, map, rule, eight_connected);
+
+	detail::forRowBands(write_policy, width * height, height, [&](size_t y_begin, size_t y_end) {
+		for (size_t y = y_begin; y < y_end; y++)
+			for (size_t x = 0; x < width; x++)
+				(*labels)(x, y) = L(provisional(x, y));
+	});
+	return components;
+}
+
+// Label the connected areas of tiles satisfying [rule] of [map]. See labelComponents() with an execution policy.
+template<ResizableTileMapLike LabelMap, TileMapLike M, std::predicate<const tile_t<M>&> Rule>
+	requires std::unsigned_integral<tile_t<LabelMap>>
+std::vector<Component> labelComponents(
+	LabelMap* labels,
+	const M& map,
+	Rule&& rule,
+	bool eight_connected = false
+) {
+	return labelComponents(execution::seq, labels, map, rule, eight_connected);
+}
+
+}; // |===|   END namespace tm2D   |===|
@@ -0,0 +1,207 @@
+#pragma once
+
+#include "TileMap2D.h"
+
+#include <tuple>
+#include <utility>
+
+// Multi-layer 2-dimensional tilemaps stored as structures of arrays, one contiguous plane per layer.
+
+namespace tm2D
+{
+
+namespace detail
+{
+
+// Call [func(std::integral_constant<size_t, I>{})] for I in [0; N), in order.
+template<size_t N, typename F>
+void forEachIndex(F&& func)
+{
+	[&]<size_t... I>(std::index_sequence<I...>) {
+		(func(std::integral_constant<size_t, I>{}), ...);
+	}(std::make_index_sequence<N>{});
+}
+
+}; // namespace detail
+
+// A 2-dimensional tilemap of layers of tiles of the types [Layers] sharing one size, each layer stored as its own contiguous row-major plane.
+// Passes over one layer (e.g. lighting over a light layer) only load that layer into cache, where a TileMap2D_1D of a struct would load all its fields.
+// layer<I>() gets a TileMap2DView of layer I (its read-only plane on a const tilemap), which works with every algorithm, e.g. 'fillArea(map.layer<Light>(), ...)' with 'enum Layer { Terrain, Height, Light }' naming the layers.
+template<typename... Layers>
+	requires (sizeof...(Layers) > 0)
+struct TileMap2D_Layers
+{
+	static constexpr size_t layer_count = sizeof...(Layers);
+
+	// Tile type of layer [I].
+	template<size_t I>
+	using layer_type = std::tuple_element_t<I, std::tuple<Layers...>>;
+
+	// Tiles of all layers at a position.
+	using tile_type = std::tuple<Layers...>;
+
+	TileMap2D_Layers() {}
+
+	TileMap2D_Layers(size_t width, size_t height)
+	{
+		reset(width, height);
+	}
+
+	TileMap2D_Layers(size_t width, size_t height, const Layers&... padding)
+	{
+		reset(width, height, padding...);
+	}
+
+	constexpr size_t width() const { return _width; }
+	constexpr size_t height() const { return _height; }
+
+	// Get references to the tiles of all layers at ([x]; [y]) directly (does not check for bounds), e.g. 'auto [terrain, height, light] = map(x, y);'.
+	// Note: this does not return a reference to a single tile, so the layer maps are not 'TileMapLike'. Run algorithms on layer<I>().
+	std::tuple<Layers&...> operator()(size_t x, size_t y)
+	{
+		return std::apply([&](auto&... planes) { return std::tuple<Layers&...>(planes(x, y)...); }, _planes);
+	}
+
+	std::tuple<const Layers&...> operator()(size_t x, size_t y) const
+	{
+		return std::apply([&](const auto&... planes) { return std::tuple<const Layers&...>(planes(x, y)...); }, _planes);
+	}
+
+	// Get the tiles of all layers at ([x]; [y]), or default tiles if it is out of bounds.
+	tile_type get(size_t x, size_t y) const
+	{
+		if (x >= _width || y >= _height) return {};
+		return std::apply([&](const auto&... planes) { return tile_type(planes(x, y)...); }, _planes);
+	}
+
+	// Set the tiles of all layers at ([x]; [y]), if it is within bounds.
+	void set(size_t x, size_t y, const Layers&... tiles)
+	{
+		if (x >= _width || y >= _height) return;
+		std::apply([&](auto&... planes) { ((planes(x, y) = tiles), ...); }, _planes);
+	}
+
+	// Reinitialize the tilemap with default tiles in every layer.
+	void reset(size_t new_width, size_t new_height)
+	{
+		reset(new_width, new_height, Layers{}...);
+	}
+
+	// Reinitialize the tilemap with the tile [padding] of each layer.
+	void reset(size_t new_width, size_t new_height, const Layers&... padding)
+	{
+		_width = new_width;
+		_height = new_height;
+		std::apply([&](auto&... planes) { (planes.reset(new_width, new_height, padding), ...); }, _planes);
+	}
+
+	// Reinitialize the tilemap for callers that overwrite every tile afterwards. See TileMap2D_1D::resetUninitialized().
+	void resetUninitialized(size_t new_width, size_t new_height)
+	{
+		_width = new_width;
+		_height = new_height;
+		std::apply([&](auto&... planes) { (planes.resetUninitialized(new_width, new_height), ...); }, _planes);
+	}
+
+	// Get a view of layer [I], sharing its plane. It is invalidated by reset() and rot90().
+	template<size_t I>
+	TileMap2DView<layer_type<I>> layer()
+	{
+		return TileMap2DView<layer_type<I>>(std::get<I>(_planes).data(), _width, _height);
+	}
+
+	// Get the plane of layer [I], read-only. It is invalidated by reset() and rot90().
+	template<size_t I>
+	const TileMap2D_1D<layer_type<I>>& layer() const
+	{
+		return std::get<I>(_planes);
+	}
+
+	// Call [func(layer)] with every layer, in order: a view with the non-const tilemap, and a read-only plane with the const one. See layer().
+	template<typename F>
+	void forEachLayer(F&& func)
+	{
+		detail::forEachIndex<layer_count>([&](auto i) { func(layer<decltype(i)::value>()); });
+	}
+
+	template<typename F>
+	void forEachLayer(F&& func) const
+	{
+		detail::forEachIndex<layer_count>([&](auto i) { func(layer<decltype(i)::value>()); });
+	}
+
+	// Flip every layer. See tm2D::flip().
+	void flip(bool horizontal, bool vertical)
+	{
+		std::apply([&](auto&... planes) { (tm2D::flip(planes, horizontal, vertical), ...); }, _planes);
+	}
+
+	// Rotate every layer 90 degrees in place. See tm2D::rot90().
+	void rot90(bool rotate_left)
+	{
+		std::apply([&](auto&... planes) { (tm2D::rot90(&planes, rotate_left), ...); }, _planes);
+		std::swap(_width, _height);
+	}
+
+private:
+	std::tuple<TileMap2D_1D<Layers>...> _planes;
+	size_t _width = 0;
+	size_t _height = 0;
+};
+
+// Flip every layer of the tilemap. See flip().
+template<typename... Layers>
+void flip(TileMap2D_Layers<Layers...>& map, bool horizontal, bool vertical)
+{
+	map.flip(horizontal, vertical);
+}
+
+// Rotate every layer of the tilemap 90 degrees in place. See rot90().
+template<typename... Layers>
+bool rot90(TileMap2D_Layers<Layers...>* map, bool rotate_left)
+{
+	map->rot90(rotate_left);
+	return true;
+}
+
+// Set a chunk of every layer of a multi-layer tilemap from another one, one plane at a time. See setChunk().
+// Returns the area of [output] written to.
+template<typename... Layers>
+Rect setChunk(
+	TileMap2D_Layers<Layers...>* output,
+	const TileMap2D_Layers<Layers...>* input,
+	size_t x,
+	size_t y,
+	const Rect& src_area = {}
+) {
+	Rect area;
+	detail::forEachIndex<sizeof...(Layers)>([&](auto i) {
+		auto output_layer = output->template layer<decltype(i)::value>();
+		const auto& input_layer = input->template layer<decltype(i)::value>();
+		area = setChunk(&output_layer, &input_layer, x, y, src_area);
+	});
+	return area;
+}
+
+// Get a chunk of every layer of a multi-layer tilemap with the size of [src_area], one plane at a time. See getChunk().
+template<typename... Layers>
+void getChunk(
+	TileMap2D_Layers<Layers...>* output,
+	const TileMap2D_Layers<Layers...>* input,
+	const Rect& src_area
+) {
+	if (output == input) {
+		TileMap2D_Layers<Layers...> chunk;
+		getChunk(&chunk, input, src_area);
+		*output = std::move(chunk);
+		return;
+	}
+
+	const Rect src_cliprect = src_area.intersection({ 0, 0, input->width(), input->height() });
+	// Only the tiles outside of [input] need padding.
+	if (src_cliprect == src_area) output->resetUninitialized(src_area.width, src_area.height);
+	else output->reset(src_area.width, src_area.height);
+	if (src_cliprect.width && src_cliprect.height) setChunk(output, input, 0, 0, src_cliprect);
+}
+
+}; // |===|   END namespace tm2D   |===|
@@ -0,0 +1,367 @@
+#pragma once
+
+#include "TileMap2D.h"
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Memory-mapped file backed 2-dimensional tilemaps, for maps larger than the memory.
+
+namespace tm2D
+{
+
+// Header at the start of a tilemap file, followed by the row-major tiles at [data_offset].
+// Fields are stored in the native byte order, which [byte_order] is checked against.
+struct MMapHeader
+{
+	static constexpr uint32_t current_version = 1;
+	static constexpr uint32_t native_byte_order = 0x01020304;
+
+	char magic[4] = { 'T', 'M', '2', 'D' };
+	uint32_t version = current_version;
+	uint32_t byte_order = native_byte_order;
+	// Size in bytes of a tile.
+	uint32_t tile_size = 0;
+	uint64_t width = 0;
+	uint64_t height = 0;
+	// Distance in tiles between the starts of 2 consecutive rows.
+	uint64_t pitch = 0;
+	// Offset in bytes of the first tile from the start of the file.
+	uint64_t data_offset = 0;
+};
+static_assert(sizeof(MMapHeader) == 48);
+
+// How a tilemap file is mapped.
+enum class MMapMode
+{
+	// Writing to the tiles is undefined behavior.
+	ReadOnly,
+	// Writes go to the file.
+	ReadWrite,
+	// Writes stay private to the mapping and never reach the file.
+	CopyOnWrite,
+};
+
+namespace detail
+{
+
+// A whole file mapped in memory.
+struct MappedFile
+{
+	MappedFile() {}
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	MappedFile(MappedFile&& other) noexcept { swap(other); }
+	MappedFile& operator=(MappedFile&& other) noexcept
+	{
+		if (this != &other) {
+			close();
+			swap(other);
+		}
+		return *this;
+	}
+
+	~MappedFile() { close(); }
+
+	// Open and map the file at [path].
+	// Params:
+	//   [create_size] If not 0, the file is created (or truncated) with this size in bytes, zero-filled. [mode] must be MMapMode::ReadWrite.
+	bool open(const char* path, MMapMode mode, uint64_t create_size = 0)
+	{
+		close();
+		const bool create = create_size != 0;
+		if (create && mode != MMapMode::ReadWrite) return false;
+
+#if defined(_WIN32)
+		_file = CreateFileA(path,
+			GENERIC_READ | (mode == MMapMode::ReadWrite ? GENERIC_WRITE : 0),
+			FILE_SHARE_READ, NULL,
+			create ? CREATE_ALWAYS : OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL, NULL
+		);
+		if (_file == INVALID_HANDLE_VALUE) return false;
+
+		uint64_t file_size = create_size;
+		if (!create) {
+			LARGE_INTEGER size;
+			if (!GetFileSizeEx(_file, &size)) return fail();
+			file_size = (uint64_t)size.QuadPart;
+		}
+		if (file_size == 0 || file_size > SIZE_MAX) return fail();
+
+		// Creating a writable mapping larger than the file extends the file.
+		const DWORD protect = mode == MMapMode::ReadOnly ? PAGE_READONLY : mode == MMapMode::ReadWrite ? PAGE_READWRITE : PAGE_WRITECOPY;
+		HANDLE mapping = CreateFileMappingA(_file, NULL, protect, DWORD(file_size >> 32), DWORD(file_size), NULL);
+		if (!mapping) return fail();
+
+		const DWORD access = mode == MMapMode::ReadOnly ? FILE_MAP_READ : mode == MMapMode::ReadWrite ? FILE_MAP_WRITE : FILE_MAP_COPY;
+		_data = MapViewOfFile(mapping, access, 0, 0, 0);
+		// The view keeps the mapping alive.
+		CloseHandle(mapping);
+		if (!_data) return fail();
+#else
+		const int fd = ::open(path, mode == MMapMode::ReadWrite ? O_RDWR | (create ? O_CREAT | O_TRUNC : 0) : O_RDONLY, 0644);
+		if (fd < 0) return false;
+
+		uint64_t file_size = create_size;
+		struct stat st;
+		if (create) {
+			if (ftruncate(fd, (off_t)create_size) != 0) { ::close(fd); return false; }
+		}
+		else {
+			if (fstat(fd, &st) != 0) { ::close(fd); return false; }
+			file_size = (uint64_t)st.st_size;
+		}
+		if (file_size == 0 || file_size > SIZE_MAX) { ::close(fd); return false; }
+
+		void* data = mmap(NULL, (size_t)file_size,
+			PROT_READ | (mode == MMapMode::ReadOnly ? 0 : PROT_WRITE),
+			mode == MMapMode::CopyOnWrite ? MAP_PRIVATE : MAP_SHARED,
+			fd, 0
+		);
+		// The mapping keeps the file alive.
+		::close(fd);
+		if (data == MAP_FAILED) return false;
+		_data = data;
+#endif
+
+		_size = (size_t)file_size;
+		_mode = mode;
+		return true;
+	}
+
+	// Write the modified pages overlapping the [length] bytes at [offset] to the file, and wait for it.
+	// Does nothing unless the file is mapped with MMapMode::ReadWrite.
+	bool flush(size_t offset, size_t length)
+	{
+		if (!_data || _mode != MMapMode::ReadWrite || length == 0) return true;
+
+#if defined(_WIN32)
+		return FlushViewOfFile((char*)_data + offset, length) && FlushFileBuffers(_file);
+#else
+		// msync() needs a page-aligned address.
+		const size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+		const size_t begin = offset / page_size * page_size;
+		return msync((char*)_data + begin, offset + length - begin, MS_SYNC) == 0;
+#endif
+	}
+
+	// Unmap the file. Modified pages are written back by the system.
+	void close()
+	{
+#if defined(_WIN32)
+		if (_data) UnmapViewOfFile(_data);
+		if (_file != INVALID_HANDLE_VALUE) CloseHandle(_file);
+		_file = INVALID_HANDLE_VALUE;
+#else
+		if (_data) munmap(_data, _size);
+#endif
+		_data = NULL;
+		_size = 0;
+	}
+
+	void* data() const { return _data; }
+	size_t size() const { return _size; }
+	MMapMode mode() const { return _mode; }
+
+private:
+	void swap(MappedFile& other) noexcept
+	{
+		std::swap(_data, other._data);
+		std::swap(_size, other._size);
+		std::swap(_mode, other._mode);
+#if defined(_WIN32)
+		std::swap(_file, other._file);
+#endif
+	}
+
+#if defined(_WIN32)
+	bool fail()
+	{
+		close();
+		return false;
+	}
+
+	HANDLE _file = INVALID_HANDLE_VALUE;
+#endif
+	void* _data = NULL;
+	size_t _size = 0;
+	MMapMode _mode = MMapMode::ReadOnly;
+};
+
+// Alignment in bytes of the tiles in a tilemap file.
+inline constexpr size_t mmap_data_alignment = 64;
+// Offset in bytes of the tiles in the tilemap files written here: right after the header, aligned.
+inline constexpr size_t mmap_data_offset = (sizeof(MMapHeader) + mmap_data_alignment - 1) / mmap_data_alignment * mmap_data_alignment;
+
+}; // namespace detail
+
+// A 2-dimensional tilemap stored in a memory-mapped file, starting with a MMapHeader.
+// Opening a file is instant whatever its size, and tiles are paged in on demand. With MMapMode::ReadWrite, edits go to the file without a serialization pass: the system writes them back eventually, and flush() forces it.
+// Note: the tiles are stored as raw bytes, so [T] must be trivially copyable and the file is only portable between builds with the same layout of [T].
+template<typename T>
+	requires std::is_trivially_copyable_v<T>
+struct TileMap2D_MMap: public StaticTileMap2DImpl<TileMap2D_MMap<T>, TileMap2DImpl<T>>
+{
+	TileMap2D_MMap() {}
+
+	TileMap2D_MMap(TileMap2D_MMap&& other) noexcept
+		: _file(std::move(other._file)), _header(other._header), _view(std::exchange(other._view, {})) {}
+
+	TileMap2D_MMap& operator=(TileMap2D_MMap&& other) noexcept
+	{
+		if (this == &other) return *this;
+
+		_file = std::move(other._file);
+		_header = other._header;
+		_view = std::exchange(other._view, {});
+		return *this;
+	}
+
+	// Create (or overwrite) the tilemap file at [path] with [width] x [height] tiles of [elem], and map it with MMapMode::ReadWrite.
+	// Params:
+	//   [pitch] Distance in tiles between the starts of 2 consecutive rows. If lower than [width], [width] is used.
+	bool create(const char* path, size_t width, size_t height, const T& elem = {}, size_t pitch = 0)
+	{
+		close();
+
+		MMapHeader header;
+		header.tile_size = sizeof(T);
+		header.width = width;
+		header.height = height;
+		header.pitch = std::max<>(pitch, width);
+		header.data_offset = detail::mmap_data_offset;
+
+		uint64_t file_size;
+		if (!dataEnd(header, file_size) || !_file.open(path, MMapMode::ReadWrite, file_size)) return false;
+		std::memcpy(_file.data(), &header, sizeof(MMapHeader));
+		map(header);
+
+		// The file is zero-filled when created.
+		static constexpr unsigned char zero[sizeof(T)] = {};
+		if (std::memcmp(&elem, zero, sizeof(T)) != 0)
+			std::fill(_view.data(), _view.data() + _view.pitch() * height, elem);
+		return true;
+	}
+
+	// Open and map the existing tilemap file at [path].
+	// Fails if the file is not a tilemap file of tiles of the size of [T] in the native byte order, or if it is truncated.
+	bool open(const char* path, MMapMode mode = MMapMode::ReadWrite)
+	{
+		close();
+		if (!_file.open(path, mode)) return false;
+
+		MMapHeader header;
+		uint64_t file_size;
+		if (_file.size() < sizeof(MMapHeader)) return fail();
+		std::memcpy(&header, _file.data(), sizeof(MMapHeader));
+
+		if (
+			std::memcmp(header.magic, MMapHeader().magic, sizeof(header.magic)) != 0 ||
+			header.version != MMapHeader::current_version ||
+			header.byte_order != MMapHeader::native_byte_order ||
+			header.tile_size != sizeof(T) ||
+			header.pitch < header.width ||
+			header.data_offset < sizeof(MMapHeader) ||
+			header.data_offset % alignof(T) != 0 ||
+			!dataEnd(header, file_size) || file_size > _file.size()
+		) return fail();
+
+		map(header);
+		return true;
+	}
+
+	// Write the modified tiles to the file, and wait for it. Does nothing unless the file is mapped with MMapMode::ReadWrite.
+	bool flush() { return _file.flush(0, _file.size()); }
+
+	// Write the modified rows overlapping [area] to the file, and wait for it. See flush().
+	bool flush(const Rect& area)
+	{
+		const Rect cliprect = area.intersection({ 0, 0, width(), height() });
+		if (cliprect.width == 0 || cliprect.height == 0) return true;
+
+		const size_t row_bytes = _view.pitch() * sizeof(T);
+		return _file.flush(
+			(size_t)_header.data_offset + row_bytes * cliprect.y + cliprect.x * sizeof(T),
+			row_bytes * (cliprect.height - 1) + cliprect.width * sizeof(T)
+		);
+	}
+
+	// Unmap the file, leaving an empty tilemap. Modified tiles are written back by the system.
+	void close()
+	{
+		_file.close();
+		_header = {};
+		_view = {};
+	}
+
+	bool isOpen() const { return _file.data() != NULL; }
+
+	MMapMode mode() const { return _file.mode(); }
+
+	const MMapHeader& header() const { return _header; }
+
+	constexpr size_t width() const final { return _view.width(); }
+	constexpr size_t height() const final { return _view.height(); }
+
+	constexpr T& operator()(size_t x, size_t y) final { return _view(x, y); }
+
+	constexpr const T& operator()(size_t x, size_t y) const final { return _view(x, y); }
+
+	constexpr T* data() const { return _view.data(); }
+
+	// Get the distance in tiles between the starts of 2 consecutive rows.
+	constexpr size_t pitch() const { return _view.pitch(); }
+
+	// Get a view of the whole tilemap, sharing its mapping.
+	constexpr TileMap2DView<T> view() const { return _view; }
+
+	// Get a view of [area] of the tilemap (clipped to its bounds), sharing its mapping.
+	TileMap2DView<T> subview(const Rect& area) const { return _view.subview(area); }
+
+private:
+	// Get the offset in bytes of the end of the tiles of [header] in [end]. Fails on overflow.
+	static bool dataEnd(const MMapHeader& header, uint64_t& end)
+	{
+		if (header.pitch > SIZE_MAX || header.height > SIZE_MAX || header.data_offset > SIZE_MAX) return false;
+		const uint64_t max_tiles = (SIZE_MAX - header.data_offset) / sizeof(T);
+		if (header.height != 0 && header.pitch > max_tiles / header.height) return false;
+		end = header.data_offset + header.pitch * header.height * sizeof(T);
+		return true;
+	}
+
+	void map(const MMapHeader& header)
+	{
+		_header = header;
+		_view = TileMap2DView<T>((char*)_file.data() + header.data_offset, (size_t)header.width, (size_t)header.height, (size_t)header.pitch);
+	}
+
+	bool fail()
+	{
+		close();
+		return false;
+	}
+
+	detail::MappedFile _file;
+	MMapHeader _header = {};
+	TileMap2DView<T> _view;
+};
+
+}; // |===|   END namespace tm2D   |===|
@@ -0,0 +1,369 @@
+#pragma once
+
+#include "TileMap2D.h"
+
+#include <array>
+#include <bit>
+#include <cstdint>
+
+// Bit-packed 2-dimensional tilemaps of small unsigned tiles, such as collision and visibility layers.
+
+namespace tm2D
+{
+
+namespace detail
+{
+
+// Fill the bits [begin; end) of [row] with the bits of [pattern] at the same positions in their words.
+inline void fillBits(uint64_t* row, size_t begin, size_t end, uint64_t pattern)
+{
+	if (begin >= end) return;
+
+	const size_t first_word = begin / 64, last_word = (end - 1) / 64;
+	const uint64_t first_mask = ~uint64_t(0) << (begin % 64), last_mask = ~uint64_t(0) >> (63 - (end - 1) % 64);
+
+	if (first_word == last_word) {
+		const uint64_t mask = first_mask & last_mask;
+		row[first_word] = (row[first_word] & ~mask) | (pattern & mask);
+		return;
+	}
+	row[first_word] = (row[first_word] & ~first_mask) | (pattern & first_mask);
+	std::fill(row + first_word + 1, row + last_word, pattern);
+	row[last_word] = (row[last_word] & ~last_mask) | (pattern & last_mask);
+}
+
+// Get the 64 bits of [row] (of [words] words) starting at bit [bit]. Bits past the row read as 0.
+inline uint64_t readBits(const uint64_t* row, size_t words, size_t bit)
+{
+	const size_t word = bit / 64, shift = bit % 64;
+	uint64_t bits = row[word] >> shift;
+	if (shift && word + 1 < words) bits |= row[word + 1] << (64 - shift);
+	return bits;
+}
+
+// Copy [count] bits of [src] (of [src_words] words) from bit [src_bit] to [dst] at bit [dst_bit], a destination word at a time. The ranges must not overlap.
+inline void copyBits(uint64_t* dst, size_t dst_bit, const uint64_t* src, size_t src_words, size_t src_bit, size_t count)
+{
+	for (size_t done = 0; done < count;) {
+		const size_t bit = dst_bit + done, word = bit / 64, shift = bit % 64;
+		const size_t n = std::min<size_t>(64 - shift, count - done);
+		const uint64_t mask = (n == 64 ? ~uint64_t(0) : (uint64_t(1) << n) - 1) << shift;
+
+		dst[word] = (dst[word] & ~mask) | ((readBits(src, src_words, src_bit + done) << shift) & mask);
+		done += n;
+	}
+}
+
+// Reverse the order of the [Bits]-bit fields of [word].
+template<unsigned Bits>
+constexpr uint64_t reverseFields(uint64_t word)
+{
+	if constexpr (Bits <= 32) word = (word >> 32) | (word << 32);
+	if constexpr (Bits <= 16) word = ((word >> 16) & 0x0000FFFF0000FFFFull) | ((word & 0x0000FFFF0000FFFFull) << 16);
+	if constexpr (Bits <= 8) word = ((word >> 8) & 0x00FF00FF00FF00FFull) | ((word & 0x00FF00FF00FF00FFull) << 8);
+	if constexpr (Bits <= 4) word = ((word >> 4) & 0x0F0F0F0F0F0F0F0Full) | ((word & 0x0F0F0F0F0F0F0F0Full) << 4);
+	if constexpr (Bits <= 2) word = ((word >> 2) & 0x3333333333333333ull) | ((word & 0x3333333333333333ull) << 2);
+	if constexpr (Bits <= 1) word = ((word >> 1) & 0x5555555555555555ull) | ((word & 0x5555555555555555ull) << 1);
+	return word;
+}
+
+}; // namespace detail
+
+// A 2-dimensional tilemap of [Bits]-bit unsigned tiles, packed in 64-bit words. Each row starts on a new word.
+// As tiles are not addressable, 'operator()' returns a proxy reference, so this is not a 'TileMapLike' and has its own flip(), getChunk(), setChunk() and fillArea(), working a word at a time where they can.
+// Packing and unpacking from and to other tilemaps of integral tiles is done with the getChunk() and setChunk() overloads.
+template<unsigned Bits>
+	requires (Bits == 1 || Bits == 2 || Bits == 4 || Bits == 8)
+struct TileMap2D_Packed
+{
+	using tile_type = uint8_t;
+
+	static constexpr unsigned bits = Bits;
+	static constexpr size_t tiles_per_word = 64 / Bits;
+	static constexpr uint64_t tile_mask = (uint64_t(1) << Bits) - 1;
+
+	// Proxy to a tile, converting to and assignable from 'tile_type'.
+	struct reference
+	{
+		operator tile_type() const { return tile_type((*_word >> _shift) & tile_mask); }
+
+		reference& operator=(tile_type t)
+		{
+			*_word = (*_word & ~(tile_mask << _shift)) | ((uint64_t(t) & tile_mask) << _shift);
+			return *this;
+		}
+		reference& operator=(const reference& r) { return *this = tile_type(r); }
+
+	private:
+		friend TileMap2D_Packed;
+		reference(uint64_t* word, unsigned shift) : _word(word), _shift(shift) {}
+
+		uint64_t* _word;
+		unsigned _shift;
+	};
+
+	TileMap2D_Packed() {}
+
+	TileMap2D_Packed(size_t width, size_t height, tile_type elem = 0)
+	{
+		reset(width, height, elem);
+	}
+
+	constexpr size_t width() const { return _width; }
+	constexpr size_t height() const { return _height; }
+
+	// Unchecked tile access.
+	reference operator()(size_t x, size_t y) { return { &_words[x / tiles_per_word + _pitch * y], unsigned(x % tiles_per_word * Bits) }; }
+	tile_type operator()(size_t x, size_t y) const { return tile_type((_words[x / tiles_per_word + _pitch * y] >> (x % tiles_per_word * Bits)) & tile_mask); }
+
+	// Get the tile at ([x]; [y]), or 0 if it is out of the tilemap.
+	tile_type get(size_t x, size_t y) const { return (x < _width && y < _height) ? (*this)(x, y) : 0; }
+	// Set the tile at ([x]; [y]), if it is in the tilemap. Only the low [Bits] bits of [t] are stored.
+	void set(size_t x, size_t y, tile_type t)
+	{
+		if (x < _width && y < _height) (*this)(x, y) = t;
+	}
+
+	// Initialize the tilemap with a new buffer filled with [padding].
+	void reset(size_t new_width, size_t new_height, tile_type padding = 0)
+	{
+		_width = new_width;
+		_height = new_height;
+		_pitch = (new_width + tiles_per_word - 1) / tiles_per_word;
+		_words.assign(_pitch * new_height, 0);
+		if (padding & tile_mask) fillRect({ 0, 0, new_width, new_height }, padding);
+	}
+
+	// Get the packed words. Tile x of row y is at bits '(x % tiles_per_word) * Bits' of word 'x / tiles_per_word + pitch() * y'. Bits past the end of a row are 0.
+	uint64_t* data() { return _words.data(); }
+	const uint64_t* data() const { return _words.data(); }
+
+	// Get the distance in words between the starts of 2 consecutive rows.
+	constexpr size_t pitch() const { return _pitch; }
+
+	// Fill [area] (clipped to the tilemap) with [elem].
+	void fillRect(const Rect& area, tile_type elem)
+	{
+		const Rect cliprect = area.intersection({ 0, 0, _width, _height });
+		for (size_t y = cliprect.y; y < cliprect.y + cliprect.height; y++)
+			detail::fillBits(row(y), cliprect.x * Bits, (cliprect.x + cliprect.width) * Bits, broadcast(elem));
+	}
+
+	// Count the tiles equal to [value] in [area] (clipped to the tilemap), a word at a time.
+	size_t count(const Rect& area, tile_type value) const
+	{
+		const Rect cliprect = area.intersection({ 0, 0, _width, _height });
+		if (!cliprect.width || !cliprect.height) return 0;
+
+		const size_t begin = cliprect.x * Bits, end = (cliprect.x + cliprect.width) * Bits;
+		const size_t first_word = begin / 64, last_word = (end - 1) / 64;
+		const uint64_t pattern = broadcast(value);
+
+		size_t n = 0;
+		for (size_t y = cliprect.y; y < cliprect.y + cliprect.height; y++) {
+			const uint64_t* const r = row(y);
+			for (size_t w = first_word; w <= last_word; w++) {
+				// Fields equal to [value] become 0, then every bit of a field is or-ed into its lowest bit.
+				uint64_t diff = r[w] ^ pattern;
+				if constexpr (Bits >= 2) diff |= diff >> 1;
+				if constexpr (Bits >= 4) diff |= diff >> 2;
+				if constexpr (Bits >= 8) diff |= diff >> 4;
+
+				uint64_t mask = ~uint64_t(0);
+				if (w == first_word) mask &= ~uint64_t(0) << (begin % 64);
+				if (w == last_word) mask &= ~uint64_t(0) >> (63 - (end - 1) % 64);
+				n += (size_t)std::popcount(~diff & low_bits & mask);
+			}
+		}
+		return n;
+	}
+
+	// Flip the tilemap. Rows are swapped and reversed a word at a time.
+	void flip(bool horizontal, bool vertical)
+	{
+		if (horizontal) {
+			const size_t pad = _pitch * 64 - _width * Bits;
+			for (size_t y = 0; y < _height; y++) {
+				uint64_t* const r = row(y);
+				std::reverse(r, r + _pitch);
+				for (size_t w = 0; w < _pitch; w++) r[w] = detail::reverseFields<Bits>(r[w]);
+
+				// Move the reversed tiles from the end of the row back to its start.
+				if (pad) {
+					for (size_t w = 0; w < _pitch; w++)
+						r[w] = (r[w] >> pad) | (w + 1 < _pitch ? r[w + 1] << (64 - pad) : 0);
+				}
+			}
+		}
+		if (vertical) {
+			for (size_t y = 0; y < _height / 2; y++)
+				std::swap_ranges(row(y), row(y) + _pitch, row(_height - 1 - y));
+		}
+	}
+
+	// Fill a polygonal area of elements sastifying [rule] with [elem], using a scanline flood fill. See tm2D::fillArea().
+	// [rule] is evaluated once per tile value, and the runs are filled a word at a time.
+	// Returns the bounding rectangle of the filled tiles.
+	template<std::predicate<tile_type> Rule>
+	Rect fillArea(
+		const Point& center,
+		Rule&& rule,
+		tile_type elem,
+		bool eight_connected = false,
+		std::pmr::memory_resource* scratch = std::pmr::get_default_resource()
+	) {
+		std::array<bool, size_t(1) << Bits> fillable;
+		for (size_t t = 0; t < fillable.size(); t++) fillable[t] = (bool)rule(tile_type(t));
+
+		elem = tile_type(elem & tile_mask);
+		size_t min_x = _width, min_y = _height, max_x = 0, max_y = 0;
+
+		const auto fill = [&](size_t begin, size_t end, size_t y) {
+			min_x = std::min<>(min_x, begin);
+			max_x = std::max<>(max_x, end);
+			min_y = std::min<>(min_y, y);
+			max_y = std::max<>(max_y, y + 1);
+			detail::fillBits(row(y), begin * Bits, end * Bits, broadcast(elem));
+		};
+
+		if (!fillable[elem]) {
+			detail::scanlineFill(_width, _height, center, eight_connected, scratch,
+				[&](size_t x, size_t y) { return fillable[(*this)(x, y)]; },
+				fill
+			);
+		}
+		else {
+			// Filled tiles still satisfy the rule, so they are told apart with a bitmap.
+			TileMap2D_Packed<1> filled(_width, _height);
+
+			detail::scanlineFill(_width, _height, center, eight_connected, scratch,
+				[&](size_t x, size_t y) { return !std::as_const(filled)(x, y) && fillable[(*this)(x, y)]; },
+				[&](size_t begin, size_t end, size_t y) {
+					fill(begin, end, y);
+					filled.fillRect({ begin, y, end - begin, 1 }, 1);
+				}
+			);
+		}
+
+		if (min_x >= max_x) return {};
+		return { min_x, min_y, max_x - min_x, max_y - min_y };
+	}
+
+private:
+	// A word with the lowest bit of each field set.
+	static constexpr uint64_t low_bits = ~uint64_t(0) / tile_mask;
+
+	// Get a word with every field set to [t].
+	static constexpr uint64_t broadcast(tile_type t) { return (uint64_t(t) & tile_mask) * low_bits; }
+
+	uint64_t* row(size_t y) { return _words.data() + _pitch * y; }
+	const uint64_t* row(size_t y) const { return _words.data() + _pitch * y; }
+
+	std::vector<uint64_t> _words;
+	size_t _width = 0;
+	size_t _height = 0;
+	size_t _pitch = 0;
+};
+
+// Flip the packed tilemap. See TileMap2D_Packed::flip().
+template<unsigned Bits>
+void flip(TileMap2D_Packed<Bits>& map, bool horizontal, bool vertical)
+{
+	map.flip(horizontal, vertical);
+}
+
+// Set a chunk of a packed tilemap from another one, copying bit ranges a word at a time. See setChunk().
+// Returns the area of [output] written to.
+template<unsigned Bits>
+Rect setChunk(
+	TileMap2D_Packed<Bits>* output,
+	const TileMap2D_Packed<Bits>* input,
+	size_t x,
+	size_t y,
+	Rect src_area = {}
+) {
+	if (src_area == Rect(0, 0, 0, 0))
+		src_area = { 0, 0, input->width(), input->height() };
+
+	const Rect
+		src_cliprect = src_area.intersection({ 0, 0, input->width(), input->height() }),
+		dst_cliprect = Rect(x, y, src_cliprect.width, src_cliprect.height).intersection({ 0, 0, output->width(), output->height() });
+	if (!dst_cliprect.width || !dst_cliprect.height) return dst_cliprect;
+
+	// Rows of the same tilemap may overlap, so they are copied from a copy.
+	if (output == input) {
+		TileMap2D_Packed<Bits> copy;
+		getChunk(&copy, input, { src_cliprect.x, src_cliprect.y, dst_cliprect.width, dst_cliprect.height });
+		return setChunk(output, &copy, dst_cliprect.x, dst_cliprect.y);
+	}
+
+	for (size_t _y = 0; _y < dst_cliprect.height; _y++) {
+		detail::copyBits(
+			output->data() + output->pitch() * (dst_cliprect.y + _y), dst_cliprect.x * Bits,
+			input->data() + input->pitch() * (src_cliprect.y + _y), input->pitch(), src_cliprect.x * Bits,
+			dst_cliprect.width * Bits
+		);
+	}
+	return dst_cliprect;
+}
+
+// Get a chunk of a packed tilemap with the size of [src_area] into another one, copying bit ranges a word at a time. See getChunk().
+template<unsigned Bits>
+void getChunk(
+	TileMap2D_Packed<Bits>* output,
+	const TileMap2D_Packed<Bits>* input,
+	const Rect& src_area
+) {
+	if (output == input) {
+		TileMap2D_Packed<Bits> chunk;
+		getChunk(&chunk, input, src_area);
+		*output = std::move(chunk);
+		return;
+	}
+
+	output->reset(src_area.width, src_area.height, 0);
+	setChunk(output, input, 0, 0, src_area);
+}
+
+// Pack [src_area] of a tilemap of integral tiles into [output] at ([x]; [y]), keeping the low [Bits] bits of each tile. See setChunk().
+// Returns the area of [output] written to.
+template<unsigned Bits, TileMapLike In>
+	requires std::integral<tile_t<In>>
+Rect setChunk(
+	TileMap2D_Packed<Bits>* output,
+	const In* input,
+	size_t x,
+	size_t y,
+	Rect src_area = {}
+) {
+	if (src_area == Rect(0, 0, 0, 0))
+		src_area = { 0, 0, input->width(), input->height() };
+
+	const Rect
+		src_cliprect = src_area.intersection({ 0, 0, input->width(), input->height() }),
+		dst_cliprect = Rect(x, y, src_cliprect.width, src_cliprect.height).intersection({ 0, 0, output->width(), output->height() });
+
+	for (size_t _y = 0; _y < dst_cliprect.height; _y++)
+		for (size_t _x = 0; _x < dst_cliprect.width; _x++)
+			(*output)(dst_cliprect.x + _x, dst_cliprect.y + _y) = (uint8_t)(*input)(src_cliprect.x + _x, src_cliprect.y + _y);
+	return dst_cliprect;
+}
+
+// Unpack a chunk of a packed tilemap with the size of [src_area] into a tilemap of integral tiles. See getChunk().
+template<ResizableTileMapLike Out, unsigned Bits>
+	requires std::integral<tile_t<Out>>
+void getChunk(
+	Out* output,
+	const TileMap2D_Packed<Bits>* input,
+	const Rect& src_area
+) {
+	const Rect src_cliprect = src_area.intersection({ 0, 0, input->width(), input->height() });
+	if (src_cliprect == src_area) detail::resetForOverwrite(*output, src_area.width, src_area.height);
+	else output->reset(src_area.width, src_area.height, {});
+
+	for (size_t _y = 0; _y < src_cliprect.height; _y++)
+		for (size_t _x = 0; _x < src_cliprect.width; _x++)
+			(*output)(_x, _y) = (tile_t<Out>)(*input)(src_cliprect.x + _x, src_cliprect.y + _y);
+}
+
+}; // |===|   END namespace tm2D   |===|
@@ -0,0 +1,357 @@
+#pragma once
+
+#include "TileMap2D.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <exception>
+
+// Thread pool and parallel execution policies for whole-tilemap operations.
+
+namespace tm2D
+{
+
+// A fixed-size pool of worker threads.
+struct ThreadPool
+{
+	// Params:
+	//   [threads] Number of worker threads. If 0, the number of hardware threads minus one is used, as the calling thread also takes part in parallelFor().
+	explicit ThreadPool(size_t threads = 0)
+	{
+		if (threads == 0) threads = std::max<>(std::thread::hardware_concurrency(), 2u) - 1;
+
+		for (size_t i = 0; i < threads; i++) {
+			_workers.emplace_back([this] {
+				for (;;) {
+					std::function<void()> task;
+					{
+						std::unique_lock<std::mutex> lock(_mutex);
+						_cv.wait(lock, [this] { return _stop || !_tasks.empty(); });
+						if (_tasks.empty()) return;
+						task = std::move(_tasks.front());
+						_tasks.pop_front();
+					}
+					task();
+				}
+			});
+		}
+	}
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	// Finish the queued tasks and join the worker threads.
+	~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_stop = true;
+		}
+		_cv.notify_all();
+		for (std::thread& worker : _workers) worker.join();
+	}
+
+	// Get the number of worker threads.
+	size_t size() const { return _workers.size(); }
+
+	// Queue [func] to be run on a worker thread.
+	template<typename F>
+	auto submit(F&& func) -> std::future<std::invoke_result_t<std::decay_t<F>>>
+	{
+		using R = std::invoke_result_t<std::decay_t<F>>;
+		auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(func));
+		std::future<R> result = task->get_future();
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_tasks.emplace_back([task] { (*task)(); });
+		}
+		_cv.notify_one();
+		return result;
+	}
+
+	// Call [func(begin, end)] for [parts] consecutive ranges splitting [0; count), on the worker threads and the calling thread, and wait for all of them.
+	// The calling thread processes ranges too, so this can be called from a worker thread. The first exception thrown by [func] is rethrown.
+	// Params:
+	//   [parts] Number of ranges. If 0, it is the number of participating threads.
+	template<typename F>
+	void parallelFor(size_t count, F&& func, size_t parts = 0)
+	{
+		if (parts == 0) parts = size() + 1;
+		parts = std::min<>(parts, count);
+		if (parts <= 1) {
+			if (count) func(size_t(0), count);
+			return;
+		}
+
+		// Shared with the helper tasks, which may start after all ranges are done.
+		struct State
+		{
+			std::atomic<size_t> next = 0;
+			std::atomic<size_t> done = 0;
+			std::mutex mutex;
+			std::condition_variable cv;
+			std::exception_ptr error;
+		};
+		auto state = std::make_shared<State>();
+
+		const auto run = [state, &func, count, parts] {
+			for (;;) {
+				const size_t i = state->next++;
+				if (i >= parts) return;
+
+				try {
+					func(i * count / parts, (i + 1) * count / parts);
+				}
+				catch (...) {
+					std::lock_guard<std::mutex> lock(state->mutex);
+					if (!state->error) state->error = std::current_exception();
+				}
+
+				if (++state->done == parts) {
+					std::lock_guard<std::mutex> lock(state->mutex);
+					state->cv.notify_all();
+				}
+			}
+		};
+
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			for (size_t i = 0; i < std::min<>(parts - 1, size()); i++) _tasks.emplace_back(run);
+		}
+		_cv.notify_all();
+
+		run();
+
+		std::unique_lock<std::mutex> lock(state->mutex);
+		state->cv.wait(lock, [&] { return state->done == parts; });
+		if (state->error) std::rethrow_exception(state->error);
+	}
+
+private:
+	std::vector<std::thread> _workers;
+	std::deque<std::function<void()>> _tasks;
+	std::mutex _mutex;
+	std::condition_variable _cv;
+	bool _stop = false;
+};
+
+// Get the thread pool used by parallel algorithms when none is given, created on first use.
+inline ThreadPool& defaultThreadPool()
+{
+	static ThreadPool pool;
+	return pool;
+}
+
+// Execution policies for tilemap operations, mirroring 'std::execution'.
+namespace execution
+{
+
+// Run on the calling thread.
+struct sequenced_policy {};
+
+// Split the work into row bands run on a thread pool.
+struct parallel_policy
+{
+	// Pool to run on. If NULL, defaultThreadPool() is used.
+	ThreadPool* pool = NULL;
+	// Operations on fewer tiles than this run on the calling thread.
+	size_t threshold = 256 * 256;
+	// Number of row bands per participating thread, for load balancing.
+	size_t bands_per_thread = 4;
+
+	// Get a copy of the policy running on [thread_pool].
+	constexpr parallel_policy on(ThreadPool& thread_pool) const
+	{
+		parallel_policy policy = *this;
+		policy.pool = &thread_pool;
+		return policy;
+	}
+
+	// Get a copy of the policy with a different size threshold.
+	constexpr parallel_policy withThreshold(size_t tiles) const
+	{
+		parallel_policy policy = *this;
+		policy.threshold = tiles;
+		return policy;
+	}
+};
+
+inline constexpr sequenced_policy seq{};
+inline constexpr parallel_policy par{};
+
+}; // namespace execution
+
+// One of the execution policies in tm2D::execution.
+template<typename P>
+concept ExecutionPolicy =
+	std::same_as<std::remove_cvref_t<P>, execution::sequenced_policy> ||
+	std::same_as<std::remove_cvref_t<P>, execution::parallel_policy>;
+
+namespace detail
+{
+
+// Call [func(y_begin, y_end)] over row bands splitting [0; rows), following [policy]. [tiles] is the number of tiles processed, compared against the policy's threshold.
+template<ExecutionPolicy P, typename F>
+void forRowBands(const P& policy, size_t tiles, size_t rows, F&& func)
+{
+	if constexpr (std::same_as<std::remove_cvref_t<P>, execution::parallel_policy>) {
+		if (tiles >= policy.threshold && rows > 1) {
+			ThreadPool& pool = policy.pool ? *policy.pool : defaultThreadPool();
+			pool.parallelFor(rows, func, (pool.size() + 1) * std::max<size_t>(policy.bands_per_thread, 1));
+			return;
+		}
+	}
+
+	if (rows) func(size_t(0), rows);
+}
+
+// Prepare [area] of [map] to be written to following [policy], and get the policy to write it with.
+// Tilemaps allocating their storage on writes (see allocates_on_write) are written sequentially: allocating up front would allocate every chunk of the area,
+// even the ones that keep the padding tile, and the bands of rows written by an algorithm don't map to disjoint chunks in general (e.g. a vertical flip or a rotation).
+// Other tilemaps get allocateArea() called before concurrent writes if they have it, e.g. a TileMap2D_Tracked marks the area up front.
+template<ExecutionPolicy P, TileMapLike M>
+auto prepareConcurrentWrite(const P& policy, M& map, const Rect& area)
+{
+	if constexpr (allocates_on_write<M>) return execution::seq;
+	else {
+		if constexpr (std::same_as<std::remove_cvref_t<P>, execution::parallel_policy> && requires { map.allocateArea(area); }) map.allocateArea(area);
+		return policy;
+	}
+}
+
+}; // namespace detail
+
+// Flip the tilemap, following [policy]. See flip().
+template<ExecutionPolicy P, TileMapLike M>
+void flip(const P& policy, M& map, bool horizontal, bool vertical)
+{
+	TM2D_INSTRUMENT_SCOPE(Flip);
+	const size_t width = map.width(), height = map.height();
+	if (horizontal || vertical) TM2D_INSTRUMENT_COUNT(width * height, width * height * sizeof(tile_t<M>));
+	const auto write_policy = detail::prepareConcurrentWrite(policy, map, { 0, 0, width, height });
+
+	if (horizontal && vertical) {
+		detail::forRowBands(write_policy, width * height, height / 2, [&](size_t y_begin, size_t y_end) { detail::swapReversedMirroredRows(map, y_begin, y_end); });
+		if (height % 2) detail::reverseRows(map, height / 2, height / 2 + 1);
+	}
+	else if (horizontal)
+		detail::forRowBands(write_policy, width * height, height, [&](size_t y_begin, size_t y_end) { detail::reverseRows(map, y_begin, y_end); });
+	else if (vertical)
+		detail::forRowBands(write_policy, width * height, height / 2, [&](size_t y_begin, size_t y_end) { detail::swapMirroredRows(map, y_begin, y_end); });
+}
+
+// Rotate the tilemap 90 degrees in the top left corner, following [policy]. See rot90().
+template<ExecutionPolicy P, ResizableTileMapLike Out, TileMapLike In>
+	requires std::same_as<tile_t<Out>, tile_t<In>>
+void rot90(
+	const P& policy,
+	Out* output,
+	const In* input,
+	bool rotate_left
+) {
+	TM2D_INSTRUMENT_SCOPE(Rot90);
+	TM2D_INSTRUMENT_COUNT(input->width() * input->height(), input->width() * input->height() * sizeof(tile_t<In>));
+	detail::resetForOverwrite(*output, input->height(), input->width());
+	const auto write_policy = detail::prepareConcurrentWrite(policy, *output, { 0, 0, output->width(), output->height() });
+
+	detail::forRowBands(write_policy, input->width() * input->height(), input->height(), [&](size_t y_begin, size_t y_end) {
+		detail::rotateRows90(*output, *input, rotate_left, y_begin, y_end);
+	});
+}
+
+// Rotate the tilemap 180 degrees, following [policy]. See rot180().
+template<ExecutionPolicy P, ResizableTileMapLike Out, TileMapLike In>
+	requires std::same_as<tile_t<Out>, tile_t<In>>
+void rot180(
+	const P& policy,
+	Out* output,
+	const In* input
+) {
+	TM2D_INSTRUMENT_SCOPE(Rot180);
+	TM2D_INSTRUMENT_COUNT(input->width() * input->height(), input->width() * input->height() * sizeof(tile_t<In>));
+	detail::resetForOverwrite(*output, input->width(), input->height());
+	const auto write_policy = detail::prepareConcurrentWrite(policy, *output, { 0, 0, output->width(), output->height() });
+
+	detail::forRowBands(write_policy, input->width() * input->height(), input->height(), [&](size_t y_begin, size_t y_end) {
+		detail::rotateRows180(*output, *input, y_begin, y_end);
+	});
+}
+
+// Get a chunk of a 2D tilemap, following [policy]. See getChunk().
+template<ExecutionPolicy P, ResizableTileMapLike Out, TileMapLike In>
+	requires std::same_as<tile_t<Out>, tile_t<In>>
+void getChunk(
+	const P& policy,
+	Out* output,
+	const In* input,
+	const Rect& src_area
+) {
+	TM2D_INSTRUMENT_SCOPE(GetChunk);
+	const Rect src_cliprect = src_area.intersection({ 0, 0, input->width(), input->height() });
+	if (src_cliprect == src_area) detail::resetForOverwrite(*output, src_area.width, src_area.height);
+	else output->reset(src_area.width, src_area.height, {});
+	TM2D_INSTRUMENT_COUNT(src_cliprect.width * src_cliprect.height, src_cliprect.width * src_cliprect.height * sizeof(tile_t<In>));
+	const auto write_policy = detail::prepareConcurrentWrite(policy, *output, { 0, 0, src_cliprect.width, src_cliprect.height });
+
+	detail::forRowBands(write_policy, src_cliprect.width * src_cliprect.height, src_cliprect.height, [&](size_t y_begin, size_t y_end) {
+		detail::copyArea(*output, *input, 0, y_begin, { src_cliprect.x, src_cliprect.y + y_begin, src_cliprect.width, y_end - y_begin });
+	});
+}
+
+// Set a chunk of a 2D tilemap, following [policy]. See setChunk().
+// Note: unlike setChunk(), the source and destination areas must not overlap.
+// Returns the area of [output] written to.
+template<ExecutionPolicy P, TileMapLike Out, TileMapLike In>
+	requires std::same_as<tile_t<Out>, tile_t<In>>
+Rect setChunk(
+	const P& policy,
+	Out* output,
+	const In* input,
+	size_t x,
+	size_t y,
+	Rect src_area = {}
+) {
+	TM2D_INSTRUMENT_SCOPE(SetChunk);
+	if (src_area == Rect(0, 0, 0, 0))
+		src_area = { 0, 0, input->width(), input->height() };
+
+	const Rect
+		src_cliprect = src_area.intersection({ 0, 0, input->width(), input->height() }),
+		dst_cliprect = Rect(x, y, src_cliprect.width, src_cliprect.height).intersection({ 0, 0, output->width(), output->height() });
+	TM2D_INSTRUMENT_COUNT(dst_cliprect.width * dst_cliprect.height, dst_cliprect.width * dst_cliprect.height * sizeof(tile_t<In>));
+	const auto write_policy = detail::prepareConcurrentWrite(policy, *output, dst_cliprect);
+
+	detail::forRowBands(write_policy, dst_cliprect.width * dst_cliprect.height, dst_cliprect.height, [&](size_t y_begin, size_t y_end) {
+		detail::copyArea(*output, *input, dst_cliprect.x, dst_cliprect.y + y_begin, { src_cliprect.x, src_cliprect.y + y_begin, dst_cliprect.width, y_end - y_begin });
+	});
+	return dst_cliprect;
+}
+
+// Call [func(tile, x, y)] for every tile of the tilemap, following [policy].
+// [func] is called concurrently for different rows with the parallel policy.
+template<ExecutionPolicy P, TileMapLike M, typename F>
+	requires std::invocable<F&, tile_t<M>&, size_t, size_t>
+void forEachTile(const P& policy, M& map, F&& func)
+{
+	const size_t width = map.width(), height = map.height();
+	const auto write_policy = detail::prepareConcurrentWrite(policy, map, { 0, 0, width, height });
+
+	detail::forRowBands(write_policy, width * height, height, [&](size_t y_begin, size_t y_end) {
+		for (size_t y = y_begin; y < y_end; y++) {
+			if constexpr (ContiguousTileMap<M>) {
+				const auto row = detail::rowData(map, y);
+				for (size_t x = 0; x < width; x++) func(row[x], x, y);
+			}
+			else {
+				for (size_t x = 0; x < width; x++) func(map(x, y), x, y);
+			}
+		}
+	});
+}
+
+}; // |===|   END namespace tm2D   |===|
@@ -0,0 +1,677 @@
+#pragma once
+
+#include "TileMap2D.h"
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+// Shortest paths over the passable tiles of 2-dimensional tilemaps: A*, Jump Point Search, and a hierarchy of clusters of tiles for long paths on large tilemaps.
+
+namespace tm2D
+{
+
+// Moves allowed in the paths of PathFinder and PathHierarchy.
+struct PathOptions
+{
+	// If true, paths also move diagonally, at a cost of sqrt(2) instead of 1.
+	bool eight_connected = true;
+	// If true, diagonal moves may pass an impassable tile orthogonally adjacent to them. Otherwise both of these tiles must be passable.
+	bool cut_corners = false;
+	// Area the paths stay within (clipped to the tilemap). Default value is the whole tilemap.
+	Rect area = {};
+};
+
+namespace detail
+{
+
+inline constexpr float diagonal_cost = 1.41421356f;
+inline constexpr float no_path = std::numeric_limits<float>::infinity();
+
+// Get the cost of the shortest path from [a] to [b] with no obstacle, the heuristic of the searches.
+inline float pathDistance(const Point& a, const Point& b, bool eight_connected)
+{
+	const size_t
+		dx = a.x > b.x ? a.x - b.x : b.x - a.x,
+		dy = a.y > b.y ? a.y - b.y : b.y - a.y;
+	if (!eight_connected) return float(dx + dy);
+	return float(std::max<>(dx, dy)) + (diagonal_cost - 1.0f) * float(std::min<>(dx, dy));
+}
+
+}; // namespace detail
+
+// Search state of A*, Jump Point Search and Dijkstra over a tilemap.
+// Its buffers are kept from one search to the next and only grow, so that repeated searches do not allocate. Numbering the searches in the nodes saves clearing them.
+// Note: the searched area can't have more than 2^32 - 1 tiles.
+struct PathFinder
+{
+	// Find the shortest path from [start] to [goal] over the tiles satisfying [passable] with A*.
+	// Returns true and sets [path] (if not NULL) to the tiles of the path from [start] to [goal], both included, if there is one.
+	template<TileMapLike M, std::predicate<const tile_t<M>&> Passable>
+	bool findPath(
+		const M& map,
+		const Point& start,
+		const Point& goal,
+		Passable&& passable,
+		std::vector<Point>* path,
+		const PathOptions& options = {}
+	) {
+		if (!search(map, start, &goal, passable, options, false)) return false;
+		if (path) buildPath(goal, path);
+		return true;
+	}
+
+	// Find the shortest path from [start] to [goal] over the tiles satisfying [passable] with Jump Point Search, with the same cost as findPath().
+	// Instead of expanding every tile, it jumps over the straight runs of passable tiles to the tiles where the shortest paths may turn, which is
+	// much faster than A* over the open areas of uniform-cost tilemaps. The paths are 8-connected without cutting corners, whatever [options] says.
+	template<TileMapLike M, std::predicate<const tile_t<M>&> Passable>
+	bool findPathJPS(
+		const M& map,
+		const Point& start,
+		const Point& goal,
+		Passable&& passable,
+		std::vector<Point>* path,
+		const PathOptions& options = {}
+	) {
+		PathOptions jps_options = options;
+		jps_options.eight_connected = true;
+		jps_options.cut_corners = false;
+		if (!search(map, start, &goal, passable, jps_options, true)) return false;
+		if (path) buildPath(goal, path);
+		return true;
+	}
+
+	// Find the costs of the shortest paths from [start] to every tile reachable over the tiles satisfying [passable], read with costTo() (Dijkstra).
+	// Returns false if [start] is not a passable tile of the area.
+	template<TileMapLike M, std::predicate<const tile_t<M>&> Passable>
+	bool findCosts(
+		const M& map,
+		const Point& start,
+		Passable&& passable,
+		const PathOptions& options = {}
+	) {
+		return search(map, start, NULL, passable, options, false);
+	}
+
+	// Get the cost of the shortest path to [p] found by the last findCosts(), or infinity if there is none.
+	// After findPath(), only the tiles expanded by the search have the costs of their shortest paths.
+	float costTo(const Point& p) const
+	{
+		if (p.x - _area.x >= _area.width || p.y - _area.y >= _area.height) return detail::no_path;
+		const Node& node = _nodes[index(p.x, p.y)];
+		return node.search == _search && node.closed ? node.g : detail::no_path;
+	}
+
+	// Get the cost of the path found by the last search: 1 per orthogonal move, and sqrt(2) per diagonal one.
+	float cost() const { return _cost; }
+
+	// Get the number of tiles expanded by the last search, a measure of its work.
+	size_t expandedNodes() const { return _expanded; }
+
+private:
+	static constexpr uint32_t no_parent = UINT32_MAX;
+
+	struct Node
+	{
+		float g;
+		uint32_t parent;
+		uint32_t search;
+		bool closed;
+	};
+
+	struct OpenNode
+	{
+		float f;
+		float g;
+		uint32_t index;
+
+		// The top of the heap has the lowest f, then the highest g, which is the nearest to the goal.
+		bool operator<(const OpenNode& n) const { return f > n.f || (f == n.f && g < n.g); }
+	};
+
+	size_t index(size_t x, size_t y) const { return (x - _area.x) + _area.width * (y - _area.y); }
+
+	Point position(size_t i) const { return { _area.x + i % _area.width, _area.y + i / _area.width }; }
+
+	template<TileMapLike M, typename Passable>
+	bool search(
+		const M& map,
+		const Point& start,
+		const Point* goal,
+		Passable& passable,
+		const PathOptions& options,
+		bool jump
+	) {
+		_area = options.area == Rect(0, 0, 0, 0) ? Rect(0, 0, map.width(), map.height()) : options.area.intersection({ 0, 0, map.width(), map.height() });
+		_cost = 0;
+		_expanded = 0;
+		_open.clear();
+
+		const size_t count = _area.width * _area.height;
+		if (count >= no_parent) return false;
+		if (_nodes.size() < count) _nodes.resize(count, Node{ 0, no_parent, 0, false });
+		if (++_search == 0) {
+			for (Node& node : _nodes) node.search = 0;
+			_search = 1;
+		}
+
+		// Out of the area, the coordinates wrap around to large values.
+		const auto open = [&](size_t x, size_t y) {
+			return x - _area.x < _area.width && y - _area.y < _area.height && passable(map(x, y));
+		};
+		if (!open(start.x, start.y) || (goal && !open(goal->x, goal->y))) return false;
+
+		const auto relax = [&](const Point& p, uint32_t parent, float g) {
+			const size_t i = index(p.x, p.y);
+			Node& node = _nodes[i];
+			if (node.search != _search) node = { detail::no_path, no_parent, _search, false };
+			if (node.closed || g >= node.g) return;
+
+			node.g = g;
+			node.parent = parent;
+			_open.push_back({ g + (goal ? detail::pathDistance(p, *goal, options.eight_connected) : 0.0f), g, uint32_t(i) });
+			std::push_heap(_open.begin(), _open.end());
+		};
+		relax(start, no_parent, 0.0f);
+
+		while (!_open.empty()) {
+			std::pop_heap(_open.begin(), _open.end());
+			const OpenNode top = _open.back();
+			_open.pop_back();
+
+			Node& node = _nodes[top.index];
+			if (node.closed || top.g > node.g) continue;
+			node.closed = true;
+			_expanded++;
+
+			const Point p = position(top.index);
+			if (goal && p == *goal) {
+				_cost = node.g;
+				return true;
+			}
+
+			if (jump) {
+				expandJumps(p, top.index, node, *goal, open, relax);
+				continue;
+			}
+
+			// Orthogonal neighbors first, whose passability decides the diagonal moves that don't cut corners.
+			const bool
+				right = open(p.x + 1, p.y), left = open(p.x - 1, p.y),
+				down = open(p.x, p.y + 1), up = open(p.x, p.y - 1);
+			const float g = node.g;
+			if (right) relax({ p.x + 1, p.y }, top.index, g + 1.0f);
+			if (left) relax({ p.x - 1, p.y }, top.index, g + 1.0f);
+			if (down) relax({ p.x, p.y + 1 }, top.index, g + 1.0f);
+			if (up) relax({ p.x, p.y - 1 }, top.index, g + 1.0f);
+			if (!options.eight_connected) continue;
+
+			const bool cut = options.cut_corners;
+			const auto diagonal = [&](size_t x, size_t y, bool side_x, bool side_y) {
+				if ((cut || (side_x && side_y)) && open(x, y)) relax({ x, y }, top.index, g + detail::diagonal_cost);
+			};
+			diagonal(p.x + 1, p.y + 1, right, down);
+			diagonal(p.x - 1, p.y + 1, left, down);
+			diagonal(p.x + 1, p.y - 1, right, up);
+			diagonal(p.x - 1, p.y - 1, left, up);
+		}
+		return !goal;
+	}
+
+	// Find the tile the search jumps to from [p] in the direction ([dx]; [dy]) (wrapping around for -1): the goal, or a tile where the shortest paths may turn.
+	// Moving straight, it is a tile with a passable side whose tile behind is impassable. Moving diagonally, it is a tile from which a straight jump finds one.
+	template<typename Open>
+	static bool jumpTo(Point p, size_t dx, size_t dy, const Point& goal, Open& open, Point* found)
+	{
+		size_t x = p.x + dx, y = p.y + dy;
+		if (dx && dy) {
+			for (;;) {
+				if (!open(x, y)) return false;
+				if ((x == goal.x && y == goal.y) || jumpTo({ x, y }, dx, 0, goal, open, NULL) || jumpTo({ x, y }, 0, dy, goal, open, NULL)) break;
+				// The next diagonal move must not cut corners.
+				if (!open(x + dx, y) || !open(x, y + dy)) return false;
+				x += dx;
+				y += dy;
+			}
+		}
+		else {
+			for (;; x += dx, y += dy) {
+				if (!open(x, y)) return false;
+				if (x == goal.x && y == goal.y) break;
+				if (dx) {
+					if ((open(x, y - 1) && !open(x - dx, y - 1)) || (open(x, y + 1) && !open(x - dx, y + 1))) break;
+				}
+				else {
+					if ((open(x - 1, y) && !open(x - 1, y - dy)) || (open(x + 1, y) && !open(x + 1, y - dy))) break;
+				}
+			}
+		}
+		if (found) *found = { x, y };
+		return true;
+	}
+
+	// Jump from the expanded tile [p] in the directions not pruned by the direction it was reached from.
+	template<typename Open, typename Relax>
+	void expandJumps(const Point& p, uint32_t i, const Node& node, const Point& goal, Open& open, Relax& relax)
+	{
+		constexpr size_t m = SIZE_MAX;
+		size_t directions[8][2];
+		size_t count = 0;
+		const auto add = [&](size_t dx, size_t dy) {
+			directions[count][0] = dx;
+			directions[count][1] = dy;
+			count++;
+		};
+
+		if (node.parent == no_parent) {
+			for (size_t dy : { size_t(0), size_t(1), m })
+				for (size_t dx : { size_t(0), size_t(1), m })
+					if ((dx || dy) && (!(dx && dy) || (open(p.x + dx, p.y) && open(p.x, p.y + dy)))) add(dx, dy);
+		}
+		else {
+			const Point parent = position(node.parent);
+			const size_t
+				dx = p.x == parent.x ? 0 : p.x > parent.x ? 1 : m,
+				dy = p.y == parent.y ? 0 : p.y > parent.y ? 1 : m;
+
+			if (dx && dy) {
+				const bool horizontal = open(p.x + dx, p.y), vertical = open(p.x, p.y + dy);
+				if (vertical) add(0, dy);
+				if (horizontal) add(dx, 0);
+				if (horizontal && vertical) add(dx, dy);
+			}
+			else if (dx) {
+				const bool next = open(p.x + dx, p.y), below = open(p.x, p.y + 1), above = open(p.x, p.y - 1);
+				if (next) {
+					add(dx, 0);
+					if (below) add(dx, 1);
+					if (above) add(dx, m);
+				}
+				if (below) add(0, 1);
+				if (above) add(0, m);
+			}
+			else {
+				const bool next = open(p.x, p.y + dy), right = open(p.x + 1, p.y), left = open(p.x - 1, p.y);
+				if (next) {
+					add(0, dy);
+					if (right) add(1, dy);
+					if (left) add(m, dy);
+				}
+				if (right) add(1, 0);
+				if (left) add(m, 0);
+			}
+		}
+
+		for (size_t d = 0; d < count; d++) {
+			Point found;
+			if (jumpTo(p, directions[d][0], directions[d][1], goal, open, &found))
+				relax(found, i, node.g + detail::pathDistance(p, found, true));
+		}
+	}
+
+	// Set [path] to the tiles from the start to [goal], filling in the straight runs between jump points.
+	void buildPath(const Point& goal, std::vector<Point>* path) const
+	{
+		path->clear();
+		Point p = goal;
+		for (uint32_t parent = _nodes[index(goal.x, goal.y)].parent; parent != no_parent; parent = _nodes[parent].parent) {
+			const Point to = position(parent);
+			const size_t
+				dx = p.x == to.x ? 0 : p.x < to.x ? 1 : SIZE_MAX,
+				dy = p.y == to.y ? 0 : p.y < to.y ? 1 : SIZE_MAX;
+			for (; p != to; p.x += dx, p.y += dy) path->push_back(p);
+		}
+		path->push_back(p);
+		std::reverse(path->begin(), path->end());
+	}
+
+	std::vector<Node> _nodes;
+	std::vector<OpenNode> _open;
+	uint32_t _search = 0;
+	Rect _area;
+	float _cost = 0;
+	size_t _expanded = 0;
+};
+
+// Hierarchical pathfinding (HPA*) over clusters of (1 << [ClusterShift]) x (1 << [ClusterShift]) tiles, for long paths on large tilemaps.
+// The passable runs along the borders of adjacent clusters are entrances, linked across the border and to the entrances of the same cluster with the costs of the paths
+// between them within the cluster. A search runs over this small graph, then the path is refined with searches within single clusters, which is near-optimal.
+// Only the clusters of the modified areas are rebuilt by update(): with a TileMap2D_Chunked of the same shift, a cluster is a chunk, e.g. one of the areas of
+// TileMap2D_CoW::changedAreas() or DirtyTracker::consumeDirty() (with the same shift).
+// With corners cut, a diagonal move can cross a border between 2 impassable tiles, which is linked by its own node pair.
+// Note: every call must pass the same tilemap and passability rule as build().
+template<size_t ClusterShift = 5>
+	requires (ClusterShift > 1 && ClusterShift < 16)
+struct PathHierarchy
+{
+	// Width and height of a cluster in tiles.
+	static constexpr size_t cluster_size = size_t(1) << ClusterShift;
+
+	// [options] are the moves of the paths. Its area is ignored: the hierarchy covers the whole tilemap.
+	explicit PathHierarchy(const PathOptions& options = {})
+		: _options(options)
+	{
+		_options.area = {};
+	}
+
+	// Build the hierarchy of [map] over the tiles satisfying [passable].
+	template<TileMapLike M, std::predicate<const tile_t<M>&> Passable>
+	void build(const M& map, Passable&& passable)
+	{
+		_width = map.width();
+		_height = map.height();
+		_clusters_x = (_width + cluster_size - 1) >> ClusterShift;
+		_clusters_y = (_height + cluster_size - 1) >> ClusterShift;
+		_nodes.clear();
+		_free_nodes.clear();
+		_cluster_nodes.assign(_clusters_x * _clusters_y, {});
+		_border_nodes.assign(2 * _clusters_x * _clusters_y, {});
+		update(map, passable, { 0, 0, _width, _height });
+	}
+
+	// Rebuild the clusters overlapping [area] (clipped to the tilemap), after the passability of its tiles changed.
+	template<TileMapLike M, std::predicate<const tile_t<M>&> Passable>
+	void update(const M& map, Passable&& passable, const Rect& area)
+	{
+		const Rect cliprect = area.intersection({ 0, 0, _width, _height });
+		if (!cliprect.width || !cliprect.height) return;
+
+		const size_t
+			cx_begin = cliprect.x >> ClusterShift, cx_end = ((cliprect.x + cliprect.width - 1) >> ClusterShift) + 1,
+			cy_begin = cliprect.y >> ClusterShift, cy_end = ((cliprect.y + cliprect.height - 1) >> ClusterShift) + 1;
+
+		// The entrances of the borders of the modified clusters change, so the costs within their neighbors change too.
+		for (size_t cy = cy_begin; cy < cy_end; cy++) {
+			for (size_t cx = cx_begin; cx < cx_end; cx++) {
+				rebuildBorder(map, passable, cx, cy, false);
+				rebuildBorder(map, passable, cx, cy, true);
+				// The left and top borders are the right and bottom ones of the previous clusters, already rebuilt within [area].
+				if (cx == cx_begin && cx) rebuildBorder(map, passable, cx - 1, cy, false);
+				if (cy == cy_begin && cy) rebuildBorder(map, passable, cx, cy - 1, true);
+			}
+		}
+		// The diagonal links of the right borders reach the first row of the clusters below and the last row of the clusters above.
+		if (diagonalLinks()) {
+			for (size_t cx = cx_begin ? cx_begin - 1 : 0; cx < cx_end; cx++) {
+				if (cy_begin) rebuildBorder(map, passable, cx, cy_begin - 1, false);
+				if (cy_end < _clusters_y) rebuildBorder(map, passable, cx, cy_end, false);
+			}
+		}
+		// Their corner links reach one more row of clusters above and below.
+		const size_t margin_y = diagonalLinks() ? 2 : 1;
+		for (size_t cy = cy_begin > margin_y ? cy_begin - margin_y : 0; cy < std::min<>(cy_end + margin_y, _clusters_y); cy++) {
+			for (size_t cx = cx_begin ? cx_begin - 1 : 0; cx < std::min<>(cx_end + 1, _clusters_x); cx++) {
+				// Only the clusters sharing a border with the modified ones, or a corner with diagonal links.
+				const bool inside_x = cx >= cx_begin && cx < cx_end, inside_y = cy >= cy_begin && cy < cy_end;
+				if (inside_x || inside_y || diagonalLinks()) rebuildCosts(map, passable, cx, cy);
+			}
+		}
+	}
+
+	// Find a path from [start] to [goal] over the tiles satisfying [passable], through the entrances of the clusters.
+	// Returns true and sets [path] (if not NULL) to the tiles of the path from [start] to [goal], both included, if there is one.
+	template<TileMapLike M, std::predicate<const tile_t<M>&> Passable>
+	bool findPath(
+		const M& map,
+		const Point& start,
+		const Point& goal,
+		Passable&& passable,
+		std::vector<Point>* path
+	) {
+		_cost = 0;
+		if (start.x >= _width || start.y >= _height || goal.x >= _width || goal.y >= _height) return false;
+		if (!passable(map(start.x, start.y)) || !passable(map(goal.x, goal.y))) return false;
+
+		const uint32_t start_cluster = clusterOf(start), goal_cluster = clusterOf(goal);
+		if (start_cluster == goal_cluster && _finder.findPath(map, start, goal, passable, path, clusterOptions(start_cluster))) {
+			_cost = _finder.cost();
+			return true;
+		}
+
+		// The start and the goal join the graph as 2 more nodes, linked to the entrances of their clusters.
+		const uint32_t node_count = uint32_t(_nodes.size()), start_node = node_count, goal_node = node_count + 1;
+		_start_edges.clear();
+		_finder.findCosts(map, start, passable, clusterOptions(start_cluster));
+		for (uint32_t n : _cluster_nodes[start_cluster]) {
+			const float cost = _finder.costTo(_nodes[n].position);
+			if (cost != detail::no_path) _start_edges.push_back({ n, cost });
+		}
+		_goal_costs.assign(node_count, detail::no_path);
+		_finder.findCosts(map, goal, passable, clusterOptions(goal_cluster));
+		for (uint32_t n : _cluster_nodes[goal_cluster]) _goal_costs[n] = _finder.costTo(_nodes[n].position);
+
+		if (!searchGraph(start_node, goal_node, goal)) return false;
+		_cost = _g[goal_node];
+		if (!path) return true;
+
+		// Refine the path between consecutive nodes: searching within a cluster, or stepping across a border.
+		path->clear();
+		std::vector<Point> segment;
+		Point from = start;
+		uint32_t from_cluster = start_cluster;
+		for (size_t i = _graph_path.size() - 1; i-- > 0;) {
+			const uint32_t n = _graph_path[i];
+			const Point to = n == goal_node ? goal : _nodes[n].position;
+			const uint32_t to_cluster = n == goal_node ? goal_cluster : _nodes[n].cluster;
+
+			if (from_cluster == to_cluster) _finder.findPath(map, from, to, passable, &segment, clusterOptions(to_cluster));
+			else segment = { from, to };
+			path->insert(path->end(), segment.begin() + (path->empty() ? 0 : 1), segment.end());
+			from = to;
+			from_cluster = to_cluster;
+		}
+		return true;
+	}
+
+	// Get the cost of the path found by the last findPath(): 1 per orthogonal move, and sqrt(2) per diagonal one.
+	float cost() const { return _cost; }
+
+	// Get the number of entrance nodes of the graph.
+	size_t nodeCount() const { return _nodes.size() - _free_nodes.size(); }
+
+private:
+	struct Edge
+	{
+		uint32_t to;
+		float cost;
+	};
+
+	struct Node
+	{
+		Point position;
+		uint32_t cluster;
+		// Node on the other side of the border, linked with a cost of [across_cost]: 1, or sqrt(2) for a diagonal link.
+		uint32_t across;
+		float across_cost;
+		// Nodes of the same cluster.
+		std::vector<Edge> edges;
+	};
+
+	struct OpenNode
+	{
+		float f;
+		uint32_t node;
+
+		bool operator<(const OpenNode& n) const { return f > n.f; }
+	};
+
+	uint32_t clusterOf(const Point& p) const { return uint32_t((p.x >> ClusterShift) + _clusters_x * (p.y >> ClusterShift)); }
+
+	// Whether diagonal moves can cross a border between 2 impassable tiles, where the borders have no entrance.
+	bool diagonalLinks() const { return _options.eight_connected && _options.cut_corners; }
+
+	PathOptions clusterOptions(uint32_t cluster) const
+	{
+		PathOptions options = _options;
+		options.area = Rect((cluster % _clusters_x) << ClusterShift, (cluster / _clusters_x) << ClusterShift, cluster_size, cluster_size);
+		return options;
+	}
+
+	uint32_t addNode(const Point& position, uint32_t cluster)
+	{
+		uint32_t n;
+		if (_free_nodes.empty()) {
+			n = uint32_t(_nodes.size());
+			_nodes.emplace_back();
+		}
+		else {
+			n = _free_nodes.back();
+			_free_nodes.pop_back();
+		}
+		_nodes[n].position = position;
+		_nodes[n].cluster = cluster;
+		_nodes[n].edges.clear();
+		_cluster_nodes[cluster].push_back(n);
+		return n;
+	}
+
+	// Replace the entrances of the right ([vertical] false) or bottom ([vertical] true) border of the cluster ([cx]; [cy]), if it has a neighbor there.
+	template<TileMapLike M, typename Passable>
+	void rebuildBorder(const M& map, Passable& passable, size_t cx, size_t cy, bool vertical)
+	{
+		const size_t cluster = cx + _clusters_x * cy;
+		std::vector<uint32_t>& border = _border_nodes[2 * cluster + vertical];
+		for (uint32_t n : border) {
+			std::vector<uint32_t>& nodes = _cluster_nodes[_nodes[n].cluster];
+			nodes.erase(std::find(nodes.begin(), nodes.end(), n));
+			_free_nodes.push_back(n);
+		}
+		border.clear();
+		if (vertical ? cy + 1 >= _clusters_y : cx + 1 >= _clusters_x) return;
+
+		// The border runs along the last row or column of the cluster, next to the first one of its neighbor.
+		const size_t
+			length = vertical ? _width : _height,
+			begin = (vertical ? cx : cy) << ClusterShift,
+			end = std::min<>(begin + cluster_size, length),
+			line = ((vertical ? cy : cx) << ClusterShift) + cluster_size - 1;
+		const auto at = [&](size_t i, size_t side) { return vertical ? Point{ i, line + side } : Point{ line + side, i }; };
+		const auto entrance = [&](size_t i) {
+			const Point a = at(i, 0), b = at(i, 1);
+			return passable(map(a.x, a.y)) && passable(map(b.x, b.y));
+		};
+		const auto link = [&](const Point& from, const Point& to, float cost) {
+			const uint32_t a = addNode(from, uint32_t(cluster)), b = addNode(to, clusterOf(to));
+			_nodes[a].across = b;
+			_nodes[b].across = a;
+			_nodes[a].across_cost = _nodes[b].across_cost = cost;
+			border.push_back(a);
+			border.push_back(b);
+		};
+		const auto orthogonal = [&](size_t i) { link(at(i, 0), at(i, 1), 1.0f); };
+
+		// One node pair in the middle of the short runs, and one at each end of the long ones.
+		for (size_t i = begin; i < end;) {
+			if (!entrance(i)) {
+				i++;
+				continue;
+			}
+			size_t run_end = i + 1;
+			while (run_end < end && entrance(run_end)) run_end++;
+			if (run_end - i < 6) orthogonal(i + (run_end - i) / 2);
+			else {
+				orthogonal(i);
+				orthogonal(run_end - 1);
+			}
+			i = run_end;
+		}
+
+		// A diagonal move with a passable tile orthogonally adjacent to it can be replaced by 2 orthogonal moves through the entrances, so only the ones between 2 impassable tiles are linked.
+		// The right borders also link the diagonal moves across the corners of the cluster, which would otherwise be linked twice.
+		if (!diagonalLinks()) return;
+		for (size_t i = begin; i < end; i++) {
+			const Point a = at(i, 0);
+			if (!passable(map(a.x, a.y))) continue;
+			for (size_t j : { i - 1, i + 1 }) {
+				if (j >= length || (vertical && (j < begin || j >= end))) continue;
+				const Point b = at(j, 1), c = at(j, 0), d = at(i, 1);
+				if (passable(map(b.x, b.y)) && !passable(map(c.x, c.y)) && !passable(map(d.x, d.y))) link(a, b, detail::diagonal_cost);
+			}
+		}
+	}
+
+	// Replace the costs of the paths between the nodes of the cluster ([cx]; [cy]).
+	template<TileMapLike M, typename Passable>
+	void rebuildCosts(const M& map, Passable& passable, size_t cx, size_t cy)
+	{
+		const uint32_t cluster = uint32_t(cx + _clusters_x * cy);
+		const std::vector<uint32_t>& nodes = _cluster_nodes[cluster];
+		for (uint32_t n : nodes) _nodes[n].edges.clear();
+
+		for (size_t i = 0; i + 1 < nodes.size(); i++) {
+			_finder.findCosts(map, _nodes[nodes[i]].position, passable, clusterOptions(cluster));
+			for (size_t j = i + 1; j < nodes.size(); j++) {
+				const float cost = _finder.costTo(_nodes[nodes[j]].position);
+				if (cost == detail::no_path) continue;
+				_nodes[nodes[i]].edges.push_back({ nodes[j], cost });
+				_nodes[nodes[j]].edges.push_back({ nodes[i], cost });
+			}
+		}
+	}
+
+	// A* over the graph from [start_node] to [goal_node], setting _graph_path to the nodes of the path from the goal back to the start.
+	bool searchGraph(uint32_t start_node, uint32_t goal_node, const Point& goal)
+	{
+		const size_t count = _nodes.size() + 2;
+		_g.assign(count, detail::no_path);
+		_parent.assign(count, UINT32_MAX);
+		_closed.assign(count, false);
+		_open.clear();
+
+		const auto relax = [&](uint32_t n, uint32_t parent, float g) {
+			if (_closed[n] || g >= _g[n]) return;
+			_g[n] = g;
+			_parent[n] = parent;
+			const Point& p = n == goal_node ? goal : _nodes[n].position;
+			_open.push_back({ g + detail::pathDistance(p, goal, _options.eight_connected), n });
+			std::push_heap(_open.begin(), _open.end());
+		};
+		_g[start_node] = 0;
+		for (const Edge& edge : _start_edges) relax(edge.to, start_node, edge.cost);
+
+		while (!_open.empty()) {
+			std::pop_heap(_open.begin(), _open.end());
+			const uint32_t n = _open.back().node;
+			_open.pop_back();
+			if (_closed[n]) continue;
+			_closed[n] = true;
+
+			if (n == goal_node) {
+				_graph_path.clear();
+				for (uint32_t p = goal_node; p != UINT32_MAX; p = _parent[p]) _graph_path.push_back(p);
+				return true;
+			}
+
+			const Node& node = _nodes[n];
+			relax(node.across, n, _g[n] + node.across_cost);
+			for (const Edge& edge : node.edges) relax(edge.to, n, _g[n] + edge.cost);
+			if (_goal_costs[n] != detail::no_path) relax(goal_node, n, _g[n] + _goal_costs[n]);
+		}
+		return false;
+	}
+
+	PathOptions _options;
+	PathFinder _finder;
+	size_t _width = 0;
+	size_t _height = 0;
+	size_t _clusters_x = 0;
+	size_t _clusters_y = 0;
+	float _cost = 0;
+
+	std::vector<Node> _nodes;
+	std::vector<uint32_t> _free_nodes;
+	// Nodes of each cluster, and node pairs of the right then bottom border of each cluster.
+	std::vector<std::vector<uint32_t>> _cluster_nodes;
+	std::vector<std::vector<uint32_t>> _border_nodes;
+
+	// Buffers of the searches over the graph.
+	std::vector<Edge> _start_edges;
+	std::vector<float> _goal_costs;
+	std::vector<float> _g;
+	std::vector<uint32_t> _parent;
+	std::vector<bool> _closed;
+	std::vector<OpenNode> _open;
+	std::vector<uint32_t> _graph_path;
+};
+
+}; // |===|   END namespace tm2D   |===|
@@ -0,0 +1,410 @@
+#pragma once
+
+#include "TileMap2D.h"
+#include "TileMap2D_Parallel.h"
+
+#include <cmath>
+#include <vector>
+
+// Resampling of 2-dimensional tilemaps to other sizes, e.g. for minimaps and levels of detail, and mip chains of TileMap2D_1D.
+
+namespace tm2D
+{
+
+// How resample() computes the output tiles from the input tiles.
+enum class Filter
+{
+	// The input tile under the center of the output tile. Works with every tile type.
+	Nearest,
+	// The average of the input tiles covered by the output tile, e.g. of 2 x 2 tiles when halving both sides. Upscales like Nearest.
+	Box,
+	// Linear interpolation between the 2 x 2 input tiles around the center of the output tile. Downscales by more than 2 skip tiles: prefer Box for them.
+	Bilinear
+};
+
+namespace detail
+{
+
+// Number of 8-bit channels filtered separately in tiles of type [T]: 1 for 'uint8_t', 4 for 'uint32_t' (packed colors, e.g. RGBA), and 0 for other types.
+template<typename T>
+inline constexpr size_t byte_channels = std::same_as<T, uint8_t> ? 1 : std::same_as<T, uint32_t> ? 4 : 0;
+
+// Whether Box and Bilinear can filter tiles of type [T]: as packed 8-bit channels, or as arithmetic values.
+template<typename T>
+inline constexpr bool filterable = byte_channels<T> != 0 || std::is_arithmetic_v<T>;
+
+// Convert a filtered value back to a tile, rounding to the nearest integer for integral tiles.
+template<typename T>
+T filteredTile(double value)
+{
+	if constexpr (std::is_integral_v<T>) return T(std::floor(value + 0.5));
+	else return T(value);
+}
+
+// 2 input columns (or rows) of a bilinear sample, and the weight of the second one as a fraction and in 1/256.
+struct LinearTap
+{
+	size_t first;
+	size_t second;
+	double fraction;
+	uint32_t weight;
+};
+
+inline LinearTap linearTap(size_t i, size_t src_size, size_t dst_size)
+{
+	// Centers of the output tiles, in the coordinates of the centers of the input tiles.
+	const double s = std::max<>((double(i) + 0.5) * double(src_size) / double(dst_size) - 0.5, 0.0);
+	LinearTap tap;
+	tap.first = std::min<>(size_t(s), src_size - 1);
+	tap.second = std::min<>(tap.first + 1, src_size - 1);
+	tap.fraction = tap.first == tap.second ? 0.0 : s - double(tap.first);
+	tap.weight = uint32_t(std::lround(tap.fraction * 256.0));
+	return tap;
+}
+
+// First input column (or row) of the range covered by the output one [i] with Box, and the end of the range: at least 1 tile when upscaling.
+inline size_t boxBegin(size_t i, size_t src_size, size_t dst_size) { return i * src_size / dst_size; }
+inline size_t boxEnd(size_t i, size_t src_size, size_t dst_size) { return std::max<>(boxBegin(i, src_size, dst_size) + 1, (i + 1) * src_size / dst_size); }
+
+// Input columns read by every output column with a filter, shared by the rows.
+struct ResampleColumns
+{
+	// Nearest: the column under the center. Box: the first column of the range.
+	std::vector<size_t> begin;
+	// Box: the end of the range, and 1 / its width.
+	std::vector<size_t> end;
+	std::vector<double> scale;
+	// Bilinear: the columns around the center.
+	std::vector<LinearTap> taps;
+
+	ResampleColumns(Filter filter, size_t src_width, size_t dst_width)
+	{
+		switch (filter) {
+		case Filter::Nearest:
+			begin.resize(dst_width);
+			for (size_t x = 0; x < dst_width; x++) begin[x] = (2 * x + 1) * src_width / (2 * dst_width);
+			break;
+		case Filter::Box:
+			begin.resize(dst_width);
+			end.resize(dst_width);
+			scale.resize(dst_width);
+			for (size_t x = 0; x < dst_width; x++) {
+				begin[x] = boxBegin(x, src_width, dst_width);
+				end[x] = boxEnd(x, src_width, dst_width);
+				scale[x] = 1.0 / double(end[x] - begin[x]);
+			}
+			break;
+		case Filter::Bilinear:
+			taps.resize(dst_width);
+			for (size_t x = 0; x < dst_width; x++) taps[x] = linearTap(x, src_width, dst_width);
+			break;
+		}
+	}
+};
+
+// Get the row [y] of [map], read in place if it is contiguous, otherwise copied to [copy].
+template<TileMapLike M>
+const tile_t<M>* readRow(const M& map, size_t y, std::vector<tile_t<M>>& copy)
+{
+	if constexpr (ContiguousTileMap<M>) return rowData(map, y);
+	else {
+		copy.resize(map.width());
+		for (size_t x = 0; x < copy.size(); x++) copy[x] = map(x, y);
+		return copy.data();
+	}
+}
+
+// Get the tiles to write the row [y] of [map] to: the row itself if it is contiguous, otherwise [buffer], written to the row by flushRow().
+template<TileMapLike M>
+tile_t<M>* writeRow(M& map, size_t y, std::vector<tile_t<M>>& buffer)
+{
+	if constexpr (ContiguousTileMap<M>) return rowData(map, y);
+	else {
+		buffer.resize(map.width());
+		return buffer.data();
+	}
+}
+
+template<TileMapLike M>
+void flushRow(M& map, size_t y, const std::vector<tile_t<M>>& buffer)
+{
+	if constexpr (!ContiguousTileMap<M>)
+		for (size_t x = 0; x < buffer.size(); x++) map(x, y) = buffer[x];
+}
+
+// Average the 2 x 2 blocks of tiles of [Channels] bytes of the rows [row0] and [row1] into the [count] tiles of [dst], rounding to the nearest.
+template<size_t Channels>
+void halveRows(uint8_t* dst, const uint8_t* row0, const uint8_t* row1, size_t count)
+{
+	const size_t bytes = count * Channels;
+	size_t i = 0;
+#if TM2D_SSE2
+	// 16 output bytes from 32 bytes of each row, summed as 16-bit integers.
+	const __m128i zero = _mm_setzero_si128(), two = _mm_set1_epi16(2);
+	const auto sums = [&](const uint8_t* a, const uint8_t* b) {
+		const __m128i va = _mm_loadu_si128((const __m128i*)a), vb = _mm_loadu_si128((const __m128i*)b);
+		__m128i s;
+		if constexpr (Channels == 1) {
+			const __m128i even = _mm_set1_epi16(0x00FF);
+			s = _mm_add_epi16(
+				_mm_add_epi16(_mm_and_si128(va, even), _mm_srli_epi16(va, 8)),
+				_mm_add_epi16(_mm_and_si128(vb, even), _mm_srli_epi16(vb, 8)));
+		}
+		else {
+			// The 2 tiles of each half of the rows are added after the rows are.
+			const __m128i
+				low = _mm_add_epi16(_mm_unpacklo_epi8(va, zero), _mm_unpacklo_epi8(vb, zero)),
+				high = _mm_add_epi16(_mm_unpackhi_epi8(va, zero), _mm_unpackhi_epi8(vb, zero));
+			s = _mm_add_epi16(_mm_unpacklo_epi64(low, high), _mm_unpackhi_epi64(low, high));
+		}
+		return _mm_srli_epi16(_mm_add_epi16(s, two), 2);
+	};
+	for (; i + 16 <= bytes; i += 16) {
+		const __m128i low = sums(row0 + 2 * i, row1 + 2 * i), high = sums(row0 + 2 * i + 16, row1 + 2 * i + 16);
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(low, high));
+	}
+#elif TM2D_NEON
+	// 16 output bytes from 32 bytes of each row, with rounding narrowing shifts of the 16-bit sums.
+	const auto sums = [&](const uint8_t* a, const uint8_t* b) {
+		const uint8x16_t va = vld1q_u8(a), vb = vld1q_u8(b);
+		if constexpr (Channels == 1) return vrshrn_n_u16(vaddq_u16(vpaddlq_u8(va), vpaddlq_u8(vb)), 2);
+		else {
+			const uint16x8_t
+				low = vaddl_u8(vget_low_u8(va), vget_low_u8(vb)),
+				high = vaddl_u8(vget_high_u8(va), vget_high_u8(vb));
+			return vrshrn_n_u16(vcombine_u16(vadd_u16(vget_low_u16(low), vget_high_u16(low)), vadd_u16(vget_low_u16(high), vget_high_u16(high))), 2);
+		}
+	};
+	for (; i + 16 <= bytes; i += 16)
+		vst1q_u8(dst + i, vcombine_u8(sums(row0 + 2 * i, row1 + 2 * i), sums(row0 + 2 * i + 16, row1 + 2 * i + 16)));
+#endif
+	for (; i < bytes; i++) {
+		const size_t s = 2 * (i - i % Channels) + i % Channels;
+		dst[i] = uint8_t((row0[s] + row0[s + Channels] + row1[s] + row1[s + Channels] + 2) >> 2);
+	}
+}
+
+// Compute the rows [y_begin; y_end) of [output] from [input] with [filter]. See resample().
+template<TileMapLike Out, TileMapLike In>
+void resampleRows(Out& output, const In& input, Filter filter, const ResampleColumns& columns, size_t y_begin, size_t y_end)
+{
+	using T = tile_t<In>;
+	constexpr size_t channels = byte_channels<T>;
+	const size_t src_width = input.width(), src_height = input.height(), dst_width = output.width(), dst_height = output.height();
+	std::vector<T> copy0, copy1, buffer;
+
+	if (filter == Filter::Nearest) {
+		size_t previous_y = SIZE_MAX;
+		for (size_t y = y_begin; y < y_end; y++) {
+			const size_t src_y = (2 * y + 1) * src_height / (2 * dst_height);
+			T* const dst = writeRow(output, y, buffer);
+			// Upscaled rows repeat the previous row. Non-contiguous rows are still in [buffer].
+			if (src_y == previous_y) {
+				if constexpr (ContiguousTileMap<Out>) copyRow(dst, rowData(output, y - 1), dst_width);
+			}
+			else {
+				const T* const src = readRow(input, src_y, copy0);
+				for (size_t x = 0; x < dst_width; x++) dst[x] = src[columns.begin[x]];
+			}
+			flushRow(output, y, buffer);
+			previous_y = src_y;
+		}
+		return;
+	}
+
+	if constexpr (filterable<T>) {
+		if (filter == Filter::Box) {
+			if (src_width == 2 * dst_width && src_height == 2 * dst_height) {
+				for (size_t y = y_begin; y < y_end; y++) {
+					const T* const row0 = readRow(input, 2 * y, copy0);
+					const T* const row1 = readRow(input, 2 * y + 1, copy1);
+					T* const dst = writeRow(output, y, buffer);
+					if constexpr (channels != 0) halveRows<channels>((uint8_t*)dst, (const uint8_t*)row0, (const uint8_t*)row1, dst_width);
+					else {
+						for (size_t x = 0; x < dst_width; x++)
+							dst[x] = filteredTile<T>((double(row0[2 * x]) + double(row0[2 * x + 1]) + double(row1[2 * x]) + double(row1[2 * x + 1])) * 0.25);
+					}
+					flushRow(output, y, buffer);
+				}
+				return;
+			}
+
+			// The rows of the range of each output row are summed first, then the columns of the range of each output tile.
+			using Sum = std::conditional_t<channels != 0, uint32_t, double>;
+			const size_t values = src_width * std::max<size_t>(channels, 1);
+			std::vector<Sum> sums(values);
+			for (size_t y = y_begin; y < y_end; y++) {
+				const size_t src_y = boxBegin(y, src_height, dst_height), src_y_end = boxEnd(y, src_height, dst_height);
+				std::fill(sums.begin(), sums.end(), Sum(0));
+				for (size_t row_y = src_y; row_y < src_y_end; row_y++) {
+					const T* const src = readRow(input, row_y, copy0);
+					if constexpr (channels != 0) {
+						const uint8_t* const bytes = (const uint8_t*)src;
+						for (size_t i = 0; i < values; i++) sums[i] += bytes[i];
+					}
+					else for (size_t i = 0; i < values; i++) sums[i] += double(src[i]);
+				}
+
+				T* const dst = writeRow(output, y, buffer);
+				const size_t rows = src_y_end - src_y;
+				const double row_scale = 1.0 / double(rows);
+				for (size_t x = 0; x < dst_width; x++) {
+					const size_t src_x = columns.begin[x], src_x_end = columns.end[x];
+					const double scale = columns.scale[x] * row_scale;
+					if constexpr (channels != 0) {
+						uint64_t channel_sums[channels] = {};
+						for (size_t i = src_x; i < src_x_end; i++)
+							for (size_t c = 0; c < channels; c++) channel_sums[c] += sums[channels * i + c];
+						// Multiplying by the reciprocal rounds like '(sum + count / 2) / count': the half added keeps the product away from the integers.
+						const double bias = double(((src_x_end - src_x) * rows) / 2) + 0.5;
+						uint8_t* const tile = (uint8_t*)(dst + x);
+						for (size_t c = 0; c < channels; c++) tile[c] = uint8_t((double(channel_sums[c]) + bias) * scale);
+					}
+					else {
+						double sum = 0;
+						for (size_t i = src_x; i < src_x_end; i++) sum += sums[i];
+						dst[x] = filteredTile<T>(sum * scale);
+					}
+				}
+				flushRow(output, y, buffer);
+			}
+			return;
+		}
+
+		// Bilinear: the 2 rows around each output row are interpolated first, then the 2 columns around each output tile.
+		// 8-bit channels are interpolated with 8-bit fixed-point weights.
+		using Value = std::conditional_t<channels != 0, uint16_t, double>;
+		const size_t values = src_width * std::max<size_t>(channels, 1);
+		std::vector<Value> row(values);
+		for (size_t y = y_begin; y < y_end; y++) {
+			const LinearTap tap = linearTap(y, src_height, dst_height);
+			const T* const src0 = readRow(input, tap.first, copy0);
+			const T* const src1 = readRow(input, tap.second, copy1);
+			if constexpr (channels != 0) {
+				const uint8_t* const bytes0 = (const uint8_t*)src0;
+				const uint8_t* const bytes1 = (const uint8_t*)src1;
+				const uint16_t w1 = uint16_t(tap.weight), w0 = uint16_t(256 - tap.weight);
+				for (size_t i = 0; i < values; i++) row[i] = uint16_t(bytes0[i] * w0 + bytes1[i] * w1);
+			}
+			else for (size_t i = 0; i < values; i++) row[i] = double(src0[i]) + (double(src1[i]) - double(src0[i])) * tap.fraction;
+
+			T* const dst = writeRow(output, y, buffer);
+			for (size_t x = 0; x < dst_width; x++) {
+				const LinearTap& column = columns.taps[x];
+				if constexpr (channels != 0) {
+					uint8_t* const tile = (uint8_t*)(dst + x);
+					const uint32_t w1 = column.weight, w0 = 256 - column.weight;
+					for (size_t c = 0; c < channels; c++)
+						tile[c] = uint8_t((row[channels * column.first + c] * w0 + row[channels * column.second + c] * w1 + 32768) >> 16);
+				}
+				else dst[x] = filteredTile<T>(row[column.first] + (row[column.second] - row[column.first]) * column.fraction);
+			}
+			flushRow(output, y, buffer);
+		}
+	}
+}
+
+}; // namespace detail
+
+// Resample [input] to [new_width] x [new_height] tiles in [output] with [filter], following [policy].
+// Box and Bilinear filter 'uint8_t' tiles, and 'uint32_t' tiles as 4 packed 8-bit channels (e.g. RGBA colors), with integer arithmetic: halving
+// both sides with Box (mip levels) runs SIMD kernels. They filter other arithmetic tiles as values, rounded to the nearest for integral types.
+// Rows are computed in parallel bands with the parallel policy. [output] must not share its buffer with [input].
+// Returns:
+//   'false' if [filter] can't filter the tiles (only Nearest works for non-arithmetic tiles), in which case [output] is left unchanged.
+template<ExecutionPolicy P, ResizableTileMapLike Out, TileMapLike In>
+	requires std::same_as<tile_t<Out>, tile_t<In>>
+bool resample(
+	const P& policy,
+	Out* output,
+	const In* input,
+	size_t new_width,
+	size_t new_height,
+	Filter filter = Filter::Box
+) {
+	if constexpr (!detail::filterable<tile_t<In>>) {
+		if (filter != Filter::Nearest) return false;
+	}
+	TM2D_INSTRUMENT_SCOPE(Resample);
+	const size_t width = input->width(), height = input->height();
+	if (!width || !height) {
+		output->reset(new_width, new_height, {});
+		return true;
+	}
+	detail::resetForOverwrite(*output, new_width, new_height);
+	if (!new_width || !new_height) return true;
+	TM2D_INSTRUMENT_COUNT(new_width * new_height, new_width * new_height * sizeof(tile_t<Out>));
+	const auto write_policy = detail::prepareConcurrentWrite(policy, *output, { 0, 0, new_width, new_height });
+
+	// Every filter keeps the tiles of a tilemap of the same size.
+	if (new_width == width && new_height == height) {
+		detail::forRowBands(write_policy, width * height, height, [&](size_t y_begin, size_t y_end) {
+			detail::copyArea(*output, *input, 0, y_begin, { 0, y_begin, width, y_end - y_begin });
+		});
+		return true;
+	}
+
+	const detail::ResampleColumns columns(filter, width, new_width);
+	detail::forRowBands(write_policy, new_width * new_height, new_height, [&](size_t y_begin, size_t y_end) {
+		detail::resampleRows(*output, *input, filter, columns, y_begin, y_end);
+	});
+	return true;
+}
+
+// Resample [input] to [new_width] x [new_height] tiles in [output] with [filter]. See resample() with an execution policy.
+template<ResizableTileMapLike Out, TileMapLike In>
+	requires std::same_as<tile_t<Out>, tile_t<In>>
+bool resample(
+	Out* output,
+	const In* input,
+	size_t new_width,
+	size_t new_height,
+	Filter filter = Filter::Box
+) {
+	return resample(execution::seq, output, input, new_width, new_height, filter);
+}
+
+// Build the mip chain of [map] in [levels], following [policy]: each level halves the width and height of the previous one (rounding down, down to 1),
+// starting from [map] and ending at 1 x 1 tile or after [max_levels] levels. Each level is resampled from the previous one with [filter]. See resample().
+// The tilemaps already in [levels] are reused, so that rebuilding the chain of a tilemap of the same size does not allocate.
+// Returns:
+//   'false' if [filter] can't filter the tiles, in which case [levels] is left unchanged.
+template<ExecutionPolicy P, typename T, typename A, typename L>
+bool buildMipChain(
+	const P& policy,
+	std::vector<TileMap2D_1D<T, A, L>>* levels,
+	const TileMap2D_1D<T, A, L>* map,
+	Filter filter = Filter::Box,
+	size_t max_levels = SIZE_MAX
+) {
+	if constexpr (!detail::filterable<T>) {
+		if (filter != Filter::Nearest) return false;
+	}
+	size_t count = 0;
+	for (size_t width = map->width(), height = map->height(); (width > 1 || height > 1) && count < max_levels; count++) {
+		width = std::max<size_t>(width / 2, 1);
+		height = std::max<size_t>(height / 2, 1);
+	}
+	if (!map->width() || !map->height()) count = 0;
+	levels->resize(count, TileMap2D_1D<T, A, L>(map->get_allocator()));
+
+	const TileMap2D_1D<T, A, L>* previous = map;
+	for (TileMap2D_1D<T, A, L>& level : *levels) {
+		resample(policy, &level, previous, std::max<size_t>(previous->width() / 2, 1), std::max<size_t>(previous->height() / 2, 1), filter);
+		previous = &level;
+	}
+	return true;
+}
+
+// Build the mip chain of [map] in [levels]. See buildMipChain() with an execution policy.
+template<typename T, typename A, typename L>
+bool buildMipChain(
+	std::vector<TileMap2D_1D<T, A, L>>* levels,
+	const TileMap2D_1D<T, A, L>* map,
+	Filter filter = Filter::Box,
+	size_t max_levels = SIZE_MAX
+) {
+	return buildMipChain(execution::seq, levels, map, filter, max_levels);
+}
+
+}; // |===|   END namespace tm2D   |===|
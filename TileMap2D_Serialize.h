@@ -0,0 +1,506 @@
+#pragma once
+
+#include "TileMap2D.h"
+
+#include <istream>
+#include <ostream>
+#include <cstdint>
+#include <cstring>
+
+// Compact binary serialization of 2-dimensional tilemaps, with per-chunk compression and a chunk index for partial loading.
+//
+// Layout of a stream:
+//   SerializeHeader
+//   Encoded chunks, in row-major chunk order
+//   Chunk index: a SerializeChunkEntry per chunk, in the same order
+//   SerializeTrailer, locating the chunk index
+// Offsets are relative to the start of the header, which records the size of the whole serialized tilemap so that it can be embedded in a larger stream.
+// Fields and tiles are stored in the native byte order.
+
+namespace tm2D
+{
+
+// How the tiles of a chunk are encoded.
+enum class ChunkEncoding : uint32_t
+{
+	// Row-major raw tiles.
+	Raw = 0,
+	// Row-major tiles as runs: a LEB128 varint 'n', then either 'n / 2 + 1' literal tiles (even 'n') or a tile repeated 'n / 2 + 1' times (odd 'n').
+	// A run holds at most 'rle_max_run' tiles, which bounds the number of tiles a chunk of a given size can decode to.
+	RLE = 1,
+};
+
+// Header at the start of a serialized tilemap.
+struct SerializeHeader
+{
+	static constexpr uint32_t current_version = 2;
+	static constexpr uint32_t native_byte_order = 0x01020304;
+
+	char magic[4] = { 'T', 'M', '2', 'S' };
+	uint32_t version = current_version;
+	uint32_t byte_order = native_byte_order;
+	// Size in bytes of a tile.
+	uint32_t tile_size = 0;
+	uint64_t width = 0;
+	uint64_t height = 0;
+	// Width and height of a chunk in tiles. The chunks on the right and bottom edges are clipped to the tilemap.
+	uint32_t chunk_size = 0;
+	uint32_t reserved = 0;
+	// Size in bytes of the serialized tilemap, from the start of the header to the end of the trailer.
+	uint64_t size = 0;
+};
+static_assert(sizeof(SerializeHeader) == 48);
+
+// Location of an encoded chunk.
+struct SerializeChunkEntry
+{
+	uint64_t offset = 0;
+	uint64_t size = 0;
+	ChunkEncoding encoding = ChunkEncoding::Raw;
+	uint32_t reserved = 0;
+};
+static_assert(sizeof(SerializeChunkEntry) == 24);
+
+// End of a serialized tilemap.
+struct SerializeTrailer
+{
+	uint64_t index_offset = 0;
+	char magic[4] = { 'T', 'M', '2', 'I' };
+	uint32_t reserved = 0;
+};
+static_assert(sizeof(SerializeTrailer) == 16);
+
+struct SerializeOptions
+{
+	// Width and height of a chunk in tiles, which is the granularity of partial loading.
+	size_t chunk_size = 64;
+	// If true, chunks are RLE-encoded when it makes them smaller.
+	bool compress = true;
+};
+
+// Maximum number of tiles in a run of ChunkEncoding::RLE.
+constexpr size_t rle_max_run = size_t(1) << 16;
+
+namespace detail
+{
+
+// Encoded bytes appended to a buffer.
+struct ByteBuffer
+{
+	std::vector<unsigned char> bytes;
+
+	void append(const void* data, size_t size) { bytes.insert(bytes.end(), (const unsigned char*)data, (const unsigned char*)data + size); }
+	uint64_t size() const { return bytes.size(); }
+};
+
+// Encoded bytes only counted, to size an encoding without producing it.
+struct ByteCounter
+{
+	uint64_t count = 0;
+
+	void append(const void*, size_t size) { count += size; }
+	uint64_t size() const { return count; }
+};
+
+// Append [value] to [out] (a ByteBuffer or a ByteCounter) as a LEB128 varint.
+template<typename Sink>
+void writeVarint(Sink& out, uint64_t value)
+{
+	unsigned char bytes[10];
+	size_t size = 0;
+	for (; value >= 0x80; value >>= 7) bytes[size++] = (unsigned char)(value | 0x80);
+	bytes[size++] = (unsigned char)value;
+	out.append(bytes, size);
+}
+
+// Read a LEB128 varint from [in], which is advanced past it. Fails past [end].
+inline bool readVarint(const unsigned char*& in, const unsigned char* end, uint64_t& value)
+{
+	value = 0;
+	for (unsigned shift = 0; in != end && shift < 64; shift += 7) {
+		const unsigned char byte = *in++;
+		value |= uint64_t(byte & 0x7f) << shift;
+		if (!(byte & 0x80)) return true;
+	}
+	return false;
+}
+
+// Append the [count] tiles at [tiles] to [out] (a ByteBuffer or a ByteCounter) with ChunkEncoding::RLE. Tiles are compared bytewise.
+template<typename T, typename Sink>
+void encodeRLE(Sink& out, const T* tiles, size_t count)
+{
+	const auto equal = [&](size_t a, size_t b) { return std::memcmp(tiles + a, tiles + b, sizeof(T)) == 0; };
+	const auto append = [&](const T* begin, size_t n) { out.append(begin, n * sizeof(T)); };
+
+	size_t literal = 0;
+	const auto flushLiteral = [&](size_t end) {
+		for (size_t n; literal != end; literal += n) {
+			n = std::min(end - literal, rle_max_run);
+			writeVarint(out, (n - 1) * 2);
+			append(tiles + literal, n);
+		}
+	};
+
+	for (size_t i = 0; i < count;) {
+		size_t run = 1;
+		while (i + run < count && run < rle_max_run && equal(i, i + run)) run++;
+
+		// Runs of 2 tiles are only worth it for tiles larger than the varint.
+		if (run >= 3 || (run == 2 && sizeof(T) > 1)) {
+			flushLiteral(i);
+			writeVarint(out, (run - 1) * 2 + 1);
+			append(tiles + i, 1);
+			literal = i + run;
+		}
+		i += run;
+	}
+	flushLiteral(count);
+}
+
+// Decode [count] tiles encoded with ChunkEncoding::RLE from [in] to [tiles]. Fails if [in] does not hold exactly [count] tiles.
+template<typename T>
+bool decodeRLE(const unsigned char* in, size_t size, T* tiles, size_t count)
+{
+	const unsigned char* const end = in + size;
+	size_t i = 0;
+
+	while (in != end) {
+		uint64_t header;
+		if (!readVarint(in, end, header)) return false;
+		const uint64_t n = header / 2 + 1;
+		if (n > rle_max_run || n > count - i) return false;
+
+		if (header & 1) {
+			if (size_t(end - in) < sizeof(T)) return false;
+			T tile;
+			std::memcpy(&tile, in, sizeof(T));
+			in += sizeof(T);
+			std::fill(tiles + i, tiles + i + n, tile);
+		}
+		else {
+			if (size_t(end - in) / sizeof(T) < n) return false;
+			std::memcpy(tiles + i, in, n * sizeof(T));
+			in += n * sizeof(T);
+		}
+		i += (size_t)n;
+	}
+	return i == count;
+}
+
+// Whether a chunk of [count] tiles of type [T] can be encoded by [entry], without decoding it.
+template<typename T>
+bool chunkEntryFits(const SerializeChunkEntry& entry, uint64_t count)
+{
+	if (entry.encoding == ChunkEncoding::Raw) return entry.size % sizeof(T) == 0 && entry.size / sizeof(T) == count;
+	// A run takes at least a byte of varint and a tile, and holds at most 'rle_max_run' tiles.
+	return entry.encoding == ChunkEncoding::RLE && (count + rle_max_run - 1) / rle_max_run <= entry.size / (1 + sizeof(T));
+}
+
+template<typename T>
+bool writeBytes(std::ostream& out, const T* data, size_t count = 1)
+{
+	return (bool)out.write((const char*)data, std::streamsize(sizeof(T) * count));
+}
+
+template<typename T>
+bool readBytes(std::istream& in, T* data, size_t count = 1)
+{
+	return (bool)in.read((char*)data, std::streamsize(sizeof(T) * count));
+}
+
+// Get the number of bytes of the seekable stream [in] from its current position into [size], leaving the position unchanged.
+// This bounds the sizes read from untrusted headers before anything is allocated from them.
+inline bool remainingBytes(std::istream& in, uint64_t* size)
+{
+	const std::streamoff position = in.tellg();
+	if (position < 0 || !in.seekg(0, std::ios::end)) return false;
+	const std::streamoff end = in.tellg();
+	if (end < position || !in.seekg(position)) return false;
+	*size = uint64_t(end - position);
+	return true;
+}
+
+}; // namespace detail
+
+// Serialize [map] to [out], as chunks compressed following [options].
+// On seekable streams, each chunk is encoded once and the header is written last, seeking back to it.
+// Other streams are only written sequentially: a first pass counts the sizes of the encoded chunks without producing them, so that the header can be written first.
+// Returns false if writing fails.
+template<TileMapLike M>
+	requires std::is_trivially_copyable_v<tile_t<M>>
+bool writeTileMap(std::ostream& out, const M& map, const SerializeOptions& options = {})
+{
+	using T = tile_t<M>;
+
+	SerializeHeader header;
+	header.tile_size = sizeof(T);
+	header.width = map.width();
+	header.height = map.height();
+	header.chunk_size = (uint32_t)std::clamp<size_t>(options.chunk_size, 1, UINT32_MAX);
+
+	const size_t chunk_size = header.chunk_size;
+	const size_t chunks_x = (map.width() + chunk_size - 1) / chunk_size, chunks_y = (map.height() + chunk_size - 1) / chunk_size;
+
+	std::vector<SerializeChunkEntry> index(chunks_x * chunks_y);
+	std::vector<T> tiles;
+	detail::ByteBuffer encoded;
+
+	// Copy the chunk ([cx]; [cy]) to 'tiles', and RLE-encode it to [sink] if compressing.
+	// Returns the entry of the chunk at [offset], RLE-encoded if that makes it smaller.
+	const auto encodeChunk = [&](size_t cx, size_t cy, uint64_t offset, auto& sink) {
+		const Rect area = Rect(cx * chunk_size, cy * chunk_size, chunk_size, chunk_size).intersection({ 0, 0, map.width(), map.height() });
+		tiles.resize(area.width * area.height);
+		TileMap2DView<T> chunk(tiles.data(), area.width, area.height);
+		detail::copyArea(chunk, map, 0, 0, area);
+
+		if (options.compress) detail::encodeRLE(sink, tiles.data(), tiles.size());
+		const uint64_t rle_size = sink.size();
+
+		SerializeChunkEntry entry;
+		entry.offset = offset;
+		entry.size = tiles.size() * sizeof(T);
+		if (options.compress && rle_size < entry.size) {
+			entry.encoding = ChunkEncoding::RLE;
+			entry.size = rle_size;
+		}
+		return entry;
+	};
+	const auto writeChunk = [&](const SerializeChunkEntry& entry) {
+		return entry.encoding == ChunkEncoding::RLE ? detail::writeBytes(out, encoded.bytes.data(), encoded.bytes.size()) : detail::writeBytes(out, tiles.data(), tiles.size());
+	};
+
+	const std::streampos start = out.tellp();
+	const bool seekable = start != std::streampos(-1);
+	uint64_t offset = sizeof(SerializeHeader);
+
+	if (seekable) {
+		if (!detail::writeBytes(out, &header)) return false;
+		for (size_t i = 0; i < index.size(); i++) {
+			encoded.bytes.clear();
+			index[i] = encodeChunk(i % chunks_x, i / chunks_x, offset, encoded);
+			if (!writeChunk(index[i])) return false;
+			offset += index[i].size;
+		}
+	}
+	else {
+		for (size_t i = 0; i < index.size(); i++) {
+			detail::ByteCounter counter;
+			index[i] = encodeChunk(i % chunks_x, i / chunks_x, offset, counter);
+			offset += index[i].size;
+		}
+	}
+
+	SerializeTrailer trailer;
+	trailer.index_offset = offset;
+	header.size = offset + index.size() * sizeof(SerializeChunkEntry) + sizeof(SerializeTrailer);
+
+	if (seekable) {
+		if (!detail::writeBytes(out, index.data(), index.size()) || !detail::writeBytes(out, &trailer)) return false;
+		const std::streampos end = out.tellp();
+		return end != std::streampos(-1) && out.seekp(start) && detail::writeBytes(out, &header) && out.seekp(end);
+	}
+
+	if (!detail::writeBytes(out, &header)) return false;
+	for (size_t i = 0; i < index.size(); i++) {
+		encoded.bytes.clear();
+		if (!writeChunk(encodeChunk(i % chunks_x, i / chunks_x, index[i].offset, encoded))) return false;
+	}
+	return detail::writeBytes(out, index.data(), index.size()) && detail::writeBytes(out, &trailer);
+}
+
+// Reader of serialized tilemaps, decoding only the chunks overlapping the requested areas.
+// The input stream must be seekable, and is read from as long as the reader is used.
+template<typename T>
+	requires std::is_trivially_copyable_v<T>
+struct TileMapReader
+{
+	TileMapReader() {}
+
+	// Read the header and the chunk index of the serialized tilemap starting at the current position of [in].
+	// Fails if it is not a serialized tilemap of tiles of the size of [T] in the native byte order, or if it does not fit in the rest of [in].
+	bool open(std::istream& in)
+	{
+		close();
+
+		// The rest of the stream bounds everything read from it before anything is allocated.
+		const std::streamoff base = in.tellg();
+		uint64_t available;
+		if (base < 0 || !detail::remainingBytes(in, &available)) return false;
+
+		SerializeHeader header;
+		if (!detail::readBytes(in, &header)) return false;
+		if (
+			std::memcmp(header.magic, SerializeHeader().magic, sizeof(header.magic)) != 0 ||
+			header.version != SerializeHeader::current_version ||
+			header.byte_order != SerializeHeader::native_byte_order ||
+			header.tile_size != sizeof(T) ||
+			header.chunk_size == 0 ||
+			header.size < sizeof(SerializeHeader) + sizeof(SerializeTrailer) || header.size > available ||
+			header.width > SIZE_MAX || header.height > SIZE_MAX ||
+			(header.height != 0 && header.width > SIZE_MAX / header.height)
+		) return false;
+
+		const uint64_t chunks_x = header.width / header.chunk_size + (header.width % header.chunk_size != 0);
+		const uint64_t chunks_y = header.height / header.chunk_size + (header.height % header.chunk_size != 0);
+
+		// The trailer ends the serialized tilemap, and the chunk index fills the space before it.
+		SerializeTrailer trailer;
+		if (
+			!in.seekg(base + std::streamoff(header.size - sizeof(SerializeTrailer))) ||
+			!detail::readBytes(in, &trailer) ||
+			std::memcmp(trailer.magic, SerializeTrailer().magic, sizeof(trailer.magic)) != 0 ||
+			trailer.index_offset < sizeof(SerializeHeader) || trailer.index_offset > header.size - sizeof(SerializeTrailer)
+		) return false;
+
+		const uint64_t index_size = header.size - sizeof(SerializeTrailer) - trailer.index_offset;
+		if (
+			index_size % sizeof(SerializeChunkEntry) != 0 ||
+			(chunks_y != 0 && chunks_x > index_size / sizeof(SerializeChunkEntry) / chunks_y) ||
+			chunks_x * chunks_y != index_size / sizeof(SerializeChunkEntry)
+		) return false;
+
+		std::vector<SerializeChunkEntry> index((size_t)(chunks_x * chunks_y));
+		if (
+			!in.seekg(base + std::streamoff(trailer.index_offset)) ||
+			!detail::readBytes(in, index.data(), index.size())
+		) return false;
+
+		for (uint64_t cy = 0; cy < chunks_y; cy++) {
+			const uint64_t chunk_height = std::min<uint64_t>(header.chunk_size, header.height - cy * header.chunk_size);
+			for (uint64_t cx = 0; cx < chunks_x; cx++) {
+				const uint64_t chunk_width = std::min<uint64_t>(header.chunk_size, header.width - cx * header.chunk_size);
+				const SerializeChunkEntry& entry = index[cx + chunks_x * cy];
+				if (
+					entry.offset < sizeof(SerializeHeader) || entry.offset > trailer.index_offset ||
+					entry.size > trailer.index_offset - entry.offset ||
+					!detail::chunkEntryFits<T>(entry, chunk_width * chunk_height)
+				) return false;
+			}
+		}
+
+		_in = &in;
+		_base = base;
+		_header = header;
+		_chunks_x = (size_t)chunks_x;
+		_chunks_y = (size_t)chunks_y;
+		_index = std::move(index);
+		return true;
+	}
+
+	// Stop using the input stream.
+	void close()
+	{
+		_in = NULL;
+		_header = {};
+		_chunks_x = _chunks_y = 0;
+		_index.clear();
+	}
+
+	bool isOpen() const { return _in != NULL; }
+
+	const SerializeHeader& header() const { return _header; }
+
+	size_t width() const { return (size_t)_header.width; }
+	size_t height() const { return (size_t)_header.height; }
+
+	// Decode the chunk of the serialized tilemap with the size of [src_area] into [output], like tm2D::getChunk().
+	// Returns false if the stream can't be read or is corrupted.
+	template<ResizableTileMapLike Out>
+		requires std::same_as<tile_t<Out>, T>
+	bool getChunk(Out* output, const Rect& src_area)
+	{
+		const Rect src_cliprect = src_area.intersection({ 0, 0, width(), height() });
+		if (src_cliprect == src_area) detail::resetForOverwrite(*output, src_area.width, src_area.height);
+		else output->reset(src_area.width, src_area.height, {});
+
+		return decodeArea(*output, 0, 0, src_cliprect);
+	}
+
+	// Decode [src_area] of the serialized tilemap into [output] at ([x]; [y]), like tm2D::setChunk().
+	// Only the chunks overlapping the area are read. Returns false if the stream can't be read or is corrupted.
+	// Parameters:
+	//   [src_area]: Source area to decode. Default value is the whole serialized tilemap.
+	template<TileMapLike Out>
+		requires std::same_as<tile_t<Out>, T>
+	bool setChunk(Out* output, size_t x, size_t y, Rect src_area = {})
+	{
+		if (src_area == Rect(0, 0, 0, 0))
+			src_area = { 0, 0, width(), height() };
+
+		// Clip to the tilemap, then to the part landing in [output].
+		Rect src_cliprect = src_area.intersection({ 0, 0, width(), height() });
+		const Rect dst_cliprect = Rect(x, y, src_cliprect.width, src_cliprect.height).intersection({ 0, 0, output->width(), output->height() });
+		src_cliprect.width = dst_cliprect.width;
+		src_cliprect.height = dst_cliprect.height;
+
+		return decodeArea(*output, dst_cliprect.x, dst_cliprect.y, src_cliprect);
+	}
+
+private:
+	// Decode [src_cliprect], which is within the tilemap, into [output] at ([dst_x]; [dst_y]).
+	template<TileMapLike Out>
+	bool decodeArea(Out& output, size_t dst_x, size_t dst_y, const Rect& src_cliprect)
+	{
+		if (!_in) return false;
+		if (!src_cliprect.width || !src_cliprect.height) return true;
+
+		const size_t chunk_size = _header.chunk_size;
+		for (size_t cy = src_cliprect.y / chunk_size; cy <= (src_cliprect.y + src_cliprect.height - 1) / chunk_size; cy++) {
+			for (size_t cx = src_cliprect.x / chunk_size; cx <= (src_cliprect.x + src_cliprect.width - 1) / chunk_size; cx++) {
+				const Rect chunk_area = Rect(cx * chunk_size, cy * chunk_size, chunk_size, chunk_size).intersection({ 0, 0, width(), height() });
+				if (!decodeChunk(cx, cy, chunk_area)) return false;
+
+				const Rect area = chunk_area.intersection(src_cliprect);
+				const TileMap2DView<T> chunk(_tiles.data(), chunk_area.width, chunk_area.height);
+				detail::copyArea(output, chunk,
+					dst_x + (area.x - src_cliprect.x), dst_y + (area.y - src_cliprect.y),
+					{ area.x - chunk_area.x, area.y - chunk_area.y, area.width, area.height }
+				);
+			}
+		}
+		return true;
+	}
+
+	// Decode the chunk ([cx]; [cy]) covering [chunk_area] into '_tiles'.
+	// open() checked that the entry fits the chunk, so the buffers are bounded by the size of the entry.
+	bool decodeChunk(size_t cx, size_t cy, const Rect& chunk_area)
+	{
+		const SerializeChunkEntry& entry = _index[cx + _chunks_x * cy];
+		const size_t count = chunk_area.width * chunk_area.height;
+		_tiles.resize(count);
+
+		if (!_in->seekg(_base + std::streamoff(entry.offset))) return false;
+
+		if (entry.encoding == ChunkEncoding::Raw) {
+			return detail::readBytes(*_in, _tiles.data(), count);
+		}
+		else {
+			_encoded.resize((size_t)entry.size);
+			return
+				detail::readBytes(*_in, _encoded.data(), _encoded.size()) &&
+				detail::decodeRLE(_encoded.data(), _encoded.size(), _tiles.data(), count);
+		}
+	}
+
+	std::istream* _in = NULL;
+	std::streamoff _base = 0;
+	SerializeHeader _header = {};
+	size_t _chunks_x = 0;
+	size_t _chunks_y = 0;
+	std::vector<SerializeChunkEntry> _index;
+	// Scratch buffers for decoding a chunk.
+	std::vector<T> _tiles;
+	std::vector<unsigned char> _encoded;
+};
+
+// Deserialize the whole tilemap at the current position of [in] into [output]. The stream must be seekable.
+// Returns false if the stream can't be read, is corrupted, or holds tiles of another size.
+template<ResizableTileMapLike Out>
+	requires std::is_trivially_copyable_v<tile_t<Out>>
+bool readTileMap(std::istream& in, Out* output)
+{
+	TileMapReader<tile_t<Out>> reader;
+	return reader.open(in) && reader.getChunk(output, { 0, 0, reader.width(), reader.height() });
+}
+
+}; // |===|   END namespace tm2D   |===|
@@ -0,0 +1,243 @@
+#pragma once
+
+#include "TileMap2D.h"
+#include "TileMap2D_Parallel.h"
+
+#include <array>
+
+// Stencils over 2-dimensional tilemaps: every output tile computed from the neighborhood of the input tile at its position, e.g. blurs, erosion and dilation, or cellular automata.
+
+namespace tm2D
+{
+
+// How the neighbors outside of a tilemap are read.
+enum class Border
+{
+	// The nearest tile within the tilemap.
+	Clamp,
+	// The tile on the opposite side, as if the tilemap was a torus.
+	Wrap,
+	// A padding tile.
+	Pad
+};
+
+// The (2 * [Radius] + 1) x (2 * [Radius] + 1) tiles around a tile, passed to the kernel of applyStencil().
+template<typename T, size_t Radius>
+struct Neighborhood
+{
+	static constexpr size_t radius = Radius;
+	// Width and height of the neighborhood.
+	static constexpr size_t size = 2 * Radius + 1;
+
+	// [rows] are the pointers to the [size] rows of the neighborhood, whose center is at index [x] in each row.
+	constexpr Neighborhood(const T* const* rows, size_t x, Point position)
+		: position(position), _rows(rows), _x(x) {}
+
+	// Get the tile at the offset ([dx]; [dy]) from the center, both within [-Radius; Radius].
+	constexpr const T& operator()(ptrdiff_t dx, ptrdiff_t dy) const { return _rows[(ptrdiff_t)Radius + dy][(ptrdiff_t)_x + dx]; }
+
+	// Get the center tile.
+	constexpr const T& center() const { return _rows[Radius][_x]; }
+
+	// Fold [op(accumulator, tile)] over the tiles in row-major order, e.g. 'n.reduce(0u, std::plus<>())' for their sum.
+	template<typename U, typename Op>
+	constexpr U reduce(U init, Op&& op) const
+	{
+		for (size_t dy = 0; dy < size; dy++)
+			for (size_t dx = 0; dx < size; dx++)
+				init = op(std::move(init), _rows[dy][_x - Radius + dx]);
+		return init;
+	}
+
+	// Position of the center tile in the tilemap.
+	Point position;
+
+private:
+	const T* const* _rows;
+	size_t _x;
+};
+
+namespace detail
+{
+
+// Get the index within [0; size) read for the row or column [i] following [border], or [size] for the padding tile. [size] must not be 0.
+inline size_t borderIndex(ptrdiff_t i, size_t size, Border border)
+{
+	if (i >= 0 && (size_t)i < size) return (size_t)i;
+
+	switch (border) {
+	case Border::Clamp:
+		return i < 0 ? 0 : size - 1;
+	case Border::Wrap: {
+		const ptrdiff_t wrapped = i % (ptrdiff_t)size;
+		return (size_t)(wrapped < 0 ? wrapped + (ptrdiff_t)size : wrapped);
+	}
+	default:
+		return size;
+	}
+}
+
+// Compute the rows [y_begin; y_end) of the first [width] columns of [output] with the stencil [kernel] over [input]. See applyStencil().
+template<size_t Radius, TileMapLike Out, TileMapLike In, typename Kernel>
+void stencilRows(
+	Out& output,
+	const In& input,
+	Kernel& kernel,
+	Border border,
+	const tile_t<In>& padding,
+	size_t width,
+	size_t y_begin,
+	size_t y_end
+) {
+	using T = tile_t<In>;
+	using N = Neighborhood<T, Radius>;
+	constexpr size_t size = N::size;
+	const size_t input_width = input.width(), input_height = input.height();
+
+	// Rows of the neighborhoods of the current row. The rows of contiguous tilemaps are read in place, the others are copied to a ring of [size] rows first.
+	std::array<const T*, size> rows;
+	std::vector<T> padding_row;
+	if (border == Border::Pad) padding_row.assign(input_width, padding);
+	[[maybe_unused]] std::vector<T> copies;
+	[[maybe_unused]] std::array<ptrdiff_t, size> copied;
+	if constexpr (!ContiguousTileMap<In>) {
+		copies.resize(input_width * size);
+		copied.fill(PTRDIFF_MIN);
+	}
+
+	// Neighborhood of the tiles within [Radius] of the left and right edges, gathered following [border].
+	std::array<T, size * size> window;
+	std::array<const T*, size> window_rows;
+	for (size_t i = 0; i < size; i++) window_rows[i] = window.data() + size * i;
+
+	// The interior columns have all their neighbors within [input].
+	const size_t
+		interior_begin = std::min<>(Radius, width),
+		interior_end = std::max<>(interior_begin, std::min<>(width, input_width > Radius ? input_width - Radius : 0));
+
+	for (size_t y = y_begin; y < y_end; y++) {
+		for (size_t i = 0; i < size; i++) {
+			const ptrdiff_t row_y = (ptrdiff_t)y + (ptrdiff_t)i - (ptrdiff_t)Radius;
+			const size_t src_y = borderIndex(row_y, input_height, border);
+
+			if (src_y == input_height) rows[i] = padding_row.data();
+			else if constexpr (ContiguousTileMap<In>) rows[i] = rowData(input, src_y);
+			else {
+				// Consecutive rows go to consecutive slots, so the rows of a neighborhood never share one.
+				const size_t slot = (y + i) % size;
+				T* const copy = copies.data() + input_width * slot;
+				if (copied[slot] != row_y) {
+					for (size_t x = 0; x < input_width; x++) copy[x] = input(x, src_y);
+					copied[slot] = row_y;
+				}
+				rows[i] = copy;
+			}
+		}
+
+		const auto write = [&](size_t x, const N& neighborhood) {
+			if constexpr (ContiguousTileMap<Out>) rowData(output, y)[x] = kernel(neighborhood);
+			else output(x, y) = kernel(neighborhood);
+		};
+		const auto writeEdge = [&](size_t x) {
+			for (size_t dx = 0; dx < size; dx++) {
+				const size_t src_x = borderIndex((ptrdiff_t)x + (ptrdiff_t)dx - (ptrdiff_t)Radius, input_width, border);
+				for (size_t i = 0; i < size; i++) window[size * i + dx] = src_x == input_width ? padding : rows[i][src_x];
+			}
+			write(x, N(window_rows.data(), Radius, { x, y }));
+		};
+
+		for (size_t x = 0; x < interior_begin; x++) writeEdge(x);
+		for (size_t x = interior_begin; x < interior_end; x++) write(x, N(rows.data(), x, { x, y }));
+		for (size_t x = interior_end; x < width; x++) writeEdge(x);
+	}
+}
+
+}; // namespace detail
+
+// Compute every tile of [output] as [kernel(neighborhood)], the neighborhood being the tiles within [Radius] of the tile at the same position in [input], following [policy].
+// E.g. a 3 x 3 box blur: 'applyStencil<1>(&blurred, &map, [](const auto& n) { return n.reduce(0u, std::plus<>()) / 9; });'.
+// The neighbors outside of [input] are read following [border], with [padding] for Border::Pad. Only the tiles within [Radius] of the left and right edges gather their
+// neighborhood into a window following [border]: the others read the rows of [input] in place with no bounds checks nor branches, so that the compiler can vectorize a simple kernel.
+// A resizable [output] is reset to the size of [input]; otherwise only the tiles within both are computed. [kernel] is called concurrently for different rows with the parallel policy.
+// [output] must not share its buffer with [input].
+template<size_t Radius, ExecutionPolicy P, TileMapLike Out, TileMapLike In, typename Kernel>
+	requires std::convertible_to<std::invoke_result_t<Kernel&, const Neighborhood<tile_t<In>, Radius>&>, tile_t<Out>>
+void applyStencil(
+	const P& policy,
+	Out* output,
+	const In* input,
+	Kernel&& kernel,
+	Border border = Border::Clamp,
+	const tile_t<In>& padding = {}
+) {
+	TM2D_INSTRUMENT_SCOPE(Stencil);
+	if constexpr (ResizableTileMapLike<Out>) detail::resetForOverwrite(*output, input->width(), input->height());
+	const size_t
+		width = std::min<>(output->width(), input->width()),
+		height = std::min<>(output->height(), input->height());
+	if (!width || !height) return;
+	TM2D_INSTRUMENT_COUNT(width * height, width * height * sizeof(tile_t<Out>));
+	const auto write_policy = detail::prepareConcurrentWrite(policy, *output, { 0, 0, width, height });
+
+	detail::forRowBands(write_policy, width * height, height, [&](size_t y_begin, size_t y_end) {
+		detail::stencilRows<Radius>(*output, *input, kernel, border, padding, width, y_begin, y_end);
+	});
+}
+
+// Compute every tile of [output] as [kernel(neighborhood)] of the tiles of [input]. See applyStencil() with an execution policy.
+template<size_t Radius, TileMapLike Out, TileMapLike In, typename Kernel>
+	requires std::convertible_to<std::invoke_result_t<Kernel&, const Neighborhood<tile_t<In>, Radius>&>, tile_t<Out>>
+void applyStencil(
+	Out* output,
+	const In* input,
+	Kernel&& kernel,
+	Border border = Border::Clamp,
+	const tile_t<In>& padding = {}
+) {
+	applyStencil<Radius>(execution::seq, output, input, kernel, border, padding);
+}
+
+// Apply the stencil [kernel] to [map] [iterations] times, following [policy], e.g. to run the generations of a cellular automaton.
+// The passes alternate between [map] and a back buffer, so that each one reads the whole result of the previous one. See applyStencil().
+template<size_t Radius, ExecutionPolicy P, TileMapLike M, typename Kernel>
+	requires std::convertible_to<std::invoke_result_t<Kernel&, const Neighborhood<tile_t<M>, Radius>&>, tile_t<M>>
+void iterateStencil(
+	const P& policy,
+	M* map,
+	size_t iterations,
+	Kernel&& kernel,
+	Border border = Border::Clamp,
+	const tile_t<M>& padding = {}
+) {
+	if constexpr (detail::is_tilemap_1d<M>) {
+		// Swap the buffers between the passes.
+		M back(map->get_allocator());
+		for (size_t i = 0; i < iterations; i++) {
+			applyStencil<Radius>(policy, &back, map, kernel, border, padding);
+			std::swap(*map, back);
+		}
+	}
+	else {
+		TileMap2D_1D<tile_t<M>> back;
+		for (size_t i = 0; i < iterations; i++) {
+			if (i % 2) applyStencil<Radius>(policy, map, &back, kernel, border, padding);
+			else applyStencil<Radius>(policy, &back, map, kernel, border, padding);
+		}
+		if (iterations % 2) setChunk(policy, map, &back, 0, 0);
+	}
+}
+
+// Apply the stencil [kernel] to [map] [iterations] times. See iterateStencil() with an execution policy.
+template<size_t Radius, TileMapLike M, typename Kernel>
+	requires std::convertible_to<std::invoke_result_t<Kernel&, const Neighborhood<tile_t<M>, Radius>&>, tile_t<M>>
+void iterateStencil(
+	M* map,
+	size_t iterations,
+	Kernel&& kernel,
+	Border border = Border::Clamp,
+	const tile_t<M>& padding = {}
+) {
+	iterateStencil<Radius>(execution::seq, map, iterations, kernel, border, padding);
+}
+
+}; // |===|   END namespace tm2D   |===|
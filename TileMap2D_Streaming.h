@@ -0,0 +1,434 @@
+#pragma once
+
+#include "TileMap2D.h"
+#include "TileMap2D_Chunked.h"
+#include "TileMap2D_Parallel.h"
+
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+
+// Asynchronous streaming of the chunks of a TileMap2D_Chunked around moving views, for worlds that don't fit in memory.
+
+namespace tm2D
+{
+
+// Options of a ChunkStreamer.
+struct StreamingOptions
+{
+	// Bytes of loaded and loading chunks to keep at most. Chunks in use are never evicted, even over the budget.
+	size_t memory_budget = size_t(64) << 20;
+	// Number of chunks around the view that are prefetched.
+	size_t margin = 1;
+	// Time in seconds the view is extrapolated along its velocity, to prefetch the chunks it is moving to.
+	double lookahead = 0.5;
+	// Number of prefetches in progress at most, so that a fast view doesn't queue loads it has already left. If 0, it is twice the number of worker threads.
+	size_t max_prefetches = 0;
+};
+
+// Loads the chunks of a TileMap2D_Chunked around a moving view on a thread pool, keeps the chunks in use, and evicts the least recently used other ones over a memory budget.
+// Chunks are loaded into separate buffers on the worker threads, and moved into the tilemap by poll(), so the tilemap itself is only accessed from the thread owning it. All member functions must be called from that thread.
+// Note: the tilemap must not be resized while it is streamed. Only chunks loaded by the streamer are evicted, and chunks written to before their load completes keep their tiles.
+template<typename T, size_t ChunkShift = 6>
+struct ChunkStreamer
+{
+	using Map = TileMap2D_Chunked<T, ChunkShift>;
+
+	static constexpr size_t chunk_size = Map::chunk_size;
+	// Size of the buffer of a chunk in bytes.
+	static constexpr size_t chunk_bytes = chunk_size * chunk_size * sizeof(T);
+
+	// Load the tiles of [area], the area of a chunk, into [tiles], which is filled with the padding tile. Called concurrently on the worker threads.
+	// Returns 'false' if the chunk is empty, in which case it stays unallocated and reads as the padding tile.
+	using Loader = std::function<bool(const Rect& area, TileMap2DView<T> tiles)>;
+	// Called with the area and the tiles of a chunk before it is evicted, e.g. to save its modifications.
+	using Unloader = std::function<void(const Rect& area, TileMap2DView<T> tiles)>;
+
+	// Keeps the chunks of an area from being evicted until it is destroyed or released. See pin().
+	// Note: a Pin refers to its streamer, so it must be released or destroyed before the streamer is.
+	struct Pin
+	{
+		Pin() {}
+
+		Pin(Pin&& other) noexcept
+			: _streamer(std::exchange(other._streamer, nullptr)), _chunks(other._chunks) {}
+
+		Pin& operator=(Pin&& other) noexcept
+		{
+			if (this != &other) {
+				release();
+				_streamer = std::exchange(other._streamer, nullptr);
+				_chunks = other._chunks;
+			}
+			return *this;
+		}
+
+		~Pin() { release(); }
+
+		void release()
+		{
+			if (_streamer) _streamer->unpin(_chunks);
+			_streamer = nullptr;
+		}
+
+	private:
+		friend ChunkStreamer;
+
+		Pin(ChunkStreamer* streamer, const Rect& chunks)
+			: _streamer(streamer), _chunks(chunks) {}
+
+		ChunkStreamer* _streamer = nullptr;
+		Rect _chunks;
+	};
+
+	// Params:
+	//   [loader] Function loading the tiles of a chunk. See Loader.
+	//   [pool] Pool running the loads, which must outlive the streamer.
+	ChunkStreamer(Map& map, Loader loader, ThreadPool& pool = defaultThreadPool(), const StreamingOptions& options = {})
+		: _map(map), _loader(std::move(loader)), _pool(pool), _options(options), _chunks(map.chunksX() * map.chunksY())
+	{
+		if (!_options.max_prefetches) _options.max_prefetches = 2 * std::max<>(pool.size(), size_t(1));
+	}
+
+	ChunkStreamer(const ChunkStreamer&) = delete;
+	ChunkStreamer& operator=(const ChunkStreamer&) = delete;
+
+	// Wait for the loads in progress, whose chunks are discarded. Every Pin must have been released.
+	~ChunkStreamer()
+	{
+		assert(_pins == 0 && "ChunkStreamer destroyed with outstanding pins");
+		std::unique_lock<std::mutex> lock(_tasks->mutex);
+		_tasks->cv.wait(lock, [&] { return _tasks->running == 0; });
+	}
+
+	// Set the function called before a chunk is evicted.
+	void setUnloader(Unloader unloader) { _unloader = std::move(unloader); }
+
+	// Move the loaded chunks into the tilemap, prefetch the chunks around [view] and in the direction it moves to, nearest first, and evict the least recently used chunks over the memory budget.
+	// Call once per frame or tick, with the area in use, e.g. the camera or the area a player can see.
+	// Params:
+	//   [velocity_x], [velocity_y] Velocity of the view in tiles per second.
+	void update(const Rect& view, double velocity_x = 0.0, double velocity_y = 0.0)
+	{
+		_tick++;
+		poll();
+
+		const double dx = velocity_x * _options.lookahead, dy = velocity_y * _options.lookahead;
+		const Rect chunks = chunkRange(
+			double(view.x) + std::min<>(dx, 0.0), double(view.y) + std::min<>(dy, 0.0),
+			double(view.x + view.width) + std::max<>(dx, 0.0), double(view.y + view.height) + std::max<>(dy, 0.0),
+			_options.margin
+		);
+
+		std::vector<size_t> missing;
+		for (size_t cy = chunks.y; cy < chunks.y + chunks.height; cy++) {
+			for (size_t cx = chunks.x; cx < chunks.x + chunks.width; cx++) {
+				ChunkState& chunk = _chunks[cx + _map.chunksX() * cy];
+				chunk.last_used = _tick;
+				if (chunk.status == Status::Unloaded) missing.push_back(cx + _map.chunksX() * cy);
+			}
+		}
+
+		// Chunks nearest to the center of the view are loaded first, which are the visible ones.
+		const double center_x = double(view.x) + double(view.width) / 2, center_y = double(view.y) + double(view.height) / 2;
+		const auto distance = [&](size_t index) {
+			const double
+				x = (double(index % _map.chunksX()) + 0.5) * double(chunk_size) - center_x,
+				y = (double(index / _map.chunksX()) + 0.5) * double(chunk_size) - center_y;
+			return x * x + y * y;
+		};
+		std::sort(missing.begin(), missing.end(), [&](size_t a, size_t b) { return distance(a) < distance(b); });
+
+		for (size_t index : missing) {
+			if (_loading.size() >= _options.max_prefetches) break;
+			schedule(index);
+		}
+		evict();
+	}
+
+	// Schedule the loads of the chunks intersecting [area] that are not loaded, regardless of the prefetch limit.
+	// Returns a future that is ready when the chunks are loaded. They are moved into the tilemap by the next call to poll(), update() or load().
+	std::shared_future<void> request(const Rect& area)
+	{
+		const Rect chunks = chunkRange(area);
+		auto group = std::make_shared<Group>();
+		std::shared_future<void> ready = group->ready.get_future().share();
+
+		for (size_t cy = chunks.y; cy < chunks.y + chunks.height; cy++) {
+			for (size_t cx = chunks.x; cx < chunks.x + chunks.width; cx++) {
+				const size_t index = cx + _map.chunksX() * cy;
+				ChunkState& chunk = _chunks[index];
+				chunk.last_used = _tick;
+
+				if (chunk.status == Status::Unloaded) schedule(index);
+				if (chunk.status == Status::Loading) {
+					group->remaining++;
+					if (!chunk.load->join(group)) group->remaining--;
+				}
+			}
+		}
+		// The group starts with one arrival pending for this call, so that it can't be completed while chunks are being added to it.
+		group->arrive();
+		return ready;
+	}
+
+	// Load the chunks intersecting [area] into the tilemap, waiting for them if needed. Exceptions thrown by the loader are rethrown.
+	void load(const Rect& area)
+	{
+		request(area).wait();
+		poll();
+	}
+
+	// Keep the chunks intersecting [area] from being evicted while the returned Pin is alive, e.g. while they are copied to a client with getChunk(). Pins of overlapping areas add up.
+	// The Pin must not outlive the streamer.
+	[[nodiscard]] Pin pin(const Rect& area)
+	{
+		_pins++;
+		const Rect chunks = chunkRange(area);
+		for (size_t cy = chunks.y; cy < chunks.y + chunks.height; cy++)
+			for (size_t cx = chunks.x; cx < chunks.x + chunks.width; cx++)
+				_chunks[cx + _map.chunksX() * cy].pins++;
+		return Pin(this, chunks);
+	}
+
+	// Move the chunks that finished loading into the tilemap. The first exception thrown by the loader since the last call is rethrown, the chunk being left unloaded.
+	// Returns the number of chunks moved into the tilemap.
+	size_t poll()
+	{
+		size_t installed = 0;
+		std::exception_ptr error;
+
+		for (size_t i = 0; i < _loading.size();) {
+			const size_t index = _loading[i];
+			ChunkState& chunk = _chunks[index];
+			if (!chunk.load->finished()) {
+				i++;
+				continue;
+			}
+
+			_loading[i] = _loading.back();
+			_loading.pop_back();
+			const std::shared_ptr<Load> load = std::move(chunk.load);
+
+			if (load->error) {
+				chunk.status = Status::Unloaded;
+				if (!error) error = load->error;
+				continue;
+			}
+
+			const size_t cx = index % _map.chunksX(), cy = index / _map.chunksX();
+			if (load->tiles && !_map.chunk(cx, cy)) {
+				_map.adoptChunk(cx, cy, std::move(load->tiles));
+				installed++;
+			}
+			chunk.status = Status::Loaded;
+			_loaded.push_back(index);
+		}
+
+		if (error) std::rethrow_exception(error);
+		return installed;
+	}
+
+	// Evict the least recently used chunks that are not pinned nor used since the last update(), until the memory budget is met.
+	void evict()
+	{
+		size_t bytes = memoryUsage();
+		if (bytes <= _options.memory_budget) return;
+
+		std::vector<size_t> candidates;
+		for (size_t index : _loaded) {
+			const ChunkState& chunk = _chunks[index];
+			if (!chunk.pins && chunk.last_used != _tick && _map.chunk(index % _map.chunksX(), index / _map.chunksX())) candidates.push_back(index);
+		}
+		std::sort(candidates.begin(), candidates.end(), [&](size_t a, size_t b) { return _chunks[a].last_used < _chunks[b].last_used; });
+
+		for (size_t index : candidates) {
+			if (bytes <= _options.memory_budget) break;
+
+			const size_t cx = index % _map.chunksX(), cy = index / _map.chunksX();
+			if (_unloader) {
+				const Rect area = _map.chunkRect(cx, cy);
+				_unloader(area, TileMap2DView<T>(_map.chunk(cx, cy), area.width, area.height, chunk_size));
+			}
+			_map.releaseChunk(cx, cy);
+			_chunks[index].status = Status::Unloaded;
+			bytes -= chunk_bytes;
+		}
+
+		_loaded.erase(std::remove_if(_loaded.begin(), _loaded.end(), [&](size_t index) { return _chunks[index].status != Status::Loaded; }), _loaded.end());
+	}
+
+	// Check if chunk ([cx]; [cy]) is loaded into the tilemap.
+	bool isLoaded(size_t cx, size_t cy) const { return _chunks[cx + _map.chunksX() * cy].status == Status::Loaded; }
+
+	// Get the number of loads in progress, or finished and not yet polled.
+	size_t pendingLoads() const { return _loading.size(); }
+
+	// Get the bytes of the allocated chunks loaded by the streamer and of the loads in progress, which is compared against the memory budget.
+	size_t memoryUsage() const
+	{
+		size_t chunks = _loading.size();
+		for (size_t index : _loaded)
+			if (_map.chunk(index % _map.chunksX(), index / _map.chunksX())) chunks++;
+		return chunks * chunk_bytes;
+	}
+
+	constexpr const StreamingOptions& options() const { return _options; }
+
+private:
+	enum class Status : uint8_t
+	{
+		Unloaded,
+		Loading,
+		Loaded
+	};
+
+	// Chunk loads waited for by request(), which is ready once all of them finished.
+	struct Group
+	{
+		std::atomic<size_t> remaining = 1;
+		std::promise<void> ready;
+
+		void arrive()
+		{
+			if (--remaining == 0) ready.set_value();
+		}
+	};
+
+	// A chunk load, shared with the task running it.
+	struct Load
+	{
+		// Set by the task before it finishes.
+		std::unique_ptr<T[]> tiles;
+		std::exception_ptr error;
+
+		bool finished()
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			return _finished;
+		}
+
+		// Add [group] to the groups to notify when the load finishes. Returns 'false' if it is already finished.
+		bool join(const std::shared_ptr<Group>& group)
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			if (_finished) return false;
+			_groups.push_back(group);
+			return true;
+		}
+
+		void finish()
+		{
+			std::vector<std::shared_ptr<Group>> groups;
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_finished = true;
+				std::swap(groups, _groups);
+			}
+			for (const std::shared_ptr<Group>& group : groups) group->arrive();
+		}
+
+	private:
+		std::mutex _mutex;
+		bool _finished = false;
+		std::vector<std::shared_ptr<Group>> _groups;
+	};
+
+	// Number of running tasks, waited for by the destructor.
+	struct Tasks
+	{
+		std::mutex mutex;
+		std::condition_variable cv;
+		size_t running = 0;
+	};
+
+	struct ChunkState
+	{
+		std::shared_ptr<Load> load;
+		// Value of the update counter when the chunk was last in use.
+		uint64_t last_used = 0;
+		uint32_t pins = 0;
+		Status status = Status::Unloaded;
+	};
+
+	void schedule(size_t index)
+	{
+		ChunkState& chunk = _chunks[index];
+		chunk.status = Status::Loading;
+		chunk.load = std::make_shared<Load>();
+		_loading.push_back(index);
+
+		{
+			std::lock_guard<std::mutex> lock(_tasks->mutex);
+			_tasks->running++;
+		}
+
+		const Rect area = _map.chunkRect(index % _map.chunksX(), index / _map.chunksX());
+		_pool.submit([load = chunk.load, tasks = _tasks, loader = &_loader, area, padding = _map.padding()] {
+			try {
+				std::unique_ptr<T[]> tiles = std::make_unique<T[]>(chunk_size * chunk_size);
+				std::fill(tiles.get(), tiles.get() + chunk_size * chunk_size, padding);
+				if ((*loader)(area, TileMap2DView<T>(tiles.get(), area.width, area.height, chunk_size))) load->tiles = std::move(tiles);
+			}
+			catch (...) {
+				load->error = std::current_exception();
+			}
+			load->finish();
+
+			std::lock_guard<std::mutex> lock(tasks->mutex);
+			if (--tasks->running == 0) tasks->cv.notify_all();
+		});
+	}
+
+	void unpin(const Rect& chunks)
+	{
+		_pins--;
+		for (size_t cy = chunks.y; cy < chunks.y + chunks.height; cy++)
+			for (size_t cx = chunks.x; cx < chunks.x + chunks.width; cx++)
+				_chunks[cx + _map.chunksX() * cy].pins--;
+	}
+
+	// Get the chunks intersecting [area], as a Rect of chunk coordinates.
+	Rect chunkRange(const Rect& area) const
+	{
+		const Rect cliprect = area.intersection({ 0, 0, _map.width(), _map.height() });
+		if (!cliprect.width || !cliprect.height) return {};
+
+		const size_t cx = cliprect.x >> ChunkShift, cy = cliprect.y >> ChunkShift;
+		return { cx, cy, ((cliprect.x + cliprect.width - 1) >> ChunkShift) + 1 - cx, ((cliprect.y + cliprect.height - 1) >> ChunkShift) + 1 - cy };
+	}
+
+	// Get the chunks intersecting [[x0]; [x1]) x [[y0]; [y1]) in tiles, extended by [margin] chunks and clipped to the chunk directory.
+	Rect chunkRange(double x0, double y0, double x1, double y1, size_t margin) const
+	{
+		const auto clamp = [](double c, size_t chunks) { return c <= 0.0 ? size_t(0) : c >= double(chunks) ? chunks : size_t(c); };
+		const double size = double(chunk_size);
+		const size_t
+			cx0 = clamp(std::floor(x0 / size) - double(margin), _map.chunksX()),
+			cy0 = clamp(std::floor(y0 / size) - double(margin), _map.chunksY()),
+			cx1 = clamp(std::ceil(x1 / size) + double(margin), _map.chunksX()),
+			cy1 = clamp(std::ceil(y1 / size) + double(margin), _map.chunksY());
+		if (cx0 >= cx1 || cy0 >= cy1) return {};
+		return { cx0, cy0, cx1 - cx0, cy1 - cy0 };
+	}
+
+	Map& _map;
+	Loader _loader;
+	Unloader _unloader;
+	ThreadPool& _pool;
+	StreamingOptions _options;
+	std::vector<ChunkState> _chunks;
+	// Indices of the chunks loading and loaded.
+	std::vector<size_t> _loading;
+	std::vector<size_t> _loaded;
+	std::shared_ptr<Tasks> _tasks = std::make_shared<Tasks>();
+	uint64_t _tick = 0;
+	// Number of pins not released, checked by the destructor.
+	size_t _pins = 0;
+};
+
+}; // |===|   END namespace tm2D   |===|
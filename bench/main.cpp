@@ -0,0 +1,283 @@
+#include "TileMap2D.h"
+#include "TileMap2D_Stencil.h"
+#include "TileMap2D_Resample.h"
+#include "TileMap2D_Image.h"
+
+#include <bit>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+
+// Benchmarks of the tilemap operations on TileMap2DView and TileMap2D_1D in its memory layouts, over tilemap sizes and tile sizes.
+// Each line reports the fastest run of a benchmark named '<operation>/<tilemap>/<tile>/<size>', and the tiles processed per second in that run.
+
+namespace
+{
+
+constexpr const char* usage =
+	"Usage: tm2d_bench [options]\n"
+	"  --sizes <n,...>       Widths and heights of the square tilemaps (default: 256,1024,4096)\n"
+	"  --filter <text>       Only run the benchmarks whose name contains <text>\n"
+	"  --min-time <seconds>  Minimum time spent on each benchmark (default: 0.2)\n"
+	"  --max-memory <MiB>    Skip the tilemap and tile sizes needing more memory (default: 4096)\n"
+	"  --quick               Run every benchmark once on 64 x 64 tilemaps\n"
+	"  --help                Print this message\n";
+
+struct Options
+{
+	std::vector<size_t> sizes = { 256, 1024, 4096 };
+	std::string filter;
+	double min_time = 0.2;
+	size_t min_runs = 3;
+	size_t max_memory = size_t(4096) << 20;
+};
+
+// A 16-byte tile, e.g. a tile with a few layers of properties.
+struct Tile16
+{
+	uint32_t values[4];
+
+	bool operator==(const Tile16&) const = default;
+};
+
+template<typename T>
+T tileValue(uint32_t value)
+{
+	if constexpr (std::is_same_v<T, Tile16>) return { { value, value, value, value } };
+	else return T(value);
+}
+
+template<typename T>
+const char* tileName()
+{
+	if constexpr (std::is_same_v<T, Tile16>) return "16B";
+	else if constexpr (sizeof(T) == 1) return "1B";
+	else return "4B";
+}
+
+// A TileMap2DView over its own buffer.
+template<typename T>
+struct ViewMap
+{
+	ViewMap(size_t width, size_t height)
+		: buffer(width * height), map(buffer.data(), width, height) {}
+
+	std::vector<T> buffer;
+	tm2D::TileMap2DView<T> map;
+};
+
+// Run [func] for at least [options].min_time and [options].min_runs times after a warm-up run, and print the fastest run.
+template<typename F>
+void run(const Options& options, const std::string& name, size_t tiles, F&& func)
+{
+	if (!options.filter.empty() && name.find(options.filter) == std::string::npos) return;
+
+	using clock = std::chrono::steady_clock;
+	func();
+
+	double best = std::numeric_limits<double>::infinity(), total = 0.0;
+	size_t runs = 0;
+	while (runs < options.min_runs || total < options.min_time) {
+		const clock::time_point start = clock::now();
+		func();
+		const double elapsed = std::chrono::duration<double>(clock::now() - start).count();
+		best = std::min<>(best, elapsed);
+		total += elapsed;
+		runs++;
+	}
+
+	std::printf("%-32s %12.3f us %10.1f Mtiles/s %8zu runs\n", name.c_str(), best * 1e6, double(tiles) / best * 1e-6, runs);
+	std::fflush(stdout);
+}
+
+template<tm2D::TileMapLike M>
+void randomize(M& map, std::mt19937& rng)
+{
+	for (size_t y = 0; y < map.height(); y++)
+		for (size_t x = 0; x < map.width(); x++)
+			map(x, y) = tileValue<tm2D::tile_t<M>>(rng());
+}
+
+// Draw vertical walls every 8 columns with a gap alternating between the bottom and the top row, so that fillArea() from (0; 0) fills a serpentine corridor.
+template<tm2D::TileMapLike M>
+void drawMaze(M& map)
+{
+	using T = tm2D::tile_t<M>;
+	const size_t width = map.width(), height = map.height();
+
+	for (size_t y = 0; y < height; y++) {
+		for (size_t x = 0; x < width; x++) {
+			const bool wall = x % 8 == 7 && y != ((x / 8) % 2 ? 0 : height - 1);
+			map(x, y) = tileValue<T>(wall ? 1 : 0);
+		}
+	}
+}
+
+template<typename T>
+void benchmarkTiles(const Options& options, size_t size)
+{
+	const size_t tiles = size * size;
+	// The four benchmarked tilemaps, the source of setChunk() and the output of getChunk() and rot90().
+	// The Z-order map rounds its sides up to powers of 2.
+	const size_t zorder_tiles = std::bit_ceil(size) * std::bit_ceil(size);
+	if ((5 * tiles + zorder_tiles) * sizeof(T) > options.max_memory) {
+		std::printf("skipped %s/%zu: needs more than --max-memory\n", tileName<T>(), size);
+		return;
+	}
+
+	std::mt19937 rng(1);
+	ViewMap<T> view(size, size);
+	tm2D::TileMap2D_1D<T> vector(size, size);
+	tm2D::TileMap2D_1D<T, std::allocator<T>, tm2D::layout::ZOrder> zorder(size, size);
+	tm2D::TileMap2D_1D<T, std::allocator<T>, tm2D::layout::Tiled<>> tiled(size, size);
+	tm2D::TileMap2D_1D<T> source(size, size), output;
+	randomize(view.map, rng);
+	randomize(vector, rng);
+	randomize(zorder, rng);
+	randomize(tiled, rng);
+	randomize(source, rng);
+
+	// Run [func] on the view and on the vector in each layout.
+	const auto bench = [&](const char* operation, size_t processed, auto&& func) {
+		const std::string suffix = std::string("/") + tileName<T>() + "/" + std::to_string(size);
+		run(options, operation + std::string("/View") + suffix, processed, [&] { func(view.map); });
+		run(options, operation + std::string("/1D") + suffix, processed, [&] { func(vector); });
+		run(options, operation + std::string("/ZOrder") + suffix, processed, [&] { func(zorder); });
+		run(options, operation + std::string("/Tiled") + suffix, processed, [&] { func(tiled); });
+	};
+
+	bench("flip_h", tiles, [](auto& map) { tm2D::flip(map, true, false); });
+	bench("flip_v", tiles, [](auto& map) { tm2D::flip(map, false, true); });
+	bench("flip_hv", tiles, [](auto& map) { tm2D::flip(map, true, true); });
+	bench("rot90", tiles, [](auto& map) { tm2D::rot90(&map, true); });
+	bench("rot90_copy", tiles, [&](auto& map) { tm2D::rot90(&output, &map, true); });
+
+	const tm2D::Rect chunk = { size / 4, size / 4, size / 2, size / 2 };
+	bench("getChunk", chunk.width * chunk.height, [&](auto& map) { tm2D::getChunk(&output, &map, chunk); });
+	bench("setChunk", tiles, [&](auto& map) { tm2D::setChunk(&map, &source, 0, 0); });
+
+	if constexpr (std::is_arithmetic_v<T>) {
+		bench("blur3x3", tiles, [&](auto& map) {
+			tm2D::applyStencil<1>(&output, &map, [](const auto& n) { return T(n.reduce(uint32_t(0), std::plus<>()) / 9); });
+		});
+		bench("halve_box", tiles, [&](auto& map) { tm2D::resample(&output, &map, size / 2, size / 2, tm2D::Filter::Box); });
+		bench("scale_bilinear", tiles, [&](auto& map) { tm2D::resample(&output, &map, size * 3 / 4, size * 3 / 4, tm2D::Filter::Bilinear); });
+	}
+	bench("halve_nearest", tiles / 4, [&](auto& map) { tm2D::resample(&output, &map, size / 2, size / 2, tm2D::Filter::Nearest); });
+
+	if constexpr (sizeof(T) == 4) {
+		std::stringstream qoi;
+		tm2D::writeImage(qoi, source, tm2D::ImageFormat::QOI);
+		bench("encode_qoi", tiles, [&](auto& map) {
+			std::stringstream out;
+			tm2D::writeImage(out, map, tm2D::ImageFormat::QOI);
+		});
+		bench("decode_qoi", tiles, [&](auto& map) {
+			tm2D::ImageReader<T> reader;
+			qoi.seekg(0);
+			reader.open(qoi);
+			reader.setChunk(&map, 0, 0);
+		});
+	}
+
+	drawMaze(view.map);
+	drawMaze(vector);
+	drawMaze(zorder);
+	drawMaze(tiled);
+	const T ink = tileValue<T>(3);
+	// Every run refills the corridor with the other of the 2 floor values.
+	bench("fillArea", tiles - (size / 8) * (size - 1), [](auto& map) {
+		const T from = map(0, 0), to = tileValue<T>(from == tileValue<T>(0) ? 2 : 0);
+		tm2D::fillArea(map, { 0, 0 }, [&](const T& tile) { return tile == from; }, to);
+	});
+
+	// Read the 16 x 16 windows around random points, the 2D-local access the Z-order and tiled layouts are for.
+	const size_t window = std::min<size_t>(16, size);
+	std::vector<tm2D::Point> points(1024);
+	for (auto& point : points) point = { rng() % (size - window + 1), rng() % (size - window + 1) };
+	volatile size_t found = 0;
+	bench("window16", points.size() * window * window, [&](auto& map) {
+		size_t count = 0;
+		for (const auto& point : points)
+			for (size_t y = point.y; y < point.y + window; y++)
+				for (size_t x = point.x; x < point.x + window; x++)
+					count += map(x, y) == ink;
+		found = count;
+	});
+
+	std::vector<std::pair<tm2D::Point, tm2D::Point>> lines(1024);
+	size_t plotted = 0;
+	for (auto& [p1, p2] : lines) {
+		p1 = { rng() % size, rng() % size };
+		p2 = { rng() % size, rng() % size };
+		plotted += std::max<>(std::max<>(p1.x, p2.x) - std::min<>(p1.x, p2.x), std::max<>(p1.y, p2.y) - std::min<>(p1.y, p2.y)) + 1;
+	}
+	bench("drawLine", plotted, [&](auto& map) {
+		for (const auto& [p1, p2] : lines)
+			tm2D::drawLine(map, p1, p2, [&](auto* m, size_t x, size_t y) { (*m)(x, y) = ink; });
+	});
+}
+
+bool parseSizes(const char* text, std::vector<size_t>& sizes)
+{
+	sizes.clear();
+	for (const char* p = text; *p;) {
+		char* end;
+		const unsigned long long size = std::strtoull(p, &end, 10);
+		if (end == p || !size) return false;
+		sizes.push_back(size_t(size));
+		p = *end == ',' ? end + 1 : end;
+		if (*end && *end != ',') return false;
+	}
+	return !sizes.empty();
+}
+
+bool parseOptions(int argc, char** argv, Options& options)
+{
+	for (int i = 1; i < argc; i++) {
+		const char* arg = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+		if (!std::strcmp(arg, "--help")) return false;
+		if (!std::strcmp(arg, "--quick")) {
+			options.sizes = { 64 };
+			options.min_time = 0.0;
+			options.min_runs = 1;
+			continue;
+		}
+		if (!value) return false;
+		i++;
+
+		if (!std::strcmp(arg, "--sizes")) {
+			if (!parseSizes(value, options.sizes)) return false;
+		}
+		else if (!std::strcmp(arg, "--filter")) options.filter = value;
+		else if (!std::strcmp(arg, "--min-time")) options.min_time = std::atof(value);
+		else if (!std::strcmp(arg, "--max-memory")) options.max_memory = size_t(std::strtoull(value, nullptr, 10)) << 20;
+		else return false;
+	}
+	return true;
+}
+
+}; // namespace
+
+int main(int argc, char** argv)
+{
+	Options options;
+	if (!parseOptions(argc, argv, options)) {
+		std::fputs(usage, stderr);
+		return 1;
+	}
+
+	for (size_t size : options.sizes) {
+		benchmarkTiles<uint8_t>(options, size);
+		benchmarkTiles<uint32_t>(options, size);
+		benchmarkTiles<Tile16>(options, size);
+	}
+	return 0;
+}
@@ -1,12 +1,14 @@
-#include "TileMap2D.h"
-#include "lodepng.h"
-
-int main()
-{
-	std::vector<uint8_t> data;
-	uint32_t w, h;
-	lodepng::decode(data, w, h, "img.png");
-	tm2D::TileMap2DView<uint32_t> tmap(data.data(), w, h);
-	tmap.fillArea({ 0, 0 }, [](uint32_t color) { return (color & 0xff000000) == 0x00; }, 0xff000000);
-	lodepng::encode("save.png", data, w, h);
-}
+#include "TileMap2D.h"
+#include "TileMap2D_Image.h"
+
+#include <fstream>
+
+int main()
+{
+	std::ifstream in("img.png", std::ios::binary);
+	tm2D::TileMap2D_1D<uint32_t> tmap;
+	if (!tm2D::readImage(in, &tmap)) return 1;
+	tmap.fillArea({ 0, 0 }, [](uint32_t color) { return (color & 0xff000000) == 0x00; }, 0xff000000);
+	std::ofstream out("save.png", std::ios::binary);
+	return tm2D::writeImage(out, tmap, tm2D::ImageFormat::PNG) ? 0 : 1;
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "TileMap2D.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+// Helpers of the behaviour tests. Each test is an executable which exits with a failure at the first broken check.
+
+#define TM2D_CHECK(condition) \
+	do { \
+		if (!(condition)) { \
+			std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+			std::exit(EXIT_FAILURE); \
+		} \
+	} while (false)
+
+namespace tm2D::test
+{
+
+// Whether [a] and [b] have the same size and tiles.
+template<TileMapLike A, TileMapLike B>
+bool sameTiles(const A& a, const B& b)
+{
+	if (a.width() != b.width() || a.height() != b.height()) return false;
+	for (size_t y = 0; y < a.height(); y++) {
+		for (size_t x = 0; x < a.width(); x++) {
+			if (!(a(x, y) == b(x, y))) return false;
+		}
+	}
+	return true;
+}
+
+// Whether [a] and [b] are the same area, or both empty: the empty results of Rect::intersection() may keep a position.
+inline bool sameArea(const Rect& a, const Rect& b)
+{
+	return a == b || ((!a.width || !a.height) && (!b.width || !b.height));
+}
+
+// Set every tile of [map] to a random value below [range], repeating each value over runs of up to [run] tiles so that the tilemap compresses.
+template<TileMapLike M>
+void randomize(M& map, std::mt19937& rng, unsigned range, size_t run = 1)
+{
+	tile_t<M> value = {};
+	for (size_t y = 0; y < map.height(); y++) {
+		for (size_t x = 0; x < map.width(); x++) {
+			if ((x + y * map.width()) % run == 0) value = tile_t<M>(rng() % range);
+			map(x, y) = value;
+		}
+	}
+}
+
+// Run [count] random operations on [map] and on [expected], a TileMap2D_1D of the same size and tiles, checking that they give the same results.
+// Tile values stay small, so that the operations often write tiles equal to the ones they replace.
+template<ResizableTileMapLike M, typename T>
+	requires std::same_as<tile_t<M>, T>
+void compareOperations(M& map, TileMap2D_1D<T>& expected, std::mt19937& rng, int count)
+{
+	for (int op = 0; op < count; op++) {
+		const Rect area(rng() % 80, rng() % 80, rng() % 40, rng() % 40);
+		const T value = T(rng() % 4);
+		switch (rng() % 9) {
+		case 0:
+			for (int i = 0; i < 20; i++) {
+				const size_t x = rng() % 80, y = rng() % 80;
+				expected.set(x, y, value);
+				map.set(x, y, value);
+			}
+			break;
+		case 1:
+			fillRect(expected, area, value);
+			fillRect(map, area, value);
+			break;
+		case 2: {
+			TileMap2D_1D<T> input(area.width, area.height, T());
+			randomize(input, rng, 4, 5);
+			TM2D_CHECK(setChunk(&expected, &input, area.x, area.y) == setChunk(&map, &input, area.x, area.y));
+			break;
+		}
+		case 3: {
+			const bool horizontal = rng() % 2, vertical = rng() % 2;
+			flip(expected, horizontal, vertical);
+			flip(map, horizontal, vertical);
+			break;
+		}
+		case 4: {
+			const bool left = rng() % 2;
+			TM2D_CHECK(rot90(&expected, left) && rot90(&map, left));
+			break;
+		}
+		case 5: {
+			if (!expected.width() || !expected.height()) break;
+			const Point center = { rng() % expected.width(), rng() % expected.height() };
+			const T from = expected(center.x, center.y), to = T(rng() % 2 ? from : from + 1);
+			const bool eight = rng() % 2;
+			TM2D_CHECK(
+				fillArea(expected, center, [&](const T& t) { return t == from; }, to, eight) ==
+				fillArea(map, center, [&](const T& t) { return t == from; }, to, eight)
+			);
+			break;
+		}
+		case 6:
+			transform(expected, area, [](const T& t) { return T(t ^ 1); });
+			transform(map, area, [](const T& t) { return T(t ^ 1); });
+			break;
+		case 7:
+			replace(expected, value, T(value + 1), area);
+			replace(map, value, T(value + 1), area);
+			break;
+		case 8: {
+			TileMap2D_1D<T> a, b;
+			getChunk(&a, &expected, area);
+			getChunk(&b, &map, area);
+			TM2D_CHECK(sameTiles(a, b));
+			break;
+		}
+		}
+		TM2D_CHECK(sameTiles(map, expected));
+	}
+}
+
+}; // namespace tm2D::test
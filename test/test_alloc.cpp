@@ -0,0 +1,153 @@
+#include "TileMap2D.h"
+#include "test.h"
+
+#include <memory_resource>
+
+using namespace tm2D;
+
+// Memory resource counting the allocations it forwards to 'new' and 'delete'.
+struct CountingResource: public std::pmr::memory_resource
+{
+	size_t allocations = 0;
+	size_t deallocations = 0;
+	size_t bytes = 0;
+
+	// Get the number of bytes allocated and not deallocated yet.
+	size_t outstanding() const { return bytes; }
+
+private:
+	void* do_allocate(size_t size, size_t alignment) final
+	{
+		allocations++;
+		bytes += size;
+		return std::pmr::new_delete_resource()->allocate(size, alignment);
+	}
+	void do_deallocate(void* ptr, size_t size, size_t alignment) final
+	{
+		deallocations++;
+		bytes -= size;
+		std::pmr::new_delete_resource()->deallocate(ptr, size, alignment);
+	}
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept final { return this == &other; }
+};
+
+int main()
+{
+	std::mt19937 rng(10);
+
+	// Allocations made from the default resource instead of the supplied one are counted too.
+	CountingResource fallback;
+	std::pmr::set_default_resource(&fallback);
+
+	// reset() and resetUninitialized() reuse the capacity of the buffer when the new size fits in it.
+	{
+		CountingResource resource;
+		pmr::TileMap2D_1D<uint16_t> map(64, 48, 3, &resource);
+		const uint16_t* const data = map.data();
+		TM2D_CHECK(resource.allocations == 1 && resource.outstanding() >= 64 * 48 * sizeof(uint16_t));
+
+		map.reset(40, 30, 5);
+		TM2D_CHECK(map.data() == data && map.width() == 40 && map.height() == 30 && map.pitch() == 40);
+		TM2D_CHECK(test::sameTiles(map, TileMap2D_1D<uint16_t>(40, 30, 5)));
+		map.resetUninitialized(48, 64);
+		TM2D_CHECK(map.data() == data && map.width() == 48 && map.height() == 64);
+		map.reset(64, 48);
+		TM2D_CHECK(map.data() == data && test::sameTiles(map, TileMap2D_1D<uint16_t>(64, 48, 0)));
+		TM2D_CHECK(resource.allocations == 1);
+
+		// getChunk() and rot90() into the tilemap reuse its buffer as well.
+		TileMap2D_1D<uint16_t> input(30, 20, 0);
+		test::randomize(input, rng, 1000);
+		getChunk(&map, &input, { 5, 5, 30, 20 });
+		TM2D_CHECK(map.data() == data && map(0, 0) == input(5, 5) && map(29, 19) == 0);
+		rot90(&map, &input, true);
+		TM2D_CHECK(map.data() == data && map.width() == 20 && map.height() == 30 && map(0, 0) == input(29, 0));
+		TM2D_CHECK(resource.allocations == 1);
+
+		// Growing past the capacity allocates once.
+		map.reset(100, 100);
+		TM2D_CHECK(resource.allocations == 2 && resource.deallocations == 1);
+	}
+
+	// adopt() and release() hand the buffer over without copying it.
+	{
+		std::vector<uint32_t> buffer(12 * 7);
+		for (size_t i = 0; i < buffer.size(); i++) buffer[i] = uint32_t(i);
+		const uint32_t* const data = buffer.data();
+
+		TileMap2D_1D<uint32_t> map(std::move(buffer), 12, 7);
+		TM2D_CHECK(map.data() == data && map.width() == 12 && map.height() == 7 && map(5, 3) == 5 + 12 * 3);
+
+		std::vector<uint32_t> released = map.release();
+		TM2D_CHECK(released.data() == data && released.size() == 12 * 7 && released[40] == 40);
+		TM2D_CHECK(map.width() == 0 && map.height() == 0);
+
+		// Adopted again at another size, in the same buffer when it fits.
+		map.adopt(std::move(released), 7, 12);
+		TM2D_CHECK(map.data() == data && map.width() == 7 && map.height() == 12 && map(5, 3) == 5 + 7 * 3);
+		map.adopt(map.release(), 6, 5);
+		TM2D_CHECK(map.data() == data && map(5, 4) == 5 + 6 * 4);
+
+		// A buffer too small for the size is grown.
+		std::vector<uint32_t> small(4, 9);
+		map.adopt(std::move(small), 3, 3);
+		TM2D_CHECK(map(0, 0) == 9 && map(0, 1) == 9 && map(2, 2) == 0);
+	}
+	{
+		CountingResource resource;
+		std::pmr::vector<uint16_t> buffer(20 * 10, 4, &resource);
+		pmr::TileMap2D_1D<uint16_t> map(std::move(buffer), 20, 10);
+		TM2D_CHECK(map.get_allocator().resource() == &resource);
+		std::pmr::vector<uint16_t> released = map.release();
+		TM2D_CHECK(released.get_allocator().resource() == &resource && map.get_allocator().resource() == &resource);
+		map.adopt(std::move(released), 10, 20);
+		TM2D_CHECK(resource.allocations == 1 && resource.deallocations == 0);
+	}
+
+	// pmr::TileMap2D_1D allocates from the supplied resource, also in the algorithms writing to it, and gives everything back.
+	{
+		CountingResource resource;
+		{
+			pmr::TileMap2D_1D<uint16_t> map(37, 23, 0, &resource), chunk(&resource);
+			test::randomize(map, rng, 1000);
+			TileMap2D_1D<uint16_t> expected(map.width(), map.height(), 0);
+			setChunk(&expected, &map, 0, 0);
+			const std::initializer_list<uint16_t> list = { 1, 2, 3, 4 };
+			const pmr::TileMap2D_1D<uint16_t> listed(list, 2, 2, &resource);
+			const pmr::TileMap2D_1D<uint16_t> viewed(map.subview({ 3, 4, 10, 10 }), &resource);
+
+			getChunk(&chunk, &map, { 10, 10, 40, 40 });
+			rot90(&map, true);
+			rot90(&expected, true);
+			TM2D_CHECK(rot90(&map, false) && rot90(&map, false));
+			TM2D_CHECK(rot90(&expected, false) && rot90(&expected, false));
+			rot180(&chunk, &map);
+			flip(map, true, true);
+			flip(expected, true, true);
+			TM2D_CHECK(test::sameTiles(map, expected));
+
+			// The converting constructor keeps the allocator.
+			const tm2D::TileMap2D_1D<uint16_t, std::pmr::polymorphic_allocator<uint16_t>, layout::ZOrder> zorder(map);
+			TM2D_CHECK(zorder.get_allocator().resource() == &resource && test::sameTiles(zorder, expected));
+
+			TM2D_CHECK(map.get_allocator().resource() == &resource && chunk.get_allocator().resource() == &resource);
+			TM2D_CHECK(listed.get_allocator().resource() == &resource && viewed.get_allocator().resource() == &resource);
+			TM2D_CHECK(resource.allocations >= 7);
+		}
+		TM2D_CHECK(resource.outstanding() == 0 && resource.allocations == resource.deallocations);
+	}
+
+	// fillArea() takes its temporary buffers from the scratch resource.
+	{
+		CountingResource scratch;
+		TileMap2D_1D<uint8_t> map(50, 50, 0);
+		fillRect(map, { 10, 0, 1, 40 }, 1);
+		TM2D_CHECK(fillArea(map, { 0, 0 }, [](uint8_t tile) { return tile == 0; }, uint8_t(2), false, &scratch) == Rect(0, 0, 50, 50));
+		TM2D_CHECK(scratch.allocations > 0 && scratch.outstanding() == 0);
+	}
+
+	TM2D_CHECK(fallback.allocations == 0);
+	std::pmr::set_default_resource(nullptr);
+
+	return 0;
+}
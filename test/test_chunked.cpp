@@ -0,0 +1,89 @@
+#include "TileMap2D_Chunked.h"
+#include "test.h"
+
+using namespace tm2D;
+
+int main()
+{
+	std::mt19937 rng(6);
+
+	// The same operations on a chunked tilemap and on a TileMap2D_1D give the same tiles.
+	for (int trial = 0; trial < 30; trial++) {
+		const size_t width = 1 + rng() % 70, height = 1 + rng() % 70;
+		TileMap2D_1D<uint16_t> expected(width, height, 0);
+		TileMap2D_Chunked<uint16_t, 3> chunked(width, height);
+
+		test::compareOperations(chunked, expected, rng, 40);
+
+		// Resizing keeps the tiles in both sizes and pads the new space.
+		const size_t new_width = rng() % 90, new_height = rng() % 90;
+		TileMap2D_1D<uint16_t> resized;
+		getChunk(&resized, &expected, { 0, 0, new_width, new_height });
+		chunked.resize(new_width, new_height);
+		TM2D_CHECK(test::sameTiles(chunked, resized));
+	}
+
+	// Rotating a non-square tilemap in place keeps its padding, and only allocates the chunks holding other tiles.
+	{
+		TileMap2D_Chunked<uint8_t, 3> chunked(40, 20, 9);
+		chunked(3, 17) = 1;
+		TM2D_CHECK(rot90(&chunked, true));
+		TM2D_CHECK(chunked.width() == 20 && chunked.height() == 40);
+		TM2D_CHECK(chunked.padding() == 9);
+		TM2D_CHECK(chunked.allocatedChunks() == 1);
+		TM2D_CHECK(chunked(17, 36) == 1 && chunked(16, 36) == 9 && chunked(0, 0) == 9);
+	}
+
+
+	// Released chunks read as the padding tile, and are allocated again filled with it.
+	{
+		TileMap2D_Chunked<int16_t, 3> chunked(20, 12, -1);
+		fillRect(chunked, { 0, 0, 20, 12 }, 4);
+		TM2D_CHECK(chunked.allocatedChunks() == 6);
+		chunked.releaseChunk(1, 0);
+		TM2D_CHECK(chunked.allocatedChunks() == 5 && chunked.chunk(1, 0) == NULL);
+		TM2D_CHECK(std::as_const(chunked)(8, 0) == -1 && std::as_const(chunked)(15, 7) == -1 && std::as_const(chunked)(16, 0) == 4);
+		chunked(9, 1) = 2;
+		TM2D_CHECK(std::as_const(chunked)(8, 0) == -1 && std::as_const(chunked)(9, 1) == 2);
+	}
+
+	// Adopted chunks are used without copying, and their tiles outside of chunkRect() are revealed as padding when the tilemap grows.
+	{
+		TileMap2D_Chunked<int16_t, 3> chunked(20, 12, -1);
+		const Rect edge = chunked.chunkRect(2, 1);
+		TM2D_CHECK((edge == Rect(16, 8, 4, 4)));
+
+		std::unique_ptr<int16_t[]> tiles = std::make_unique<int16_t[]>(8 * 8);
+		for (size_t y = 0; y < 8; y++)
+			for (size_t x = 0; x < 8; x++) tiles[x + 8 * y] = x < edge.width && y < edge.height ? int16_t(x + 10 * y) : -1;
+		const int16_t* const data = tiles.get();
+		chunked.adoptChunk(2, 1, std::move(tiles));
+		TM2D_CHECK(chunked.chunk(2, 1) == data && chunked.allocatedChunks() == 1);
+		TM2D_CHECK(std::as_const(chunked)(17, 10) == 21 && std::as_const(chunked)(19, 11) == 33);
+
+		size_t visited = 0;
+		chunked.forEachChunk([&](size_t cx, size_t cy, const Rect& area, const int16_t* chunk) {
+			TM2D_CHECK(cx == 2 && cy == 1 && area == edge && chunk == data);
+			visited++;
+		});
+		TM2D_CHECK(visited == 1);
+
+		chunked.resize(24, 16);
+		TM2D_CHECK(chunked.chunk(2, 1) == data && std::as_const(chunked)(17, 10) == 21);
+		TM2D_CHECK(std::as_const(chunked)(20, 8) == -1 && std::as_const(chunked)(16, 12) == -1 && std::as_const(chunked)(23, 15) == -1);
+
+		// Shrinking through the chunk resets its tiles past the new size, so that growing again shows the padding.
+		chunked.resize(18, 10);
+		chunked.resize(24, 16);
+		TM2D_CHECK(std::as_const(chunked)(17, 9) == 11 && std::as_const(chunked)(18, 9) == -1 && std::as_const(chunked)(17, 10) == -1);
+		TM2D_CHECK(chunked.chunk(2, 1) == data);
+
+		// Copies own their chunks.
+		TileMap2D_Chunked<int16_t, 3> copy = chunked;
+		TM2D_CHECK(copy.chunk(2, 1) != data && copy.padding() == -1 && test::sameTiles(copy, chunked));
+		copy(16, 8) = 7;
+		TM2D_CHECK(std::as_const(chunked)(16, 8) == 0);
+	}
+
+	return 0;
+}
@@ -0,0 +1,130 @@
+#include "TileMap2D.h"
+#include "TileMap2D_Chunked.h"
+#include "test.h"
+
+#include <string>
+
+using namespace tm2D;
+
+// Get a tile of [T] for a small [value].
+template<typename T>
+T tileOf(uint16_t value)
+{
+	if constexpr (std::same_as<T, std::string>) return std::string(value, 'x');
+	else return T(value);
+}
+
+// Get a [width] x [height] tilemap of random tiles of [T].
+template<typename T>
+TileMap2D_1D<T> randomMap(std::mt19937& rng, size_t width, size_t height)
+{
+	TileMap2D_1D<T> map(width, height, T());
+	for (size_t y = 0; y < height; y++)
+		for (size_t x = 0; x < width; x++)
+			map(x, y) = tileOf<T>(uint16_t(rng() % 20));
+	return map;
+}
+
+// Check setChunk() from [map] to itself, shifting areas by up to 5 tiles in every direction, against copies through a temporary on [expected], a TileMap2D_1D of the same size and tiles.
+template<typename M, typename T>
+void checkSelfCopies(M& map, TileMap2D_1D<T>& expected, std::mt19937& rng)
+{
+	const size_t width = expected.width(), height = expected.height();
+	for (int op = 0; op < 40; op++) {
+		const Rect src_area(rng() % (width + 3), rng() % (height + 3), rng() % (width + 5), rng() % (height + 5));
+		const ptrdiff_t dx = ptrdiff_t(rng() % 11) - 5, dy = ptrdiff_t(rng() % 11) - 5;
+		const size_t x = size_t(std::max<>(ptrdiff_t(src_area.x) + dx, ptrdiff_t(0))), y = size_t(std::max<>(ptrdiff_t(src_area.y) + dy, ptrdiff_t(0)));
+
+		// The default area is the whole tilemap.
+		TileMap2D_1D<T> copy;
+		getChunk(&copy, &expected, (src_area == Rect() ? Rect(0, 0, width, height) : src_area).intersection({ 0, 0, width, height }));
+		const Rect expected_result = setChunk(&expected, &copy, x, y);
+		TM2D_CHECK(test::sameArea(setChunk(&map, &map, x, y, src_area), expected_result));
+		TM2D_CHECK(test::sameTiles(map, expected));
+	}
+}
+
+// Check getChunk() and setChunk() on a view of [area] of a buffer padded on every side, leaving the tiles outside of the view untouched.
+template<typename T>
+void checkSubviews(std::mt19937& rng)
+{
+	for (int trial = 0; trial < 200; trial++) {
+		TileMap2D_1D<T> buffer = randomMap<T>(rng, 1 + rng() % 50, 1 + rng() % 50);
+		const Rect area(rng() % buffer.width(), rng() % buffer.height(), rng() % buffer.width(), rng() % buffer.height());
+		TileMap2DView<T> view = buffer.subview(area);
+		const Rect cliprect = area.intersection({ 0, 0, buffer.width(), buffer.height() });
+		TM2D_CHECK(view.width() == cliprect.width && view.height() == cliprect.height && view.pitch() == buffer.width());
+
+		TileMap2D_1D<T> tiles;
+		getChunk(&tiles, &buffer, cliprect);
+		TM2D_CHECK(test::sameTiles(view, tiles));
+
+		// Chunks partly outside of the view are padded, not read from the rest of the buffer.
+		const Rect chunk_area(rng() % (view.width() + 3), rng() % (view.height() + 3), rng() % (view.width() + 5), rng() % (view.height() + 5));
+		TileMap2D_1D<T> chunk, chunk_expected;
+		getChunk(&chunk, &view, chunk_area);
+		getChunk(&chunk_expected, &tiles, chunk_area);
+		TM2D_CHECK(test::sameTiles(chunk, chunk_expected));
+
+		// Writes are clipped to the view.
+		const TileMap2D_1D<T> input = randomMap<T>(rng, rng() % 30, rng() % 30);
+		const size_t x = rng() % (view.width() + 3), y = rng() % (view.height() + 3);
+		const Rect src_area(rng() % (input.width() + 2), rng() % (input.height() + 2), rng() % (input.width() + 3), rng() % (input.height() + 3));
+		TileMap2D_1D<T> buffer_expected = buffer;
+		const Rect written = setChunk(&tiles, &input, x, y, src_area);
+		setChunk(&buffer_expected, &tiles, cliprect.x, cliprect.y);
+		TM2D_CHECK(test::sameArea(setChunk(&view, &input, x, y, src_area), written));
+		TM2D_CHECK(test::sameTiles(buffer, buffer_expected));
+
+		// Views of the same buffer may overlap.
+		const Rect other_area(rng() % buffer.width(), rng() % buffer.height(), rng() % buffer.width(), rng() % buffer.height());
+		const TileMap2DView<T> other = buffer.subview(other_area);
+		TileMap2D_1D<T> other_tiles;
+		getChunk(&other_tiles, &other, { 0, 0, other.width(), other.height() });
+		setChunk(&tiles, &other_tiles, 0, 0);
+		setChunk(&buffer_expected, &tiles, cliprect.x, cliprect.y);
+		setChunk(&view, &other, 0, 0);
+		TM2D_CHECK(test::sameTiles(buffer, buffer_expected));
+	}
+}
+
+// Check the copies of [T] tiles within contiguous, pitched and chunked tilemaps.
+template<typename T>
+void checkCopies(std::mt19937& rng)
+{
+	for (int trial = 0; trial < 100; trial++) {
+		const TileMap2D_1D<T> tiles = randomMap<T>(rng, rng() % 40, rng() % 40);
+		{
+			TileMap2D_1D<T> map = tiles, expected = tiles;
+			checkSelfCopies(map, expected, rng);
+		}
+		{
+			TileMap2D_1D<T> buffer = randomMap<T>(rng, tiles.width() + 7, tiles.height() + 3);
+			setChunk(&buffer, &tiles, 4, 2);
+			TileMap2D_1D<T> buffer_expected = buffer, expected = tiles;
+			TileMap2DView<T> view = buffer.subview({ 4, 2, tiles.width(), tiles.height() });
+			checkSelfCopies(view, expected, rng);
+			setChunk(&buffer_expected, &expected, 4, 2);
+			TM2D_CHECK(test::sameTiles(buffer, buffer_expected));
+		}
+		{
+			TileMap2D_Chunked<T, 3> map(tiles.width(), tiles.height());
+			setChunk(&map, &tiles, 0, 0);
+			TileMap2D_1D<T> expected = tiles;
+			checkSelfCopies(map, expected, rng);
+		}
+	}
+	checkSubviews<T>(rng);
+}
+
+int main()
+{
+	std::mt19937 rng(1);
+
+	// Trivially copyable tiles are moved with 'memmove', the others one by one.
+	checkCopies<uint16_t>(rng);
+	checkCopies<uint64_t>(rng);
+	checkCopies<std::string>(rng);
+
+	return 0;
+}
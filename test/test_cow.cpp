@@ -0,0 +1,120 @@
+#include "TileMap2D_Chunked.h"
+#include "TileMap2D_Parallel.h"
+#include "test.h"
+
+using namespace tm2D;
+
+int main()
+{
+	std::mt19937 rng(23);
+
+	// The same operations on a copy-on-write tilemap and on a TileMap2D_1D give the same tiles, and leave the snapshots taken in between as they were.
+	for (int trial = 0; trial < 30; trial++) {
+		const size_t width = 1 + rng() % 70, height = 1 + rng() % 70;
+		TileMap2D_1D<uint16_t> expected(width, height, 0);
+		TileMap2D_CoW<uint16_t, 3> cow(width, height);
+
+		std::vector<std::pair<TileMap2D_CoW<uint16_t, 3>, TileMap2D_1D<uint16_t>>> snapshots;
+		for (int batch = 0; batch < 4; batch++) {
+			snapshots.emplace_back(cow.snapshot(), expected);
+			test::compareOperations(cow, expected, rng, 10);
+		}
+		for (const auto& [snapshot, tiles] : snapshots) TM2D_CHECK(test::sameTiles(snapshot, tiles));
+
+		// Restoring a snapshot is an assignment.
+		cow = snapshots[1].first;
+		TM2D_CHECK(test::sameTiles(cow, snapshots[1].second));
+	}
+
+	// Writes only clone the chunks they change.
+	{
+		TileMap2D_CoW<uint8_t, 3> cow(64, 40, 0);
+		fillRect(cow, { 0, 0, 64, 40 }, 1);
+		TM2D_CHECK(cow.allocatedChunks() == 40);
+		const TileMap2D_CoW<uint8_t, 3> snapshot = cow.snapshot();
+		TM2D_CHECK(cow.sharedChunks() == 40 && cow.changedAreas(snapshot).empty());
+
+		// Writing the tiles' own values keeps the chunks shared.
+		cow.set(10, 10, 1);
+		fillRect(cow, { 8, 8, 30, 20 }, 1);
+		replace(cow, uint8_t(2), uint8_t(3));
+		TM2D_CHECK(cow.sharedChunks() == 40);
+
+		cow.set(10, 10, 2);
+		TM2D_CHECK(!cow.isShared(1, 1) && cow.sharedChunks() == 39 && snapshot.sharedChunks() == 39);
+		TM2D_CHECK(cow.changedAreas(snapshot) == std::vector<Rect>{ Rect(8, 8, 8, 8) });
+		TM2D_CHECK(snapshot(10, 10) == 1);
+
+		// Parallel writes are made sequentially, cloning the chunks they change.
+		const execution::parallel_policy par = execution::par.withThreshold(0);
+		forEachTile(par, cow, [](uint8_t& tile, size_t x, size_t) { tile = uint8_t(x); });
+		TM2D_CHECK(cow.sharedChunks() == 0 && snapshot.sharedChunks() == 0);
+		TM2D_CHECK(cow(63, 39) == 63);
+		TM2D_CHECK(test::sameTiles(snapshot, TileMap2D_1D<uint8_t>(64, 40, 1)));
+	}
+
+	// Rotating a non-square tilemap in place keeps its padding, and only allocates the chunks holding other tiles.
+	{
+		TileMap2D_CoW<uint8_t, 3> cow(40, 20, 9);
+		cow(3, 17) = 1;
+		const TileMap2D_CoW<uint8_t, 3> snapshot = cow.snapshot();
+		TM2D_CHECK(rot90(&cow, true));
+		TM2D_CHECK(cow.width() == 20 && cow.height() == 40);
+		TM2D_CHECK(cow.padding() == 9);
+		TM2D_CHECK(cow.allocatedChunks() == 1);
+		TM2D_CHECK(cow(17, 36) == 1 && cow(16, 36) == 9 && cow(0, 0) == 9);
+		TM2D_CHECK(snapshot.width() == 40 && snapshot(3, 17) == 1);
+	}
+
+
+	// Chunks are cloned only while another copy holds them: once they are no longer shared, writes go to the same buffer.
+	{
+		TileMap2D_CoW<uint16_t, 3> cow(20, 20, 0);
+		fillRect(cow, { 0, 0, 20, 20 }, 1);
+		const uint16_t* const original = cow.chunk(0, 0);
+		cow(1, 1) = 2;
+		TM2D_CHECK(cow.chunk(0, 0) == original && !cow.isShared(0, 0));
+
+		TileMap2D_CoW<uint16_t, 3> first = cow, second = cow;
+		TM2D_CHECK(cow.isShared(0, 0) && first.chunk(0, 0) == original && second.chunk(0, 0) == original);
+
+		// The first write clones the chunk for this copy only: the two others still share the original.
+		cow(1, 1) = 3;
+		const uint16_t* const cloned = cow.chunk(0, 0);
+		TM2D_CHECK(cloned != original && !cow.isShared(0, 0) && first.isShared(0, 0) && second.isShared(0, 0));
+		TM2D_CHECK(cow(2, 2) == 1 && std::as_const(first)(1, 1) == 2 && std::as_const(second)(1, 1) == 2);
+		cow(2, 2) = 4;
+		TM2D_CHECK(cow.chunk(0, 0) == cloned);
+
+		// Without the second copy, the first one owns the original again.
+		second = TileMap2D_CoW<uint16_t, 3>();
+		TM2D_CHECK(!first.isShared(0, 0));
+		first(1, 1) = 5;
+		TM2D_CHECK(first.chunk(0, 0) == original && std::as_const(cow)(1, 1) == 3);
+
+		// Chunks are shared again by assignment.
+		cow = first;
+		TM2D_CHECK(cow.chunk(0, 0) == original && cow.isShared(0, 0) && cow.sharedChunks() == cow.allocatedChunks());
+	}
+
+	// changedAreas() lists the chunks with other buffers than the other copy, clipped to the tilemap, row by row.
+	{
+		TileMap2D_CoW<uint8_t, 3> cow(20, 12, 0);
+		cow(0, 0) = 1;
+		const TileMap2D_CoW<uint8_t, 3> snapshot = cow.snapshot();
+		TM2D_CHECK(cow.changedAreas(snapshot).empty() && snapshot.changedAreas(cow).empty());
+
+		// Allocating a chunk, and cloning one without changing its tiles, count as changes.
+		cow(19, 11) = 2;
+		cow(3, 3) = 1;
+		cow.set(9, 1, 0);
+		const std::vector<Rect> expected = { Rect(0, 0, 8, 8), Rect(16, 8, 4, 4) };
+		TM2D_CHECK(cow.changedAreas(snapshot) == expected && snapshot.changedAreas(cow) == expected);
+
+		// Restoring the snapshot undoes all of them.
+		cow = snapshot;
+		TM2D_CHECK(cow.changedAreas(snapshot).empty() && std::as_const(cow)(19, 11) == 0);
+	}
+
+	return 0;
+}
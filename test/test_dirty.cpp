@@ -0,0 +1,72 @@
+#include "TileMap2D_Dirty.h"
+#include "TileMap2D_Parallel.h"
+#include "TileMap2D_Chunked.h"
+#include "test.h"
+
+using namespace tm2D;
+
+// Whether exactly the cells of [tracker] overlapping [area] are dirty.
+template<size_t CellShift>
+bool dirtyExactly(const DirtyTracker<CellShift>& tracker, const Rect& area)
+{
+	for (size_t cy = 0; cy < tracker.cellsY(); cy++) {
+		for (size_t cx = 0; cx < tracker.cellsX(); cx++) {
+			const Rect cell = tracker.cellRect(cx, cy);
+			if (tracker.isDirty(cx, cy) != (cell.intersection(area).width != 0)) return false;
+		}
+	}
+	return true;
+}
+
+int main()
+{
+	std::mt19937 rng(14);
+
+	// Writes through the tile accessors and the members.
+	{
+		TileMap2D_Tracked<TileMap2D_1D<uint8_t>, 3> tracked(TileMap2D_1D<uint8_t>(50, 40, 0));
+		TM2D_CHECK(!tracked.hasDirty());
+		tracked(17, 9) = 1;
+		TM2D_CHECK(dirtyExactly(tracked.tracker(), { 17, 9, 1, 1 }));
+		TM2D_CHECK(tracked.consumeDirty() == std::vector<Rect>{ Rect(16, 8, 8, 8) });
+		TM2D_CHECK(!tracked.hasDirty());
+
+		tracked.fillRect({ 3, 30, 20, 20 }, 2);
+		TM2D_CHECK(dirtyExactly(tracked.tracker(), { 3, 30, 20, 10 }));
+		TM2D_CHECK(tracked.map()(22, 39) == 2);
+		tracked.clearDirty();
+
+		const TileMap2D_1D<uint8_t> input(9, 9, 3);
+		TM2D_CHECK(tracked.setChunk(&input, 45, 0) == Rect(45, 0, 5, 9));
+		TM2D_CHECK(dirtyExactly(tracked.tracker(), { 45, 0, 5, 9 }));
+	}
+
+	// Tracking a tilemap allocating on writes, which the parallel algorithms write sequentially.
+	static_assert(allocates_on_write<TileMap2D_Tracked<TileMap2D_Chunked<uint16_t, 4>>> && !allocates_on_write<TileMap2D_Tracked<TileMap2D_1D<uint16_t>>>);
+
+	// Concurrent writes from the parallel algorithms, which must be free of data races.
+	const execution::parallel_policy policy = execution::par.withThreshold(0);
+	for (int trial = 0; trial < 20; trial++) {
+		TileMap2D_1D<uint16_t> input(rng() % 200, rng() % 200, 0);
+		test::randomize(input, rng, 100);
+		TileMap2D_Tracked<TileMap2D_1D<uint16_t>> tracked(TileMap2D_1D<uint16_t>(150, 150, 0));
+
+		const size_t x = rng() % 160, y = rng() % 160;
+		const Rect area = setChunk(policy, &tracked, &input, x, y);
+		TM2D_CHECK(area == Rect(x, y, input.width(), input.height()).intersection({ 0, 0, 150, 150 }));
+		TM2D_CHECK(dirtyExactly(tracked.tracker(), area));
+		for (size_t ty = 0; ty < area.height; ty++)
+			for (size_t tx = 0; tx < area.width; tx++)
+				TM2D_CHECK(std::as_const(tracked)(area.x + tx, area.y + ty) == input(tx, ty));
+
+		tracked.clearDirty();
+		forEachTile(policy, tracked, [](uint16_t& tile, size_t, size_t) { tile++; });
+		TM2D_CHECK(dirtyExactly(tracked.tracker(), { 0, 0, 150, 150 }));
+
+		tracked.clearDirty();
+		flip(policy, tracked, true, true);
+		TM2D_CHECK(dirtyExactly(tracked.tracker(), { 0, 0, 150, 150 }));
+	}
+
+	return 0;
+}
@@ -0,0 +1,87 @@
+#include "TileMap2D.h"
+#include "TileMap2D_Chunked.h"
+#include "test.h"
+
+#include <deque>
+#include <memory_resource>
+
+using namespace tm2D;
+
+// Fill the area of [map] around [center] with [elem] by a breadth-first search over the tiles satisfying [rule] before the fill, and get its bounding rectangle.
+template<typename Rule>
+Rect naiveFill(TileMap2D_1D<uint8_t>& map, const Point& center, Rule rule, uint8_t elem, bool eight_connected)
+{
+	const size_t width = map.width(), height = map.height();
+	if (center.x >= width || center.y >= height) return {};
+
+	TileMap2D_1D<uint8_t> reached(width, height, 0);
+	std::deque<Point> queue = { center };
+	reached(center.x, center.y) = 1;
+	size_t min_x = width, min_y = height, max_x = 0, max_y = 0;
+
+	while (!queue.empty()) {
+		const Point p = queue.front();
+		queue.pop_front();
+		min_x = std::min<>(min_x, p.x);
+		min_y = std::min<>(min_y, p.y);
+		max_x = std::max<>(max_x, p.x + 1);
+		max_y = std::max<>(max_y, p.y + 1);
+
+		for (int dy = -1; dy <= 1; dy++) {
+			for (int dx = -1; dx <= 1; dx++) {
+				if ((!dx && !dy) || (!eight_connected && dx && dy)) continue;
+				const size_t x = p.x + dx, y = p.y + dy;
+				if (x >= width || y >= height || reached(x, y) || !rule(map(x, y))) continue;
+				reached(x, y) = 1;
+				queue.push_back({ x, y });
+			}
+		}
+	}
+
+	for (size_t y = 0; y < height; y++)
+		for (size_t x = 0; x < width; x++)
+			if (reached(x, y)) map(x, y) = elem;
+	return { min_x, min_y, max_x - min_x, max_y - min_y };
+}
+
+int main()
+{
+	std::mt19937 rng(4);
+	std::pmr::monotonic_buffer_resource scratch;
+
+	// The filled tiles and their bounding rectangle are the breadth-first search's, on contiguous and chunked tilemaps.
+	for (int trial = 0; trial < 1000; trial++) {
+		TileMap2D_1D<uint8_t> map(1 + rng() % 60, 1 + rng() % 60, 0);
+		test::randomize(map, rng, 4, 1 + rng() % 6);
+		TileMap2D_Chunked<uint8_t, 3> chunked(map.width(), map.height());
+		setChunk(&chunked, &map, 0, 0);
+
+		// The center may not satisfy the rule, or be out of bounds. [elem] may still satisfy the rule.
+		const Point center = { rng() % (map.width() + 2), rng() % (map.height() + 2) };
+		const uint8_t below = uint8_t(1 + rng() % 3), elem = uint8_t(rng() % 4);
+		const auto rule = [below](uint8_t tile) { return tile < below; };
+		const bool eight_connected = rng() % 2;
+
+		TileMap2D_1D<uint8_t> expected = map;
+		const Rect area = naiveFill(expected, center, rule, elem, eight_connected);
+		TM2D_CHECK(fillArea(map, center, rule, elem, eight_connected, trial % 2 ? &scratch : std::pmr::get_default_resource()) == area);
+		TM2D_CHECK(test::sameTiles(map, expected));
+		TM2D_CHECK(fillArea(chunked, center, rule, elem, eight_connected) == area);
+		TM2D_CHECK(test::sameTiles(chunked, expected));
+		scratch.release();
+	}
+
+	// Spans through a maze of walls, over a large area.
+	{
+		TileMap2D_1D<uint8_t> map(300, 200, 0);
+		for (size_t x = 2; x < 300; x += 4)
+			fillRect(map, { x, size_t(x % 8 == 2 ? 0 : 1), 1, 199 }, 1);
+		TileMap2D_1D<uint8_t> expected = map;
+		const auto rule = [](uint8_t tile) { return tile == 0; };
+		TM2D_CHECK(fillArea(map, { 0, 0 }, rule, 0) == naiveFill(expected, { 0, 0 }, rule, 0, false));
+		TM2D_CHECK(fillArea(map, { 299, 199 }, rule, 2) == naiveFill(expected, { 299, 199 }, rule, 2, false));
+		TM2D_CHECK(test::sameTiles(map, expected));
+	}
+
+	return 0;
+}
@@ -0,0 +1,120 @@
+#include "TileMap2D.h"
+#include "TileMap2D_Chunked.h"
+#include "test.h"
+
+using namespace tm2D;
+
+// A tile of 16 bytes, with no SIMD kernel.
+struct Tile16
+{
+	uint64_t low = 0;
+	uint64_t high = 0;
+
+	bool operator==(const Tile16&) const = default;
+};
+
+// Get a random tile.
+template<typename T>
+T randomTile(std::mt19937& rng)
+{
+	if constexpr (std::same_as<T, Tile16>) return { rng(), rng() };
+	else return T(rng());
+}
+
+// Get a [width] x [height] tilemap of random tiles.
+template<typename T>
+TileMap2D_1D<T> randomMap(size_t width, size_t height, std::mt19937& rng)
+{
+	TileMap2D_1D<T> map(width, height, T());
+	for (size_t y = 0; y < height; y++)
+		for (size_t x = 0; x < width; x++)
+			map(x, y) = randomTile<T>(rng);
+	return map;
+}
+
+// Get [input] mirrored tile by tile, with rows [y_begin; y_end) and their mirrored rows mirrored vertically, and rows [reversed_begin; reversed_end) mirrored horizontally.
+template<TileMapLike In>
+TileMap2D_1D<tile_t<In>> naiveMirror(const In& input, bool horizontal, size_t y_begin, size_t y_end, size_t reversed_begin, size_t reversed_end)
+{
+	const size_t width = input.width(), height = input.height();
+	TileMap2D_1D<tile_t<In>> output(width, height, tile_t<In>());
+	for (size_t y = 0; y < height; y++) {
+		const bool mirrored = (y >= y_begin && y < y_end) || (height - 1 - y >= y_begin && height - 1 - y < y_end);
+		const bool reversed = horizontal && (mirrored || (y >= reversed_begin && y < reversed_end));
+		for (size_t x = 0; x < width; x++)
+			output(x, y) = input(reversed ? width - 1 - x : x, mirrored ? height - 1 - y : y);
+	}
+	return output;
+}
+
+// Get [input] flipped tile by tile.
+template<TileMapLike In>
+TileMap2D_1D<tile_t<In>> naiveFlip(const In& input, bool horizontal, bool vertical)
+{
+	return naiveMirror(input, horizontal, 0, vertical ? input.height() / 2 : 0, 0, input.height());
+}
+
+// Check the flips of [T] tiles against the naive ones, on widths around the SIMD kernels and odd and even heights.
+template<typename T>
+void checkFlips(std::mt19937& rng)
+{
+	for (int trial = 0; trial < 60; trial++) {
+		const TileMap2D_1D<T> map = randomMap<T>(rng() % 150, rng() % 20, rng);
+
+		for (int horizontal = 0; horizontal < 2; horizontal++) {
+			for (int vertical = 0; vertical < 2; vertical++) {
+				const TileMap2D_1D<T> expected = naiveFlip(map, horizontal, vertical);
+				TileMap2D_1D<T> flipped = map;
+				flip(flipped, horizontal, vertical);
+				TM2D_CHECK(test::sameTiles(flipped, expected));
+
+				// Not contiguous.
+				TileMap2D_Chunked<T, 3> chunked(map.width(), map.height());
+				setChunk(&chunked, &map, 0, 0);
+				flip(chunked, horizontal, vertical);
+				TM2D_CHECK(test::sameTiles(chunked, expected));
+			}
+		}
+
+		// The row kernels on bands of rows, as split by the parallel policy.
+		const size_t height = map.height(), half = height / 2;
+		const size_t y_begin = rng() % (half + 1), y_end = y_begin + rng() % (half - y_begin + 1);
+		const size_t reversed_begin = rng() % (height + 1), reversed_end = reversed_begin + rng() % (height - reversed_begin + 1);
+		TileMap2D_1D<T> rows = map;
+		detail::reverseRows(rows, reversed_begin, reversed_end);
+		TM2D_CHECK(test::sameTiles(rows, naiveMirror(map, true, 0, 0, reversed_begin, reversed_end)));
+		rows = map;
+		detail::swapMirroredRows(rows, y_begin, y_end);
+		TM2D_CHECK(test::sameTiles(rows, naiveMirror(map, false, y_begin, y_end, 0, 0)));
+		rows = map;
+		detail::swapReversedMirroredRows(rows, y_begin, y_end);
+		TM2D_CHECK(test::sameTiles(rows, naiveMirror(map, true, y_begin, y_end, 0, 0)));
+	}
+
+	// Pitched subviews, leaving the tiles around them untouched.
+	for (int trial = 0; trial < 60; trial++) {
+		TileMap2D_1D<T> map = randomMap<T>(1 + rng() % 150, 1 + rng() % 20, rng);
+		const Rect area(rng() % map.width(), rng() % map.height(), rng() % 150, rng() % 20);
+		const bool horizontal = rng() % 2, vertical = rng() % 2;
+
+		TileMap2DView<T> view = map.subview(area);
+		TileMap2D_1D<T> expected = map;
+		const TileMap2D_1D<T> naive = naiveFlip(view, horizontal, vertical);
+		setChunk(&expected, &naive, area.x, area.y);
+		flip(view, horizontal, vertical);
+		TM2D_CHECK(test::sameTiles(map, expected));
+	}
+}
+
+int main()
+{
+	std::mt19937 rng(19);
+
+	checkFlips<uint8_t>(rng);
+	checkFlips<uint16_t>(rng);
+	checkFlips<uint32_t>(rng);
+	checkFlips<uint64_t>(rng);
+	checkFlips<Tile16>(rng);
+
+	return 0;
+}
@@ -0,0 +1,111 @@
+#include "TileMap2D.h"
+#include "TileMap2D_Chunked.h"
+#include "test.h"
+
+using namespace tm2D;
+
+// A type-erased tilemap only implementing the virtual accessors, so that the default gather() and scatter() of TileMap2DImpl are used.
+struct Erased: public TileMap2DImpl<uint16_t>
+{
+	explicit Erased(TileMap2D_1D<uint16_t> tiles)
+		: tiles(std::move(tiles)) {}
+
+	size_t width() const final { return tiles.width(); }
+	size_t height() const final { return tiles.height(); }
+	uint16_t& operator()(size_t x, size_t y) final { return tiles(x, y); }
+	const uint16_t& operator()(size_t x, size_t y) const final { return tiles(x, y); }
+
+	TileMap2D_1D<uint16_t> tiles;
+};
+
+// Check gather() and scatter() on [map] against get() and set() point by point on [expected], a TileMap2D_1D of the same size and tiles.
+template<typename M>
+void checkBatches(M& map, TileMap2D_1D<uint16_t>& expected, std::mt19937& rng)
+{
+	const size_t width = expected.width(), height = expected.height();
+	for (int batch = 0; batch < 20; batch++) {
+		// Points in and out of bounds, possibly repeated, and more or fewer tiles than points.
+		std::vector<Point> points(rng() % 100);
+		for (Point& p : points) p = { rng() % (width + 10), rng() % (height + 10) };
+		if (!points.empty() && batch % 4 == 0) points.back() = { SIZE_MAX, 0 };
+		const size_t count = std::min<>(points.size(), size_t(rng() % 120));
+
+		size_t within = 0;
+		for (size_t i = 0; i < count; i++) within += points[i].x < width && points[i].y < height;
+
+		std::vector<uint16_t> tiles(count + rng() % 3 * (points.size() - count), 99);
+		const size_t read = std::min<>(points.size(), tiles.size());
+		size_t read_within = 0;
+		for (size_t i = 0; i < read; i++) read_within += points[i].x < width && points[i].y < height;
+
+		TM2D_CHECK(gather(std::as_const(map), std::span<const Point>(points), std::span<uint16_t>(tiles)) == read_within);
+		for (size_t i = 0; i < tiles.size(); i++) TM2D_CHECK(tiles[i] == (i < read ? expected.get(points[i].x, points[i].y) : 99));
+
+		for (uint16_t& tile : tiles) tile = uint16_t(rng() % 5);
+		const std::span<const uint16_t> written(tiles.data(), count);
+		TM2D_CHECK(scatter(map, std::span<const Point>(points), written) == within);
+		for (size_t i = 0; i < count; i++) expected.set(points[i].x, points[i].y, tiles[i]);
+		TM2D_CHECK(test::sameTiles(map, expected));
+	}
+}
+
+int main()
+{
+	std::mt19937 rng(27);
+
+	for (int trial = 0; trial < 50; trial++) {
+		TileMap2D_1D<uint16_t> tiles(rng() % 40, rng() % 40, 0);
+		test::randomize(tiles, rng, 5);
+
+		// Contiguous, pitched, chunked and sparse tilemaps.
+		{
+			TileMap2D_1D<uint16_t> map = tiles, expected = tiles;
+			checkBatches(map, expected, rng);
+		}
+		{
+			TileMap2D_1D<uint16_t> buffer(tiles.width() + 7, tiles.height() + 3, 1);
+			setChunk(&buffer, &tiles, 4, 2);
+			TileMap2D_1D<uint16_t> buffer_expected = buffer, expected = tiles;
+			TileMap2DView<uint16_t> view = buffer.subview({ 4, 2, tiles.width(), tiles.height() });
+			checkBatches(view, expected, rng);
+			setChunk(&buffer_expected, &expected, 4, 2);
+			TM2D_CHECK(test::sameTiles(buffer, buffer_expected));
+		}
+		{
+			TileMap2D_Chunked<uint16_t, 3> map(tiles.width(), tiles.height());
+			setChunk(&map, &tiles, 0, 0);
+			TileMap2D_1D<uint16_t> expected = tiles;
+			checkBatches(map, expected, rng);
+		}
+		{
+			TileMap2D_Sparse<uint16_t, 3> map(tiles.width(), tiles.height());
+			setChunk(&map, &tiles, 0, 0);
+			TileMap2D_1D<uint16_t> expected = tiles;
+			checkBatches(map, expected, rng);
+		}
+
+		// Type-erased, through the overrides of StaticTileMap2DImpl and through the default virtual functions.
+		{
+			TileMap2D_Chunked<uint16_t, 3> map(tiles.width(), tiles.height());
+			setChunk(&map, &tiles, 0, 0);
+			TileMap2DImpl<uint16_t>& erased = map;
+			TileMap2D_1D<uint16_t> expected = tiles;
+			checkBatches(erased, expected, rng);
+		}
+		{
+			Erased map(tiles);
+			TileMap2DImpl<uint16_t>& erased = map;
+			TileMap2D_1D<uint16_t> expected = tiles;
+			checkBatches(erased, expected, rng);
+
+			// The member functions make one virtual call for the batch.
+			const std::vector<Point> points = { { 0, 0 }, { tiles.width(), 0 } };
+			std::vector<uint16_t> batch(2, 7);
+			TM2D_CHECK(erased.scatter(points, batch) == (tiles.width() && tiles.height() ? 1 : 0));
+			TM2D_CHECK(erased.gather(points, batch) == (tiles.width() && tiles.height() ? 1 : 0));
+			TM2D_CHECK(batch[0] == (tiles.width() && tiles.height() ? 7 : 0) && batch[1] == 0);
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,163 @@
+// Every header compiled together, with the class templates explicitly instantiated and the function templates called once on small tilemaps,
+// so that the templates no other target uses keep compiling.
+
+#include "TileMap2D.h"
+#include "TileMap2D_Chunked.h"
+#include "TileMap2D_Dirty.h"
+#include "TileMap2D_Image.h"
+#include "TileMap2D_Integral.h"
+#include "TileMap2D_Label.h"
+#include "TileMap2D_Layers.h"
+#include "TileMap2D_MMap.h"
+#include "TileMap2D_Packed.h"
+#include "TileMap2D_Parallel.h"
+#include "TileMap2D_Path.h"
+#include "TileMap2D_Resample.h"
+#include "TileMap2D_Serialize.h"
+#include "TileMap2D_Stencil.h"
+#include "TileMap2D_Streaming.h"
+#include "test.h"
+
+#include <cstdio>
+#include <sstream>
+
+template struct tm2D::TileMap2DView<uint16_t>;
+template struct tm2D::TileMap2D_1D<uint8_t>;
+template struct tm2D::TileMap2D_1D<uint16_t, std::allocator<uint16_t>, tm2D::layout::ZOrder>;
+template struct tm2D::TileMap2D_1D<uint32_t, std::allocator<uint32_t>, tm2D::layout::Tiled<>>;
+template struct tm2D::TileMap2D_1D<float, std::pmr::polymorphic_allocator<float>>;
+
+template struct tm2D::TileMap2D_Chunked<uint16_t>;
+template struct tm2D::TileMap2D_Sparse<uint8_t, 4>;
+template struct tm2D::TileMap2D_CoW<uint32_t>;
+template struct tm2D::DirtyTracker<>;
+template struct tm2D::TileMap2D_Tracked<tm2D::TileMap2D_1D<uint8_t>>;
+template struct tm2D::TileMap2D_Tracked<tm2D::TileMap2DView<uint16_t>, 3>;
+template struct tm2D::ImageReader<uint32_t>;
+template struct tm2D::SummedAreaTable<uint64_t>;
+template struct tm2D::TileMap2D_Layers<uint8_t, float, uint32_t>;
+template struct tm2D::TileMap2D_MMap<uint16_t>;
+template struct tm2D::TileMap2D_Packed<1>;
+template struct tm2D::TileMap2D_Packed<2>;
+template struct tm2D::TileMap2D_Packed<4>;
+template struct tm2D::TileMap2D_Packed<8>;
+template struct tm2D::PathHierarchy<>;
+template struct tm2D::TileMapReader<uint16_t>;
+template struct tm2D::Neighborhood<float, 1>;
+template struct tm2D::ChunkStreamer<uint8_t, 4>;
+
+using namespace tm2D;
+
+int main()
+{
+	const execution::parallel_policy par = execution::par.withThreshold(0);
+	TileMap2D_1D<uint8_t> map(20, 12, 1);
+	TileMap2D_1D<uint8_t> output;
+	const auto passable = [](uint8_t t) { return t != 0; };
+
+	// TileMap2D.h and TileMap2D_Parallel.h.
+	fillRect(map, { 4, 0, 1, 10 }, 0);
+	flip(par, map, true, false);
+	rot90(par, &output, &map, true);
+	rot180(par, &output, &map);
+	getChunk(par, &output, &map, { 1, 1, 5, 5 });
+	setChunk(par, &output, &map, 0, 0);
+	forEachTile(par, output, [](uint8_t& tile, size_t, size_t) { tile++; });
+
+	// TileMap2D_Chunked.h and TileMap2D_Dirty.h.
+	TileMap2D_Chunked<uint16_t> chunked(100, 70, 3);
+	TileMap2D_Sparse<uint8_t, 4> sparse(40, 40);
+	TileMap2D_CoW<uint32_t> cow(30, 30);
+	chunked.resize(80, 90);
+	setChunk(&sparse, &map, 3, 3);
+	sparse.compact();
+	cow.set(1, 1, 5);
+	TM2D_CHECK(cow.snapshot().changedAreas(cow).empty());
+	TileMap2D_Tracked<TileMap2D_1D<uint8_t>> tracked(map);
+	tracked.fillArea({ 0, 0 }, passable, 2);
+	tracked.transform({ 0, 0, 5, 5 }, [](uint8_t t) { return uint8_t(t + 1); });
+	tracked.replace(2, 3);
+	tracked.setChunk(&map, 2, 2);
+	TM2D_CHECK(!tracked.consumeDirty().empty());
+
+	// TileMap2D_Integral.h and TileMap2D_Label.h.
+	SummedAreaTable<uint64_t> table(map, [](uint8_t t) { return t; });
+	table.build(par, map, [](uint8_t t) { return t; });
+	table.update(map, { 0, 0, 3, 3 }, [](uint8_t t) { return t; });
+	TM2D_CHECK(table.average({ 0, 0, 4, 4 }) >= 0.0);
+	TileMap2D_1D<uint16_t> labels;
+	labelComponents(&labels, map, passable);
+	labelComponents(par, &labels, map, passable, true);
+
+	// TileMap2D_Layers.h and TileMap2D_Packed.h.
+	TileMap2D_Layers<uint8_t, float, uint32_t> layers(8, 6), layers_chunk;
+	layers.set(1, 1, 2, 0.5f, 7);
+	layers.forEachLayer([](auto layer) { fillRect(layer, { 0, 0, 2, 2 }, {}); });
+	flip(layers, true, true);
+	rot90(&layers, false);
+	getChunk(&layers_chunk, &layers, { 1, 1, 4, 4 });
+	setChunk(&layers, &layers_chunk, 0, 0);
+	TileMap2D_Packed<2> packed(33, 9), packed_chunk;
+	setChunk(&packed, &map, 0, 0);
+	packed.fillRect({ 1, 1, 30, 3 }, 2);
+	packed.fillArea({ 0, 0 }, [](uint8_t t) { return t == 0; }, 3);
+	flip(packed, true, false);
+	getChunk(&packed_chunk, &packed, { 3, 0, 20, 5 });
+	setChunk(&packed, &packed_chunk, 5, 5);
+	getChunk(&output, &packed, { 0, 0, 33, 9 });
+
+	// TileMap2D_Path.h.
+	PathFinder finder;
+	std::vector<Point> path;
+	finder.findPath(map, { 0, 0 }, { 19, 11 }, passable, &path);
+	finder.findPathJPS(map, { 0, 0 }, { 19, 11 }, passable, &path);
+	finder.findCosts(map, { 0, 0 }, passable);
+	PathHierarchy<2> hierarchy;
+	hierarchy.build(map, passable);
+	hierarchy.update(map, passable, { 0, 0, 5, 5 });
+	hierarchy.findPath(map, { 0, 0 }, { 19, 11 }, passable, &path);
+
+	// TileMap2D_Resample.h and TileMap2D_Stencil.h.
+	TileMap2D_1D<uint32_t> pixels(16, 10, 0xff00ff00u), resampled;
+	TM2D_CHECK(resample(&resampled, &pixels, 7, 5, Filter::Bilinear));
+	TM2D_CHECK(resample(par, &resampled, &pixels, 32, 20, Filter::Nearest));
+	std::vector<TileMap2D_1D<uint32_t>> mips;
+	TM2D_CHECK(buildMipChain(&mips, &pixels));
+	TileMap2D_1D<float> heights(12, 12, 1.0f), blurred;
+	applyStencil<1>(&blurred, &heights, [](const Neighborhood<float, 1>& n) { return n.reduce(0.0f, std::plus<>()) / 9.0f; });
+	iterateStencil<1>(par, &heights, 2, [](const Neighborhood<float, 1>& n) { return n.center(); }, Border::Wrap);
+
+	// TileMap2D_Serialize.h, TileMap2D_Image.h and TileMap2D_MMap.h.
+	std::stringstream stream;
+	TM2D_CHECK(writeTileMap(stream, chunked));
+	TM2D_CHECK(readTileMap(stream, &chunked));
+	std::stringstream image;
+	TM2D_CHECK(writeImage(image, pixels, ImageFormat::QOI));
+	TM2D_CHECK(readImage(image, &cow));
+	const char* const path_name = "tm2d_test_headers.tm2d";
+	{
+		TileMap2D_MMap<uint16_t> mapped;
+		TM2D_CHECK(mapped.create(path_name, 10, 10, 4));
+		fillRect(mapped, { 0, 0, 5, 5 }, 1);
+		TM2D_CHECK(mapped.flush({ 0, 0, 5, 5 }));
+	}
+	std::remove(path_name);
+
+	// TileMap2D_Streaming.h.
+	{
+		TileMap2D_Chunked<uint8_t, 4> world(64, 64);
+		ChunkStreamer<uint8_t, 4> streamer(world, [](const Rect&, TileMap2DView<uint8_t> tiles) {
+			tiles(0, 0) = 1;
+			return true;
+		});
+		streamer.setUnloader([](const Rect&, TileMap2DView<uint8_t>) {});
+		streamer.update({ 0, 0, 20, 20 }, 5.0, 0.0);
+		ChunkStreamer<uint8_t, 4>::Pin pin = streamer.pin({ 0, 0, 16, 16 });
+		streamer.load({ 0, 0, 16, 16 });
+		TM2D_CHECK(streamer.isLoaded(0, 0));
+		pin.release();
+		streamer.evict();
+	}
+
+	return 0;
+}
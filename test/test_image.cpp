@@ -0,0 +1,186 @@
+#include "TileMap2D_Image.h"
+#include "TileMap2D_Chunked.h"
+#include "test.h"
+#include "lodepng.h"
+
+#include <sstream>
+
+using namespace tm2D;
+
+// A 4-byte RGBA image of [kind]: noise, gradients, runs or a few repeated colors, so that every QOI operation is used.
+TileMap2D_1D<uint32_t> makeImage(size_t width, size_t height, int kind, std::mt19937& rng)
+{
+	TileMap2D_1D<uint32_t> image(width, height);
+	for (size_t y = 0; y < height; y++) {
+		for (size_t x = 0; x < width; x++) {
+			switch (kind) {
+			case 0: image(x, y) = rng(); break;
+			case 1: image(x, y) = 0xff000000u | uint32_t((x + y) & 0xff) | uint32_t(((x * 3) & 0xff) << 8) | uint32_t((y & 0xff) << 16); break;
+			case 2: image(x, y) = (x / 7 + y / 5) % 3 ? 0xff102030u : 0x80ffffffu; break;
+			default: image(x, y) = 0xff000000u | (rng() % 3 ? 0x00808080u + (rng() % 5) * 0x010101u : rng()); break;
+			}
+		}
+	}
+	return image;
+}
+
+bool readString(const std::string& data, TileMap2D_1D<uint32_t>* output)
+{
+	std::istringstream in(data);
+	return readImage(in, output);
+}
+
+// Check the PNG decoder on an image of [color_type] and [depth] encoded by lodepng with blocks of [btype], against the RGBA pixels lodepng decodes.
+void checkPNG(LodePNGColorType color_type, unsigned depth, unsigned btype, std::mt19937& rng)
+{
+	const unsigned width = 1 + rng() % 70, height = 1 + rng() % 40;
+	lodepng::State state;
+	state.encoder.auto_convert = 0;
+	state.encoder.filter_palette_zero = 0;
+	state.encoder.zlibsettings.btype = btype;
+	LodePNGColorMode& color = state.info_png.color;
+	color.colortype = color_type;
+	color.bitdepth = depth;
+	// A palette of fewer colors than the indices can reach, some of them transparent, or a transparent key.
+	if (color_type == LCT_PALETTE)
+		for (unsigned i = 0; i < (1u << depth) - (1u << depth) / 4; i++) lodepng_palette_add(&color, rng(), rng(), rng(), rng() % 3 ? 255 : rng());
+	else if ((color_type == LCT_GREY || color_type == LCT_RGB) && rng() % 2) {
+		color.key_defined = 1;
+		color.key_r = color.key_g = color.key_b = 1;
+	}
+	lodepng_color_mode_copy(&state.info_raw, &color);
+
+	// Few sample values, so that the key matches some pixels and the compression finds runs.
+	std::vector<unsigned char> raw(lodepng_get_raw_size(width, height, &color));
+	for (unsigned char& byte : raw) byte = rng() % 4 ? (unsigned char)(rng() % 2 ? 0 : 1) : (unsigned char)rng();
+	if (color_type == LCT_PALETTE && depth == 8)
+		for (unsigned char& byte : raw) byte = (unsigned char)(byte % 200);
+	std::vector<unsigned char> png, expected;
+	TM2D_CHECK(lodepng::encode(png, raw, width, height, state) == 0);
+	unsigned expected_width, expected_height;
+	TM2D_CHECK(lodepng::decode(expected, expected_width, expected_height, png) == 0);
+
+	const std::string data(png.begin(), png.end());
+	TileMap2D_1D<uint32_t> loaded;
+	TM2D_CHECK(readString(data, &loaded));
+	TM2D_CHECK(loaded.width() == width && loaded.height() == height && std::memcmp(loaded.data(), expected.data(), expected.size()) == 0);
+
+	// Areas, into a non-contiguous tilemap.
+	std::istringstream in(data);
+	ImageReader<uint32_t> reader;
+	TM2D_CHECK(reader.open(in) && reader.format() == ImageFormat::PNG);
+	TileMap2D_Chunked<uint32_t, 3> chunked(width + 5, height + 5);
+	const Rect area(rng() % width, rng() % height, rng() % width + 1, rng() % height + 1);
+	TM2D_CHECK(reader.setChunk(&chunked, 2, 3, area));
+	TileMap2D_1D<uint32_t> expected_chunked(width + 5, height + 5, 0);
+	setChunk(&expected_chunked, &loaded, 2, 3, area);
+	TM2D_CHECK(test::sameTiles(chunked, expected_chunked));
+}
+
+int main()
+{
+	std::mt19937 rng(30);
+
+	// Round-trips of whole images and of areas, into contiguous and non-contiguous tilemaps.
+	for (int kind = 0; kind < 4; kind++) {
+		const TileMap2D_1D<uint32_t> image = makeImage(37 + kind * 13, 21 + kind * 7, kind, rng);
+		for (ImageFormat format : { ImageFormat::Raw, ImageFormat::QOI, ImageFormat::PNG }) {
+			std::ostringstream out;
+			TM2D_CHECK(writeImage(out, image, format));
+			TileMap2D_1D<uint32_t> loaded;
+			TM2D_CHECK(readString(out.str(), &loaded));
+			TM2D_CHECK(test::sameTiles(loaded, image));
+
+			std::istringstream in(out.str());
+			ImageReader<uint32_t> reader;
+			TM2D_CHECK(reader.open(in) && reader.format() == format);
+			for (int i = 0; i < 10; i++) {
+				const Rect area(rng() % 60, rng() % 60, rng() % 40, rng() % 40);
+				TileMap2D_1D<uint32_t, std::allocator<uint32_t>, layout::ZOrder> part;
+				TM2D_CHECK(reader.getChunk(&part, area));
+				TileMap2D_1D<uint32_t> expected;
+				getChunk(&expected, &image, area);
+				TM2D_CHECK(test::sameTiles(part, expected));
+			}
+		}
+	}
+
+	// PNG images of every color type and bit depth, with stored, fixed and dynamic Huffman blocks.
+	const std::pair<LodePNGColorType, std::vector<unsigned>> png_modes[] = {
+		{ LCT_GREY, { 1, 2, 4, 8, 16 } },
+		{ LCT_RGB, { 8, 16 } },
+		{ LCT_PALETTE, { 1, 2, 4, 8 } },
+		{ LCT_GREY_ALPHA, { 8, 16 } },
+		{ LCT_RGBA, { 8, 16 } },
+	};
+	for (const auto& [color_type, depths] : png_modes)
+		for (unsigned depth : depths)
+			for (unsigned btype = 0; btype < 3; btype++)
+				for (int trial = 0; trial < 5; trial++) checkPNG(color_type, depth, btype, rng);
+
+	// PNG images written from a non-contiguous tilemap, large enough to span several IDAT chunks and move the window of the compressor, decoded by lodepng.
+	for (int kind = 0; kind < 4; kind++) {
+		const TileMap2D_1D<uint32_t> image = makeImage(300, 250, kind, rng);
+		TileMap2D_Chunked<uint32_t, 4> chunked(image.width(), image.height());
+		setChunk(&chunked, &image, 0, 0);
+		std::ostringstream out;
+		TM2D_CHECK(writeImage(out, chunked, ImageFormat::PNG));
+		const std::string data = out.str();
+		std::vector<unsigned char> decoded;
+		unsigned width, height;
+		TM2D_CHECK(lodepng::decode(decoded, width, height, (const unsigned char*)data.data(), data.size()) == 0);
+		TM2D_CHECK(width == image.width() && height == image.height() && std::memcmp(decoded.data(), image.data(), decoded.size()) == 0);
+	}
+	{
+		std::ostringstream out;
+		TM2D_CHECK(!writeImage(out, TileMap2D_1D<uint32_t>(0, 5), ImageFormat::PNG));
+	}
+
+	// The QOI encoding of a red pixel repeated once: a difference from the initial black, then a run.
+	{
+		std::ostringstream out;
+		TM2D_CHECK(writeImage(out, TileMap2D_1D<uint32_t>(2, 1, 0xff0000ffu), ImageFormat::QOI));
+		const std::string expected(
+			"qoif\0\0\0\x02\0\0\0\x01\x04\0"
+			"\x5a\xc0"
+			"\0\0\0\0\0\0\0\x01", 24);
+		TM2D_CHECK(out.str() == expected);
+	}
+
+	// Headers claiming more pixels than the stream holds fail without allocating them.
+	{
+		std::string qoi("qoif\0\0\xff\xff\0\0\xff\xff\x04\0" "\0\0\0\0\0\0\0\x01", 22);
+		TileMap2D_1D<uint32_t> loaded;
+		TM2D_CHECK(!readString(qoi, &loaded));
+
+		std::ostringstream out;
+		TM2D_CHECK(writeImage(out, makeImage(20, 10, 0, rng), ImageFormat::Raw));
+		const std::string raw = out.str();
+		TM2D_CHECK(readString(raw, &loaded));
+		TM2D_CHECK(!readString(raw.substr(0, raw.size() - 1), &loaded));
+
+		std::string huge = raw;
+		const uint64_t size = 1 << 20;
+		std::memcpy(huge.data() + offsetof(MMapHeader, width), &size, sizeof(size));
+		std::memcpy(huge.data() + offsetof(MMapHeader, height), &size, sizeof(size));
+		std::memcpy(huge.data() + offsetof(MMapHeader, pitch), &size, sizeof(size));
+		TM2D_CHECK(!readString(huge, &loaded));
+	}
+
+	// Truncated PNG images fail, and corrupted ones fail or decode to an image of their size.
+	{
+		std::ostringstream out;
+		TM2D_CHECK(writeImage(out, makeImage(40, 30, 3, rng), ImageFormat::PNG));
+		const std::string png = out.str();
+		TileMap2D_1D<uint32_t> loaded;
+		// The IEND chunk after the image data is not read.
+		for (size_t size = 0; size + 12 < png.size(); size += 1 + size / 8) TM2D_CHECK(!readString(png.substr(0, size), &loaded));
+		for (int i = 0; i < 500; i++) {
+			std::string corrupted = png;
+			corrupted[rng() % corrupted.size()] ^= char(1 << (rng() % 8));
+			if (readString(corrupted, &loaded)) TM2D_CHECK(loaded.width() == 40 && loaded.height() == 30);
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,133 @@
+#include "TileMap2D.h"
+#include "TileMap2D_Parallel.h"
+#include "test.h"
+
+#include <thread>
+
+#ifndef TM2D_INSTRUMENT
+	#error "test_instrument.cpp must be built with TM2D_INSTRUMENT defined"
+#endif
+
+using namespace tm2D;
+
+// Begin and end events reported to the trace callback.
+struct TraceEvent
+{
+	Operation op;
+	bool end;
+	OperationStats stats;
+};
+
+void trace(Operation op, const OperationStats* stats, void* user_data)
+{
+	static_cast<std::vector<TraceEvent>*>(user_data)->push_back({ op, stats != nullptr, stats ? *stats : OperationStats() });
+}
+
+// Whether [op] is recorded as called [calls] times, with [tiles] tiles visited and [bytes] bytes copied in total.
+bool recorded(Operation op, uint64_t calls, uint64_t tiles, uint64_t bytes)
+{
+	const OperationStats& stats = instrumentStats()[op];
+	return stats.calls == calls && stats.tiles_visited == tiles && stats.bytes_copied == bytes;
+}
+
+// Whether every operation but [ops] has no call recorded.
+bool onlyRecorded(std::initializer_list<Operation> ops)
+{
+	for (size_t i = 0; i < size_t(Operation::Count); i++)
+		if (std::find(ops.begin(), ops.end(), Operation(i)) == ops.end() && instrumentStats()[Operation(i)].calls) return false;
+	return true;
+}
+
+int main()
+{
+	std::mt19937 rng(21);
+	TileMap2D_1D<uint32_t> input(30, 20, 0);
+	test::randomize(input, rng, 1000);
+	TileMap2D_1D<uint32_t> output;
+
+	// getChunk() and setChunk() count the tiles within both tilemaps.
+	instrumentStats().reset();
+	getChunk(&output, &input, { 20, 15, 25, 10 });
+	TM2D_CHECK(recorded(Operation::GetChunk, 1, 10 * 5, 10 * 5 * sizeof(uint32_t)) && onlyRecorded({ Operation::GetChunk }));
+	getChunk(&output, &input, { 40, 0, 5, 5 });
+	TM2D_CHECK(recorded(Operation::GetChunk, 2, 10 * 5, 10 * 5 * sizeof(uint32_t)));
+
+	instrumentStats().reset();
+	output.reset(12, 12);
+	setChunk(&output, &input, 4, 2, { 0, 0, 10, 20 });
+	TM2D_CHECK(recorded(Operation::SetChunk, 1, 8 * 10, 8 * 10 * sizeof(uint32_t)) && onlyRecorded({ Operation::SetChunk }));
+
+	// Calls following a parallel policy are recorded once, on the calling thread.
+	instrumentStats().reset();
+	const execution::parallel_policy par = execution::par.withThreshold(0);
+	getChunk(par, &output, &input, { 0, 0, 30, 20 });
+	setChunk(par, &output, &input, 10, 10);
+	TM2D_CHECK(recorded(Operation::GetChunk, 1, 30 * 20, 30 * 20 * sizeof(uint32_t)));
+	TM2D_CHECK(recorded(Operation::SetChunk, 1, 20 * 10, 20 * 10 * sizeof(uint32_t)));
+
+	// The stats are kept per thread.
+	std::thread([&] {
+		getChunk(&output, &input, { 0, 0, 4, 4 });
+		TM2D_CHECK(recorded(Operation::GetChunk, 1, 16, 16 * sizeof(uint32_t)));
+	}).join();
+	TM2D_CHECK(recorded(Operation::GetChunk, 1, 30 * 20, 30 * 20 * sizeof(uint32_t)));
+
+	// rot90() into another tilemap.
+	instrumentStats().reset();
+	rot90(&output, &input, true);
+	TM2D_CHECK(recorded(Operation::Rot90, 1, 30 * 20, 30 * 20 * sizeof(uint32_t)) && onlyRecorded({ Operation::Rot90 }));
+
+	// The work of nested operations also counts for their parent: the transposition of a square in place, then its flip.
+	instrumentStats().reset();
+	TileMap2D_1D<uint32_t> square(16, 16, 0);
+	TM2D_CHECK(rot90(&square, false));
+	TM2D_CHECK(recorded(Operation::Flip, 1, 16 * 16, 16 * 16 * sizeof(uint32_t)));
+	TM2D_CHECK(recorded(Operation::Rot90, 1, 2 * 16 * 16, 2 * 16 * 16 * sizeof(uint32_t)) && onlyRecorded({ Operation::Rot90, Operation::Flip }));
+
+	// Other shapes are rotated in place through a nested rot90() into a temporary.
+	instrumentStats().reset();
+	output = input;
+	TM2D_CHECK(rot90(&output, true));
+	TM2D_CHECK(recorded(Operation::Rot90, 2, 2 * 30 * 20, 2 * 30 * 20 * sizeof(uint32_t)) && onlyRecorded({ Operation::Rot90 }));
+
+	// fillArea() counts the tiles checked against its rule and the largest number of spans queued.
+	instrumentStats().reset();
+	TileMap2D_1D<uint8_t> row(25, 1, 0);
+	fillArea(row, { 7, 0 }, [](uint8_t tile) { return tile == 0; }, uint8_t(1));
+	TM2D_CHECK(recorded(Operation::FillArea, 1, 25, 0) && instrumentStats()[Operation::FillArea].peak_queue == 0);
+
+	// From the middle row, both adjacent rows are queued at once.
+	instrumentStats().reset();
+	TileMap2D_1D<uint8_t> rows(10, 3, 0);
+	fillArea(rows, { 0, 1 }, [](uint8_t tile) { return tile == 0; }, uint8_t(1));
+	TM2D_CHECK(instrumentStats()[Operation::FillArea].peak_queue == 2 && instrumentStats()[Operation::FillArea].tiles_visited >= 30);
+
+	// The trace callback is called when each operation begins and ends, nested like the operations, with the stats of the call at its end.
+	std::vector<TraceEvent> events;
+	setTraceCallback(trace, &events);
+	TM2D_CHECK(rot90(&square, true));
+	getChunk(&output, &input, { 0, 0, 5, 5 });
+	rot180(&square);
+	setTraceCallback(nullptr);
+	getChunk(&output, &input, { 0, 0, 5, 5 });
+
+	const std::vector<std::pair<Operation, bool>> sequence = {
+		{ Operation::Rot90, false }, { Operation::Flip, false }, { Operation::Flip, true }, { Operation::Rot90, true },
+		{ Operation::GetChunk, false }, { Operation::GetChunk, true },
+		{ Operation::Rot180, false }, { Operation::Flip, false }, { Operation::Flip, true }, { Operation::Rot180, true },
+	};
+	TM2D_CHECK(events.size() == sequence.size());
+	std::vector<Operation> open;
+	for (size_t i = 0; i < events.size(); i++) {
+		TM2D_CHECK(events[i].op == sequence[i].first && events[i].end == sequence[i].second);
+		if (!events[i].end) open.push_back(events[i].op);
+		else {
+			TM2D_CHECK(!open.empty() && open.back() == events[i].op && events[i].stats.calls == 1);
+			open.pop_back();
+		}
+	}
+	TM2D_CHECK(open.empty());
+	TM2D_CHECK(events[3].stats.tiles_visited == 2 * 16 * 16 && events[5].stats.tiles_visited == 25 && events[9].stats.tiles_visited == 16 * 16);
+
+	return 0;
+}
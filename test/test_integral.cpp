@@ -0,0 +1,60 @@
+#include "TileMap2D_Integral.h"
+#include "test.h"
+
+using namespace tm2D;
+
+// Sum of [value(tile)] over [area] (clipped to [map]), a tile at a time.
+template<typename S, typename F>
+S naiveSum(const TileMap2D_1D<uint8_t>& map, const Rect& area, F&& value)
+{
+	const Rect cliprect = area.intersection({ 0, 0, map.width(), map.height() });
+	S sum = 0;
+	for (size_t y = cliprect.y; y < cliprect.y + cliprect.height; y++)
+		for (size_t x = cliprect.x; x < cliprect.x + cliprect.width; x++)
+			sum += value(map(x, y));
+	return sum;
+}
+
+int main()
+{
+	std::mt19937 rng(16);
+	const execution::parallel_policy par = execution::par.withThreshold(0);
+	// Negative values, so that the rows below an update are shifted by negative changes too.
+	const auto value = [](uint8_t t) { return int64_t(t) - 5; };
+	const auto blocked = [](uint8_t t) { return t == 0; };
+
+	for (int trial = 0; trial < 30; trial++) {
+		TileMap2D_1D<uint8_t> map(rng() % 120, rng() % 90, 0);
+		test::randomize(map, rng, 10, 1 + rng() % 6);
+
+		SummedAreaTable<int64_t> table(map, value);
+		SummedAreaTable<int64_t> parallel;
+		parallel.build(par, map, value);
+		SummedAreaTable<uint32_t> counts(map, blocked);
+		TM2D_CHECK(table.width() == map.width() && table.height() == map.height());
+
+		for (int op = 0; op < 60; op++) {
+			for (int query = 0; query < 20; query++) {
+				const Rect area(rng() % 130, rng() % 100, rng() % 130, rng() % 100);
+				const int64_t expected = naiveSum<int64_t>(map, area, value);
+				TM2D_CHECK(table.sum(area) == expected);
+				TM2D_CHECK(parallel.sum(area) == expected);
+				TM2D_CHECK(counts.sum(area) == naiveSum<uint32_t>(map, area, blocked));
+
+				const Rect cliprect = area.intersection({ 0, 0, map.width(), map.height() });
+				const size_t tiles = cliprect.width * cliprect.height;
+				TM2D_CHECK(table.average(area) == (tiles ? double(expected) / double(tiles) : 0.0));
+			}
+
+			// Change a chunk of the tilemap, and update the tables with the area written to.
+			TileMap2D_1D<uint8_t> chunk(rng() % 40, rng() % 40, 0);
+			test::randomize(chunk, rng, 10, 3);
+			const Rect changed = setChunk(&map, &chunk, rng() % 130, rng() % 100);
+			table.update(map, changed, value);
+			parallel.update(map, changed, value);
+			counts.update(map, changed, blocked);
+		}
+	}
+
+	return 0;
+}
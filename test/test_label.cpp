@@ -0,0 +1,76 @@
+#include "TileMap2D_Label.h"
+#include "test.h"
+
+using namespace tm2D;
+
+// Label the components of the tiles satisfying [rule] of [map] one flood fill at a time, from their first tile in row-major order.
+template<typename Rule>
+std::vector<Component> floodLabels(TileMap2D_1D<uint16_t>* labels, const TileMap2D_1D<uint8_t>& map, Rule&& rule, bool eight_connected)
+{
+	// Tiles to label are 0 until they are filled, the other ones are never filled.
+	labels->reset(map.width(), map.height(), 0xffff);
+	for (size_t y = 0; y < map.height(); y++)
+		for (size_t x = 0; x < map.width(); x++)
+			if (rule(map(x, y))) (*labels)(x, y) = 0;
+
+	std::vector<Component> components;
+	for (size_t y = 0; y < map.height(); y++) {
+		for (size_t x = 0; x < map.width(); x++) {
+			if ((*labels)(x, y) != 0) continue;
+			const uint16_t label = uint16_t(components.size() + 1);
+			Component component;
+			component.bounds = fillArea(*labels, { x, y }, [](uint16_t t) { return t == 0; }, label, eight_connected);
+			for (size_t _y = component.bounds.y; _y < component.bounds.y + component.bounds.height; _y++)
+				for (size_t _x = component.bounds.x; _x < component.bounds.x + component.bounds.width; _x++)
+					component.area += (*labels)(_x, _y) == label;
+			components.push_back(component);
+		}
+	}
+	replace(*labels, uint16_t(0xffff), uint16_t(0));
+	return components;
+}
+
+// Whether [a] and [b] have the same components in the same order.
+bool sameComponents(const std::vector<Component>& a, const std::vector<Component>& b)
+{
+	if (a.size() != b.size()) return false;
+	for (size_t i = 0; i < a.size(); i++) {
+		if (a[i].area != b[i].area || a[i].bounds != b[i].bounds) return false;
+	}
+	return true;
+}
+
+int main()
+{
+	std::mt19937 rng(17);
+	// Many bands, so that components are joined across most rows.
+	execution::parallel_policy par = execution::par.withThreshold(0);
+	par.bands_per_thread = 16;
+
+	for (int trial = 0; trial < 60; trial++) {
+		TileMap2D_1D<uint8_t> map(rng() % 100, rng() % 80, 0);
+		test::randomize(map, rng, 2 + trial % 4, 1 + rng() % 4);
+		const auto rule = [](uint8_t t) { return t != 0; };
+		const bool eight = trial % 2;
+
+		TileMap2D_1D<uint16_t> expected;
+		const std::vector<Component> expected_components = floodLabels(&expected, map, rule, eight);
+
+		TileMap2D_1D<uint16_t> labels;
+		TM2D_CHECK(sameComponents(labelComponents(&labels, map, rule, eight), expected_components));
+		TM2D_CHECK(test::sameTiles(labels, expected));
+
+		TileMap2D_1D<uint16_t> parallel_labels;
+		TM2D_CHECK(sameComponents(labelComponents(par, &parallel_labels, map, rule, eight), expected_components));
+		TM2D_CHECK(test::sameTiles(parallel_labels, expected));
+
+		// Labels too narrow for the provisional labels, going through a temporary buffer.
+		if (expected_components.size() <= 0xff) {
+			TileMap2D_1D<uint8_t> narrow;
+			TM2D_CHECK(sameComponents(labelComponents(par, &narrow, map, rule, eight), expected_components));
+			TM2D_CHECK(test::sameTiles(narrow, expected));
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,143 @@
+#include "TileMap2D_Layers.h"
+#include "test.h"
+
+using namespace tm2D;
+
+using Layers = TileMap2D_Layers<uint8_t, float, uint32_t>;
+
+// A TileMap2D_1D per layer, transformed like a multi-layer tilemap.
+struct Planes
+{
+	TileMap2D_1D<uint8_t> terrain;
+	TileMap2D_1D<float> height;
+	TileMap2D_1D<uint32_t> light;
+};
+
+// Whether every layer of [map] has the size and tiles of its plane in [expected].
+bool sameLayers(const Layers& map, const Planes& expected)
+{
+	return map.width() == expected.terrain.width() && map.height() == expected.terrain.height() &&
+		test::sameTiles(map.layer<0>(), expected.terrain) && test::sameTiles(map.layer<1>(), expected.height) && test::sameTiles(map.layer<2>(), expected.light);
+}
+
+// Get a multi-layer tilemap of [width] x [height] random tiles, and its planes in [expected].
+Layers randomLayers(size_t width, size_t height, std::mt19937& rng, Planes* expected)
+{
+	Layers map(width, height);
+	expected->terrain.reset(width, height, 0);
+	expected->height.reset(width, height, 0.0f);
+	expected->light.reset(width, height, 0);
+	for (size_t y = 0; y < height; y++) {
+		for (size_t x = 0; x < width; x++) {
+			expected->terrain(x, y) = uint8_t(rng() % 4);
+			expected->height(x, y) = float(rng() % 100) / 4.0f;
+			expected->light(x, y) = uint32_t(rng());
+			map.set(x, y, expected->terrain(x, y), expected->height(x, y), expected->light(x, y));
+		}
+	}
+	return map;
+}
+
+// The const layers are read-only.
+static_assert(std::is_const_v<std::remove_reference_t<decltype(std::declval<const Layers&>().layer<1>())>>);
+static_assert(!TileMapLike<Layers>);
+
+int main()
+{
+	std::mt19937 rng(24);
+
+	// The same operations on a multi-layer tilemap and on a TileMap2D_1D per layer give the same tiles.
+	for (int trial = 0; trial < 30; trial++) {
+		Planes expected;
+		Layers map = randomLayers(rng() % 50, rng() % 50, rng, &expected);
+		TM2D_CHECK(sameLayers(map, expected));
+
+		for (int op = 0; op < 30; op++) {
+			const Rect area(rng() % 60, rng() % 60, rng() % 30, rng() % 30);
+			switch (rng() % 5) {
+			case 0: {
+				const bool horizontal = rng() % 2, vertical = rng() % 2;
+				flip(map, horizontal, vertical);
+				flip(expected.terrain, horizontal, vertical);
+				flip(expected.height, horizontal, vertical);
+				flip(expected.light, horizontal, vertical);
+				break;
+			}
+			case 1: {
+				const bool left = rng() % 2;
+				TM2D_CHECK(rot90(&map, left));
+				rot90(&expected.terrain, left);
+				rot90(&expected.height, left);
+				rot90(&expected.light, left);
+				break;
+			}
+			case 2: {
+				// From another tilemap, or overlapping within the same one.
+				Planes input_expected;
+				Layers input = randomLayers(rng() % 30, rng() % 30, rng, &input_expected);
+				const bool self = rng() % 2;
+				const Layers& source = self ? map : input;
+				const Planes& source_expected = self ? expected : input_expected;
+				const size_t x = rng() % 60, y = rng() % 60;
+				const Rect written = setChunk(&map, &source, x, y, area);
+				TM2D_CHECK(setChunk(&expected.terrain, &source_expected.terrain, x, y, area) == written);
+				setChunk(&expected.height, &source_expected.height, x, y, area);
+				setChunk(&expected.light, &source_expected.light, x, y, area);
+				break;
+			}
+			case 3: {
+				// Partly outside the tilemap, padded with default tiles.
+				Layers chunk;
+				getChunk(&chunk, &std::as_const(map), area);
+				Planes chunk_expected;
+				getChunk(&chunk_expected.terrain, &expected.terrain, area);
+				getChunk(&chunk_expected.height, &expected.height, area);
+				getChunk(&chunk_expected.light, &expected.light, area);
+				TM2D_CHECK(sameLayers(chunk, chunk_expected));
+
+				getChunk(&map, &map, area);
+				expected = chunk_expected;
+				break;
+			}
+			case 4: {
+				// Algorithms run on the views of the layers.
+				if (!map.width() || !map.height()) break;
+				const Point center = { rng() % map.width(), rng() % map.height() };
+				const uint8_t from = expected.terrain(center.x, center.y);
+				auto terrain = map.layer<0>();
+				TM2D_CHECK(
+					fillArea(terrain, center, [&](uint8_t t) { return t == from; }, uint8_t(from + 1)) ==
+					fillArea(expected.terrain, center, [&](uint8_t t) { return t == from; }, uint8_t(from + 1))
+				);
+				map.forEachLayer([&](auto layer) {
+					using L = tile_t<decltype(layer)>;
+					replace(layer, L(1), L(2), area);
+				});
+				replace(expected.terrain, uint8_t(1), uint8_t(2), area);
+				replace(expected.height, 1.0f, 2.0f, area);
+				replace(expected.light, uint32_t(1), uint32_t(2), area);
+				break;
+			}
+			}
+			TM2D_CHECK(sameLayers(map, expected));
+		}
+
+		// Tiles out of bounds are default tiles, and are not written.
+		const size_t width = map.width(), height = map.height();
+		map.set(width, 0, 1, 1.0f, 1);
+		TM2D_CHECK(map.get(width, 0) == Layers::tile_type() && sameLayers(map, expected));
+		if (width && height) {
+			auto [terrain, height_tile, light] = map(width - 1, height - 1);
+			terrain = 3;
+			TM2D_CHECK(map.get(width - 1, height - 1) == Layers::tile_type(3, height_tile, light));
+		}
+	}
+
+	// Resetting fills each layer with its padding tile.
+	Layers map(5, 4, 1, 2.0f, 3);
+	TM2D_CHECK(map.get(4, 3) == Layers::tile_type(1, 2.0f, 3));
+	map.reset(7, 2);
+	TM2D_CHECK(map.width() == 7 && map.get(6, 1) == Layers::tile_type());
+
+	return 0;
+}
@@ -0,0 +1,129 @@
+#include "TileMap2D.h"
+#include "test.h"
+
+#include <bit>
+
+using namespace tm2D;
+
+// Get the index of ([x]; [y]) in Z-order over [x_bits] x [y_bits] bits, interleaving the bits one at a time.
+size_t naiveZOrder(size_t x, size_t y, unsigned x_bits, unsigned y_bits)
+{
+	const unsigned common = std::min<>(x_bits, y_bits);
+	size_t index = 0;
+	for (unsigned b = 0; b < common; b++) index |= ((x >> b) & 1) << (2 * b) | ((y >> b) & 1) << (2 * b + 1);
+	for (unsigned b = common; b < std::max<>(x_bits, y_bits); b++) index |= (((x_bits > y_bits ? x : y) >> b) & 1) << (common + b);
+	return index;
+}
+
+// Get the side of the buffer of [L] for a side of [size] tiles.
+template<typename L>
+size_t paddedSide(size_t size)
+{
+	if constexpr (std::same_as<L, layout::ZOrder>) return std::bit_ceil(size);
+	else return (size + L::block_size - 1) / L::block_size * L::block_size;
+}
+
+// Check that [L] maps the tiles of its padded sides one to one to the indices of its buffer, and position() maps them back.
+template<typename L>
+void checkIndices(std::mt19937& rng)
+{
+	for (int trial = 0; trial < 300; trial++) {
+		const size_t width = 1 + rng() % (trial % 2 ? 70 : 9), height = 1 + rng() % (trial % 3 ? 70 : 9);
+		L layout;
+		const size_t count = layout.reset(width, height);
+		const size_t padded_width = paddedSide<L>(width), padded_height = paddedSide<L>(height);
+		TM2D_CHECK(count == padded_width * padded_height);
+
+		std::vector<bool> seen(count, false);
+		for (size_t y = 0; y < padded_height; y++) {
+			for (size_t x = 0; x < padded_width; x++) {
+				const size_t i = layout.index(x, y);
+				TM2D_CHECK(i < count && !seen[i]);
+				seen[i] = true;
+				TM2D_CHECK((layout.position(i) == Point{ x, y }));
+				if constexpr (std::same_as<L, layout::ZOrder>)
+					TM2D_CHECK(i == naiveZOrder(x, y, (unsigned)std::countr_zero(padded_width), (unsigned)std::countr_zero(padded_height)));
+			}
+		}
+	}
+
+	// Large sides, sampled.
+	for (int trial = 0; trial < 100; trial++) {
+		const size_t width = 1 + rng() % (trial % 2 ? 1 << 20 : 9), height = 1 + rng() % (trial % 2 ? 9 : 1 << 20);
+		L layout;
+		layout.reset(width, height);
+		for (int sample = 0; sample < 1000; sample++) {
+			const Point p = { rng() % width, rng() % height };
+			TM2D_CHECK(layout.position(layout.index(p.x, p.y)) == p);
+			if constexpr (std::same_as<L, layout::ZOrder>)
+				TM2D_CHECK(layout.index(p.x, p.y) == naiveZOrder(p.x, p.y, (unsigned)std::countr_zero(std::bit_ceil(width)), (unsigned)std::countr_zero(std::bit_ceil(height))));
+		}
+	}
+}
+
+// Check that tilemaps of [L] keep their tiles through conversions and give the results of row-major tilemaps.
+template<typename L>
+void checkTileMaps(std::mt19937& rng)
+{
+	using Map = TileMap2D_1D<uint16_t, std::allocator<uint16_t>, L>;
+
+	for (int trial = 0; trial < 100; trial++) {
+		TileMap2D_1D<uint16_t> expected(rng() % 60, rng() % 60, 0);
+		test::randomize(expected, rng, 1000);
+
+		// To and from row-major.
+		Map map(expected);
+		TM2D_CHECK(test::sameTiles(map, expected));
+		TM2D_CHECK(test::sameTiles(TileMap2D_1D<uint16_t>(map), expected));
+		TileMap2D_1D<uint16_t> copy;
+		getChunk(&copy, &map, { 0, 0, map.width(), map.height() });
+		TM2D_CHECK(test::sameTiles(copy, expected));
+
+		for (int horizontal = 0; horizontal < 2; horizontal++) {
+			for (int vertical = 0; vertical < 2; vertical++) {
+				Map flipped = map;
+				TileMap2D_1D<uint16_t> flipped_expected = expected;
+				flip(flipped, horizontal, vertical);
+				flip(flipped_expected, horizontal, vertical);
+				TM2D_CHECK(test::sameTiles(flipped, flipped_expected));
+			}
+		}
+		for (int left = 0; left < 2; left++) {
+			Map rotated;
+			TileMap2D_1D<uint16_t> rotated_expected;
+			rot90(&rotated, &map, left);
+			rot90(&rotated_expected, &expected, left);
+			TM2D_CHECK(test::sameTiles(rotated, rotated_expected));
+			rotated = map;
+			TM2D_CHECK(rot90(&rotated, left));
+			TM2D_CHECK(test::sameTiles(rotated, rotated_expected));
+		}
+
+		// Partly outside the tilemap.
+		const Rect area(rng() % 70, rng() % 70, rng() % 40, rng() % 40);
+		Map chunk;
+		TileMap2D_1D<uint16_t> chunk_expected;
+		getChunk(&chunk, &map, area);
+		getChunk(&chunk_expected, &expected, area);
+		TM2D_CHECK(test::sameTiles(chunk, chunk_expected));
+
+		test::compareOperations(map, expected, rng, 20);
+	}
+}
+
+int main()
+{
+	std::mt19937 rng(25);
+
+	checkIndices<layout::ZOrder>(rng);
+	checkIndices<layout::Tiled<1>>(rng);
+	checkIndices<layout::Tiled<3>>(rng);
+	checkIndices<layout::Tiled<5>>(rng);
+
+	checkTileMaps<layout::ZOrder>(rng);
+	checkTileMaps<layout::Tiled<1>>(rng);
+	checkTileMaps<layout::Tiled<3>>(rng);
+	checkTileMaps<layout::Tiled<5>>(rng);
+
+	return 0;
+}
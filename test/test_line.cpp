@@ -0,0 +1,159 @@
+#include "TileMap2D.h"
+#include "test.h"
+
+#include <algorithm>
+
+using namespace tm2D;
+
+// Integers wide enough for the products of the coordinates of the lines tested. Coordinates are kept below 2^24 without 128-bit integers.
+#if defined(__SIZEOF_INT128__)
+using Wide = unsigned __int128;
+constexpr size_t max_coordinate = size_t(1) << 62;
+#else
+using Wide = uint64_t;
+constexpr size_t max_coordinate = size_t(1) << 24;
+#endif
+
+// Get the tiles of the unclipped line from [p1] to [p2] within [clip], by the major coordinate, in no particular order.
+// At each step along the major axis, the exact minor coordinate is rounded half up.
+std::vector<Point> naiveLine(const Point& p1, const Point& p2, const Rect& clip)
+{
+	const auto inside = [&](size_t x, size_t y) { return x - clip.x < clip.width && y - clip.y < clip.height; };
+	const size_t dx = p1.x < p2.x ? p2.x - p1.x : p1.x - p2.x, dy = p1.y < p2.y ? p2.y - p1.y : p1.y - p2.y;
+	if (!dx && !dy) return inside(p1.x, p1.y) ? std::vector<Point>{ p1 } : std::vector<Point>();
+
+	const bool x_major = dx > dy;
+	const size_t
+		n = x_major ? dx : dy, dm = x_major ? dy : dx,
+		major0 = x_major ? p1.x : p1.y, major1 = x_major ? p2.x : p2.y, minor0 = x_major ? p1.y : p1.x, minor1 = x_major ? p2.y : p2.x,
+		major_begin = x_major ? clip.x : clip.y, major_end = major_begin + (x_major ? clip.width : clip.height);
+
+	std::vector<Point> tiles;
+	for (size_t major = major_begin; major < major_end; major++) {
+		if (major < std::min<>(major0, major1) || major > std::max<>(major0, major1)) continue;
+		const Wide t = major > major0 ? major - major0 : major0 - major;
+		const Wide twice = 2 * Wide(n) * minor0 + n;
+		const size_t minor = size_t((minor1 > minor0 ? twice + 2 * t * dm : twice - 2 * t * dm) / (2 * Wide(n)));
+		const size_t x = x_major ? major : minor, y = x_major ? minor : major;
+		if (inside(x, y)) tiles.push_back({ x, y });
+	}
+	return tiles;
+}
+
+// Check that the line from [p1] to [p2] plots the tiles of the unclipped line within [clip], each once, from [p1] to [p2].
+void checkLine(const Point& p1, const Point& p2, const Rect& clip)
+{
+	std::vector<Point> plotted;
+	detail::rasterizeLine(p1, p2, clip, [&](size_t x, size_t y) { plotted.push_back({ x, y }); });
+
+	// Steps to adjacent tiles, towards [p2].
+	const auto distance = [](size_t a, size_t b) { return a < b ? b - a : a - b; };
+	for (size_t i = 1; i < plotted.size(); i++) {
+		const Point a = plotted[i - 1], b = plotted[i];
+		TM2D_CHECK(b.x == a.x || (b.x > a.x) == (p2.x > p1.x));
+		TM2D_CHECK(b.y == a.y || (b.y > a.y) == (p2.y > p1.y));
+		TM2D_CHECK(distance(a.x, b.x) <= 1 && distance(a.y, b.y) <= 1 && !(a == b));
+	}
+
+	const auto less = [](const Point& a, const Point& b) { return a.y != b.y ? a.y < b.y : a.x < b.x; };
+	std::vector<Point> expected = naiveLine(p1, p2, clip);
+	std::sort(plotted.begin(), plotted.end(), less);
+	std::sort(expected.begin(), expected.end(), less);
+	TM2D_CHECK(plotted == expected);
+
+	// The same tiles in the other direction.
+	std::vector<Point> reversed;
+	detail::rasterizeLine(p2, p1, clip, [&](size_t x, size_t y) { reversed.push_back({ x, y }); });
+	std::sort(reversed.begin(), reversed.end(), less);
+	TM2D_CHECK(reversed == expected);
+}
+
+// Get a coordinate at random, near the tilemap or anywhere below [max_coordinate].
+size_t randomCoordinate(std::mt19937_64& rng)
+{
+	switch (rng() % 3) {
+	case 0: return rng() % 100;
+	case 1: return rng() % 10000;
+	default: return rng() % max_coordinate;
+	}
+}
+
+int main()
+{
+	std::mt19937_64 rng(5);
+
+	// mulAddDivMod() against the wide integers.
+	for (int trial = 0; trial < 100000; trial++) {
+		const size_t bits = 1 + rng() % 31;
+		const size_t a = rng() % max_coordinate, b = rng() % (size_t(1) << bits), c = rng() % max_coordinate, d = 1 + rng() % (max_coordinate - 1);
+		const Wide v = Wide(a) * b + c;
+		if (v / d > SIZE_MAX) continue;
+		size_t rem;
+		TM2D_CHECK(detail::mulAddDivMod(a, b, c, d, rem) == size_t(v / d));
+		TM2D_CHECK(rem == size_t(v % d));
+	}
+
+	// Lines anywhere, clipped to areas near the origin.
+	for (int trial = 0; trial < 20000; trial++) {
+		const Rect clip(rng() % 50, rng() % 50, rng() % 80, rng() % 80);
+		Point p1 = { randomCoordinate(rng), randomCoordinate(rng) }, p2 = { randomCoordinate(rng), randomCoordinate(rng) };
+
+		// Horizontal, vertical and diagonal lines.
+		switch (trial % 5) {
+		case 0: p2.y = p1.y; break;
+		case 1: p2.x = p1.x; break;
+		case 2: {
+			const size_t d = std::min<>(p1.x, p1.y);
+			p2 = trial % 2 ? Point{ p1.x - d, p1.y - d } : Point{ p1.x - d, p1.y + d };
+			break;
+		}
+		}
+		checkLine(p1, p2, clip);
+	}
+
+	// Lines through the tilemap from far outside, whose clipping must skip most of their steps exactly.
+	for (int trial = 0; trial < 20000; trial++) {
+		const Rect clip(0, 0, 1 + rng() % 64, 1 + rng() % 64);
+		const Point inside = { rng() % clip.width, rng() % clip.height };
+		const Point far = { rng() % max_coordinate, rng() % max_coordinate };
+		checkLine(inside, far, clip);
+
+		// Through [inside], to the other side of the tilemap.
+		const size_t scale = 1 + rng() % 1000;
+		const size_t dx = std::min<>(far.x / scale, inside.x), dy = std::min<>(far.y / scale, inside.y);
+		checkLine({ inside.x - dx, inside.y - dy }, { inside.x + dx * scale, inside.y + dy * scale }, clip);
+	}
+
+	// drawLine() and drawLines() call the draw function once per tile of the lines within the tilemap.
+	for (int trial = 0; trial < 1000; trial++) {
+		TileMap2D_1D<uint32_t> map(rng() % 60, rng() % 60, 0), expected(map.width(), map.height(), 0);
+		std::vector<std::pair<Point, Point>> lines(rng() % 5);
+		size_t expected_calls = 0;
+		for (auto& [p1, p2] : lines) {
+			p1 = { randomCoordinate(rng), randomCoordinate(rng) };
+			p2 = { rng() % 80, rng() % 80 };
+			for (const Point& p : naiveLine(p1, p2, { 0, 0, map.width(), map.height() })) {
+				expected(p.x, p.y)++;
+				expected_calls++;
+			}
+		}
+
+		size_t calls = 0;
+		const auto draw = [&](TileMap2D_1D<uint32_t>* target, size_t x, size_t y) {
+			TM2D_CHECK(target == &map && x < map.width() && y < map.height());
+			(*target)(x, y)++;
+			calls++;
+		};
+		drawLines(map, std::span<const std::pair<Point, Point>>(lines), draw);
+		TM2D_CHECK(calls == expected_calls && test::sameTiles(map, expected));
+
+		for (const auto& [p1, p2] : lines) drawLine(map, p1, p2, draw);
+		TM2D_CHECK(calls == 2 * expected_calls);
+		for (size_t y = 0; y < expected.height(); y++)
+			for (size_t x = 0; x < expected.width(); x++)
+				expected(x, y) *= 2;
+		TM2D_CHECK(test::sameTiles(map, expected));
+	}
+
+	return 0;
+}
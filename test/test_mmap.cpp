@@ -0,0 +1,124 @@
+#include "TileMap2D_MMap.h"
+#include "test.h"
+
+#include <cstddef>
+#include <fstream>
+#include <iterator>
+
+using namespace tm2D;
+
+const char* const path_name = "tm2d_test_mmap.tm2d";
+
+// Get the bytes of the file at [path].
+std::vector<char> readFile(const char* path)
+{
+	std::ifstream file(path, std::ios::binary);
+	return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+void writeFile(const char* path, const std::vector<char>& bytes)
+{
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	file.write(bytes.data(), (std::streamsize)bytes.size());
+}
+
+// Whether opening the file at [path] as a tilemap of [T] fails, leaving the tilemap closed.
+template<typename T>
+bool openFails(const char* path)
+{
+	TileMap2D_MMap<T> mapped;
+	return !mapped.open(path, MMapMode::ReadOnly) && !mapped.isOpen() && mapped.width() == 0;
+}
+
+int main()
+{
+	std::mt19937 rng(12);
+	TileMap2D_1D<uint16_t> expected(37, 23, 0);
+	test::randomize(expected, rng, 60000);
+
+	// Created with padded rows, written, closed and opened again read-only.
+	{
+		TileMap2D_MMap<uint16_t> mapped;
+		TM2D_CHECK(mapped.create(path_name, 37, 23, 7, 40));
+		TM2D_CHECK(mapped.isOpen() && mapped.mode() == MMapMode::ReadWrite);
+		TM2D_CHECK(mapped.width() == 37 && mapped.height() == 23 && mapped.pitch() == 40);
+		TM2D_CHECK(test::sameTiles(mapped, TileMap2D_1D<uint16_t>(37, 23, 7)));
+		setChunk(&mapped, &expected, 0, 0);
+		TM2D_CHECK(mapped.flush({ 0, 0, 37, 12 }) && mapped.flush());
+	}
+	{
+		TileMap2D_MMap<uint16_t> mapped;
+		TM2D_CHECK(mapped.open(path_name, MMapMode::ReadOnly) && mapped.mode() == MMapMode::ReadOnly);
+		TM2D_CHECK(mapped.header().tile_size == sizeof(uint16_t) && mapped.header().pitch == 40 && mapped.header().data_offset % detail::mmap_data_alignment == 0);
+		TM2D_CHECK(test::sameTiles(mapped, expected));
+		TM2D_CHECK(readFile(path_name).size() == mapped.header().data_offset + 40 * 23 * sizeof(uint16_t));
+
+		// Moving keeps the mapping.
+		TileMap2D_MMap<uint16_t> moved(std::move(mapped));
+		TM2D_CHECK(!mapped.isOpen() && test::sameTiles(moved, expected));
+	}
+
+	// Writes through a read-write mapping reach the file, even without flush().
+	{
+		TileMap2D_MMap<uint16_t> mapped;
+		TM2D_CHECK(mapped.open(path_name));
+		flip(mapped, true, false);
+		flip(expected, true, false);
+	}
+	{
+		TileMap2D_MMap<uint16_t> mapped;
+		TM2D_CHECK(mapped.open(path_name, MMapMode::ReadOnly));
+		TM2D_CHECK(test::sameTiles(mapped, expected));
+	}
+
+	// Writes through a copy-on-write mapping stay in it.
+	{
+		TileMap2D_MMap<uint16_t> mapped, other;
+		TM2D_CHECK(mapped.open(path_name, MMapMode::CopyOnWrite) && other.open(path_name, MMapMode::ReadOnly));
+		fillRect(mapped, { 3, 4, 20, 10 }, 9);
+		TM2D_CHECK(mapped(3, 4) == 9 && mapped(22, 13) == 9);
+		TM2D_CHECK(mapped.flush());
+		TM2D_CHECK(test::sameTiles(other, expected));
+	}
+	{
+		TileMap2D_MMap<uint16_t> mapped;
+		TM2D_CHECK(mapped.open(path_name, MMapMode::ReadOnly));
+		TM2D_CHECK(test::sameTiles(mapped, expected));
+	}
+
+	// Files of other tiles, truncated or with a corrupted header are not opened.
+	const std::vector<char> bytes = readFile(path_name);
+	TM2D_CHECK(openFails<uint8_t>(path_name) && openFails<uint32_t>(path_name) && !openFails<int16_t>(path_name));
+
+	writeFile(path_name, std::vector<char>(bytes.begin(), bytes.end() - 1));
+	TM2D_CHECK(openFails<uint16_t>(path_name));
+	writeFile(path_name, std::vector<char>(bytes.begin(), bytes.begin() + sizeof(MMapHeader) - 1));
+	TM2D_CHECK(openFails<uint16_t>(path_name));
+	writeFile(path_name, {});
+	TM2D_CHECK(openFails<uint16_t>(path_name));
+
+	const auto corrupted = [&](size_t offset, auto value) {
+		std::vector<char> copy = bytes;
+		std::memcpy(copy.data() + offset, &value, sizeof(value));
+		writeFile(path_name, copy);
+		return openFails<uint16_t>(path_name);
+	};
+	TM2D_CHECK(corrupted(offsetof(MMapHeader, magic), 'X'));
+	TM2D_CHECK(corrupted(offsetof(MMapHeader, version), uint32_t(MMapHeader::current_version + 1)));
+	TM2D_CHECK(corrupted(offsetof(MMapHeader, byte_order), uint32_t(0x04030201)));
+	TM2D_CHECK(corrupted(offsetof(MMapHeader, width), uint64_t(41)));
+	TM2D_CHECK(corrupted(offsetof(MMapHeader, height), uint64_t(24)));
+	TM2D_CHECK(corrupted(offsetof(MMapHeader, pitch), uint64_t(1) << 62));
+	TM2D_CHECK(corrupted(offsetof(MMapHeader, data_offset), uint64_t(65)));
+	TM2D_CHECK(corrupted(offsetof(MMapHeader, data_offset), uint64_t(sizeof(MMapHeader) - 2)));
+	TM2D_CHECK(!corrupted(offsetof(MMapHeader, height), uint64_t(22)));
+
+	std::remove(path_name);
+	TM2D_CHECK(openFails<uint16_t>(path_name));
+
+	// Creating a file at an invalid path fails.
+	TileMap2D_MMap<uint16_t> mapped;
+	TM2D_CHECK(!mapped.create("", 4, 4) && !mapped.isOpen());
+
+	return 0;
+}
@@ -0,0 +1,152 @@
+#include "TileMap2D_Packed.h"
+#include "test.h"
+
+using namespace tm2D;
+
+// Whether the bits past the end of each row of [map] are 0, as documented by TileMap2D_Packed::data().
+template<unsigned Bits>
+bool cleanPadding(const TileMap2D_Packed<Bits>& map)
+{
+	const size_t used = map.width() % TileMap2D_Packed<Bits>::tiles_per_word * Bits;
+	if (!used) return true;
+	for (size_t y = 0; y < map.height(); y++) {
+		if (map.data()[map.pitch() * y + map.pitch() - 1] >> used) return false;
+	}
+	return true;
+}
+
+// Whether [map] has the size and tiles of [expected]. test::sameTiles() needs 'TileMapLike' tilemaps, which a packed tilemap is not.
+template<unsigned Bits>
+bool sameTiles(const TileMap2D_Packed<Bits>& map, const TileMap2D_1D<uint8_t>& expected)
+{
+	if (map.width() != expected.width() || map.height() != expected.height()) return false;
+	for (size_t y = 0; y < map.height(); y++) {
+		for (size_t x = 0; x < map.width(); x++) {
+			if (map(x, y) != expected(x, y)) return false;
+		}
+	}
+	return true;
+}
+
+// Run random operations on a packed tilemap and on a TileMap2D_1D of the same tiles, checking that they give the same results.
+template<unsigned Bits>
+void comparePacked(std::mt19937& rng)
+{
+	const unsigned range = 1u << Bits;
+	for (int trial = 0; trial < 20; trial++) {
+		const size_t width = rng() % 150, height = rng() % 40;
+		const uint8_t padding = uint8_t(rng() % range);
+		TileMap2D_Packed<Bits> map(width, height, padding);
+		TileMap2D_1D<uint8_t> expected(width, height, padding);
+
+		for (int op = 0; op < 200; op++) {
+			const Rect area(rng() % 160, rng() % 50, rng() % 100, rng() % 30);
+			const uint8_t value = uint8_t(rng() % range);
+			switch (rng() % 8) {
+			case 0:
+				for (int i = 0; i < 20; i++) {
+					const size_t x = rng() % 160, y = rng() % 50;
+					expected.set(x, y, value);
+					map.set(x, y, value);
+				}
+				break;
+			case 1:
+				fillRect(expected, area, value);
+				map.fillRect(area, value);
+				break;
+			case 2: {
+				// Packing, keeping the low bits of wider tiles.
+				TileMap2D_1D<uint16_t> input(area.width, area.height, 0);
+				test::randomize(input, rng, 1000, 3);
+				TileMap2D_1D<uint8_t> low(area.width, area.height, 0);
+				for (size_t y = 0; y < area.height; y++)
+					for (size_t x = 0; x < area.width; x++)
+						low(x, y) = uint8_t(input(x, y) % range);
+				const size_t x = rng() % 160, y = rng() % 50;
+				TM2D_CHECK(setChunk(&map, &input, x, y) == setChunk(&expected, &low, x, y));
+				break;
+			}
+			case 3: {
+				// Copies between packed tilemaps, at any bit offset and overlapping within the same tilemap.
+				TileMap2D_1D<uint8_t> other_expected(rng() % 100, rng() % 30, 0);
+				test::randomize(other_expected, rng, range, 4);
+				TileMap2D_Packed<Bits> other(other_expected.width(), other_expected.height());
+				setChunk(&other, &other_expected, 0, 0);
+
+				const bool self = rng() % 2;
+				const size_t x = rng() % 160, y = rng() % 50;
+				if (self) {
+					TM2D_CHECK(setChunk(&map, &map, x, y, area) == setChunk(&expected, &expected, x, y, area));
+				}
+				else {
+					TM2D_CHECK(setChunk(&map, &other, x, y, area) == setChunk(&expected, &other_expected, x, y, area));
+				}
+				break;
+			}
+			case 4: {
+				const bool horizontal = rng() % 2, vertical = rng() % 2;
+				flip(expected, horizontal, vertical);
+				flip(map, horizontal, vertical);
+				break;
+			}
+			case 5: {
+				if (!width || !height) break;
+				const Point center = { rng() % width, rng() % height };
+				const uint8_t from = expected(center.x, center.y), to = uint8_t(rng() % 2 ? from : (from + 1) % range);
+				const bool eight = rng() % 2;
+				TM2D_CHECK(
+					fillArea(expected, center, [&](uint8_t t) { return t == from; }, to, eight) ==
+					map.fillArea(center, [&](uint8_t t) { return t == from; }, to, eight)
+				);
+				break;
+			}
+			case 6: {
+				size_t counted = 0;
+				const Rect cliprect = area.intersection({ 0, 0, width, height });
+				for (size_t y = cliprect.y; y < cliprect.y + cliprect.height; y++)
+					for (size_t x = cliprect.x; x < cliprect.x + cliprect.width; x++)
+						counted += expected(x, y) == value;
+				TM2D_CHECK(map.count(area, value) == counted);
+				break;
+			}
+			case 7: {
+				// Unpacking and packed chunks, partly outside the tilemap.
+				TileMap2D_1D<uint8_t> a, b;
+				getChunk(&a, &expected, area);
+				getChunk(&b, &map, area);
+				TM2D_CHECK(test::sameTiles(a, b));
+
+				TileMap2D_Packed<Bits> chunk;
+				getChunk(&chunk, &map, area);
+				TM2D_CHECK(chunk.width() == area.width && chunk.height() == area.height);
+				TM2D_CHECK(cleanPadding(chunk));
+				for (size_t y = 0; y < area.height; y++)
+					for (size_t x = 0; x < area.width; x++)
+						TM2D_CHECK(chunk(x, y) == map.get(area.x + x, area.y + y));
+				break;
+			}
+			}
+			TM2D_CHECK(sameTiles(map, expected));
+			TM2D_CHECK(cleanPadding(map));
+		}
+	}
+}
+
+int main()
+{
+	std::mt19937 rng(15);
+	comparePacked<1>(rng);
+	comparePacked<2>(rng);
+	comparePacked<4>(rng);
+	comparePacked<8>(rng);
+
+	// Stored values keep their low bits only.
+	TileMap2D_Packed<2> map(70, 3, 0xfe);
+	TM2D_CHECK(map.get(69, 2) == 2 && map.get(70, 2) == 0);
+	map.set(3, 1, 7);
+	TM2D_CHECK(std::as_const(map)(3, 1) == 3);
+	map(4, 1) = map(3, 1);
+	TM2D_CHECK(map.get(4, 1) == 3);
+
+	return 0;
+}
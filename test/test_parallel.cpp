@@ -0,0 +1,178 @@
+#include "TileMap2D_Parallel.h"
+#include "TileMap2D_Chunked.h"
+#include "TileMap2D_Label.h"
+#include "TileMap2D_Resample.h"
+#include "TileMap2D_Stencil.h"
+#include "test.h"
+
+using namespace tm2D;
+
+// More bands than threads, run concurrently even on a single core.
+ThreadPool pool(3);
+const execution::parallel_policy policy = execution::par.on(pool).withThreshold(0);
+
+// Get a copy of [map], whose tilemap type may be move-only.
+template<ResizableTileMapLike M>
+M copyOf(const M& map)
+{
+	M copy(map.width(), map.height());
+	setChunk(&copy, &map, 0, 0);
+	return copy;
+}
+
+// Check that the parallel overloads writing to an [M] give the tiles of the sequential ones, on random tilemaps.
+template<ResizableTileMapLike M>
+void compareWithSequential(std::mt19937& rng)
+{
+	using T = tile_t<M>;
+	for (int trial = 0; trial < 30; trial++) {
+		M map(rng() % 70, rng() % 70);
+		test::randomize(map, rng, 50, 1 + rng() % 8);
+
+		for (int horizontal = 0; horizontal < 2; horizontal++) {
+			for (int vertical = 0; vertical < 2; vertical++) {
+				M expected = copyOf(map), flipped = copyOf(map);
+				flip(expected, horizontal, vertical);
+				flip(policy, flipped, horizontal, vertical);
+				TM2D_CHECK(test::sameTiles(flipped, expected));
+			}
+		}
+
+		for (int left = 0; left < 2; left++) {
+			M expected, rotated;
+			rot90(execution::seq, &expected, &map, left);
+			rot90(policy, &rotated, &map, left);
+			TM2D_CHECK(test::sameTiles(rotated, expected));
+		}
+		{
+			M expected, rotated;
+			rot180(execution::seq, &expected, &map);
+			rot180(policy, &rotated, &map);
+			TM2D_CHECK(test::sameTiles(rotated, expected));
+		}
+
+		// Partly outside the tilemap.
+		const Rect area(rng() % 80, rng() % 80, rng() % 40, rng() % 40);
+		{
+			M expected, chunk;
+			getChunk(execution::seq, &expected, &map, area);
+			getChunk(policy, &chunk, &map, area);
+			TM2D_CHECK(test::sameTiles(chunk, expected));
+		}
+		{
+			TileMap2D_1D<T> input(rng() % 40, rng() % 40, T(0));
+			test::randomize(input, rng, 50);
+			const size_t x = rng() % 80, y = rng() % 80;
+			M expected = copyOf(map), written = copyOf(map);
+			TM2D_CHECK(setChunk(policy, &written, &input, x, y, area) == setChunk(execution::seq, &expected, &input, x, y, area));
+			TM2D_CHECK(test::sameTiles(written, expected));
+		}
+		{
+			const auto increment = [](T& tile, size_t x, size_t y) { tile = T(tile + x * 3 + y); };
+			M expected = copyOf(map), incremented = copyOf(map);
+			forEachTile(execution::seq, expected, increment);
+			forEachTile(policy, incremented, increment);
+			TM2D_CHECK(test::sameTiles(incremented, expected));
+		}
+	}
+}
+
+// Check that the parallel overloads writing to an [M] allocate the chunks allocated by the sequential ones, measured by [chunks(map)].
+// The tilemaps hold a single tile which isn't the padding, in a large area of padding tiles.
+template<ResizableTileMapLike M, typename C>
+void checkAllocations(C&& chunks)
+{
+	using T = tile_t<M>;
+	M map(512, 300);
+	map(7, 290) = T(2);
+	TileMap2D_1D<T> input(30, 30, T());
+	input(4, 5) = T(3);
+
+	const auto same = [&](const M& written, const M& expected) {
+		TM2D_CHECK(test::sameTiles(written, expected));
+		TM2D_CHECK(chunks(written) == chunks(expected));
+	};
+
+	for (int horizontal = 0; horizontal < 2; horizontal++) {
+		for (int vertical = 0; vertical < 2; vertical++) {
+			M expected = copyOf(map), flipped = copyOf(map);
+			flip(expected, horizontal, vertical);
+			flip(policy, flipped, horizontal, vertical);
+			same(flipped, expected);
+		}
+	}
+
+	M expected, written;
+	rot90(execution::seq, &expected, &map, true);
+	rot90(policy, &written, &map, true);
+	same(written, expected);
+	rot180(execution::seq, &expected, &map);
+	rot180(policy, &written, &map);
+	same(written, expected);
+	getChunk(execution::seq, &expected, &map, { 0, 100, 512, 200 });
+	getChunk(policy, &written, &map, { 0, 100, 512, 200 });
+	same(written, expected);
+
+	expected = copyOf(map), written = copyOf(map);
+	setChunk(execution::seq, &expected, &input, 100, 10);
+	setChunk(policy, &written, &input, 100, 10);
+	same(written, expected);
+
+	expected = copyOf(map), written = copyOf(map);
+	forEachTile(execution::seq, expected, [](T&, size_t, size_t) {});
+	forEachTile(policy, written, [](T&, size_t, size_t) {});
+	same(written, expected);
+
+	const auto copy = [](const Neighborhood<T, 1>& tiles) { return tiles(0, 0); };
+	applyStencil<1>(execution::seq, &expected, &map, copy);
+	applyStencil<1>(policy, &written, &map, copy);
+	same(written, expected);
+	resample(execution::seq, &expected, &map, 256, 150, Filter::Nearest);
+	resample(policy, &written, &map, 256, 150, Filter::Nearest);
+	same(written, expected);
+
+	M labels, expected_labels;
+	const auto foreground = [](T tile) { return tile != T(); };
+	labelComponents(execution::seq, &expected_labels, map, foreground);
+	labelComponents(policy, &labels, map, foreground);
+	same(labels, expected_labels);
+}
+
+int main()
+{
+	std::mt19937 rng(9);
+
+	compareWithSequential<TileMap2D_1D<uint16_t>>(rng);
+	compareWithSequential<TileMap2D_Chunked<uint16_t, 3>>(rng);
+	compareWithSequential<TileMap2D_Sparse<uint16_t, 3>>(rng);
+	compareWithSequential<TileMap2D_CoW<uint16_t, 3>>(rng);
+
+	// Into pitched subviews, leaving the tiles around them untouched.
+	for (int trial = 0; trial < 30; trial++) {
+		TileMap2D_1D<uint16_t> map(1 + rng() % 70, 1 + rng() % 70, 0);
+		test::randomize(map, rng, 50);
+		const Rect area(rng() % map.width(), rng() % map.height(), 1 + rng() % 70, 1 + rng() % 70);
+		const bool horizontal = rng() % 2, vertical = rng() % 2;
+		TileMap2D_1D<uint16_t> input(rng() % 40, rng() % 40, 0);
+		test::randomize(input, rng, 50);
+
+		TileMap2D_1D<uint16_t> expected = map;
+		auto view = expected.subview(area);
+		flip(view, horizontal, vertical);
+		setChunk(&view, &input, 1, 2);
+		forEachTile(execution::seq, view, [](uint16_t& tile, size_t x, size_t) { tile = uint16_t(tile + x); });
+
+		view = map.subview(area);
+		flip(policy, view, horizontal, vertical);
+		setChunk(policy, &view, &input, 1, 2);
+		forEachTile(policy, view, [](uint16_t& tile, size_t x, size_t) { tile = uint16_t(tile + x); });
+		TM2D_CHECK(test::sameTiles(map, expected));
+	}
+
+	// Concurrent writes don't allocate the chunks keeping the padding tile.
+	checkAllocations<TileMap2D_Chunked<uint8_t, 4>>([](const auto& map) { return map.allocatedChunks(); });
+	checkAllocations<TileMap2D_Sparse<uint8_t, 4>>([](const auto& map) { return map.denseChunks(); });
+	checkAllocations<TileMap2D_CoW<uint8_t, 4>>([](const auto& map) { return map.allocatedChunks(); });
+
+	return 0;
+}
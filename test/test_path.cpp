@@ -0,0 +1,138 @@
+#include "TileMap2D_Path.h"
+#include "test.h"
+
+#include <cmath>
+
+using namespace tm2D;
+
+using Map = TileMap2D_1D<uint8_t>;
+
+const auto passable = [](uint8_t t) { return t != 0; };
+
+// Whether the costs [a] and [b], summed in different orders, are the same.
+bool sameCost(float a, float b)
+{
+	if (std::isinf(a) || std::isinf(b)) return a == b;
+	return std::abs(a - b) <= 1e-4f * std::max<>(1.0f, a);
+}
+
+// Whether [p] is in [area].
+bool inside(const Rect& area, const Point& p)
+{
+	return p.x - area.x < area.width && p.y - area.y < area.height;
+}
+
+// Check that [path] goes from [start] to [goal] over passable tiles of the area of [options] with its moves, and get its cost.
+float pathCost(const Map& map, const std::vector<Point>& path, const Point& start, const Point& goal, const PathOptions& options)
+{
+	const Rect area = options.area == Rect() ? Rect(0, 0, map.width(), map.height()) : options.area.intersection({ 0, 0, map.width(), map.height() });
+	TM2D_CHECK(!path.empty() && path.front() == start && path.back() == goal);
+
+	float cost = 0;
+	for (size_t i = 0; i < path.size(); i++) {
+		const Point p = path[i];
+		TM2D_CHECK(inside(area, p) && passable(map(p.x, p.y)));
+		if (!i) continue;
+
+		const Point q = path[i - 1];
+		const size_t dx = p.x > q.x ? p.x - q.x : q.x - p.x, dy = p.y > q.y ? p.y - q.y : q.y - p.y;
+		TM2D_CHECK(dx <= 1 && dy <= 1 && dx + dy > 0);
+		if (dx && dy) {
+			TM2D_CHECK(options.eight_connected);
+			if (!options.cut_corners) TM2D_CHECK(passable(map(p.x, q.y)) && passable(map(q.x, p.y)));
+			cost += detail::diagonal_cost;
+		}
+		else cost += 1.0f;
+	}
+	return cost;
+}
+
+// Point of [map] at random.
+Point randomPoint(const Map& map, std::mt19937& rng)
+{
+	return { rng() % map.width(), rng() % map.height() };
+}
+
+int main()
+{
+	std::mt19937 rng(28);
+	PathFinder finder, dijkstra;
+	std::vector<Point> path;
+
+	// A* and Jump Point Search find paths of the cost of the shortest ones found by Dijkstra, exactly when there is one.
+	for (int trial = 0; trial < 200; trial++) {
+		Map map(1 + rng() % 60, 1 + rng() % 60, 1);
+		const unsigned walls = rng() % 50;
+		for (size_t y = 0; y < map.height(); y++)
+			for (size_t x = 0; x < map.width(); x++)
+				if (rng() % 100 < walls) map(x, y) = 0;
+
+		PathOptions options;
+		options.eight_connected = trial % 3 != 0;
+		options.cut_corners = trial % 3 == 2;
+		if (trial % 4 == 0) options.area = Rect(rng() % map.width(), rng() % map.height(), rng() % 60, rng() % 60);
+
+		for (int query = 0; query < 10; query++) {
+			const Point start = randomPoint(map, rng), goal = randomPoint(map, rng);
+			const bool costs = dijkstra.findCosts(map, start, passable, options);
+			const float expected = costs ? dijkstra.costTo(goal) : detail::no_path;
+			TM2D_CHECK(costs == (passable(map(start.x, start.y)) && (options.area == Rect() || inside(options.area, start))));
+
+			const bool found = finder.findPath(map, start, goal, passable, &path, options);
+			TM2D_CHECK(found == !std::isinf(expected));
+			if (found) {
+				TM2D_CHECK(sameCost(finder.cost(), expected));
+				TM2D_CHECK(sameCost(pathCost(map, path, start, goal, options), expected));
+			}
+
+			if (options.eight_connected && !options.cut_corners) {
+				TM2D_CHECK(finder.findPathJPS(map, start, goal, passable, &path, options) == found);
+				if (found) {
+					TM2D_CHECK(sameCost(finder.cost(), expected));
+					TM2D_CHECK(sameCost(pathCost(map, path, start, goal, options), expected));
+				}
+			}
+		}
+	}
+
+	// The hierarchy finds a path exactly when A* does, before and after updates of the tilemap, at least as costly as the shortest one.
+	for (int trial = 0; trial < 40; trial++) {
+		Map map(1 + rng() % 90, 1 + rng() % 90, 1);
+		const unsigned walls = rng() % 45;
+		for (size_t y = 0; y < map.height(); y++)
+			for (size_t x = 0; x < map.width(); x++)
+				if (rng() % 100 < walls) map(x, y) = 0;
+
+		PathOptions options;
+		options.eight_connected = trial % 3 != 0;
+		options.cut_corners = trial % 3 == 2;
+		PathHierarchy<3> hierarchy(options);
+		hierarchy.build(map, passable);
+
+		for (int update = 0; update < 8; update++) {
+			for (int query = 0; query < 10; query++) {
+				const Point start = randomPoint(map, rng), goal = randomPoint(map, rng);
+				const bool found = finder.findPath(map, start, goal, passable, nullptr, options);
+				TM2D_CHECK(hierarchy.findPath(map, start, goal, passable, &path) == found);
+				if (found) {
+					const float cost = pathCost(map, path, start, goal, options);
+					TM2D_CHECK(sameCost(hierarchy.cost(), cost));
+					TM2D_CHECK(cost >= finder.cost() - 1e-3f);
+				}
+			}
+
+			// Walls or floors over an area, or a wall cutting the tilemap.
+			const Rect area = update % 2 ?
+				Rect(rng() % map.width(), rng() % map.height(), rng() % 20, rng() % 20) :
+				Rect(rng() % map.width(), 0, 1, map.height());
+			fillRect(map, area, uint8_t(update % 4 == 3));
+			hierarchy.update(map, passable, area);
+
+			PathHierarchy<3> rebuilt(options);
+			rebuilt.build(map, passable);
+			TM2D_CHECK(hierarchy.nodeCount() == rebuilt.nodeCount());
+		}
+	}
+
+	return 0;
+}
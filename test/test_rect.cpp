@@ -0,0 +1,185 @@
+#include "TileMap2D.h"
+#include "TileMap2D_Chunked.h"
+#include "test.h"
+
+#include <string>
+
+using namespace tm2D;
+
+// Whether ([x]; [y]) lies in [area], which may extend past the tilemap.
+bool contains(const Rect& area, size_t x, size_t y)
+{
+	return x >= area.x && x - area.x < area.width && y >= area.y && y - area.y < area.height;
+}
+
+// Get a rectangle partly or fully outside of a [width] x [height] tilemap, or empty.
+Rect randomArea(std::mt19937& rng, size_t width, size_t height)
+{
+	if (rng() % 10 == 0) return { rng() % 5 + width, rng() % 5, rng() % 10, rng() % 10 };
+	return { rng() % (width + 5), rng() % (height + 5), rng() % (width + 10), rng() % (height + 10) };
+}
+
+// Check fillRect(), transform() and replace() on [map] against per-tile loops on [expected], a TileMap2D_1D of the same size and tiles.
+template<typename M>
+void checkRects(M& map, TileMap2D_1D<uint16_t>& expected, std::mt19937& rng)
+{
+	const size_t width = expected.width(), height = expected.height();
+	for (int op = 0; op < 30; op++) {
+		const Rect area = randomArea(rng, width, height);
+		const uint16_t value = uint16_t(rng() % 6);
+
+		switch (rng() % 5) {
+		case 0:
+			fillRect(map, area, value);
+			for (size_t y = 0; y < height; y++)
+				for (size_t x = 0; x < width; x++)
+					if (contains(area, x, y)) expected(x, y) = value;
+			break;
+		case 1:
+			// [elem] is a tile of the map, overwritten by the fill.
+			if (width && height) {
+				const Point p = { rng() % width, rng() % height };
+				const uint16_t tile = expected(p.x, p.y);
+				fillRect(map, area, map(p.x, p.y));
+				for (size_t y = 0; y < height; y++)
+					for (size_t x = 0; x < width; x++)
+						if (contains(area, x, y)) expected(x, y) = tile;
+			}
+			break;
+		case 2: {
+			const auto func = [value](uint16_t tile) { return uint16_t(tile * 3 + value) % 6; };
+			transform(map, area, func);
+			for (size_t y = 0; y < height; y++)
+				for (size_t x = 0; x < width; x++)
+					if (contains(area, x, y)) expected(x, y) = func(expected(x, y));
+			break;
+		}
+		case 3: {
+			const uint16_t old_value = uint16_t(rng() % 6);
+			replace(map, old_value, value, area);
+			for (size_t y = 0; y < height; y++)
+				for (size_t x = 0; x < width; x++)
+					if (contains(area == Rect(0, 0, 0, 0) ? Rect(0, 0, width, height) : area, x, y) && expected(x, y) == old_value) expected(x, y) = value;
+			break;
+		}
+		case 4:
+			// Both elements are tiles of the map, over the default area: the whole tilemap.
+			if (width && height) {
+				const Point a = { rng() % width, rng() % height }, b = { rng() % width, rng() % height };
+				const uint16_t old_value = expected(a.x, a.y), new_value = expected(b.x, b.y);
+				replace(map, map(a.x, a.y), map(b.x, b.y));
+				for (size_t y = 0; y < height; y++)
+					for (size_t x = 0; x < width; x++)
+						if (expected(x, y) == old_value) expected(x, y) = new_value;
+			}
+			break;
+		}
+		TM2D_CHECK(test::sameTiles(map, expected));
+	}
+}
+
+// Check blit() from [input] into [output] against a per-tile loop on [expected], a TileMap2D_1D of the size and tiles of [output].
+// The area blit() returns must be the clipped destination, or empty when nothing is copied.
+template<typename Out, typename In>
+void checkBlits(Out& output, const In& input, TileMap2D_1D<uint16_t>& expected, std::mt19937& rng)
+{
+	for (int op = 0; op < 20; op++) {
+		const Rect src_area = rng() % 4 ? randomArea(rng, input.width(), input.height()) : Rect();
+		const size_t x = rng() % (output.width() + 5), y = rng() % (output.height() + 5);
+		const uint16_t transparent = uint16_t(rng() % 6);
+		const auto mask = [transparent](uint16_t tile) { return tile != transparent; };
+
+		// The source area clipped to [input], then the destination clipped to [output].
+		const Rect src = (src_area == Rect() ? Rect(0, 0, input.width(), input.height()) : src_area).intersection({ 0, 0, input.width(), input.height() });
+		Rect covered;
+		if (x < output.width() && y < output.height() && src.width && src.height)
+			covered = { x, y, std::min<>(src.width, output.width() - x), std::min<>(src.height, output.height() - y) };
+		for (size_t _y = 0; _y < covered.height; _y++) {
+			for (size_t _x = 0; _x < covered.width; _x++) {
+				const uint16_t tile = input(src.x + _x, src.y + _y);
+				if (mask(tile)) expected(x + _x, y + _y) = tile;
+			}
+		}
+
+		const Rect result = blit(&output, &input, x, y, mask, src_area);
+		TM2D_CHECK(covered.width && covered.height ? result == covered : !result.width || !result.height);
+		TM2D_CHECK(test::sameTiles(output, expected));
+	}
+}
+
+int main()
+{
+	std::mt19937 rng(18);
+
+	for (int trial = 0; trial < 200; trial++) {
+		TileMap2D_1D<uint16_t> tiles(rng() % 40, rng() % 40, 0);
+		test::randomize(tiles, rng, 6, 1 + rng() % 4);
+
+		// Contiguous, pitched and chunked tilemaps.
+		{
+			TileMap2D_1D<uint16_t> map = tiles, expected = tiles;
+			checkRects(map, expected, rng);
+		}
+		{
+			TileMap2D_1D<uint16_t> buffer(tiles.width() + 7, tiles.height() + 3, 9);
+			setChunk(&buffer, &tiles, 4, 2);
+			TileMap2D_1D<uint16_t> buffer_expected = buffer, expected = tiles;
+			TileMap2DView<uint16_t> view = buffer.subview({ 4, 2, tiles.width(), tiles.height() });
+			checkRects(view, expected, rng);
+			setChunk(&buffer_expected, &expected, 4, 2);
+			TM2D_CHECK(test::sameTiles(buffer, buffer_expected));
+		}
+		{
+			TileMap2D_Chunked<uint16_t, 3> map(tiles.width(), tiles.height());
+			setChunk(&map, &tiles, 0, 0);
+			TileMap2D_1D<uint16_t> expected = tiles;
+			checkRects(map, expected, rng);
+		}
+
+		// Blits between contiguous and chunked tilemaps, both ways.
+		TileMap2D_1D<uint16_t> input(rng() % 30, rng() % 30, 0);
+		test::randomize(input, rng, 6, 1 + rng() % 4);
+		TileMap2D_Chunked<uint16_t, 3> chunked_input(input.width(), input.height());
+		setChunk(&chunked_input, &input, 0, 0);
+		{
+			TileMap2D_1D<uint16_t> map = tiles, expected = tiles;
+			checkBlits(map, input, expected, rng);
+			checkBlits(map, chunked_input, expected, rng);
+		}
+		{
+			TileMap2D_Chunked<uint16_t, 3> map(tiles.width(), tiles.height());
+			setChunk(&map, &tiles, 0, 0);
+			TileMap2D_1D<uint16_t> expected = tiles;
+			checkBlits(map, input, expected, rng);
+			checkBlits(map, chunked_input, expected, rng);
+		}
+	}
+
+	// Chunked tilemaps only allocate the chunks in which replace() matches tiles.
+	{
+		TileMap2D_Chunked<uint16_t, 3> map(50, 50);
+		replace(map, uint16_t(1), uint16_t(2));
+		TM2D_CHECK(map.allocatedChunks() == 0);
+		map.set(20, 30, 1);
+		replace(map, uint16_t(1), uint16_t(2));
+		TM2D_CHECK(map.allocatedChunks() == 1 && map(20, 30) == 2);
+	}
+
+	// Tiles that are not trivially copyable are only assigned where the mask holds.
+	{
+		TileMap2D_1D<std::string> output(5, 4, "bg"), input(3, 3, "");
+		input(0, 0) = "a";
+		input(2, 1) = "b";
+		input(1, 2) = "c";
+		const Rect result = blit(&output, &input, 3, 1, [](const std::string& tile) { return !tile.empty(); });
+		TM2D_CHECK((result == Rect(3, 1, 2, 3)));
+		for (size_t y = 0; y < 4; y++) {
+			for (size_t x = 0; x < 5; x++) {
+				const char* tile = x == 3 && y == 1 ? "a" : x == 4 && y == 3 ? "c" : "bg";
+				TM2D_CHECK(output(x, y) == tile);
+			}
+		}
+	}
+
+	return 0;
+}
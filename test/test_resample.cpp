@@ -0,0 +1,125 @@
+#include "TileMap2D_Resample.h"
+#include "TileMap2D_Chunked.h"
+#include "test.h"
+
+using namespace tm2D;
+
+// Get the channel [c] of the tiles of [map].
+TileMap2D_1D<uint8_t> channel(const TileMap2D_1D<uint32_t>& map, size_t c)
+{
+	TileMap2D_1D<uint8_t> bytes(map.width(), map.height(), 0);
+	for (size_t y = 0; y < map.height(); y++)
+		for (size_t x = 0; x < map.width(); x++)
+			bytes(x, y) = uint8_t(map(x, y) >> (8 * c));
+	return bytes;
+}
+
+// Average the channels of the tiles of [input] over the ranges of Box, rounding like '(sum + n / 2) / n'.
+template<typename T>
+TileMap2D_1D<T> naiveBox(const TileMap2D_1D<T>& input, size_t new_width, size_t new_height)
+{
+	constexpr size_t channels = sizeof(T);
+	const size_t width = input.width(), height = input.height();
+	TileMap2D_1D<T> output(new_width, new_height, 0);
+	for (size_t y = 0; y < new_height; y++) {
+		const size_t y_begin = y * height / new_height, y_end = std::max<>(y_begin + 1, (y + 1) * height / new_height);
+		for (size_t x = 0; x < new_width; x++) {
+			const size_t x_begin = x * width / new_width, x_end = std::max<>(x_begin + 1, (x + 1) * width / new_width);
+			const size_t n = (x_end - x_begin) * (y_end - y_begin);
+			T tile = 0;
+			for (size_t c = 0; c < channels; c++) {
+				size_t sum = 0;
+				for (size_t sy = y_begin; sy < y_end; sy++)
+					for (size_t sx = x_begin; sx < x_end; sx++)
+						sum += (input(sx, sy) >> (8 * c)) & 0xFF;
+				tile |= T((sum + n / 2) / n) << (8 * c);
+			}
+			output(x, y) = tile;
+		}
+	}
+	return output;
+}
+
+// Check Box against the naive averages on [T] tiles, on sizes down and up, and halvings of odd and even widths.
+template<typename T>
+void checkBox(std::mt19937& rng)
+{
+	for (int trial = 0; trial < 300; trial++) {
+		TileMap2D_1D<T> input(1 + rng() % 70, 1 + rng() % 70, 0);
+		test::randomize(input, rng, trial % 2 ? 0xFFFFFFFFu : 256);
+		const bool halving = trial % 3 == 0;
+		const size_t
+			new_width = halving ? std::max<size_t>(input.width() / 2, 1) : 1 + rng() % 90,
+			new_height = halving ? std::max<size_t>(input.height() / 2, 1) : 1 + rng() % 90;
+
+		TileMap2D_1D<T> output;
+		TM2D_CHECK(resample(&output, &input, new_width, new_height, Filter::Box));
+		TM2D_CHECK(test::sameTiles(output, naiveBox(input, new_width, new_height)));
+	}
+}
+
+int main()
+{
+	std::mt19937 rng(29);
+
+	checkBox<uint8_t>(rng);
+	checkBox<uint32_t>(rng);
+
+	// The SIMD kernels halving rows give the averages of their scalar tail.
+	for (int trial = 0; trial < 2000; trial++) {
+		const size_t count = rng() % 100;
+		std::vector<uint8_t> rows(2 * 2 * 4 * count), dst1(count), dst4(4 * count);
+		for (uint8_t& byte : rows) byte = uint8_t(rng());
+		const uint8_t* const row0 = rows.data(), * const row1 = rows.data() + 2 * 4 * count;
+
+		detail::halveRows<1>(dst1.data(), row0, row1, count);
+		for (size_t i = 0; i < count; i++)
+			TM2D_CHECK(dst1[i] == (row0[2 * i] + row0[2 * i + 1] + row1[2 * i] + row1[2 * i + 1] + 2) >> 2);
+		detail::halveRows<4>(dst4.data(), row0, row1, count);
+		for (size_t i = 0; i < 4 * count; i++) {
+			const size_t s = 8 * (i / 4) + i % 4;
+			TM2D_CHECK(dst4[i] == (row0[s] + row0[s + 4] + row1[s] + row1[s + 4] + 2) >> 2);
+		}
+	}
+
+	// 'uint32_t' tiles are filtered as 4 independent 8-bit channels.
+	for (int trial = 0; trial < 300; trial++) {
+		TileMap2D_1D<uint32_t> input(1 + rng() % 50, 1 + rng() % 50, 0);
+		test::randomize(input, rng, 0xFFFFFFFFu);
+		const size_t new_width = trial % 2 ? std::max<size_t>(input.width() / 2, 1) : 1 + rng() % 70, new_height = trial % 2 ? std::max<size_t>(input.height() / 2, 1) : 1 + rng() % 70;
+		const Filter filter = Filter(trial % 3);
+
+		TileMap2D_1D<uint32_t> output;
+		TM2D_CHECK(resample(&output, &input, new_width, new_height, filter));
+		for (size_t c = 0; c < 4; c++) {
+			const TileMap2D_1D<uint8_t> input_channel = channel(input, c);
+			TileMap2D_1D<uint8_t> output_channel;
+			TM2D_CHECK(resample(&output_channel, &input_channel, new_width, new_height, filter));
+			TM2D_CHECK(test::sameTiles(output_channel, channel(output, c)));
+		}
+	}
+
+	// The parallel policy gives the tiles of the sequential one, into chunked tilemaps and from them.
+	const execution::parallel_policy par = execution::par.withThreshold(0);
+	for (int trial = 0; trial < 300; trial++) {
+		TileMap2D_1D<uint32_t> input(rng() % 70, rng() % 70, 0);
+		test::randomize(input, rng, 0xFFFFFFFFu);
+		TileMap2D_Chunked<uint32_t, 3> chunked_input(input.width(), input.height());
+		setChunk(&chunked_input, &input, 0, 0);
+		const size_t new_width = trial % 2 ? std::max<size_t>(input.width() / 2, 1) : rng() % 90, new_height = trial % 2 ? std::max<size_t>(input.height() / 2, 1) : rng() % 90;
+		const Filter filter = Filter(trial % 3);
+
+		TileMap2D_1D<uint32_t> expected;
+		TM2D_CHECK(resample(execution::seq, &expected, &input, new_width, new_height, filter));
+		TileMap2D_Chunked<uint32_t, 3> output;
+		TM2D_CHECK(resample(par, &output, &input, new_width, new_height, filter));
+		TM2D_CHECK(test::sameTiles(output, expected));
+		TM2D_CHECK(resample(par, &output, &chunked_input, new_width, new_height, filter));
+		TM2D_CHECK(test::sameTiles(output, expected));
+		TileMap2D_1D<uint32_t> contiguous;
+		TM2D_CHECK(resample(par, &contiguous, &chunked_input, new_width, new_height, filter));
+		TM2D_CHECK(test::sameTiles(contiguous, expected));
+	}
+
+	return 0;
+}
@@ -0,0 +1,137 @@
+#include "TileMap2D.h"
+#include "TileMap2D_Chunked.h"
+#include "test.h"
+
+using namespace tm2D;
+
+// A tile of 16 bytes, with no SIMD kernel.
+struct Tile16
+{
+	uint64_t low = 0;
+	uint64_t high = 0;
+
+	bool operator==(const Tile16&) const = default;
+};
+
+// Get a random tile.
+template<typename T>
+T randomTile(std::mt19937& rng)
+{
+	if constexpr (std::same_as<T, Tile16>) return { rng(), rng() };
+	else return T(rng());
+}
+
+// Get a [width] x [height] tilemap of random tiles.
+template<typename T>
+TileMap2D_1D<T> randomMap(size_t width, size_t height, std::mt19937& rng)
+{
+	TileMap2D_1D<T> map(width, height, T());
+	for (size_t y = 0; y < height; y++)
+		for (size_t x = 0; x < width; x++)
+			map(x, y) = randomTile<T>(rng);
+	return map;
+}
+
+// Rotate [input] 90 degrees tile by tile.
+template<TileMapLike In>
+TileMap2D_1D<tile_t<In>> naiveRot90(const In& input, bool rotate_left)
+{
+	const size_t width = input.width(), height = input.height();
+	TileMap2D_1D<tile_t<In>> output(height, width, tile_t<In>());
+	for (size_t y = 0; y < height; y++) {
+		for (size_t x = 0; x < width; x++) {
+			if (rotate_left) output(y, width - 1 - x) = input(x, y);
+			else output(height - 1 - y, x) = input(x, y);
+		}
+	}
+	return output;
+}
+
+// Rotate [input] 180 degrees tile by tile.
+template<TileMapLike In>
+TileMap2D_1D<tile_t<In>> naiveRot180(const In& input)
+{
+	const size_t width = input.width(), height = input.height();
+	TileMap2D_1D<tile_t<In>> output(width, height, tile_t<In>());
+	for (size_t y = 0; y < height; y++)
+		for (size_t x = 0; x < width; x++)
+			output(width - 1 - x, height - 1 - y) = input(x, y);
+	return output;
+}
+
+// Check the rotations of [T] tiles against the naive ones, on sizes around the SIMD kernels and the cache blocks.
+template<typename T>
+void checkRotations(std::mt19937& rng)
+{
+	for (int trial = 0; trial < 60; trial++) {
+		const size_t width = rng() % 100, height = trial % 3 ? rng() % 100 : width;
+		const TileMap2D_1D<T> map = randomMap<T>(width, height, rng);
+
+		for (int left = 0; left < 2; left++) {
+			// Into another tilemap, contiguous or not.
+			TileMap2D_1D<T> rotated;
+			rot90(&rotated, &map, left);
+			TM2D_CHECK(test::sameTiles(rotated, naiveRot90(map, left)));
+			TileMap2D_Chunked<T, 3> chunked;
+			rot90(&chunked, &map, left);
+			TM2D_CHECK(test::sameTiles(chunked, rotated));
+
+			// In place, square or not.
+			TileMap2D_1D<T> in_place = map;
+			TM2D_CHECK(rot90(&in_place, left));
+			TM2D_CHECK(test::sameTiles(in_place, rotated));
+		}
+
+		TileMap2D_1D<T> rotated;
+		rot180(&rotated, &map);
+		TM2D_CHECK(test::sameTiles(rotated, naiveRot180(map)));
+		TileMap2D_1D<T> in_place = map;
+		rot180(&in_place);
+		TM2D_CHECK(test::sameTiles(in_place, rotated));
+	}
+
+	// Pitched subviews, read from and rotated in place, leaving the tiles around them untouched.
+	for (int trial = 0; trial < 60; trial++) {
+		TileMap2D_1D<T> map = randomMap<T>(1 + rng() % 100, 1 + rng() % 100, rng);
+		const size_t x = rng() % map.width(), y = rng() % map.height();
+		const size_t side = rng() % std::min<>(map.width() - x + 1, map.height() - y + 1);
+		const Rect area = trial % 2 ? Rect(x, y, side, side) : Rect(x, y, rng() % 100, rng() % 100);
+		const bool left = rng() % 2;
+
+		const TileMap2DView<T> view = map.subview(area);
+		TileMap2D_1D<T> rotated;
+		rot90(&rotated, &view, left);
+		TM2D_CHECK(test::sameTiles(rotated, naiveRot90(view, left)));
+		rot180(&rotated, &view);
+		TM2D_CHECK(test::sameTiles(rotated, naiveRot180(view)));
+
+		// Not resizable, so only rotated by 90 degrees when square.
+		TileMap2D_1D<T> expected = map;
+		TileMap2DView<T> in_place = map.subview(area);
+		const bool square = in_place.width() == in_place.height();
+		if (square) {
+			const TileMap2D_1D<T> naive = naiveRot90(in_place, left);
+			setChunk(&expected, &naive, area.x, area.y);
+		}
+		TM2D_CHECK(rot90(&in_place, left) == square);
+		TM2D_CHECK(test::sameTiles(map, expected));
+
+		const TileMap2D_1D<T> naive = naiveRot180(in_place);
+		setChunk(&expected, &naive, area.x, area.y);
+		rot180(&in_place);
+		TM2D_CHECK(test::sameTiles(map, expected));
+	}
+}
+
+int main()
+{
+	std::mt19937 rng(3);
+
+	checkRotations<uint8_t>(rng);
+	checkRotations<uint16_t>(rng);
+	checkRotations<uint32_t>(rng);
+	checkRotations<uint64_t>(rng);
+	checkRotations<Tile16>(rng);
+
+	return 0;
+}
@@ -0,0 +1,196 @@
+#include "TileMap2D_Serialize.h"
+#include "TileMap2D_Chunked.h"
+#include "test.h"
+
+#include <sstream>
+
+using namespace tm2D;
+
+// Overwrite the field at [offset] of the serialized tilemap [data] with [value].
+template<typename F>
+void patch(std::string& data, size_t offset, F value)
+{
+	std::memcpy(data.data() + offset, &value, sizeof(F));
+}
+
+// Stream buffer that can only be written sequentially, like a pipe.
+struct SequentialBuffer: public std::streambuf
+{
+	std::string data;
+
+protected:
+	int_type overflow(int_type c) final
+	{
+		if (c != traits_type::eof()) data.push_back(traits_type::to_char_type(c));
+		return traits_type::not_eof(c);
+	}
+	std::streamsize xsputn(const char* s, std::streamsize n) final
+	{
+		data.append(s, (size_t)n);
+		return n;
+	}
+};
+
+// Tilemap counting the reads of its tiles.
+struct CountingMap
+{
+	TileMap2D_1D<uint16_t> tiles;
+	mutable size_t reads = 0;
+
+	size_t width() const { return tiles.width(); }
+	size_t height() const { return tiles.height(); }
+	uint16_t& operator()(size_t x, size_t y) { reads++; return tiles(x, y); }
+	const uint16_t& operator()(size_t x, size_t y) const { reads++; return tiles(x, y); }
+};
+
+template<typename T>
+bool readString(const std::string& data, TileMap2D_1D<T>* output)
+{
+	std::istringstream in(data);
+	return readTileMap(in, output);
+}
+
+int main()
+{
+	std::mt19937 rng(13);
+
+	// Round-trips, with and without compression, and every chunk size clipped on the edges.
+	for (int trial = 0; trial < 40; trial++) {
+		TileMap2D_1D<uint16_t> map(rng() % 150, rng() % 130, 0);
+		test::randomize(map, rng, 5, 1 + rng() % 20);
+
+		SerializeOptions options;
+		options.chunk_size = 1 + rng() % 40;
+		options.compress = trial % 3 != 0;
+		std::ostringstream out;
+		TM2D_CHECK(writeTileMap(out, map, options));
+
+		TileMap2D_1D<uint16_t> loaded;
+		TM2D_CHECK(readString(out.str(), &loaded));
+		TM2D_CHECK(test::sameTiles(loaded, map));
+
+		// Partial loading, partly outside the tilemap, into a chunked tilemap.
+		std::istringstream in(out.str());
+		TileMapReader<uint16_t> reader;
+		TM2D_CHECK(reader.open(in));
+		const Rect area(rng() % 160, rng() % 140, rng() % 60, rng() % 60);
+		TileMap2D_Chunked<uint16_t, 4> chunked(100, 100, 7);
+		const size_t dx = rng() % 120, dy = rng() % 120;
+		TM2D_CHECK(reader.setChunk(&chunked, dx, dy, area));
+		for (size_t y = 0; y < chunked.height(); y++) {
+			for (size_t x = 0; x < chunked.width(); x++) {
+				const size_t sx = area.x + x - dx, sy = area.y + y - dy;
+				const bool inside = x >= dx && y >= dy && x - dx < area.width && y - dy < area.height && sx < map.width() && sy < map.height();
+				TM2D_CHECK(chunked(x, y) == (inside ? map(sx, sy) : 7));
+			}
+		}
+	}
+
+	// Uniform chunks larger than a run.
+	{
+		TileMap2D_1D<uint8_t> map(700, 300, 3);
+		SerializeOptions options;
+		options.chunk_size = 1000;
+		std::ostringstream out;
+		TM2D_CHECK(writeTileMap(out, map, options));
+		TM2D_CHECK(out.str().size() < 128);
+
+		TileMap2D_1D<uint8_t> loaded;
+		TM2D_CHECK(readString(out.str(), &loaded));
+		TM2D_CHECK(test::sameTiles(loaded, map));
+	}
+
+	// Seekable streams get each tile read once, and the header written last. Sequential streams get the same bytes, reading the tiles twice.
+	for (int trial = 0; trial < 20; trial++) {
+		CountingMap map{ TileMap2D_1D<uint16_t>(rng() % 150, rng() % 130, 0) };
+		test::randomize(map.tiles, rng, 5, 1 + rng() % 20);
+		SerializeOptions options;
+		options.chunk_size = 1 + rng() % 40;
+		options.compress = trial % 4 != 0;
+		const size_t count = map.width() * map.height();
+
+		std::ostringstream seekable;
+		seekable << "prefix";
+		TM2D_CHECK(writeTileMap(seekable, std::as_const(map), options));
+		seekable << "suffix";
+		TM2D_CHECK(map.reads == count);
+
+		SequentialBuffer buffer;
+		std::ostream sequential(&buffer);
+		TM2D_CHECK(sequential.tellp() == std::streampos(-1));
+		sequential << "prefix";
+		TM2D_CHECK(writeTileMap(sequential, std::as_const(map), options));
+		sequential << "suffix";
+		TM2D_CHECK(map.reads == 3 * count);
+		TM2D_CHECK(buffer.data == seekable.str());
+
+		TileMap2D_1D<uint16_t> loaded;
+		TM2D_CHECK(readString(buffer.data.substr(6, buffer.data.size() - 12), &loaded));
+		TM2D_CHECK(test::sameTiles(loaded, map.tiles));
+	}
+
+	// A serialized tilemap embedded between other data.
+	TileMap2D_1D<uint32_t> map(90, 70, 0);
+	test::randomize(map, rng, 1000, 8);
+	std::ostringstream out;
+	out << "prefix";
+	TM2D_CHECK(writeTileMap(out, map));
+	out << "suffix, which is not a trailer";
+	{
+		std::istringstream in(out.str());
+		in.seekg(6);
+		TileMap2D_1D<uint32_t> loaded;
+		TM2D_CHECK(readTileMap(in, &loaded));
+		TM2D_CHECK(test::sameTiles(loaded, map));
+	}
+
+	const std::string valid = out.str().substr(6, out.str().size() - 6 - 30);
+	TileMap2D_1D<uint32_t> loaded;
+	TM2D_CHECK(readString(valid, &loaded));
+
+	// Wrong tile size, truncation and corrupted fields fail without throwing.
+	{
+		TileMap2D_1D<uint16_t> other;
+		TM2D_CHECK(!readString(valid, &other));
+		TM2D_CHECK(!readString(valid.substr(0, valid.size() - 1), &loaded));
+		TM2D_CHECK(!readString(valid.substr(0, 30), &loaded));
+	}
+	{
+		// Petabytes of tiles in a single chunk.
+		std::ostringstream uniform;
+		TM2D_CHECK(writeTileMap(uniform, TileMap2D_1D<uint32_t>(10, 10, 1)));
+		std::string data = uniform.str();
+		TM2D_CHECK(readString(data, &loaded));
+		patch<uint64_t>(data, offsetof(SerializeHeader, width), 0xffffffff);
+		patch<uint64_t>(data, offsetof(SerializeHeader, height), 0xffffffff);
+		patch<uint32_t>(data, offsetof(SerializeHeader, chunk_size), 0xffffffff);
+		TM2D_CHECK(!readString(data, &loaded));
+	}
+	{
+		// An index of billions of chunks.
+		std::string data = valid;
+		patch<uint64_t>(data, offsetof(SerializeHeader, width), uint64_t(1) << 30);
+		patch<uint64_t>(data, offsetof(SerializeHeader, height), uint64_t(1) << 30);
+		TM2D_CHECK(!readString(data, &loaded));
+	}
+	{
+		// A size past the end of the stream.
+		std::string data = valid;
+		patch<uint64_t>(data, offsetof(SerializeHeader, size), data.size() + 1);
+		TM2D_CHECK(!readString(data, &loaded));
+	}
+	{
+		// Chunk entries claiming more tiles than they can hold.
+		std::string data = valid;
+		SerializeTrailer trailer;
+		std::memcpy(&trailer, data.data() + data.size() - sizeof(trailer), sizeof(trailer));
+		const size_t entry = trailer.index_offset;
+		patch<uint64_t>(data, entry + offsetof(SerializeChunkEntry, size), 4);
+		patch(data, entry + offsetof(SerializeChunkEntry, encoding), ChunkEncoding::RLE);
+		TM2D_CHECK(!readString(data, &loaded));
+		patch(data, entry + offsetof(SerializeChunkEntry, encoding), ChunkEncoding::Raw);
+		TM2D_CHECK(!readString(data, &loaded));
+	}
+
+	return 0;
+}
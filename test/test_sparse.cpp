@@ -0,0 +1,117 @@
+#include "TileMap2D_Chunked.h"
+#include "test.h"
+
+using namespace tm2D;
+
+int main()
+{
+	std::mt19937 rng(7);
+
+	// The same operations on a sparse tilemap and on a TileMap2D_1D give the same tiles, with and without compaction.
+	for (int trial = 0; trial < 30; trial++) {
+		const size_t width = 1 + rng() % 70, height = 1 + rng() % 70;
+		const uint8_t default_tile = uint8_t(rng() % 3);
+		TileMap2D_1D<uint8_t> expected(width, height, default_tile);
+		TileMap2D_Sparse<uint8_t, 3> sparse(width, height, default_tile);
+
+		test::compareOperations(sparse, expected, rng, 20);
+		sparse.compact();
+		TM2D_CHECK(test::sameTiles(sparse, expected));
+		test::compareOperations(sparse, expected, rng, 20);
+		TM2D_CHECK(sparse.defaultTile() == default_tile);
+	}
+
+	// The algorithms leave uniform chunks uniform when they write the tiles these already hold.
+	{
+		TileMap2D_Sparse<uint8_t, 3> sparse(24, 24, 5);
+		TM2D_CHECK(sparse.denseChunks() == 0);
+
+		fillRect(sparse, { 0, 0, 24, 24 }, 5);
+		transform(sparse, { 2, 2, 20, 20 }, [](uint8_t t) { return t; });
+		flip(sparse, true, false);
+		flip(sparse, false, true);
+		flip(sparse, true, true);
+		TM2D_CHECK(rot90(&sparse, true));
+		fillArea(sparse, { 12, 12 }, [](uint8_t t) { return t == 5; }, 5);
+		const TileMap2D_1D<uint8_t> uniform(16, 16, 5);
+		setChunk(&sparse, &uniform, 4, 4);
+		TM2D_CHECK(sparse.denseChunks() == 0);
+
+		// Rotating a non-square tilemap in place keeps its default tile.
+		sparse.reset(24, 16, 5);
+		TM2D_CHECK(rot90(&sparse, false));
+		TM2D_CHECK(sparse.width() == 16 && sparse.height() == 24);
+		TM2D_CHECK(sparse.defaultTile() == 5 && std::as_const(sparse)(0, 0) == 5);
+		TM2D_CHECK(sparse.denseChunks() == 0);
+
+		// Moving a single tile only makes the chunks it leaves and enters dense.
+		sparse.set(1, 1, 8);
+		TM2D_CHECK(sparse.denseChunks() == 1);
+		flip(sparse, true, false);
+		TM2D_CHECK(std::as_const(sparse)(14, 1) == 8);
+		TM2D_CHECK(sparse.denseChunks() == 2);
+		sparse.compact();
+		TM2D_CHECK(sparse.denseChunks() == 1);
+	}
+
+
+	// Only writes of other values than a uniform chunk's own make it dense, and compact() makes chunks holding a single value uniform again.
+	{
+		TileMap2D_Sparse<uint8_t, 3> sparse(20, 20, 0);
+		sparse.set(3, 3, 0);
+		fillRect(sparse, { 0, 0, 8, 8 }, 4);
+		TM2D_CHECK(sparse.denseChunks() == 1 && !sparse.isUniform(0, 0));
+		sparse.compact();
+		TM2D_CHECK(sparse.denseChunks() == 0 && sparse.isUniform(0, 0) && std::as_const(sparse)(7, 7) == 4);
+		const size_t directory = sparse.memoryUsage();
+
+		// Writing the value of the uniform chunk keeps it uniform, and another one fills a dense chunk with it.
+		sparse.set(5, 5, 4);
+		TM2D_CHECK(sparse.denseChunks() == 0);
+		sparse.set(5, 5, 1);
+		TM2D_CHECK(sparse.denseChunks() == 1 && std::as_const(sparse)(5, 5) == 1 && std::as_const(sparse)(0, 0) == 4 && std::as_const(sparse)(8, 0) == 0);
+		TM2D_CHECK(sparse.memoryUsage() == directory + 64);
+
+		// Writing through the non-const 'operator()' makes the chunk dense, even with its own value.
+		sparse(12, 12) = 0;
+		TM2D_CHECK(sparse.denseChunks() == 2 && !sparse.isUniform(1, 1));
+		sparse.compact();
+		TM2D_CHECK(sparse.denseChunks() == 1 && sparse.memoryUsage() == directory + 64);
+		sparse.set(5, 5, 4);
+		sparse.compact();
+		TM2D_CHECK(sparse.denseChunks() == 0 && sparse.memoryUsage() == directory);
+	}
+
+	// Resetting to the same number of chunks invalidates them without freeing their buffers, which the chunks made dense again reuse.
+	{
+		TileMap2D_Sparse<uint16_t, 3> sparse(30, 30, 1);
+		for (size_t i = 0; i < 30; i++) sparse.set(i, i, uint16_t(i + 2));
+		TM2D_CHECK(sparse.denseChunks() == 4);
+		const size_t usage = sparse.memoryUsage();
+
+		sparse.reset(32, 25, 7);
+		TM2D_CHECK(sparse.width() == 32 && sparse.height() == 25 && sparse.defaultTile() == 7);
+		TM2D_CHECK(sparse.denseChunks() == 0 && sparse.memoryUsage() == usage);
+		TM2D_CHECK(test::sameTiles(sparse, TileMap2D_1D<uint16_t>(32, 25, 7)));
+		for (size_t cy = 0; cy < sparse.chunksY(); cy++)
+			for (size_t cx = 0; cx < sparse.chunksX(); cx++) TM2D_CHECK(sparse.isUniform(cx, cy));
+
+		// The default tile of the new generation is not written, and other tiles fill the chunk from it rather than from the old tiles.
+		sparse.set(9, 9, 7);
+		TM2D_CHECK(sparse.denseChunks() == 0);
+		sparse.set(9, 9, 3);
+		TM2D_CHECK(sparse.denseChunks() == 1 && sparse.memoryUsage() == usage);
+		TM2D_CHECK(std::as_const(sparse)(9, 9) == 3 && std::as_const(sparse)(10, 10) == 7 && std::as_const(sparse)(8, 8) == 7);
+
+		// compact() frees the buffers of the invalidated chunks.
+		sparse.compact();
+		TM2D_CHECK(sparse.denseChunks() == 1 && sparse.memoryUsage() == usage - 3 * 64 * sizeof(uint16_t));
+
+		// Another number of chunks reallocates the directory.
+		sparse.reset(8, 8, 2);
+		TM2D_CHECK(sparse.denseChunks() == 0 && sparse.chunksX() == 1 && sparse.memoryUsage() <= usage);
+		TM2D_CHECK(std::as_const(sparse)(0, 0) == 2);
+	}
+
+	return 0;
+}
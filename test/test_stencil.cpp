@@ -0,0 +1,118 @@
+#include "TileMap2D_Stencil.h"
+#include "TileMap2D_Chunked.h"
+#include "test.h"
+
+using namespace tm2D;
+
+using Map = TileMap2D_1D<uint32_t>;
+
+// Get the neighbor of [input] at ([x]; [y]), possibly outside of it, following [border].
+uint32_t neighbor(const Map& input, ptrdiff_t x, ptrdiff_t y, Border border, uint32_t padding)
+{
+	const ptrdiff_t width = (ptrdiff_t)input.width(), height = (ptrdiff_t)input.height();
+	switch (border) {
+	case Border::Clamp: return input(std::clamp<ptrdiff_t>(x, 0, width - 1), std::clamp<ptrdiff_t>(y, 0, height - 1));
+	case Border::Wrap: return input((x % width + width) % width, (y % height + height) % height);
+	default: return x >= 0 && x < width && y >= 0 && y < height ? input(x, y) : padding;
+	}
+}
+
+// Apply [kernel] to the neighborhoods of [input] gathered tile by tile.
+template<size_t Radius, typename Kernel>
+Map naiveStencil(const Map& input, Kernel& kernel, Border border, uint32_t padding)
+{
+	constexpr size_t size = 2 * Radius + 1;
+	Map output(input.width(), input.height(), 0);
+	uint32_t window[size][size];
+	const uint32_t* rows[size];
+	for (size_t i = 0; i < size; i++) rows[i] = window[i];
+
+	for (size_t y = 0; y < input.height(); y++) {
+		for (size_t x = 0; x < input.width(); x++) {
+			for (size_t dy = 0; dy < size; dy++)
+				for (size_t dx = 0; dx < size; dx++)
+					window[dy][dx] = neighbor(input, ptrdiff_t(x + dx) - ptrdiff_t(Radius), ptrdiff_t(y + dy) - ptrdiff_t(Radius), border, padding);
+			output(x, y) = kernel(Neighborhood<uint32_t, Radius>(rows, Radius, { x, y }));
+		}
+	}
+	return output;
+}
+
+// Check the stencils of [Radius] against the naive ones, with each border.
+template<size_t Radius>
+void checkStencils(std::mt19937& rng)
+{
+	using N = Neighborhood<uint32_t, Radius>;
+	// Weights every neighbor by its offset, and the position.
+	const auto weighted = [](const N& n) {
+		uint32_t sum = uint32_t(n.position.x * 7 + n.position.y * 131);
+		for (ptrdiff_t dy = -(ptrdiff_t)Radius; dy <= (ptrdiff_t)Radius; dy++)
+			for (ptrdiff_t dx = -(ptrdiff_t)Radius; dx <= (ptrdiff_t)Radius; dx++)
+				sum += n(dx, dy) * uint32_t((dx + 10) * (3 * dy + 31));
+		return sum;
+	};
+	// Keeps the tiles small over the iterations.
+	const auto majority = [](const N& n) { return uint32_t(n.reduce(0u, std::plus<>()) * 2 > N::size * N::size ? 1 : 0) ^ (n.center() & 1); };
+	const execution::parallel_policy par = execution::par.withThreshold(0);
+
+	for (int trial = 0; trial < 200; trial++) {
+		// Down to narrower and shorter than a neighborhood.
+		Map input(1 + rng() % (trial % 4 ? 40 : 2 * Radius + 1), 1 + rng() % (trial % 3 ? 40 : 2 * Radius + 1), 0);
+		test::randomize(input, rng, trial % 2 ? 1000 : 2);
+		const Border border = Border(trial % 3);
+		const uint32_t padding = rng() % 1000;
+		const Map expected = naiveStencil<Radius>(input, weighted, border, padding);
+
+		Map output;
+		applyStencil<Radius>(&output, &input, weighted, border, padding);
+		TM2D_CHECK(test::sameTiles(output, expected));
+		applyStencil<Radius>(par, &output, &input, weighted, border, padding);
+		TM2D_CHECK(test::sameTiles(output, expected));
+
+		// Chunked input and output.
+		TileMap2D_Chunked<uint32_t, 3> chunked_input(input.width(), input.height()), chunked_output;
+		setChunk(&chunked_input, &input, 0, 0);
+		applyStencil<Radius>(&chunked_output, &chunked_input, weighted, border, padding);
+		TM2D_CHECK(test::sameTiles(chunked_output, expected));
+		applyStencil<Radius>(par, &chunked_output, &chunked_input, weighted, border, padding);
+		TM2D_CHECK(test::sameTiles(chunked_output, expected));
+		applyStencil<Radius>(par, &output, &chunked_input, weighted, border, padding);
+		TM2D_CHECK(test::sameTiles(output, expected));
+
+		// Into a view, not resizable, computing only the tiles within both tilemaps.
+		Map target(1 + rng() % 50, 1 + rng() % 50, 5);
+		TileMap2DView<uint32_t> view = target.subview({ 0, 0, SIZE_MAX, SIZE_MAX });
+		Map view_expected = target;
+		const Rect within(0, 0, std::min<>(target.width(), input.width()), std::min<>(target.height(), input.height()));
+		Map cropped;
+		getChunk(&cropped, &expected, within);
+		setChunk(&view_expected, &cropped, 0, 0);
+		applyStencil<Radius>(par, &view, &input, weighted, border, padding);
+		TM2D_CHECK(test::sameTiles(target, view_expected));
+
+		// Iterations alternating buffers, with odd and even counts.
+		const size_t iterations = rng() % 5;
+		Map iterated_expected = input;
+		for (size_t i = 0; i < iterations; i++) iterated_expected = naiveStencil<Radius>(iterated_expected, majority, border, padding);
+		Map iterated = input;
+		iterateStencil<Radius>(&iterated, iterations, majority, border, padding);
+		TM2D_CHECK(test::sameTiles(iterated, iterated_expected));
+		iterated = input;
+		iterateStencil<Radius>(par, &iterated, iterations, majority, border, padding);
+		TM2D_CHECK(test::sameTiles(iterated, iterated_expected));
+		iterateStencil<Radius>(par, &chunked_input, iterations, majority, border, padding);
+		TM2D_CHECK(test::sameTiles(chunked_input, iterated_expected));
+	}
+}
+
+int main()
+{
+	std::mt19937 rng(26);
+
+	checkStencils<0>(rng);
+	checkStencils<1>(rng);
+	checkStencils<2>(rng);
+	checkStencils<3>(rng);
+
+	return 0;
+}
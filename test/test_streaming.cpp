@@ -0,0 +1,134 @@
+#include "TileMap2D_Streaming.h"
+#include "test.h"
+
+#include <set>
+#include <stdexcept>
+
+using namespace tm2D;
+
+using Streamer = ChunkStreamer<uint16_t, 4>;
+
+constexpr uint16_t padding = 0xffff;
+
+// Tile of the streamed world at ([x]; [y]), or the padding tile in the empty chunks.
+uint16_t worldTile(size_t x, size_t y)
+{
+	if (((x >> 4) + (y >> 4)) % 5 == 0) return padding;
+	return uint16_t((x * 7 + y * 3) % 251);
+}
+
+// Load the tiles of worldTile(), telling the empty chunks apart.
+bool loadChunk(const Rect& area, TileMap2DView<uint16_t> tiles)
+{
+	if (worldTile(area.x, area.y) == padding) return false;
+	for (size_t y = 0; y < area.height; y++)
+		for (size_t x = 0; x < area.width; x++)
+			tiles(x, y) = worldTile(area.x + x, area.y + y);
+	return true;
+}
+
+// Check that the tiles of the loaded chunks of [world] are the ones of worldTile(), and that the other ones read as the padding tile.
+void checkTiles(const Streamer::Map& world, const Streamer& streamer)
+{
+	for (size_t y = 0; y < world.height(); y++) {
+		for (size_t x = 0; x < world.width(); x++) {
+			const bool loaded = streamer.isLoaded(x >> 4, y >> 4);
+			TM2D_CHECK(world(x, y) == (loaded ? worldTile(x, y) : padding));
+		}
+	}
+}
+
+int main()
+{
+	ThreadPool pool(2);
+
+	// Loading, and eviction down to the memory budget of the chunks not in use.
+	{
+		Streamer::Map world(200, 150, padding);
+		StreamingOptions options;
+		options.memory_budget = 6 * Streamer::chunk_bytes;
+		options.margin = 0;
+		Streamer streamer(world, loadChunk, pool, options);
+		std::set<std::pair<size_t, size_t>> unloaded;
+		streamer.setUnloader([&](const Rect& area, TileMap2DView<uint16_t> tiles) {
+			TM2D_CHECK(unloaded.insert({ area.x, area.y }).second);
+			for (size_t y = 0; y < area.height; y++)
+				for (size_t x = 0; x < area.width; x++)
+					TM2D_CHECK(tiles(x, y) == worldTile(area.x + x, area.y + y));
+		});
+
+		streamer.load({ 0, 0, 200, 150 });
+		TM2D_CHECK(streamer.pendingLoads() == 0);
+		size_t allocated = 0;
+		for (size_t cy = 0; cy < world.chunksY(); cy++) {
+			for (size_t cx = 0; cx < world.chunksX(); cx++) {
+				TM2D_CHECK(streamer.isLoaded(cx, cy));
+				allocated += world.chunk(cx, cy) != nullptr;
+			}
+		}
+		TM2D_CHECK(streamer.memoryUsage() == allocated * Streamer::chunk_bytes);
+		checkTiles(world, streamer);
+
+		// The chunks of the view and the pinned ones are kept over the budget.
+		{
+			const Streamer::Pin pin = streamer.pin({ 150, 100, 40, 40 });
+			streamer.update({ 20, 20, 40, 40 });
+			TM2D_CHECK(streamer.memoryUsage() > options.memory_budget);
+			for (size_t cy = 1; cy < 4; cy++)
+				for (size_t cx = 1; cx < 4; cx++)
+					TM2D_CHECK(streamer.isLoaded(cx, cy) && streamer.isLoaded(cx + 8, cy + 5));
+			checkTiles(world, streamer);
+		}
+		TM2D_CHECK(unloaded.size() == allocated - 15);
+
+		streamer.update({ 0, 0, 1, 1 });
+		TM2D_CHECK(streamer.memoryUsage() <= options.memory_budget);
+		TM2D_CHECK(unloaded.size() == allocated - 6);
+		checkTiles(world, streamer);
+	}
+
+	// Prefetching along the velocity of the view, and chunks written to before their load completes.
+	{
+		Streamer::Map world(200, 150, padding);
+		StreamingOptions options;
+		options.margin = 0;
+		options.lookahead = 1.0;
+		options.max_prefetches = 100;
+		Streamer streamer(world, loadChunk, pool, options);
+
+		streamer.update({ 16, 16, 16, 16 }, 40.0, 0.0);
+		TM2D_CHECK(streamer.pendingLoads() == 4);
+		world.set(60, 20, 1234);
+		streamer.request({ 16, 16, 64, 16 }).wait();
+		TM2D_CHECK(streamer.poll() == 2);
+		for (size_t cx = 1; cx < 5; cx++) TM2D_CHECK(streamer.isLoaded(cx, 1));
+		TM2D_CHECK(!streamer.isLoaded(5, 1) && !streamer.isLoaded(1, 0));
+		TM2D_CHECK(world(60, 20) == 1234 && world(61, 20) == padding && world(40, 20) == worldTile(40, 20));
+	}
+
+	// Exceptions of the loader are rethrown, the chunk being left unloaded.
+	{
+		Streamer::Map world(64, 64, padding);
+		bool fail = true;
+		Streamer streamer(world, [&](const Rect& area, TileMap2DView<uint16_t> tiles) {
+			if (fail && area.x == 16) throw std::runtime_error("load failed");
+			return loadChunk(area, tiles);
+		}, pool);
+
+		bool thrown = false;
+		try {
+			streamer.load({ 0, 0, 32, 16 });
+		}
+		catch (const std::runtime_error&) {
+			thrown = true;
+		}
+		TM2D_CHECK(thrown && streamer.isLoaded(0, 0) && !streamer.isLoaded(1, 0));
+
+		fail = false;
+		streamer.load({ 0, 0, 32, 16 });
+		TM2D_CHECK(streamer.isLoaded(1, 0));
+		checkTiles(world, streamer);
+	}
+
+	return 0;
+}